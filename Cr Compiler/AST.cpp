@@ -13,8 +13,347 @@
 
 #include "Parser.h"
 
+#include <climits>
+#include <cmath>
+
 namespace Cr
 {
+	// *************************************************************** //
+	// **                 Value class implementation.               ** //
+	// *************************************************************** //
+
+	/**
+	 * Initializes a zero value of the specified type.
+	 */
+	CR_API Ast::Value::Value(BaseType const baseType, uint8_t const rows, uint8_t const columns)
+		: m_BaseType(baseType), m_Rows(rows), m_Columns(columns), m_Double()
+	{
+		CrAssert(rows * columns <= s_MaxComponents);
+	}
+
+	/**
+	 * Converts the value to the specified type. Scalars are broadcast, extra components are dropped 
+	 * and missing ones are zero.
+	 */
+	CR_API Ast::Value Ast::Value::Convert(BaseType const baseType, uint8_t const rows, uint8_t const columns) const
+	{
+		if (baseType == m_BaseType && rows == m_Rows && columns == m_Columns)
+		{
+			return *this;
+		}
+
+		Value result(baseType, rows, columns);
+		for (uint8_t row = 0; row < rows; ++row)
+		{
+			for (uint8_t column = 0; column < columns; ++column)
+			{
+				if (!IsScalar() && (row >= m_Rows || column >= m_Columns))
+				{
+					continue;
+				}
+				auto const index = IsScalar() ? 0 : row * m_Columns + column;
+				auto const resultIndex = row * columns + column;
+				switch (baseType)
+				{
+					case BaseType::Bool:   result.m_Int[resultIndex] = GetComponent<bool>(index); break;
+					case BaseType::UInt:   result.m_Int[resultIndex] = static_cast<int32_t>(GetComponent<uint32_t>(index)); break;
+					case BaseType::Float:  result.m_Float[resultIndex] = GetComponent<float>(index); break;
+					case BaseType::Double: result.m_Double[resultIndex] = GetComponent<double>(index); break;
+					default:               result.m_Int[resultIndex] = GetComponent<int32_t>(index); break;
+				}
+			}
+		}
+		return result;
+	}
+
+	/**
+	 * Converts both operands to the common base type, that is not lower than the specified one, and 
+	 * broadcasts the scalar operand to the shape of the other one.
+	 */
+	CR_INTERNAL void Ast::Value::ConvertToCommonType(Value& lhs, Value& rhs, BaseType const lowestBaseType)
+	{
+		auto const baseType = std::max({ lhs.m_BaseType, rhs.m_BaseType, lowestBaseType });
+		auto const& shape = lhs.IsScalar() ? rhs : lhs;
+		if (!rhs.IsScalar() && (rhs.m_Rows != shape.m_Rows || rhs.m_Columns != shape.m_Columns))
+		{
+			throw ParserException("Incompatible dimensions of the operands while evaluating expression.");
+		}
+		lhs = lhs.Convert(baseType, shape.m_Rows, shape.m_Columns);
+		rhs = rhs.Convert(baseType, lhs.m_Rows, lhs.m_Columns);
+	}
+
+	/**
+	 * Applies the vectorized operation to the operands, converted to the common type. Booleans are promoted to integers.
+	 */
+	CR_INTERNAL Ast::Value Ast::Value::Compute(Simd::ComponentOp const op, Value lhs, Value rhs)
+	{
+		ConvertToCommonType(lhs, rhs, BaseType::Int);
+		Value result(lhs.m_BaseType, lhs.m_Rows, lhs.m_Columns);
+		switch (result.m_BaseType)
+		{
+			case BaseType::Float:  Simd::Compute(op, result.m_Float, lhs.m_Float, rhs.m_Float, result.GetComponentsCount()); break;
+			case BaseType::Double: Simd::Compute(op, result.m_Double, lhs.m_Double, rhs.m_Double, result.GetComponentsCount()); break;
+			default:               Simd::Compute(op, result.m_Int, lhs.m_Int, rhs.m_Int, result.GetComponentsCount()); break;
+		}
+		return result;
+	}
+
+	/**
+	 * Compares the components of the operands, converted to the common type.
+	 */
+	template<typename TCompare>
+	CR_INTERNAL Ast::Value Ast::Value::Compare(Value lhs, Value rhs, TCompare const& compare)
+	{
+		ConvertToCommonType(lhs, rhs, BaseType::Null);
+		Value result(BaseType::Bool, lhs.m_Rows, lhs.m_Columns);
+		for (size_t i = 0; i < result.GetComponentsCount(); ++i)
+		{
+			switch (lhs.m_BaseType)
+			{
+				case BaseType::UInt:   result.m_Int[i] = compare(static_cast<uint32_t>(lhs.m_Int[i]), static_cast<uint32_t>(rhs.m_Int[i])); break;
+				case BaseType::Float:  result.m_Int[i] = compare(lhs.m_Float[i], rhs.m_Float[i]); break;
+				case BaseType::Double: result.m_Int[i] = compare(lhs.m_Double[i], rhs.m_Double[i]); break;
+				default:               result.m_Int[i] = compare(lhs.m_Int[i], rhs.m_Int[i]); break;
+			}
+		}
+		return result;
+	}
+
+	// *************************************************************** //
+	CR_INTERNAL void Ast::Value::VerifyNoZeroComponents() const
+	{
+		// Floating point division by zero is not an error, it produces the infinity or NaN.
+		if (m_BaseType == BaseType::Float || m_BaseType == BaseType::Double)
+		{
+			return;
+		}
+		for (size_t i = 0; i < GetComponentsCount(); ++i)
+		{
+			if (GetComponent<double>(i) == 0.0)
+			{
+				throw ParserException("Division by zero occurred while evaluating expression.");
+			}
+		}
+	}
+
+	//
+	// Unary ops.
+	//
+	CR_API Ast::Value Ast::Value::operator-() const
+	{
+		auto result = Convert(std::max(m_BaseType, BaseType::Int));
+		for (size_t i = 0; i < result.GetComponentsCount(); ++i)
+		{
+			switch (result.m_BaseType)
+			{
+				case BaseType::Float:  result.m_Float[i] = -result.m_Float[i]; break;
+				case BaseType::Double: result.m_Double[i] = -result.m_Double[i]; break;
+				default:               result.m_Int[i] = static_cast<int32_t>(0u - static_cast<uint32_t>(result.m_Int[i])); break;
+			}
+		}
+		return result;
+	}
+	CR_API Ast::Value Ast::Value::operator!() const
+	{
+		auto result = Convert(BaseType::Bool);
+		for (size_t i = 0; i < result.GetComponentsCount(); ++i)
+		{
+			result.m_Int[i] = !result.m_Int[i];
+		}
+		return result;
+	}
+	CR_API Ast::Value Ast::Value::operator~() const
+	{
+		auto result = Convert(std::max(m_BaseType, BaseType::Int));
+		if (result.m_BaseType > BaseType::UInt)
+		{
+			throw ParserException("Bitwise operations require integral operands.");
+		}
+		for (size_t i = 0; i < result.GetComponentsCount(); ++i)
+		{
+			result.m_Int[i] = ~result.m_Int[i];
+		}
+		return result;
+	}
+
+	//
+	// Binary bitwise ops.
+	//
+	CR_API Ast::Value Ast::Value::operator|(Value const& rhs) const
+	{
+		return Compute(Simd::ComponentOp::BitwiseOr, *this, rhs);
+	}
+	CR_API Ast::Value Ast::Value::operator&(Value const& rhs) const
+	{
+		return Compute(Simd::ComponentOp::BitwiseAnd, *this, rhs);
+	}
+	CR_API Ast::Value Ast::Value::operator^(Value const& rhs) const
+	{
+		return Compute(Simd::ComponentOp::BitwiseXor, *this, rhs);
+	}
+	CR_API Ast::Value Ast::Value::operator<<(Value const& rhs) const
+	{
+		// Shifts keep the type of the left operand. Shift amount is masked like on the GPU.
+		auto result = Convert(std::max(m_BaseType, BaseType::Int));
+		auto const amount = rhs.Convert(BaseType::UInt, result.m_Rows, result.m_Columns);
+		for (size_t i = 0; i < result.GetComponentsCount(); ++i)
+		{
+			result.m_Int[i] = static_cast<int32_t>(static_cast<uint32_t>(result.m_Int[i]) << (amount.m_Int[i] & 31));
+		}
+		return result;
+	}
+	CR_API Ast::Value Ast::Value::operator>>(Value const& rhs) const
+	{
+		auto result = Convert(std::max(m_BaseType, BaseType::Int));
+		auto const amount = rhs.Convert(BaseType::UInt, result.m_Rows, result.m_Columns);
+		for (size_t i = 0; i < result.GetComponentsCount(); ++i)
+		{
+			// Signed integers are shifted arithmetically, unsigned ones logically.
+			result.m_Int[i] = result.m_BaseType == BaseType::UInt 
+				? static_cast<int32_t>(static_cast<uint32_t>(result.m_Int[i]) >> (amount.m_Int[i] & 31))
+				: result.m_Int[i] >> (amount.m_Int[i] & 31);
+		}
+		return result;
+	}
+
+	//
+	// Binary logic ops.
+	//
+	CR_API Ast::Value Ast::Value::operator||(Value const& rhs) const
+	{
+		return Compare(Convert(BaseType::Bool), rhs.Convert(BaseType::Bool), [](int32_t const a, int32_t const b) { return a || b; });
+	}
+	CR_API Ast::Value Ast::Value::operator&&(Value const& rhs) const
+	{
+		return Compare(Convert(BaseType::Bool), rhs.Convert(BaseType::Bool), [](int32_t const a, int32_t const b) { return a && b; });
+	}
+	CR_API Ast::Value Ast::Value::operator==(Value const& rhs) const
+	{
+		return Compare(*this, rhs, [](auto const a, auto const b) { return a == b; });
+	}
+	CR_API Ast::Value Ast::Value::operator!=(Value const& rhs) const
+	{
+		return Compare(*this, rhs, [](auto const a, auto const b) { return a != b; });
+	}
+	CR_API Ast::Value Ast::Value::operator<(Value const& rhs) const
+	{
+		return Compare(*this, rhs, [](auto const a, auto const b) { return a < b; });
+	}
+	CR_API Ast::Value Ast::Value::operator>(Value const& rhs) const
+	{
+		return Compare(*this, rhs, [](auto const a, auto const b) { return a > b; });
+	}
+	CR_API Ast::Value Ast::Value::operator<=(Value const& rhs) const
+	{
+		return Compare(*this, rhs, [](auto const a, auto const b) { return a <= b; });
+	}
+	CR_API Ast::Value Ast::Value::operator>=(Value const& rhs) const
+	{
+		return Compare(*this, rhs, [](auto const a, auto const b) { return a >= b; });
+	}
+
+	//
+	// Binary arithmetic ops.
+	//
+	CR_API Ast::Value Ast::Value::operator+(Value const& rhs) const
+	{
+		return Compute(Simd::ComponentOp::Add, *this, rhs);
+	}
+	CR_API Ast::Value Ast::Value::operator-(Value const& rhs) const
+	{
+		return Compute(Simd::ComponentOp::Subtract, *this, rhs);
+	}
+	CR_API Ast::Value Ast::Value::operator*(Value const& rhs) const
+	{
+		return Compute(Simd::ComponentOp::Multiply, *this, rhs);
+	}
+	CR_API Ast::Value Ast::Value::operator/(Value const& rhs) const
+	{
+		auto lhsValue = *this, rhsValue = rhs;
+		ConvertToCommonType(lhsValue, rhsValue, BaseType::Int);
+		rhsValue.VerifyNoZeroComponents();
+		switch (lhsValue.m_BaseType)
+		{
+			case BaseType::Float: case BaseType::Double:
+				return Compute(Simd::ComponentOp::Divide, lhsValue, rhsValue);
+			case BaseType::UInt:
+				for (size_t i = 0; i < lhsValue.GetComponentsCount(); ++i)
+				{
+					lhsValue.m_Int[i] = static_cast<int32_t>(static_cast<uint32_t>(lhsValue.m_Int[i]) / static_cast<uint32_t>(rhsValue.m_Int[i]));
+				}
+				return lhsValue;
+			default:
+				for (size_t i = 0; i < lhsValue.GetComponentsCount(); ++i)
+				{
+					// INT_MIN / -1 overflows, wrapping it around like the hardware.
+					lhsValue.m_Int[i] = rhsValue.m_Int[i] == -1 ? static_cast<int32_t>(0u - static_cast<uint32_t>(lhsValue.m_Int[i])) : lhsValue.m_Int[i] / rhsValue.m_Int[i];
+				}
+				return lhsValue;
+		}
+	}
+	CR_API Ast::Value Ast::Value::operator%(Value const& rhs) const
+	{
+		auto lhsValue = *this, rhsValue = rhs;
+		ConvertToCommonType(lhsValue, rhsValue, BaseType::Int);
+		rhsValue.VerifyNoZeroComponents();
+		for (size_t i = 0; i < lhsValue.GetComponentsCount(); ++i)
+		{
+			switch (lhsValue.m_BaseType)
+			{
+				case BaseType::UInt:   lhsValue.m_Int[i] = static_cast<int32_t>(static_cast<uint32_t>(lhsValue.m_Int[i]) % static_cast<uint32_t>(rhsValue.m_Int[i])); break;
+				case BaseType::Float:  lhsValue.m_Float[i] = std::fmod(lhsValue.m_Float[i], rhsValue.m_Float[i]); break;
+				case BaseType::Double: lhsValue.m_Double[i] = std::fmod(lhsValue.m_Double[i], rhsValue.m_Double[i]); break;
+				default:               lhsValue.m_Int[i] = rhsValue.m_Int[i] == -1 ? 0 : lhsValue.m_Int[i] % rhsValue.m_Int[i]; break;
+			}
+		}
+		return lhsValue;
+	}
+
+	//
+	// Ops by lexeme type.
+	//
+	CR_API Ast::Value Ast::Value::Apply(Lexeme::Type const op) const
+	{
+		switch (op)
+		{
+			case Lexeme::Type::OpAdd:        return +*this;
+			case Lexeme::Type::OpSubtract:   return -*this;
+			case Lexeme::Type::OpNot:        return !*this;
+			case Lexeme::Type::OpBitwiseNot: return ~*this;
+			default:
+				CrAssert(0);
+				return Value();
+		}
+	}
+	CR_API Ast::Value Ast::Value::Apply(Lexeme::Type const op, Value const& rhs) const
+	{
+		auto const& lhs = *this;
+		switch (op)
+		{
+			case Lexeme::Type::OpOr:                return lhs || rhs;
+			case Lexeme::Type::OpAnd:               return lhs && rhs;
+			case Lexeme::Type::OpEquals:            return lhs == rhs;
+			case Lexeme::Type::OpNotEquals:         return lhs != rhs;
+			case Lexeme::Type::OpLess:              return lhs < rhs;
+			case Lexeme::Type::OpGreater:           return lhs > rhs;
+			case Lexeme::Type::OpLessEquals:        return lhs <= rhs;
+			case Lexeme::Type::OpGreaterEquals:     return lhs >= rhs;
+			case Lexeme::Type::OpBitwiseOr:         return lhs | rhs;
+			case Lexeme::Type::OpBitwiseAnd:        return lhs & rhs;
+			case Lexeme::Type::OpBitwiseXor:        return lhs ^ rhs;
+			case Lexeme::Type::OpBitwiseLeftShift:  return lhs << rhs;
+			case Lexeme::Type::OpBitwiseRightShift: return lhs >> rhs;
+			case Lexeme::Type::OpAdd:               return lhs + rhs;
+			case Lexeme::Type::OpSubtract:          return lhs - rhs;
+			case Lexeme::Type::OpMultiply:          return lhs * rhs;
+			case Lexeme::Type::OpDivide:            return lhs / rhs;
+			case Lexeme::Type::OpModulo:            return lhs % rhs;
+			default:
+				CrAssert(0);
+				return Value();
+		}
+	}
+
 	// --------------------------------------------------------------- //
 	// --               Selection statement parsing.                -- //
 	// --------------------------------------------------------------- //
@@ -29,9 +368,9 @@ namespace Cr
 			throw ParserException("Condition expression of the 'if' statement must be convertible to scalar boolean "
 				"value.");
 		}
-		m_CondExpr.reset(condExpr);
-		m_ThenStmt.reset(thenStmt);
-		m_ElseStmt.reset(elseStmt);
+		m_CondExpr = condExpr;
+		m_ThenStmt = thenStmt;
+		m_ElseStmt = elseStmt;
 	}
 
 	// *************************************************************** //
@@ -41,6 +380,61 @@ namespace Cr
 		{
 			throw ParserException("Expression of the 'switch' statement must be convertible to scalar integral value.");
 		}
-		m_SelectionExpr.reset(switchExpr);
+		m_SelectionExpr = switchExpr;
 	}
+
+	// *************************************************************** //
+	// **                    Value class unit tests.                ** //
+	// *************************************************************** //
+
+	CrUnitTest(ValueEvaluate)
+	{
+		using Ast::Value;
+		using Ast::BaseType;
+
+		CrAssert((Value(7) - Value(3)).To<int32_t>() == 4);
+		CrAssert((Value(7u) - Value(8u)).To<uint32_t>() == UINT32_MAX);
+		CrAssert((Value(-7) / Value(2)).To<int32_t>() == -3 && (Value(-7) % Value(2)).To<int32_t>() == -1);
+		CrAssert((Value(INT32_MIN) / Value(-1)).To<int32_t>() == INT32_MIN);
+		CrAssert((Value(0xF0u) >> Value(4)).To<uint32_t>() == 0xF && (Value(-16) >> Value(2)).To<int32_t>() == -4);
+		CrAssert((Value(true) + Value(true)).GetBaseType() == BaseType::Int);
+
+		// Operands are converted to the common base type in its native width.
+		auto const sum = Value(1) + Value(0.5f);
+		CrAssert(sum.GetBaseType() == BaseType::Float && sum.To<float>() == 1.5f);
+		CrAssert((Value(0.1f) + Value(0.2f)).To<float>() == 0.1f + 0.2f);
+		CrAssert((Value(0.1) + Value(0.2)).To<double>() == 0.1 + 0.2);
+		CrAssert((Value(2) < Value(2.5)).To<bool>() && (Value(2) == Value(2.0f)).GetBaseType() == BaseType::Bool);
+
+		// Only the components of the real shape are evaluated, scalars are broadcast.
+		auto const vector = Value(1.0f).Convert(BaseType::Float, 1, 3) * Value(3.0f) - Value(0.5f);
+		CrAssert(vector.GetRows() == 1 && vector.GetColumns() == 3 && vector.GetComponent<float>(2) == 2.5f);
+		auto const matrix = Value(2).Convert(BaseType::Int, 4, 4) + Value(1).Convert(BaseType::Int, 4, 4);
+		CrAssert(matrix.GetComponentsCount() == 16 && matrix.GetComponent<int32_t>(15) == 3);
+		auto const truncated = matrix.Convert(BaseType::Double, 2, 2);
+		CrAssert(truncated.GetComponentsCount() == 4 && truncated.GetComponent<double>(3) == 3.0);
+
+		auto dimensionMismatchThrown = false;
+		try
+		{
+			Value(1.0f).Convert(BaseType::Float, 1, 2) / Value(1.0f).Convert(BaseType::Float, 2, 1);
+		}
+		catch (ParserException const&)
+		{
+			dimensionMismatchThrown = true;
+		}
+		CrAssert(dimensionMismatchThrown);
+		auto divisionByZeroThrown = false;
+		try
+		{
+			Value(1) / Value(0);
+		}
+		catch (ParserException const&)
+		{
+			divisionByZeroThrown = true;
+		}
+		CrAssert(divisionByZeroThrown);
+		CrAssert(std::isinf((Value(1) / Value(0.0)).To<double>()) && std::isnan((Value(0.0f) / Value(0.0f)).To<float>()));
+		CrAssert(std::isnan((Value(1.0f) % Value(0.0f)).To<float>()));
+	};
 }
@@ -15,252 +15,19 @@
 
 #include "Utils.h"
 #include "Lexeme.h"
-#include <vector>
+#include "Simd.h"
+#include <algorithm>
+#include <type_traits>
 
 namespace Cr
 {
 	class Parser;
+	class FlatAst;
 	template<typename T> using std__shared_ptr = T*;
 	CrDefineExceptionBase(ParserException, WorkflowException);
 
 	namespace Ast
 	{
-		union Value
-		{
-		public:
-			double m_Scalar;
-			double m_Vector[4];
-			double m_Matrix[4][4] = {};
-
-		public:
-			CRINL Value(double const scalar = 0.0f)
-				: m_Scalar(scalar) {}
-			CRINL Value& operator= (double const scalar)
-			{
-				m_Scalar = scalar;
-				return *this;
-			}
-
-			template<typename Tp>
-			CRINL Tp To() const
-			{
-				return static_cast<Tp>(m_Scalar);
-			}
-
-		public:
-			CRINL double& operator()(size_t const i, size_t const j)
-			{
-				return m_Matrix[i][j];
-			}
-			CRINL double operator()(size_t const i, size_t const j) const
-			{
-				return m_Matrix[i][j];
-			}
-
-			//
-			// Unary ops.
-			//
-			CRINL Value operator+() const
-			{
-				return *this;
-			}
-			CRINL Value operator-() const
-			{
-				Value result;
-				for (auto i = 0; i < 4; ++i)
-					for (auto j = 0; j < 4; ++j)
-						result(i, j) = -m_Matrix[i][j];
-				return result;
-			}
-			CRINL Value operator!() const
-			{
-				Value result;
-				for (auto i = 0; i < 4; ++i)
-					for (auto j = 0; j < 4; ++j)
-						result(i, j) = !m_Matrix[i][j];
-				return result;
-			}
-			CRINL Value operator~() const
-			{
-				Value result;
-				for (auto i = 0; i < 4; ++i)
-					for (auto j = 0; j < 4; ++j)
-						result(i, j) = ~static_cast<int32_t>(m_Matrix[i][j]);
-				return result;
-			}
-
-			//
-			// Binary logic ops.
-			//
-			CRINL Value operator|(Value const& rhs) const
-			{
-				Value result;
-				for (auto i = 0; i < 4; ++i)
-					for (auto j = 0; j < 4; ++j)
-						result(i, j) = static_cast<int32_t>(m_Matrix[i][j]) | static_cast<int32_t>(rhs(i, j));
-				return result;
-			}
-			CRINL Value operator&(Value const& rhs) const
-			{
-				Value result;
-				for (auto i = 0; i < 4; ++i)
-					for (auto j = 0; j < 4; ++j)
-						result(i, j) = static_cast<int32_t>(m_Matrix[i][j]) & static_cast<int32_t>(rhs(i, j));
-				return result;
-			}
-			CRINL Value operator^(Value const& rhs) const
-			{
-				Value result;
-				for (auto i = 0; i < 4; ++i)
-					for (auto j = 0; j < 4; ++j)
-						result(i, j) = static_cast<int32_t>(m_Matrix[i][j]) ^ static_cast<int32_t>(rhs(i, j));
-				return result;
-			}
-			CRINL Value operator<<(Value const& rhs) const
-			{
-				Value result;
-				for (auto i = 0; i < 4; ++i)
-					for (auto j = 0; j < 4; ++j)
-						result(i, j) = static_cast<int32_t>(m_Matrix[i][j]) << static_cast<int32_t>(rhs(i, j));
-				return result;
-			}
-			CRINL Value operator>>(Value const& rhs) const
-			{
-				Value result;
-				for (auto i = 0; i < 4; ++i)
-					for (auto j = 0; j < 4; ++j)
-						result(i, j) = static_cast<int32_t>(m_Matrix[i][j]) >> static_cast<int32_t>(rhs(i, j));
-				return result;
-			}
-
-			//
-			// Binary bitwise ops.
-			//
-			CRINL Value operator||(Value const& rhs) const
-			{
-				Value result;
-				for (auto i = 0; i < 4; ++i)
-					for (auto j = 0; j < 4; ++j)
-						result(i, j) = m_Matrix[i][j] || rhs(i, j);
-				return result;
-			}
-			CRINL Value operator&&(Value const& rhs) const
-			{
-				Value result;
-				for (auto i = 0; i < 4; ++i)
-					for (auto j = 0; j < 4; ++j)
-						result(i, j) = m_Matrix[i][j] && rhs(i, j);
-				return result;
-			}
-			CRINL Value operator==(Value const& rhs) const
-			{
-				Value result;
-				for (auto i = 0; i < 4; ++i)
-					for (auto j = 0; j < 4; ++j)
-						result(i, j) = m_Matrix[i][j] == rhs(i, j);
-				return result;
-			}
-			CRINL Value operator!=(Value const& rhs) const
-			{
-				Value result;
-				for (auto i = 0; i < 4; ++i)
-					for (auto j = 0; j < 4; ++j)
-						result(i, j) = m_Matrix[i][j] != rhs(i, j);
-				return result;
-			}
-			CRINL Value operator<(Value const& rhs) const
-			{
-				Value result;
-				for (auto i = 0; i < 4; ++i)
-					for (auto j = 0; j < 4; ++j)
-						result(i, j) = m_Matrix[i][j] < rhs(i, j);
-				return result;
-			}
-			CRINL Value operator>(Value const& rhs) const
-			{
-				Value result;
-				for (auto i = 0; i < 4; ++i)
-					for (auto j = 0; j < 4; ++j)
-						result(i, j) = m_Matrix[i][j] > rhs(i, j);
-				return result;
-			}
-			CRINL Value operator<=(Value const& rhs) const
-			{
-				Value result;
-				for (auto i = 0; i < 4; ++i)
-					for (auto j = 0; j < 4; ++j)
-						result(i, j) = m_Matrix[i][j] <= rhs(i, j);
-				return result;
-			}
-			CRINL Value operator>=(Value const& rhs) const
-			{
-				Value result;
-				for (auto i = 0; i < 4; ++i)
-					for (auto j = 0; j < 4; ++j)
-						result(i, j) = m_Matrix[i][j] >= rhs(i, j);
-				return result;
-			}
-			
-			//
-			// Binary arithmetic ops.
-			//
-			CRINL Value operator+(Value const& rhs) const
-			{
-				Value result;
-				for (auto i = 0; i < 4; ++i)
-					for (auto j = 0; j < 4; ++j)
-						result(i, j) = m_Matrix[i][j] + rhs(i, j);
-				return result;
-			}
-			CRINL Value operator-(Value const& rhs) const
-			{
-				Value result;
-				for (auto i = 0; i < 4; ++i)
-					for (auto j = 0; j < 4; ++j)
-						result(i, j) = m_Matrix[i][j] + rhs(i, j);
-				return result;
-			}
-			CRINL Value operator*(Value const& rhs) const
-			{
-				Value result;
-				for (auto i = 0; i < 4; ++i)
-					for (auto j = 0; j < 4; ++j)
-						result(i, j) = m_Matrix[i][j] * rhs(i, j);
-				return result;
-			}
-			CRINL Value operator/(Value const& rhs) const
-			{
-				Value result;
-				for (auto i = 0; i < 4; ++i)
-					for (auto j = 0; j < 4; ++j)
-					{
-						auto const rhsv = rhs(i, j);
-						if (rhsv == 0.0)
-						{
-							throw ParserException("Division by zero occurred while evaluating expression.");
-						}
-						result(i, j) = m_Matrix[i][j] / rhsv;
-					}
-				return result;
-			}
-			CRINL Value operator%(Value const& rhs) const
-			{
-				Value result;
-				for (auto i = 0; i < 4; ++i) 
-					for (auto j = 0; j < 4; ++j)
-					{
-						auto const rhsv = static_cast<int32_t>(rhs(i, j));
-						if (rhsv == 0)
-						{
-							throw ParserException("Division by zero occurred while evaluating expression.");
-						}
-						result(i, j) = static_cast<int32_t>(m_Matrix[i][j]) % rhsv;
-					}
-				return result;
-			}
-
-		};	// union Value
-
 		enum class BaseType
 		{
 			Struct = -255,
@@ -286,6 +53,7 @@ namespace Cr
 		struct Type
 		{
 			friend class Parser;
+			friend class Cr::FlatAst;
 
 		private:
 			BaseType m_BaseType;
@@ -304,6 +72,19 @@ namespace Cr
 				: m_BaseType(BaseType::Struct), m_Struct(structure)
 			{}
 
+			CRINL BaseType GetBaseType() const
+			{
+				return m_BaseType;
+			}
+			CRINL uint8_t GetRows() const
+			{
+				return m_Rows;
+			}
+			CRINL uint8_t GetColumns() const
+			{
+				return m_Columns;
+			}
+
 			CRINL bool IsStruct() const
 			{
 				return m_Struct != nullptr;
@@ -362,16 +143,177 @@ namespace Cr
 
 		};
 
+		/**
+		 * Compile-time value of the scalar, vector or matrix type.
+		 * Only rows x columns components are evaluated, they are stored row by row in the native width of the base type:
+		 * booleans and integers as 32-bit integers, floats as 32-bit floats and doubles as 64-bit ones.
+		 */
+		class Value final
+		{
+		public:
+			static uint8_t const s_MaxComponents = 16;
+
+		private:
+			BaseType m_BaseType = BaseType::Int;
+			uint8_t  m_Rows = 1;
+			uint8_t  m_Columns = 1;
+			union
+			{
+				int32_t m_Int[s_MaxComponents];	///< Components of the boolean and integral values, unsigned ones are stored as signed.
+				float   m_Float[s_MaxComponents];
+				double  m_Double[s_MaxComponents];
+			};
+			static_assert(s_MaxComponents % Simd::s_ComponentsPadding == 0, "Components are not padded for the SIMD kernels.");
+
+		public:
+			CRINL Value()
+				: m_Double() {}
+			CRINL Value(bool const scalar)
+				: m_BaseType(BaseType::Bool), m_Double() { m_Int[0] = scalar; }
+			CRINL Value(int32_t const scalar)
+				: m_BaseType(BaseType::Int), m_Double() { m_Int[0] = scalar; }
+			CRINL Value(uint32_t const scalar)
+				: m_BaseType(BaseType::UInt), m_Double() { m_Int[0] = static_cast<int32_t>(scalar); }
+			CRINL Value(float const scalar)
+				: m_BaseType(BaseType::Float), m_Double() { m_Float[0] = scalar; }
+			CRINL Value(double const scalar)
+				: m_BaseType(BaseType::Double), m_Double() { m_Double[0] = scalar; }
+
+			/**
+			 * Initializes a zero value of the specified type.
+			 */
+			CR_API Value(BaseType baseType, uint8_t rows, uint8_t columns);
+
+			CRINL BaseType GetBaseType() const
+			{
+				return m_BaseType;
+			}
+			CRINL uint8_t GetRows() const
+			{
+				return m_Rows;
+			}
+			CRINL uint8_t GetColumns() const
+			{
+				return m_Columns;
+			}
+			CRINL size_t GetComponentsCount() const
+			{
+				return m_Rows * m_Columns;
+			}
+			CRINL bool IsScalar() const
+			{
+				return m_Rows == 1 && m_Columns == 1;
+			}
+
+			/**
+			 * Returns the component, converted to the specified type.
+			 */
+			template<typename Tp>
+			CRINL Tp GetComponent(size_t const index) const
+			{
+				assert(index < GetComponentsCount());
+				switch (m_BaseType)
+				{
+					case BaseType::Float:  return static_cast<Tp>(m_Float[index]);
+					case BaseType::Double: return static_cast<Tp>(m_Double[index]);
+					case BaseType::UInt:   return static_cast<Tp>(static_cast<uint32_t>(m_Int[index]));
+					default:               return static_cast<Tp>(m_Int[index]);
+				}
+			}
+
+			template<typename Tp>
+			CRINL Tp To() const
+			{
+				return GetComponent<Tp>(0);
+			}
+
+			/**
+			 * Converts the value to the specified type. Scalars are broadcast, extra components are dropped 
+			 * and missing ones are zero.
+			 */
+			/// @{
+			CR_API Value Convert(BaseType baseType, uint8_t rows, uint8_t columns) const;
+			CRINL Value Convert(BaseType const baseType) const
+			{
+				return Convert(baseType, m_Rows, m_Columns);
+			}
+			CRINL Value Convert(Type const& type) const
+			{
+				return Convert(type.GetBaseType(), type.GetRows(), type.GetColumns());
+			}
+			/// @}
+
+		public:
+
+			//
+			// Unary ops.
+			//
+			CRINL Value operator+() const
+			{
+				return *this;
+			}
+			CR_API Value operator-() const;
+			CR_API Value operator!() const;
+			CR_API Value operator~() const;
+
+			//
+			// Binary bitwise ops.
+			//
+			CR_API Value operator|(Value const& rhs) const;
+			CR_API Value operator&(Value const& rhs) const;
+			CR_API Value operator^(Value const& rhs) const;
+			CR_API Value operator<<(Value const& rhs) const;
+			CR_API Value operator>>(Value const& rhs) const;
+
+			//
+			// Binary logic ops.
+			//
+			CR_API Value operator||(Value const& rhs) const;
+			CR_API Value operator&&(Value const& rhs) const;
+			CR_API Value operator==(Value const& rhs) const;
+			CR_API Value operator!=(Value const& rhs) const;
+			CR_API Value operator<(Value const& rhs) const;
+			CR_API Value operator>(Value const& rhs) const;
+			CR_API Value operator<=(Value const& rhs) const;
+			CR_API Value operator>=(Value const& rhs) const;
+
+			//
+			// Binary arithmetic ops.
+			//
+			CR_API Value operator+(Value const& rhs) const;
+			CR_API Value operator-(Value const& rhs) const;
+			CR_API Value operator*(Value const& rhs) const;
+			CR_API Value operator/(Value const& rhs) const;
+			CR_API Value operator%(Value const& rhs) const;
+
+			/**
+			 * Applies the unary or binary operator, specified by its lexeme type.
+			 */
+			/// @{
+			CR_API Value Apply(Lexeme::Type op) const;
+			CR_API Value Apply(Lexeme::Type op, Value const& rhs) const;
+			/// @}
+
+		private:
+			CR_INTERNAL static void ConvertToCommonType(Value& lhs, Value& rhs, BaseType lowestBaseType);
+			CR_INTERNAL static Value Compute(Simd::ComponentOp op, Value lhs, Value rhs);
+			template<typename TCompare>
+			CR_INTERNAL static Value Compare(Value lhs, Value rhs, TCompare const& compare);
+			CR_INTERNAL void VerifyNoZeroComponents() const;
+		};	// class Value
+
 		// *************************************************************** //
 		// **                     Expressions parsing.                  ** //
 		// *************************************************************** //
 
 		/**
 		 * Base class for all expressions.
+		 * Expressions are allocated in the arena of the profile and are never destroyed, so they must not own any resources.
 		 */
 		class Expression
 		{
 			friend class Parser;
+			friend class Cr::FlatAst;
 
 		public:
 			Type m_Type;
@@ -383,7 +325,6 @@ namespace Cr
 			CRINL Expression() = default;
 			CRINL Expression(Expression const&) = delete;
 			CRINL Expression& operator= (Expression const&) = delete;
-			CRINL virtual ~Expression() = default;
 
 		public:
 			CR_API virtual Value Evaluate() const
@@ -413,10 +354,11 @@ namespace Cr
 		class CommaExpression : public Expression
 		{
 			friend class Parser;
+			friend class Cr::FlatAst;
 
 		protected:
-			std::unique_ptr<Expression> m_Lhs;
-			std::unique_ptr<Expression> m_Rhs;
+			Expression* m_Lhs = nullptr;
+			Expression* m_Rhs = nullptr;
 		};	// class CommaExpression
 
 		// --------------------------------------------------------------- //
@@ -426,16 +368,21 @@ namespace Cr
 		struct Identifier
 		{
 			friend class Parser;
+			friend class Cr::FlatAst;
 		protected:
 			Type m_Type;
-			std::string m_Name;
+			Symbol m_Name = NullSymbol;
 		public:
-			CRINL virtual ~Identifier() = default;
+			/**
+			 * Makes the identifiers polymorphic, so they are checked with 'dynamic_cast', while the destructor stays trivial.
+			 */
+			CRINL virtual void EnableDynamicCast() const {}
 		};	// struct Identifier
 
 		struct Typedef : public Identifier
 		{
 			friend class Parser;
+			friend class Cr::FlatAst;
 		protected:
 			Type m_Type;
 		};	// struct Typedef
@@ -443,23 +390,26 @@ namespace Cr
 		struct VariableOrFunction : public Identifier
 		{
 			friend class Parser;
+			friend class Cr::FlatAst;
 		protected:
-			std::string m_Semantic;
+			Symbol m_Semantic = NullSymbol;
 		};	// struct VariableOrFunction
 
 		struct Variable : public VariableOrFunction
 		{
 			friend class Parser;
+			friend class Cr::FlatAst;
 
 		protected:
-			std::unique_ptr<Expression> m_InitExpr;
+			Expression* m_InitExpr = nullptr;
 
 		};	// struct Variable
 
 		struct Structure : public Identifier
 		{
 			friend class Parser;
-			std::vector<std__shared_ptr<Variable>> m_Vars;
+			friend class Cr::FlatAst;
+			ArenaVector<Variable*> m_Vars;
 		};	// struct Structure
 
 		struct Function : public VariableOrFunction
@@ -473,6 +423,7 @@ namespace Cr
 		class IdentifierExpression : public Expression
 		{
 			friend class Parser;
+			friend class Cr::FlatAst;
 
 		protected:
 			std__shared_ptr<Identifier> m_Ident;
@@ -487,13 +438,14 @@ namespace Cr
 		class ConstantExpression : public Expression
 		{
 			friend class Parser;
+			friend class Cr::FlatAst;
 
 		protected:
 			Value m_Value;
 
 		public:
 			CRINL explicit ConstantExpression(Value const& value, Type const& type) 
-				: m_Value(value)
+				: m_Value(value.Convert(type))
 			{
 				m_Type = type;
 				m_IsConstexpr = true;
@@ -507,10 +459,11 @@ namespace Cr
 		class SubscriptExpression : public Expression
 		{
 			friend class Parser;
+			friend class Cr::FlatAst;
 	
 		protected:
-			std::unique_ptr<Expression> m_Expr;
-			std::string m_Subscript;
+			Expression* m_Expr = nullptr;
+			Symbol m_Subscript;
 
 		};	// class SubscriptExpression
 
@@ -524,9 +477,10 @@ namespace Cr
 		class UnaryExpression : public Expression
 		{
 			friend class Parser;
+			friend class Cr::FlatAst;
 		protected:
 			Lexeme::Type m_Op;
-			std::unique_ptr<Expression> m_Expr;
+			Expression* m_Expr = nullptr;
 
 		public:
 			CRINL UnaryExpression(Lexeme::Type const op, Expression* const expr)
@@ -541,6 +495,7 @@ namespace Cr
 		class NotExpression : public UnaryExpression
 		{
 			friend class Parser;
+			friend class Cr::FlatAst;
 		public:
 			CR_API explicit NotExpression(Expression* const expr)
 				: UnaryExpression(Lexeme::Type::OpNot, expr)
@@ -548,7 +503,7 @@ namespace Cr
 			CR_API Value Evaluate() const override
 			{
 				CrAssert(IsConstexpr());
-				return !m_Expr->Evaluate();
+				return m_Expr->Evaluate().Apply(m_Op);
 			}
 		};	// class NotExpression
 
@@ -559,6 +514,7 @@ namespace Cr
 		class BitwiseNotExpression : public UnaryExpression
 		{
 			friend class Parser;
+			friend class Cr::FlatAst;
 		public:
 			CR_API explicit BitwiseNotExpression(Expression* const expr)
 				: UnaryExpression(Lexeme::Type::OpBitwiseNot, expr)
@@ -566,7 +522,7 @@ namespace Cr
 			CR_API Value Evaluate() const override
 			{
 				CrAssert(IsConstexpr());
-				return ~m_Expr->Evaluate();
+				return m_Expr->Evaluate().Apply(m_Op);
 			}
 		};	// class BitwiseNotExpression
 
@@ -576,6 +532,7 @@ namespace Cr
 		class NegateExpression : public UnaryExpression
 		{
 			friend class Parser;
+			friend class Cr::FlatAst;
 		public:
 			CR_API explicit NegateExpression(Expression* const expr)
 				: UnaryExpression(Lexeme::Type::OpSubtract, expr)
@@ -583,16 +540,17 @@ namespace Cr
 			CR_API Value Evaluate() const override
 			{
 				CrAssert(IsConstexpr());
-				return -m_Expr->Evaluate();
+				return m_Expr->Evaluate().Apply(m_Op);
 			}
 		};	// class NegateExpression
 
 		/**
-		 * Per-component arithmetic unary expression class.
+		 * Cast expression class.
 		 */
 		class CastExpression : public UnaryExpression
 		{
 			friend class Parser;
+			friend class Cr::FlatAst;
 
 		protected:
 			Type m_CastTo;
@@ -604,11 +562,10 @@ namespace Cr
 
 			CR_API Value Evaluate() const override
 			{
-				return m_Expr->Evaluate();
+				return m_Expr->Evaluate().Convert(m_CastTo);
 			}
-		};	// class NegateExpression
+		};	// class CastExpression
 
-		//! @todo Add cast operation.
 		//! @todo Add value node.
 
 		// --------------------------------------------------------------- //
@@ -621,10 +578,11 @@ namespace Cr
 		class BinaryExpression : public Expression
 		{
 			friend class Parser;
+			friend class Cr::FlatAst;
 		protected:
 			Lexeme::Type m_Op = Lexeme::Type::Null;
-			std::unique_ptr<Expression> m_Lhs;
-			std::unique_ptr<Expression> m_Rhs;
+			Expression* m_Lhs = nullptr;
+			Expression* m_Rhs = nullptr;
 
 		public:
 			CR_API BinaryExpression(Lexeme::Type op, Expression* const lhs, Expression* const rhs) 
@@ -638,6 +596,7 @@ namespace Cr
 		class LogicBinaryExpression : public BinaryExpression
 		{
 			friend class Parser;
+			friend class Cr::FlatAst;
 
 		public:
 			CR_API LogicBinaryExpression(Lexeme::Type const op, Expression* const lhs, Expression* const rhs)
@@ -646,22 +605,7 @@ namespace Cr
 			CR_API Value Evaluate() const override
 			{
 				CrAssert(IsConstexpr());
-				auto const lhs = m_Lhs->Evaluate();
-				auto const rhs = m_Rhs->Evaluate();
-				switch (m_Op)
-				{
-					case Lexeme::Type::OpOr:            return lhs || rhs;
-					case Lexeme::Type::OpAnd:           return lhs && rhs;
-					case Lexeme::Type::OpEquals:        return lhs == rhs;
-					case Lexeme::Type::OpNotEquals:     return lhs != rhs;
-					case Lexeme::Type::OpLess:          return lhs < rhs;
-					case Lexeme::Type::OpGreater:       return lhs > rhs;
-					case Lexeme::Type::OpLessEquals:    return lhs <= rhs;
-					case Lexeme::Type::OpGreaterEquals: return lhs >= rhs;
-					default:
-						CrAssert(0);
-						return Value();
-				}
+				return m_Lhs->Evaluate().Apply(m_Op, m_Rhs->Evaluate());
 			}
 		};	// class LogicBinaryExpression
 
@@ -672,6 +616,7 @@ namespace Cr
 		class BitwiseBinaryExpression : public BinaryExpression
 		{
 			friend class Parser;
+			friend class Cr::FlatAst;
 
 		public:
 			CR_API BitwiseBinaryExpression(Lexeme::Type const op, Expression* const lhs, Expression* const rhs)
@@ -680,19 +625,7 @@ namespace Cr
 			CR_API Value Evaluate() const override
 			{
 				CrAssert(IsConstexpr());
-				auto const lhs = m_Lhs->Evaluate();
-				auto const rhs = m_Rhs->Evaluate();
-				switch (m_Op)
-				{
-					case Lexeme::Type::OpBitwiseOr:         return lhs | rhs;
-					case Lexeme::Type::OpBitwiseAnd:        return lhs & rhs;
-					case Lexeme::Type::OpBitwiseXor:        return lhs ^ rhs;
-					case Lexeme::Type::OpBitwiseLeftShift:  return lhs << rhs;
-					case Lexeme::Type::OpBitwiseRightShift: return lhs >> rhs;
-					default:
-						CrAssert(0);
-						return Value();
-				}
+				return m_Lhs->Evaluate().Apply(m_Op, m_Rhs->Evaluate());
 			}
 		};	// class BitwiseBinaryExpression
 
@@ -703,6 +636,7 @@ namespace Cr
 		class ArithmeticBinaryExpression : public BinaryExpression
 		{
 			friend class Parser;
+			friend class Cr::FlatAst;
 
 		public:
 			CR_API ArithmeticBinaryExpression(Lexeme::Type const op, Expression* const lhs, Expression* const rhs)
@@ -711,19 +645,7 @@ namespace Cr
 			CR_API Value Evaluate() const override
 			{
 				CrAssert(IsConstexpr());
-				auto const lhs = m_Lhs->Evaluate();
-				auto const rhs = m_Rhs->Evaluate();
-				switch (m_Op)
-				{
-					case Lexeme::Type::OpAdd:      return lhs + rhs;
-					case Lexeme::Type::OpSubtract: return lhs - rhs;
-					case Lexeme::Type::OpMultiply: return lhs * rhs;
-					case Lexeme::Type::OpDivide:   return lhs / rhs;
-					case Lexeme::Type::OpModulo:   return lhs % rhs;
-					default:
-						CrAssert(0);
-						return Value();
-				}
+				return m_Lhs->Evaluate().Apply(m_Op, m_Rhs->Evaluate());
 			}
 		};	// class ArithmeticBinaryExpression
 
@@ -786,11 +708,12 @@ namespace Cr
 		class TernaryExpression : public Expression
 		{
 			friend class Parser;
+			friend class Cr::FlatAst;
 
 		private:
-			std::unique_ptr<Expression> m_CondExpr;
-			std::unique_ptr<Expression> m_ThenExpr;
-			std::unique_ptr<Expression> m_ElseExpr;
+			Expression* m_CondExpr = nullptr;
+			Expression* m_ThenExpr = nullptr;
+			Expression* m_ElseExpr = nullptr;
 
 		public:
 			CR_API TernaryExpression(Expression* const condExpr, Expression* const thenExpr, Expression* const elseExpr)
@@ -897,10 +820,12 @@ namespace Cr
 
 		/**
 		 * Base class for all statements.
+		 * Statements are allocated in the arena of the profile and are never destroyed, so they must not own any resources.
 		 */
 		class Statement
 		{
 			friend class Parser;
+			friend class Cr::FlatAst;
 
 		private:
 			Jumps m_PerformsJump;
@@ -909,7 +834,11 @@ namespace Cr
 			CRINL Statement() = default;
 			CRINL Statement(Statement const&) = delete;
 			CRINL Statement& operator= (Statement const&) = delete;
-			CRINL virtual ~Statement() = default;
+
+			/**
+			 * Makes the statements polymorphic, so they are checked with 'dynamic_cast', while the destructor stays trivial.
+			 */
+			CRINL virtual void EnableDynamicCast() const {}
 
 		};	// class Statement
 
@@ -919,15 +848,9 @@ namespace Cr
 		class CompoundStatement : public Statement
 		{
 			friend class Parser;
+			friend class Cr::FlatAst;
 		private:
-			std::vector<std::unique_ptr<Statement>> m_Stmts;
-
-		public:
-			CR_API CompoundStatement() 
-			{ }
-			CR_API explicit CompoundStatement(std::vector<std::unique_ptr<Statement>>&& stmts)
-				: m_Stmts(std::forward<std::vector<std::unique_ptr<Statement>>>(stmts))
-			{ }
+			ArenaVector<Statement*> m_Stmts;
 		};	// class CompoundStatement
 
 		// --------------------------------------------------------------- //
@@ -948,10 +871,11 @@ namespace Cr
 		class IfSelectionStatement : public SelectionStatement
 		{
 			friend class Parser;
+			friend class Cr::FlatAst;
 		private:
-			std::unique_ptr<Expression> m_CondExpr;
-			std::unique_ptr<Statement> m_ThenStmt;
-			std::unique_ptr<Statement> m_ElseStmt;
+			Expression* m_CondExpr = nullptr;
+			Statement* m_ThenStmt = nullptr;
+			Statement* m_ElseStmt = nullptr;
 
 		public:
 			CR_API virtual void Initialize(Expression* const condExpr, Statement* const thenStmt, Statement* const elseStmt);
@@ -960,11 +884,21 @@ namespace Cr
 		class SwitchSection
 		{	
 			friend class Parser;
+			friend class Cr::FlatAst;
 
 		private:
-			std::vector<std::unique_ptr<Statement>> m_Stmts;
+			ArenaVector<Statement*> m_Stmts;
 		};	// class SwitchSection
 
+		/**
+		 * Label of the 'case' section.
+		 */
+		struct SwitchCase
+		{
+			int64_t        m_Value;
+			SwitchSection* m_Section;
+		};	// struct SwitchCase
+
 		/**
 		 * Simplified 'switch' selection statement class.
 		 * Unlike in C, we do not allow variable declarations inside the switch.
@@ -973,14 +907,27 @@ namespace Cr
 		class SwitchSelectionStatement : public SelectionStatement
 		{
 			friend class Parser;
+			friend class Cr::FlatAst;
 
 		private:
-			std::unique_ptr<Expression> m_SelectionExpr;
-			std__shared_ptr<SwitchSection> m_DefaultSection;
-			std::map<int64_t, std__shared_ptr<SwitchSection>> m_Sections;
+			Expression* m_SelectionExpr = nullptr;
+			SwitchSection* m_DefaultSection = nullptr;
+			ArenaVector<SwitchCase> m_Sections;
 
 		public:
 			CR_API virtual void Initialize(Expression* const switchExpr, ...);
+
+			/**
+			 * Returns section of the 'case' label with the specified value or null pointer.
+			 */
+			CRINL SwitchSection* FindSection(int64_t const value) const
+			{
+				auto const section = std::find_if(m_Sections.begin(), m_Sections.end(), [value](SwitchCase const& switchCase)
+				{
+					return switchCase.m_Value == value;
+				});
+				return section != m_Sections.end() ? section->m_Section : nullptr;
+			}
 		};	// class IfSelectionStatement
 
 		// --------------------------------------------------------------- //
@@ -993,6 +940,7 @@ namespace Cr
 		class IterationStatement : public Statement
 		{
 			friend class Parser;
+			friend class Cr::FlatAst;
 
 		private:
 		};	// class IterationStatement
@@ -1004,10 +952,11 @@ namespace Cr
 		class WhileIterationStatement : public IterationStatement
 		{
 			friend class Parser;
+			friend class Cr::FlatAst;
 
 		private:
-			std::unique_ptr<Expression> m_CondExpr;
-			std::unique_ptr<Statement> m_LoopStmt;
+			Expression* m_CondExpr = nullptr;
+			Statement* m_LoopStmt = nullptr;
 
 		};	// class WhileIterationStatement
 
@@ -1018,10 +967,11 @@ namespace Cr
 		class DoWhileIterationStatement : public IterationStatement
 		{
 			friend class Parser;
+			friend class Cr::FlatAst;
 
 		private:
-			std::unique_ptr<Statement> m_LoopStmt;
-			std::unique_ptr<Expression> m_CondExpr;
+			Statement* m_LoopStmt = nullptr;
+			Expression* m_CondExpr = nullptr;
 
 		};	// class DoIterationStatement
 
@@ -1032,12 +982,13 @@ namespace Cr
 		class ForIterationStatement : public IterationStatement
 		{
 			friend class Parser;
+			friend class Cr::FlatAst;
 
 		private:
-			std::unique_ptr<Statement> m_InitStmt;
-			std::unique_ptr<Expression> m_CondExpr;
-			std::unique_ptr<Expression> m_StepExpr;
-			std::unique_ptr<Statement> m_LoopStmt;
+			Statement* m_InitStmt = nullptr;
+			Expression* m_CondExpr = nullptr;
+			Expression* m_StepExpr = nullptr;
+			Statement* m_LoopStmt = nullptr;
 
 		};	// class ForIterationStatement
 
@@ -1058,6 +1009,7 @@ namespace Cr
 		class BreakJumpStatement : public JumpStatement
 		{
 			friend class Parser;
+			friend class Cr::FlatAst;
 
 		private:
 			Statement* m_BreakTo = nullptr;
@@ -1070,6 +1022,7 @@ namespace Cr
 		class ContinueJumpStatement : public JumpStatement
 		{
 			friend class Parser;
+			friend class Cr::FlatAst;
 
 		private:
 			Statement* m_ContinueWith = nullptr;
@@ -1082,10 +1035,11 @@ namespace Cr
 		class ReturnJumpStatement : public JumpStatement
 		{
 			friend class Parser;
+			friend class Cr::FlatAst;
 
 		private:
 			Function* m_ReturnTo = nullptr;
-			std::unique_ptr<Expression> m_Expr;
+			Expression* m_Expr = nullptr;
 
 		};	// class ReturnJumpStatement
 
@@ -1096,6 +1050,7 @@ namespace Cr
 		class DiscardJumpStatement : public JumpStatement
 		{
 			friend class Parser;
+			friend class Cr::FlatAst;
 
 		};	// class DiscardJumpStatement
 
@@ -1109,9 +1064,10 @@ namespace Cr
 		class ExpressionStatement : public Statement
 		{
 			friend class Parser;
+			friend class Cr::FlatAst;
 
 		private:
-			std::unique_ptr<Expression> m_Expr;
+			Expression* m_Expr = nullptr;
 
 		};	// class ExpressionStatement
 
@@ -1119,14 +1075,59 @@ namespace Cr
 		class DeclarationStatement : public Statement
 		{
 			friend class Parser;
+			friend class Cr::FlatAst;
 
 		private:
-			std::vector<std__shared_ptr<Variable>> m_Vars;
-			std::vector<std__shared_ptr<Function>> m_Funcs;
-			std::vector<std__shared_ptr<Structure>> m_Structs;
+			ArenaVector<Variable*> m_Vars;
+			ArenaVector<Function*> m_Funcs;
+			ArenaVector<Structure*> m_Structs;
 
 		};	// class DeclarationStatement
 
+		// Nodes are released with the arena, their destructors are never called.
+		static_assert(std::is_trivially_destructible<Expression>::value, "AST nodes are never destroyed.");
+		static_assert(std::is_trivially_destructible<CommaExpression>::value, "AST nodes are never destroyed.");
+		static_assert(std::is_trivially_destructible<Identifier>::value, "AST nodes are never destroyed.");
+		static_assert(std::is_trivially_destructible<Typedef>::value, "AST nodes are never destroyed.");
+		static_assert(std::is_trivially_destructible<VariableOrFunction>::value, "AST nodes are never destroyed.");
+		static_assert(std::is_trivially_destructible<Variable>::value, "AST nodes are never destroyed.");
+		static_assert(std::is_trivially_destructible<Structure>::value, "AST nodes are never destroyed.");
+		static_assert(std::is_trivially_destructible<Function>::value, "AST nodes are never destroyed.");
+		static_assert(std::is_trivially_destructible<IdentifierExpression>::value, "AST nodes are never destroyed.");
+		static_assert(std::is_trivially_destructible<ConstantExpression>::value, "AST nodes are never destroyed.");
+		static_assert(std::is_trivially_destructible<SubscriptExpression>::value, "AST nodes are never destroyed.");
+		static_assert(std::is_trivially_destructible<UnaryExpression>::value, "AST nodes are never destroyed.");
+		static_assert(std::is_trivially_destructible<NotExpression>::value, "AST nodes are never destroyed.");
+		static_assert(std::is_trivially_destructible<BitwiseNotExpression>::value, "AST nodes are never destroyed.");
+		static_assert(std::is_trivially_destructible<NegateExpression>::value, "AST nodes are never destroyed.");
+		static_assert(std::is_trivially_destructible<CastExpression>::value, "AST nodes are never destroyed.");
+		static_assert(std::is_trivially_destructible<BinaryExpression>::value, "AST nodes are never destroyed.");
+		static_assert(std::is_trivially_destructible<LogicBinaryExpression>::value, "AST nodes are never destroyed.");
+		static_assert(std::is_trivially_destructible<BitwiseBinaryExpression>::value, "AST nodes are never destroyed.");
+		static_assert(std::is_trivially_destructible<ArithmeticBinaryExpression>::value, "AST nodes are never destroyed.");
+		static_assert(std::is_trivially_destructible<AssignmentBinaryExpression>::value, "AST nodes are never destroyed.");
+		static_assert(std::is_trivially_destructible<BitwiseAssignmentBinaryExpression>::value, "AST nodes are never destroyed.");
+		static_assert(std::is_trivially_destructible<ArithmeticAssignmentBinaryExpression>::value, "AST nodes are never destroyed.");
+		static_assert(std::is_trivially_destructible<TernaryExpression>::value, "AST nodes are never destroyed.");
+		static_assert(std::is_trivially_destructible<Statement>::value, "AST nodes are never destroyed.");
+		static_assert(std::is_trivially_destructible<CompoundStatement>::value, "AST nodes are never destroyed.");
+		static_assert(std::is_trivially_destructible<SelectionStatement>::value, "AST nodes are never destroyed.");
+		static_assert(std::is_trivially_destructible<IfSelectionStatement>::value, "AST nodes are never destroyed.");
+		static_assert(std::is_trivially_destructible<SwitchSection>::value, "AST nodes are never destroyed.");
+		static_assert(std::is_trivially_destructible<SwitchCase>::value, "AST nodes are never destroyed.");
+		static_assert(std::is_trivially_destructible<SwitchSelectionStatement>::value, "AST nodes are never destroyed.");
+		static_assert(std::is_trivially_destructible<IterationStatement>::value, "AST nodes are never destroyed.");
+		static_assert(std::is_trivially_destructible<WhileIterationStatement>::value, "AST nodes are never destroyed.");
+		static_assert(std::is_trivially_destructible<DoWhileIterationStatement>::value, "AST nodes are never destroyed.");
+		static_assert(std::is_trivially_destructible<ForIterationStatement>::value, "AST nodes are never destroyed.");
+		static_assert(std::is_trivially_destructible<JumpStatement>::value, "AST nodes are never destroyed.");
+		static_assert(std::is_trivially_destructible<BreakJumpStatement>::value, "AST nodes are never destroyed.");
+		static_assert(std::is_trivially_destructible<ContinueJumpStatement>::value, "AST nodes are never destroyed.");
+		static_assert(std::is_trivially_destructible<ReturnJumpStatement>::value, "AST nodes are never destroyed.");
+		static_assert(std::is_trivially_destructible<DiscardJumpStatement>::value, "AST nodes are never destroyed.");
+		static_assert(std::is_trivially_destructible<ExpressionStatement>::value, "AST nodes are never destroyed.");
+		static_assert(std::is_trivially_destructible<DeclarationStatement>::value, "AST nodes are never destroyed.");
+
 	}	// namespace Ast
 
 }   // namespace Cr
@@ -0,0 +1,475 @@
+// $$***************************************************************$$ //
+//                                                                     //
+//                  Goddamn "C for Rendering" project                  //
+//     Copyright (C) Goddamn Industries 2016. All Rights Reserved.     //
+//          ( https://github.com/GoddamnIndustries/GoddamnCr )         //
+//                                                                     //
+//    This software or any its part is distributed under the terms of  //
+//   Goddamn Industries End User License Agreement. By downloading or  //
+//   using this software or any its part you agree with the terms of   //
+//   Goddamn Industries End User License Agreement.                    //
+//                                                                     //
+// $$***************************************************************$$ //
+
+
+#include "CompiledCondition.h"
+#include "NumericLiteral.h"
+#include "Scanner.h"
+
+#include <algorithm>
+
+namespace Cr
+{
+	// *************************************************************** //
+	// **           CompiledCondition class implementation.         ** //
+	// *************************************************************** //
+
+	/**
+	 * Recursive descent compiler of the condition expressions.
+	 * Precedence of the operators is the C one.
+	 */
+	class CompiledCondition::Compiler final
+	{
+	private:
+		struct Error {};
+
+		CompiledCondition& m_Condition;
+		Lexeme const*      m_Cursor;
+		Lexeme const*      m_End;
+		size_t             m_StackSize = 0;
+
+	public:
+		CRINL Compiler(CompiledCondition& condition, Lexeme const* const begin, Lexeme const* const end)
+			: m_Condition(condition), m_Cursor(begin), m_End(end)
+		{}
+
+		/**
+		 * Compiles the whole range.
+		 * @returns False if range is not a single expression.
+		 */
+		CRINL bool Compile()
+		{
+			try
+			{
+				Compile_Ternary();
+				return m_Cursor == m_End;
+			}
+			catch (Error const&)
+			{
+				return false;
+			}
+		}
+
+	private:
+		CRINL Lexeme::Type Peek() const
+		{
+			return m_Cursor != m_End ? m_Cursor->GetType() : Lexeme::Type::Null;
+		}
+		CRINL void Expect(Lexeme::Type const type)
+		{
+			if (Peek() != type)
+			{
+				throw Error();
+			}
+			++m_Cursor;
+		}
+
+		CRINL uint32_t Emit(Opcode const opcode, uint32_t const operand = 0)
+		{
+			// Tracking the stack size, so the evaluation never overflows the fixed stack.
+			switch (opcode)
+			{
+				case Opcode::PushConstant: case Opcode::PushDefined: case Opcode::PushMacro:
+					if (++m_StackSize > s_MaxStackSize)
+					{
+						throw Error();
+					}
+					break;
+				case Opcode::Not: case Opcode::BitwiseNot: case Opcode::Negate: case Opcode::ToBool: case Opcode::Jump:
+					break;
+				default:
+					--m_StackSize;
+					break;
+			}
+			m_Condition.m_Code.push_back({ opcode, operand });
+			return static_cast<uint32_t>(m_Condition.m_Code.size() - 1);
+		}
+		CRINL void PatchJump(uint32_t const jump)
+		{
+			m_Condition.m_Code[jump].m_Operand = static_cast<uint32_t>(m_Condition.m_Code.size());
+		}
+		CRINL static uint32_t Slot(std::vector<Symbol>& slots, Symbol const name)
+		{
+			auto const slot = std::find(slots.begin(), slots.end(), name);
+			if (slot != slots.end())
+			{
+				return static_cast<uint32_t>(slot - slots.begin());
+			}
+			slots.push_back(name);
+			return static_cast<uint32_t>(slots.size() - 1);
+		}
+
+		// { TERNARY ::= OR [? TERNARY : TERNARY] }
+		// *************************************************************** //
+		CRINL void Compile_Ternary()
+		{
+			Compile_Or();
+			if (Peek() == Lexeme::Type::OpTernary)
+			{
+				++m_Cursor;
+				auto const jumpToElse = Emit(Opcode::JumpIfZero);
+				Compile_Ternary();
+				auto const jumpToEnd = Emit(Opcode::Jump);
+				--m_StackSize;
+				Expect(Lexeme::Type::OpColon);
+				PatchJump(jumpToElse);
+				Compile_Ternary();
+				PatchJump(jumpToEnd);
+			}
+		}
+
+		// { OR ::= AND [|| AND ..] }
+		// { AND ::= BITWISE-OR [&& BITWISE-OR ..] }
+		// *************************************************************** //
+		CRINL void Compile_Or()
+		{
+			Compile_And();
+			while (Peek() == Lexeme::Type::OpOr)
+			{
+				++m_Cursor;
+				auto const jump = Emit(Opcode::OrJump);
+				Compile_And();
+				Emit(Opcode::ToBool);
+				PatchJump(jump);
+			}
+		}
+		CRINL void Compile_And()
+		{
+			Compile_Binary(0);
+			while (Peek() == Lexeme::Type::OpAnd)
+			{
+				++m_Cursor;
+				auto const jump = Emit(Opcode::AndJump);
+				Compile_Binary(0);
+				Emit(Opcode::ToBool);
+				PatchJump(jump);
+			}
+		}
+
+		// { BINARY ::= UNARY [<binary-operator> UNARY ..] }
+		// *************************************************************** //
+		CRINL void Compile_Binary(size_t const level)
+		{
+			struct BinaryOperator
+			{
+				Lexeme::Type m_Type;
+				Opcode       m_Opcode;
+			};	// struct BinaryOperator
+			static std::vector<std::vector<BinaryOperator>> const s_Levels = {
+				{ { Lexeme::Type::OpBitwiseOr, Opcode::BitwiseOr } },
+				{ { Lexeme::Type::OpBitwiseXor, Opcode::BitwiseXor } },
+				{ { Lexeme::Type::OpBitwiseAnd, Opcode::BitwiseAnd } },
+				{ { Lexeme::Type::OpEquals, Opcode::Equals }, { Lexeme::Type::OpNotEquals, Opcode::NotEquals } },
+				{ { Lexeme::Type::OpLess, Opcode::Less }, { Lexeme::Type::OpLessEquals, Opcode::LessEquals }
+				, { Lexeme::Type::OpGreater, Opcode::Greater }, { Lexeme::Type::OpGreaterEquals, Opcode::GreaterEquals } },
+				{ { Lexeme::Type::OpBitwiseLeftShift, Opcode::LeftShift }, { Lexeme::Type::OpBitwiseRightShift, Opcode::RightShift } },
+				{ { Lexeme::Type::OpAdd, Opcode::Add }, { Lexeme::Type::OpSubtract, Opcode::Subtract } },
+				{ { Lexeme::Type::OpMultiply, Opcode::Multiply }, { Lexeme::Type::OpDivide, Opcode::Divide }, { Lexeme::Type::OpModulo, Opcode::Modulo } },
+			};
+			if (level == s_Levels.size())
+			{
+				Compile_Unary();
+				return;
+			}
+			Compile_Binary(level + 1);
+			while (true)
+			{
+				auto const type = Peek();
+				auto const binaryOperator = std::find_if(s_Levels[level].begin(), s_Levels[level].end(), [type](BinaryOperator const& binaryOperator)
+				{
+					return binaryOperator.m_Type == type;
+				});
+				if (binaryOperator == s_Levels[level].end())
+				{
+					return;
+				}
+				++m_Cursor;
+				Compile_Binary(level + 1);
+				Emit(binaryOperator->m_Opcode);
+			}
+		}
+
+		// { UNARY ::= [!|~|+|-] UNARY | PRIMARY }
+		// *************************************************************** //
+		CRINL void Compile_Unary()
+		{
+			switch (Peek())
+			{
+				case Lexeme::Type::OpNot:
+					++m_Cursor;
+					Compile_Unary();
+					Emit(Opcode::Not);
+					break;
+				case Lexeme::Type::OpBitwiseNot:
+					++m_Cursor;
+					Compile_Unary();
+					Emit(Opcode::BitwiseNot);
+					break;
+				case Lexeme::Type::OpAdd:
+					++m_Cursor;
+					Compile_Unary();
+					break;
+				case Lexeme::Type::OpSubtract:
+					++m_Cursor;
+					Compile_Unary();
+					Emit(Opcode::Negate);
+					break;
+				default:
+					Compile_Primary();
+					break;
+			}
+		}
+
+		// { PRIMARY ::= <constant> | defined <ident> | defined(<ident>) | <ident> | (TERNARY) }
+		// *************************************************************** //
+		CRINL void Compile_Primary()
+		{
+			auto const lexeme = m_Cursor;
+			switch (Peek())
+			{
+				case Lexeme::Type::KwTrue:
+				case Lexeme::Type::KwFalse:
+				case Lexeme::Type::CtInt:
+				case Lexeme::Type::CtUInt:
+					{
+						++m_Cursor;
+						auto const value = *lexeme == Lexeme::Type::KwTrue ? 1 : *lexeme == Lexeme::Type::KwFalse ? 0
+							: static_cast<int64_t>(NumericLiteral::DecodeInteger(lexeme->GetText(), lexeme->GetText() + lexeme->GetLength()));
+						m_Condition.m_Constants.push_back(value);
+						Emit(Opcode::PushConstant, static_cast<uint32_t>(m_Condition.m_Constants.size() - 1));
+						break;
+					}
+
+				case Lexeme::Type::KwPpDefined:
+					{
+						++m_Cursor;
+						auto const hasParens = Peek() == Lexeme::Type::OpParenOpen;
+						if (hasParens)
+						{
+							++m_Cursor;
+						}
+						auto const name = m_Cursor;
+						Expect(Lexeme::Type::IdIdentifier);
+						if (hasParens)
+						{
+							Expect(Lexeme::Type::OpParenClose);
+						}
+						Emit(Opcode::PushDefined, Slot(m_Condition.m_DefinedSlots, name->GetValueID()));
+						break;
+					}
+
+				case Lexeme::Type::IdIdentifier:
+					++m_Cursor;
+					if (Peek() == Lexeme::Type::OpParenOpen)
+					{
+						// Invocation of the function-like macro, condition should be expanded.
+						throw Error();
+					}
+					Emit(Opcode::PushMacro, Slot(m_Condition.m_MacroSlots, lexeme->GetValueID()));
+					break;
+
+				case Lexeme::Type::OpParenOpen:
+					++m_Cursor;
+					Compile_Ternary();
+					Expect(Lexeme::Type::OpParenClose);
+					break;
+
+				default:
+					throw Error();
+			}
+		}
+	};	// class CompiledCondition::Compiler
+
+	/**
+	 * Compiles the expression.
+	 */
+	CR_API bool CompiledCondition::Compile(Lexeme const* const begin, Lexeme const* const end)
+	{
+		CrAssert(begin <= end);
+		*this = CompiledCondition();
+		m_Length = static_cast<uint32_t>(end - begin);
+		if (!Compiler(*this, begin, end).Compile())
+		{
+			m_Code.clear();
+			return false;
+		}
+		return true;
+	}
+
+	/**
+	 * Evaluates the compiled expression. Arithmetic wraps around on overflow.
+	 * Unlike C, operations are signed even if an operand is unsigned: shader conditions compare small non-negative values.
+	 */
+	CR_API bool CompiledCondition::Evaluate(int64_t const* const definedValues, int64_t const* const macroValues, int64_t& value) const
+	{
+		CrAssert(IsCompiled());
+		int64_t stack[s_MaxStackSize];
+		auto top = stack - 1;
+		auto const code = m_Code.data();
+		for (size_t index = 0, size = m_Code.size(); index < size; ++index)
+		{
+			auto const operand = code[index].m_Operand;
+			switch (code[index].m_Opcode)
+			{
+				case Opcode::PushConstant:
+					*++top = m_Constants[operand];
+					break;
+				case Opcode::PushDefined:
+					*++top = definedValues[operand];
+					break;
+				case Opcode::PushMacro:
+					*++top = macroValues[operand];
+					break;
+
+				case Opcode::Not:
+					*top = *top == 0;
+					break;
+				case Opcode::BitwiseNot:
+					*top = ~*top;
+					break;
+				case Opcode::Negate:
+					*top = static_cast<int64_t>(0 - static_cast<uint64_t>(*top));
+					break;
+				case Opcode::ToBool:
+					*top = *top != 0;
+					break;
+
+#define CrConditionBinary(opcode, expression) \
+				case Opcode::opcode: \
+					{ \
+						auto const right = *top--; \
+						auto const left = *top; \
+						*top = (expression); \
+						break; \
+					}
+				CrConditionBinary(Multiply, static_cast<int64_t>(static_cast<uint64_t>(left) * static_cast<uint64_t>(right)))
+				CrConditionBinary(Add, static_cast<int64_t>(static_cast<uint64_t>(left) + static_cast<uint64_t>(right)))
+				CrConditionBinary(Subtract, static_cast<int64_t>(static_cast<uint64_t>(left) - static_cast<uint64_t>(right)))
+				CrConditionBinary(LeftShift, static_cast<int64_t>(static_cast<uint64_t>(left) << (right & 63)))
+				CrConditionBinary(RightShift, left >> (right & 63))
+				CrConditionBinary(Less, left < right)
+				CrConditionBinary(LessEquals, left <= right)
+				CrConditionBinary(Greater, left > right)
+				CrConditionBinary(GreaterEquals, left >= right)
+				CrConditionBinary(Equals, left == right)
+				CrConditionBinary(NotEquals, left != right)
+				CrConditionBinary(BitwiseAnd, left & right)
+				CrConditionBinary(BitwiseXor, left ^ right)
+				CrConditionBinary(BitwiseOr, left | right)
+#undef CrConditionBinary
+
+				case Opcode::Divide:
+				case Opcode::Modulo:
+					{
+						auto const right = *top--;
+						if (right == 0)
+						{
+							return false;
+						}
+						if (right == -1)
+						{
+							// Avoiding the overflow of the minimal value.
+							*top = code[index].m_Opcode == Opcode::Divide ? static_cast<int64_t>(0 - static_cast<uint64_t>(*top)) : 0;
+							break;
+						}
+						*top = code[index].m_Opcode == Opcode::Divide ? *top / right : *top % right;
+						break;
+					}
+
+				case Opcode::AndJump:
+					if (*top == 0)
+					{
+						index = operand - 1;
+						break;
+					}
+					--top;
+					break;
+				case Opcode::OrJump:
+					if (*top != 0)
+					{
+						*top = 1;
+						index = operand - 1;
+						break;
+					}
+					--top;
+					break;
+				case Opcode::JumpIfZero:
+					if (*top-- == 0)
+					{
+						index = operand - 1;
+					}
+					break;
+				case Opcode::Jump:
+					index = operand - 1;
+					break;
+			}
+		}
+		CrAssert(top == stack);
+		value = *top;
+		return true;
+	}
+
+	// *************************************************************** //
+	// **            CompiledCondition class unit tests.            ** //
+	// *************************************************************** //
+
+	CrUnitTest(CompiledConditionEvaluate)
+	{
+		std::vector<Lexeme> lexemes;
+		auto const compile = [&lexemes](CompiledCondition& condition, char const* const text)
+		{
+			lexemes.clear();
+			Scanner(text, text + strlen(text)).Tokenize(lexemes);
+			// Trailing new line and null lexemes are not the part of the expression.
+			auto const end = lexemes.data() + lexemes.size() - (lexemes.size() > 1 ? 2 : 1);
+			return condition.Compile(lexemes.data(), end);
+		};
+		auto const evaluate = [&compile](char const* const text, int64_t const* const definedValues = nullptr, int64_t const* const macroValues = nullptr)
+		{
+			CompiledCondition condition;
+			int64_t value = 0;
+			CrAssert(compile(condition, text) && condition.Evaluate(definedValues, macroValues, value));
+			return value;
+		};
+
+		CrAssert(evaluate("-((1 << 1) * 35) + 3 == -67") == 1);
+		CrAssert(evaluate("1 + 2 * 3 - 8 / 2 % 3") == 6);
+		CrAssert(evaluate("(0 || 5) + (3 && 0) + (2 && 7)") == 2);
+		CrAssert(evaluate("0 && 1 / 0") == 0 && evaluate("1 || 1 % 0") == 1);
+		CrAssert(evaluate("1 ? 0 ? 2 : 3 : 4") == 3 && evaluate("0 ? 1 / 0 : 5") == 5);
+		CrAssert(evaluate("0x10 | 1 ^ 3 & ~0") == 0x12);
+		CrAssert(evaluate("true + !false + !!7") == 3);
+
+		// Unsigned operands are evaluated as signed ones, in C '-1 > 0u' is true.
+		CrAssert(evaluate("-1 > 0u") == 0 && evaluate("0u - 1 < 0") == 1);
+
+		// Macros are read through the slots.
+		CompiledCondition condition;
+		CrAssert(compile(condition, "defined(A) && !defined B || A * B + A"));
+		CrAssert(condition.GetDefinedSlots().size() == 2 && condition.GetMacroSlots().size() == 2);
+		int64_t const definedValues[] = { 1, 1 };
+		int64_t const macroValues[] = { 3, 4 };
+		int64_t value;
+		CrAssert(condition.Evaluate(definedValues, macroValues, value) && value == 1);
+		int64_t const zeroValues[] = { 0, 0 };
+		CrAssert(condition.Evaluate(zeroValues, zeroValues, value) && value == 0);
+
+		// Invocations of the function-like macros and the broken expressions are not compiled.
+		for (auto const text : { "F(1)", "1 +", "(1", "1 2", "defined", "1 ? 2", "" })
+		{
+			CrAssert(!compile(condition, text) && !condition.IsCompiled());
+		}
+		CrAssert(compile(condition, "1 / 0") && !condition.Evaluate(nullptr, nullptr, value));
+	};
+
+}	// namespace Cr
@@ -0,0 +1,110 @@
+// $$***************************************************************$$ //
+//                                                                     //
+//                  Goddamn "C for Rendering" project                  //
+//     Copyright (C) Goddamn Industries 2016. All Rights Reserved.     //
+//          ( https://github.com/GoddamnIndustries/GoddamnCr )         //
+//                                                                     //
+//    This software or any its part is distributed under the terms of  //
+//   Goddamn Industries End User License Agreement. By downloading or  //
+//   using this software or any its part you agree with the terms of   //
+//   Goddamn Industries End User License Agreement.                    //
+//                                                                     //
+// $$***************************************************************$$ //
+
+
+#pragma once
+#include "Lexeme.h"
+
+#include <vector>
+
+namespace Cr
+{
+	/**
+	 * Condition of the '#if'/'#elif' directive, compiled into the stack bytecode.
+	 * Macros are referenced through the slots, so the condition is compiled once and re-evaluated
+	 * under any macro definitions: 'defined <ident>' reads the defined slot, other identifiers read the macro slot,
+	 * that holds value of the macro expansion.
+	 */
+	class CompiledCondition final
+	{
+	public:
+		static size_t const s_MaxStackSize = 64;
+
+	private:
+		enum class Opcode : uint8_t
+		{
+			PushConstant, PushDefined, PushMacro,
+			Not, BitwiseNot, Negate, ToBool,
+			Multiply, Divide, Modulo, Add, Subtract, LeftShift, RightShift,
+			Less, LessEquals, Greater, GreaterEquals, Equals, NotEquals,
+			BitwiseAnd, BitwiseXor, BitwiseOr,
+			AndJump,	///< Jumps if top is zero, pops it otherwise.
+			OrJump,		///< Replaces top with one and jumps if it is not zero, pops it otherwise.
+			JumpIfZero,	///< Pops top and jumps if it was zero.
+			Jump,
+		};	// enum class Opcode
+
+		struct Instruction
+		{
+			Opcode   m_Opcode;
+			uint32_t m_Operand;	///< Index of the constant, slot or target instruction.
+		};	// struct Instruction
+
+		class Compiler;
+
+		std::vector<Instruction> m_Code;
+		std::vector<int64_t>     m_Constants;
+		std::vector<Symbol>      m_DefinedSlots;
+		std::vector<Symbol>      m_MacroSlots;
+		uint32_t                 m_Length = 0;
+
+	public:
+
+		/**
+		 * Compiles the expression. Whole range should be a single expression.
+		 * @returns False if the expression cannot be compiled before the macro expansion:
+		 *          it has syntax errors or invokes the function-like macros.
+		 */
+		CR_API bool Compile(Lexeme const* begin, Lexeme const* end);
+
+		/**
+		 * Evaluates the compiled expression. Values are signed, unsigned operands do not make the operation unsigned.
+		 * @param definedValues Values of the defined slots, one if the macro is defined and zero otherwise.
+		 * @param macroValues Values of the macro slots.
+		 * @returns False if division by zero occurred.
+		 */
+		CR_API bool Evaluate(int64_t const* definedValues, int64_t const* macroValues, int64_t& value) const;
+
+		/**
+		 * Checks whether the last compilation succeeded.
+		 */
+		CRINL bool IsCompiled() const
+		{
+			return !m_Code.empty();
+		}
+
+		/**
+		 * Returns amount of the lexemes of the compiled range.
+		 */
+		CRINL uint32_t GetLength() const
+		{
+			return m_Length;
+		}
+
+		/**
+		 * Returns macros of the defined slots and macro slots.
+		 */
+		/// @{
+		CRINL std::vector<Symbol> const& GetDefinedSlots() const
+		{
+			return m_DefinedSlots;
+		}
+		CRINL std::vector<Symbol> const& GetMacroSlots() const
+		{
+			return m_MacroSlots;
+		}
+		/// @}
+
+	};	// class CompiledCondition
+
+}	// namespace Cr
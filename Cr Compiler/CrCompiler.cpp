@@ -11,10 +11,112 @@
 //                                                                     //
 // $$***************************************************************$$ //
 
+#include "PreprocessedOutput.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace Cr;
+
+/**
+ * Prints the command line usage of the compiler.
+ */
+static void PrintUsage()
+{
+	fputs("Usage: CrCompiler -E [-I<directory>] [-D<name>[=<value>]] [-o <output>] <input>\n"
+		"  -E  Writes the preprocessed source to the output or to the standard output.\n", stderr);
+}
+
 /**
  * Entry point for the whole "C for Rendering" shader compiler.
  */
 int main(int const argc, char const* const* const argv)
 {
+	auto doPreprocessOnly = false;
+	char const* inputPath = nullptr;
+	char const* outputPath = nullptr;
+	std::vector<char const*> includeDirectories;
+	std::vector<std::pair<std::string, std::string>> macros;
+	for (auto i = 1; i < argc; ++i)
+	{
+		auto const argument = argv[i];
+		if (strcmp(argument, "-E") == 0)
+		{
+			doPreprocessOnly = true;
+		}
+		else if (strncmp(argument, "-I", 2) == 0 && (argument[2] != '\0' || i + 1 < argc))
+		{
+			includeDirectories.push_back(argument[2] != '\0' ? argument + 2 : argv[++i]);
+		}
+		else if (strncmp(argument, "-D", 2) == 0 && argument[2] != '\0')
+		{
+			auto const definition = strchr(argument, '=');
+			macros.emplace_back(definition != nullptr ? std::string(argument + 2, definition) : argument + 2
+				, definition != nullptr ? definition + 1 : "1");
+		}
+		else if (strcmp(argument, "-o") == 0 && i + 1 < argc)
+		{
+			outputPath = argv[++i];
+		}
+		else if (argument[0] != '-' && inputPath == nullptr)
+		{
+			inputPath = argument;
+		}
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+	if (!doPreprocessOnly || inputPath == nullptr)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	FILE* outputFile = nullptr;
+	try
+	{
+		auto const inputFile = HeaderCache::Global().Find(inputPath);
+		if (inputFile == nullptr)
+		{
+			throw IO::Exception("Failed to open the input file.");
+		}
+		Preprocessor preprocessor(*inputFile);
+		for (auto const includeDirectory : includeDirectories)
+		{
+			preprocessor.AddIncludeDirectory(includeDirectory);
+		}
+		for (auto const& macro : macros)
+		{
+			preprocessor.DefineMacro(macro.first.c_str(), macro.second.c_str());
+		}
+
+		outputFile = outputPath != nullptr ? fopen(outputPath, "wb") : stdout;
+		if (outputFile == nullptr)
+		{
+			throw IO::Exception("Failed to open the output file.");
+		}
+		IO::BufferedWriter writer(outputFile);
+		PreprocessedWriter(writer).Write(preprocessor);
+		writer.Flush();
+	}
+	catch (Exception const& exception)
+	{
+		fprintf(stderr, "%s\n", exception.what());
+		if (outputFile != nullptr && outputFile != stdout)
+		{
+			fclose(outputFile);
+		}
+		return 1;
+	}
+	if (outputFile != stdout && fclose(outputFile) != 0)
+	{
+		fputs("Failed to write the output file.\n", stderr);
+		return 1;
+	}
 	return 0;
 }
@@ -0,0 +1,468 @@
+// $$***************************************************************$$ //
+//                                                                     //
+//                  Goddamn "C for Rendering" project                  //
+//     Copyright (C) Goddamn Industries 2016. All Rights Reserved.     //
+//          ( https://github.com/GoddamnIndustries/GoddamnCr )         //
+//                                                                     //
+//    This software or any its part is distributed under the terms of  //
+//   Goddamn Industries End User License Agreement. By downloading or  //
+//   using this software or any its part you agree with the terms of   //
+//   Goddamn Industries End User License Agreement.                    //
+//                                                                     //
+// $$***************************************************************$$ //
+
+
+#include "DependencyIndex.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <unordered_set>
+
+namespace Cr
+{
+	// *************************************************************** //
+	// **            DependencyIndex class implementation.          ** //
+	// *************************************************************** //
+
+	static char const s_IndexHeader[] = "CrDependencyIndex 1";
+
+	/**
+	 * Initializes a new index and loads it from the specified file, if it exists.
+	 */
+	CR_API DependencyIndex::DependencyIndex(char const* const indexPath /*= nullptr*/)
+	{
+		if (indexPath != nullptr)
+		{
+			m_IndexPath = indexPath;
+			Load();
+		}
+	}
+
+	/**
+	 * Adds the directory to search the included files in.
+	 */
+	CR_API void DependencyIndex::AddIncludeDirectory(char const* const directory)
+	{
+		CrAssert(directory != nullptr);
+		m_IncludeDirectories.emplace_back(directory);
+	}
+
+	/**
+	 * Scans the file and its includes.
+	 * Includes are resolved the way the preprocessor does: quoted paths relatively to the including file first,
+	 * then in the include directories. Files are hashed in the order of the walk, which depends on the sources only.
+	 */
+	CR_API std::vector<std::string> DependencyIndex::Scan(char const* const path, uint64_t* const sourcesHash /*= nullptr*/)
+	{
+		CrAssert(path != nullptr);
+		std::unordered_map<std::string, FileDependencies const*> files;
+		auto const scanFile = [this, &files](std::string const& path)
+		{
+			auto const normalizedPath = HeaderCache::NormalizePath(path);
+			auto const file = files.find(normalizedPath);
+			return file != files.end() ? file->second : files[normalizedPath] = ScanFile(normalizedPath);
+		};
+
+		// Walking the includes, conditions and definitions of all files are merged.
+		auto hash = Hash::Fnv1a64(nullptr, 0);
+		std::unordered_set<std::string> conditionMacros;
+		std::unordered_map<std::string, std::vector<std::string>> definitions;
+		std::unordered_set<std::string> visitedPaths;
+		std::vector<std::string> pendingPaths = { HeaderCache::NormalizePath(path) };
+		if (scanFile(path) == nullptr)
+		{
+			throw DependencyIndexException(("Cannot open the scanned file '" + std::string(path) + "'.").c_str());
+		}
+		while (!pendingPaths.empty())
+		{
+			auto const currentPath = std::move(pendingPaths.back());
+			pendingPaths.pop_back();
+			if (!visitedPaths.insert(currentPath).second)
+			{
+				continue;
+			}
+
+			auto const dependencies = scanFile(currentPath);
+			hash = Hash::Fnv1a64(currentPath.c_str(), currentPath.size() + 1, hash);
+			hash = Hash::Fnv1a64(reinterpret_cast<char const*>(&dependencies->m_Hash), sizeof dependencies->m_Hash, hash);
+			conditionMacros.insert(dependencies->m_ConditionMacros.begin(), dependencies->m_ConditionMacros.end());
+			for (auto const& definition : dependencies->m_Definitions)
+			{
+				auto& identifiers = definitions[definition.first];
+				identifiers.insert(identifiers.end(), definition.second.begin(), definition.second.end());
+			}
+			for (auto const& include : dependencies->m_Includes)
+			{
+				std::vector<std::string> candidatePaths;
+				if (!include.second)
+				{
+					auto const separator = currentPath.find_last_of('/');
+					candidatePaths.push_back(separator != std::string::npos ? currentPath.substr(0, separator + 1) + include.first : include.first);
+				}
+				for (auto const& directory : m_IncludeDirectories)
+				{
+					candidatePaths.push_back(directory + '/' + include.first);
+				}
+				auto const candidatePath = std::find_if(candidatePaths.begin(), candidatePaths.end(), [&scanFile](std::string const& candidatePath)
+				{
+					return scanFile(candidatePath) != nullptr;
+				});
+				if (candidatePath != candidatePaths.end())
+				{
+					pendingPaths.push_back(HeaderCache::NormalizePath(*candidatePath));
+				}
+			}
+		}
+
+		// Following the identifiers of the conditions through the definitions of the macros.
+		std::vector<std::string> pendingMacros(conditionMacros.begin(), conditionMacros.end());
+		while (!pendingMacros.empty())
+		{
+			auto const definition = definitions.find(pendingMacros.back());
+			pendingMacros.pop_back();
+			if (definition != definitions.end())
+			{
+				for (auto const& identifier : definition->second)
+				{
+					if (conditionMacros.insert(identifier).second)
+					{
+						pendingMacros.push_back(identifier);
+					}
+				}
+			}
+		}
+
+		if (sourcesHash != nullptr)
+		{
+			*sourcesHash = hash;
+		}
+		std::vector<std::string> macros(conditionMacros.begin(), conditionMacros.end());
+		std::sort(macros.begin(), macros.end());
+		return macros;
+	}
+
+	/**
+	 * Returns dependencies of the single file.
+	 * File is mapped to hash its contents, it is tokenized only if the contents are not indexed.
+	 * Files, registered in the header cache with 'AddFile', are used instead of the file system.
+	 */
+	CR_API FileDependencies const* DependencyIndex::ScanFile(std::string const& path)
+	{
+		auto const normalizedPath = HeaderCache::NormalizePath(path);
+		char const* begin;
+		char const* end;
+		IO::PInputStream inputStream;
+		if (!HeaderCache::Global().FindContents(normalizedPath, begin, end))
+		{
+			try
+			{
+				inputStream = std::make_shared<IO::MappedFileInputStream>(normalizedPath.c_str());
+			}
+			catch (Exception const&)
+			{
+				return nullptr;
+			}
+			inputStream->GetBuffer(begin, end);
+		}
+		auto const size = static_cast<uint64_t>(end - begin);
+		auto const hash = Hash::Fnv1a64(begin, static_cast<size_t>(size));
+		auto const indexedFile = m_Files.find(hash);
+		if (indexedFile != m_Files.end() && indexedFile->second.m_Size == size)
+		{
+			return &indexedFile->second;
+		}
+
+		TokenizedFile file;
+		file.m_Path = normalizedPath;
+		Scanner scanner(begin, end, SourceManager::Global().AddBuffer(normalizedPath.c_str(), begin, end, inputStream));
+		file.Tokenize(scanner);
+		auto& dependencies = m_Files[hash] = ScanDirectives(file);
+		dependencies.m_Hash = hash;
+		dependencies.m_Size = size;
+		m_IsModified = true;
+		return &dependencies;
+	}
+
+	/**
+	 * Scans the directives of the tokenized file. Only the indexed directive lines are visited.
+	 */
+	CR_API FileDependencies DependencyIndex::ScanDirectives(TokenizedFile const& file)
+	{
+		auto const spelling = [](Lexeme const& lexeme)
+		{
+			return std::string(lexeme.GetText(), lexeme.GetLength());
+		};
+
+		FileDependencies dependencies;
+		for (auto const directive : file.m_Directives)
+		{
+			auto lexeme = &file.m_Lexemes[directive + 1];
+			switch (lexeme->GetType())
+			{
+				// Identifiers of the conditions, 'defined' is a keyword.
+				// ---------------------------------------------------
+				case Lexeme::Type::KwIf:
+				case Lexeme::Type::KwPpElif:
+				case Lexeme::Type::KwPpIfdef:
+				case Lexeme::Type::KwPpIfndef:
+					for (++lexeme; *lexeme != Lexeme::Type::NewLine; ++lexeme)
+					{
+						if (*lexeme == Lexeme::Type::IdIdentifier)
+						{
+							dependencies.m_ConditionMacros.push_back(spelling(*lexeme));
+						}
+					}
+					break;
+
+				// Identifiers of the replacement list, except the parameters.
+				// ---------------------------------------------------
+				case Lexeme::Type::KwPpDefine:
+					{
+						++lexeme;
+						if (*lexeme != Lexeme::Type::IdIdentifier)
+						{
+							break;
+						}
+						dependencies.m_Definitions.emplace_back(spelling(*lexeme), std::vector<std::string>());
+						auto& identifiers = dependencies.m_Definitions.back().second;
+						std::vector<std::string> params;
+						if (*++lexeme == Lexeme::Type::OpParenOpen && !lexeme->HasFlags(Lexeme::FlagsLeadingSpace))
+						{
+							for (; *lexeme != Lexeme::Type::OpParenClose && *lexeme != Lexeme::Type::NewLine; ++lexeme)
+							{
+								if (*lexeme == Lexeme::Type::IdIdentifier)
+								{
+									params.push_back(spelling(*lexeme));
+								}
+							}
+						}
+						for (; *lexeme != Lexeme::Type::NewLine; ++lexeme)
+						{
+							if (*lexeme == Lexeme::Type::IdIdentifier && std::find(params.begin(), params.end(), spelling(*lexeme)) == params.end())
+							{
+								identifiers.push_back(spelling(*lexeme));
+							}
+						}
+						break;
+					}
+
+				// Included paths.
+				// ---------------------------------------------------
+				case Lexeme::Type::KwPpInclude:
+					++lexeme;
+					if (*lexeme == Lexeme::Type::CtString)
+					{
+						dependencies.m_Includes.emplace_back(std::string(lexeme->GetText() + 1, lexeme->GetLength() - 2), false);
+					}
+					else if (*lexeme == Lexeme::Type::OpLess)
+					{
+						auto const pathBegin = lexeme->GetText() + 1;
+						while (*lexeme != Lexeme::Type::OpGreater && *lexeme != Lexeme::Type::NewLine)
+						{
+							++lexeme;
+						}
+						if (*lexeme == Lexeme::Type::OpGreater)
+						{
+							dependencies.m_Includes.emplace_back(std::string(pathBegin, lexeme->GetText()), true);
+						}
+					}
+					break;
+
+				// ---------------------------------------------------
+				default:
+					break;
+			}
+		}
+		return dependencies;
+	}
+
+	/**
+	 * Loads the index file. Missing, damaged or outdated index files are ignored, files are rescanned then.
+	 * Format is line based:
+	 *   file <hash> <size>, followed by 'c <macro>', 'd <macro> [<identifier> ..]', 'q <path>' and 'a <path>' lines.
+	 */
+	CR_INTERNAL void DependencyIndex::Load()
+	{
+		auto const indexFile = fopen(m_IndexPath.c_str(), "rb");
+		if (indexFile == nullptr)
+		{
+			return;
+		}
+		std::string contents;
+		char buffer[4096];
+		for (size_t length; (length = fread(buffer, 1, sizeof buffer, indexFile)) != 0;)
+		{
+			contents.append(buffer, length);
+		}
+		fclose(indexFile);
+
+		std::unordered_map<uint64_t, FileDependencies> files;
+		FileDependencies* dependencies = nullptr;
+		auto isHeaderRead = false;
+		for (size_t begin = 0, end; begin < contents.size(); begin = end + 1)
+		{
+			end = contents.find('\n', begin);
+			if (end == std::string::npos)
+			{
+				end = contents.size();
+			}
+			auto const line = contents.substr(begin, end - begin);
+			if (!isHeaderRead)
+			{
+				if (line != s_IndexHeader)
+				{
+					return;
+				}
+				isHeaderRead = true;
+				continue;
+			}
+
+			auto const tag = line.substr(0, line.find(' '));
+			auto const argument = tag.size() < line.size() ? line.substr(tag.size() + 1) : std::string();
+			if (tag == "file")
+			{
+				unsigned long long hash, size;
+				if (sscanf(argument.c_str(), "%llx %llu", &hash, &size) != 2)
+				{
+					return;
+				}
+				dependencies = &files[hash];
+				dependencies->m_Hash = hash;
+				dependencies->m_Size = size;
+			}
+			else if (dependencies == nullptr)
+			{
+				return;
+			}
+			else if (tag == "c")
+			{
+				dependencies->m_ConditionMacros.push_back(argument);
+			}
+			else if (tag == "d")
+			{
+				std::vector<std::string> identifiers;
+				for (size_t identifierBegin = 0, identifierEnd; identifierBegin < argument.size(); identifierBegin = identifierEnd + 1)
+				{
+					identifierEnd = argument.find(' ', identifierBegin);
+					if (identifierEnd == std::string::npos)
+					{
+						identifierEnd = argument.size();
+					}
+					identifiers.push_back(argument.substr(identifierBegin, identifierEnd - identifierBegin));
+				}
+				if (identifiers.empty())
+				{
+					return;
+				}
+				auto const name = std::move(identifiers.front());
+				identifiers.erase(identifiers.begin());
+				dependencies->m_Definitions.emplace_back(std::move(name), std::move(identifiers));
+			}
+			else if (tag == "q" || tag == "a")
+			{
+				dependencies->m_Includes.emplace_back(argument, tag == "a");
+			}
+			else if (!line.empty())
+			{
+				return;
+			}
+		}
+		m_Files = std::move(files);
+	}
+
+	/**
+	 * Writes the index file. Index is written into the temporary file first, so the damaged index is never left.
+	 */
+	CR_API void DependencyIndex::Save()
+	{
+		if (m_IndexPath.empty() || !m_IsModified)
+		{
+			return;
+		}
+
+		auto const temporaryPath = m_IndexPath + ".tmp";
+		auto const indexFile = fopen(temporaryPath.c_str(), "wb");
+		if (indexFile == nullptr)
+		{
+			throw DependencyIndexException("Failed to write the dependency index.");
+		}
+		fprintf(indexFile, "%s\n", s_IndexHeader);
+		for (auto const& file : m_Files)
+		{
+			auto const& dependencies = file.second;
+			fprintf(indexFile, "file %016llx %llu\n", static_cast<unsigned long long>(file.first), static_cast<unsigned long long>(dependencies.m_Size));
+			for (auto const& macro : dependencies.m_ConditionMacros)
+			{
+				fprintf(indexFile, "c %s\n", macro.c_str());
+			}
+			for (auto const& definition : dependencies.m_Definitions)
+			{
+				fprintf(indexFile, "d %s", definition.first.c_str());
+				for (auto const& identifier : definition.second)
+				{
+					fprintf(indexFile, " %s", identifier.c_str());
+				}
+				fprintf(indexFile, "\n");
+			}
+			for (auto const& include : dependencies.m_Includes)
+			{
+				fprintf(indexFile, "%s %s\n", include.second ? "a" : "q", include.first.c_str());
+			}
+		}
+		auto const isWritten = ferror(indexFile) == 0;
+		fclose(indexFile);
+		remove(m_IndexPath.c_str());
+		if (!isWritten || rename(temporaryPath.c_str(), m_IndexPath.c_str()) != 0)
+		{
+			remove(temporaryPath.c_str());
+			throw DependencyIndexException("Failed to write the dependency index.");
+		}
+		m_IsModified = false;
+	}
+
+	// *************************************************************** //
+	// **             DependencyIndex class unit tests.             ** //
+	// *************************************************************** //
+
+	CrUnitTest(DependencyIndexScan)
+	{
+		Testing::TestFiles files("DependencyIndexTest");
+		auto const shaderPath = files.AddSource("Shader.fx", R"(#include "Shader.fxh"
+#include "Missing.fxh"
+#if QUALITY > 1 && defined(USE_FOG)
+	#define FOG_DENSITY DENSITY_SCALE * 2
+#endif
+#ifdef LIGHTS
+#endif
+NOT_OBSERVED
+)");
+		files.AddSource("Shader.fxh", R"(#ifndef HEADER_GUARD
+#define HEADER_GUARD
+#define SHADOWS(x) (x + SHADOW_BIAS)
+#if SHADOWS(1) > 0
+#endif
+#endif
+)");
+		auto const indexPath = files.GetTemporaryPath("CrDependencyIndexTest.index");
+		std::vector<std::string> const expectedMacros = { "HEADER_GUARD", "LIGHTS", "QUALITY", "SHADOWS", "SHADOW_BIAS", "USE_FOG" };
+		uint64_t sourcesHash;
+		{
+			DependencyIndex index(indexPath.c_str());
+			CrAssert(index.Scan(shaderPath.c_str(), &sourcesHash) == expectedMacros);
+			index.Save();
+		}
+		{
+			// Index is loaded from the disk, dependencies and hash are equal.
+			uint64_t loadedSourcesHash;
+			DependencyIndex index(indexPath.c_str());
+			CrAssert(index.Scan(shaderPath.c_str(), &loadedSourcesHash) == expectedMacros);
+			CrAssert(loadedSourcesHash == sourcesHash);
+
+			// Hash follows the contents of the included file.
+			files.AddSource("Shader.fxh", "#define HEADER_CHANGED\n");
+			CrAssert(index.Scan(shaderPath.c_str(), &loadedSourcesHash) != expectedMacros);
+			CrAssert(loadedSourcesHash != sourcesHash);
+		}
+	};
+
+}	// namespace Cr
@@ -0,0 +1,96 @@
+// $$***************************************************************$$ //
+//                                                                     //
+//                  Goddamn "C for Rendering" project                  //
+//     Copyright (C) Goddamn Industries 2016. All Rights Reserved.     //
+//          ( https://github.com/GoddamnIndustries/GoddamnCr )         //
+//                                                                     //
+//    This software or any its part is distributed under the terms of  //
+//   Goddamn Industries End User License Agreement. By downloading or  //
+//   using this software or any its part you agree with the terms of   //
+//   Goddamn Industries End User License Agreement.                    //
+//                                                                     //
+// $$***************************************************************$$ //
+
+
+#pragma once
+#include "HeaderCache.h"
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Cr
+{
+	CrDefineExceptionBase(DependencyIndexException, WorkflowException);
+
+	/**
+	 * Directives of the single file that matter for the dependency scan.
+	 */
+	struct FileDependencies
+	{
+		uint64_t                                                      m_Hash = 0;
+		uint64_t                                                      m_Size = 0;
+		std::vector<std::string>                                      m_ConditionMacros;	///< Identifiers of the '#if'/'#ifdef'/'#ifndef'/'#elif' directives.
+		std::vector<std::pair<std::string, std::vector<std::string>>> m_Definitions;		///< Macros with the identifiers of their replacement lists.
+		std::vector<std::pair<std::string, bool>>                     m_Includes;			///< Included paths, true for the '<path>' form.
+	};	// struct FileDependencies
+
+	/**
+	 * Lists the macros that the conditional directives of the file and its includes can observe,
+	 * without preprocessing the file. Directives of each file are scanned once and persisted
+	 * in the on-disk index keyed by the hash of the file contents, so unchanged files are never tokenized again.
+	 */
+	class DependencyIndex final
+	{
+	private:
+		std::string                                    m_IndexPath;
+		std::unordered_map<uint64_t, FileDependencies> m_Files;
+		std::vector<std::string>                       m_IncludeDirectories;
+		bool                                           m_IsModified = false;
+
+	public:
+		DependencyIndex(DependencyIndex const&) = delete;
+		DependencyIndex& operator= (DependencyIndex const&) = delete;
+
+		/**
+		 * Initializes a new index and loads it from the specified file, if it exists.
+		 * @param indexPath Path of the index file or null pointer for the index that is not persisted.
+		 */
+		CR_API explicit DependencyIndex(char const* indexPath = nullptr);
+
+		/**
+		 * Adds the directory to search the included files in.
+		 */
+		CR_API void AddIncludeDirectory(char const* directory);
+
+		/**
+		 * Scans the file and its includes. All includes are followed regardless of the conditions, missing ones are ignored.
+		 * Identifiers of the conditions are followed through the macros defined in the scanned files.
+		 * @param sourcesHash Receives the hash of the paths and contents of all the scanned files, if not null.
+		 * @returns Sorted names of the observable macros, including the ones the files define themselves.
+		 */
+		CR_API std::vector<std::string> Scan(char const* path, uint64_t* sourcesHash = nullptr);
+
+		/**
+		 * Returns dependencies of the single file, file is scanned if its contents are not indexed.
+		 * Files, registered in the header cache with 'AddFile', are used instead of the file system.
+		 * @returns Dependencies or null pointer if file cannot be opened.
+		 */
+		CR_API FileDependencies const* ScanFile(std::string const& path);
+
+		/**
+		 * Writes the index file, if anything was scanned since it was loaded.
+		 */
+		CR_API void Save();
+
+		/**
+		 * Scans the directives of the tokenized file.
+		 */
+		CR_API static FileDependencies ScanDirectives(TokenizedFile const& file);
+
+	private:
+		CR_INTERNAL void Load();
+	};	// class DependencyIndex
+
+}	// namespace Cr
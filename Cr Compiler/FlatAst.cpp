@@ -0,0 +1,324 @@
+// $$***************************************************************$$ //
+//                                                                     //
+//                  Goddamn "C for Rendering" project                  //
+//     Copyright (C) Goddamn Industries 2016. All Rights Reserved.     //
+//          ( https://github.com/GoddamnIndustries/GoddamnCr )         //
+//                                                                     //
+//    This software or any its part is distributed under the terms of  //
+//   Goddamn Industries End User License Agreement. By downloading or  //
+//   using this software or any its part you agree with the terms of   //
+//   Goddamn Industries End User License Agreement.                    //
+//                                                                     //
+// $$***************************************************************$$ //
+
+
+#include "FlatAst.h"
+#include "Parser.h"
+
+namespace Cr
+{
+	// *************************************************************** //
+	// **                FlatAst class implementation.              ** //
+	// *************************************************************** //
+
+	// *************************************************************** //
+	template<typename Tp>
+	CR_INTERNAL FlatAst::NodeId FlatAst::AddNode(NodeKind const kind, std::vector<Tp>& nodes, Tp const& node)
+	{
+		nodes.push_back(node);
+		return NodeId(kind, static_cast<uint32_t>(nodes.size() - 1));
+	}
+
+	// *************************************************************** //
+	CR_INTERNAL FlatAst::List FlatAst::AddList(std::vector<NodeId> const& nodes)
+	{
+		List const list = { static_cast<uint32_t>(m_Lists.size()), static_cast<uint32_t>(nodes.size()) };
+		m_Lists.insert(m_Lists.end(), nodes.begin(), nodes.end());
+		return list;
+	}
+
+	// *************************************************************** //
+	CR_INTERNAL uint32_t FlatAst::AddVariable(Ast::Variable const* const var)
+	{
+		auto const variableIndex = m_VariableIndices.find(var);
+		if (variableIndex != m_VariableIndices.end())
+		{
+			return variableIndex->second;
+		}
+
+		auto const index = static_cast<uint32_t>(m_Variables.size());
+		CrAssert(index <= NodeId::s_MaxIndex);
+		m_VariableIndices.emplace(var, index);
+		m_Variables.push_back({ var->m_Name, var->m_Semantic, var->m_Type, NodeId() });
+		// Initializer is added after the variable is registered, it may reference the variable itself.
+		auto const initExpr = AddExpression(var->m_InitExpr);
+		m_Variables[index].m_InitExpr = initExpr;
+		return index;
+	}
+
+	/**
+	 * Converts the statements of the tree into the flat nodes.
+	 * @returns Compound node with all the statements.
+	 */
+	CR_API FlatAst::NodeId FlatAst::AddStatements(Ast::Statement* const* const begin, Ast::Statement* const* const end)
+	{
+		std::vector<NodeId> stmts;
+		for (auto stmt = begin; stmt != end; ++stmt)
+		{
+			auto const flatStmt = AddStatement(*stmt);
+			if (!flatStmt.IsNull())
+			{
+				stmts.push_back(flatStmt);
+			}
+		}
+		return AddNode(NodeKind::Compound, m_Compounds, AddList(stmts));
+	}
+
+	/**
+	 * Converts the statement of the tree into the flat nodes.
+	 * @returns Identifier of the root node or null identifier for the null pointer.
+	 */
+	CR_API FlatAst::NodeId FlatAst::AddStatement(Ast::Statement const* const stmt)
+	{
+		if (stmt == nullptr)
+		{
+			return NodeId();
+		}
+
+		// Children are converted before their parents, so nodes of the same kind stay in the bottom-up order.
+		if (auto const compoundStmt = dynamic_cast<Ast::CompoundStatement const*>(stmt))
+		{
+			return AddStatements(compoundStmt->m_Stmts.begin(), compoundStmt->m_Stmts.end());
+		}
+		if (auto const ifStmt = dynamic_cast<Ast::IfSelectionStatement const*>(stmt))
+		{
+			IfNode const ifNode = { AddExpression(ifStmt->m_CondExpr), AddStatement(ifStmt->m_ThenStmt), AddStatement(ifStmt->m_ElseStmt) };
+			return AddNode(NodeKind::If, m_Ifs, ifNode);
+		}
+		if (auto const switchStmt = dynamic_cast<Ast::SwitchSelectionStatement const*>(stmt))
+		{
+			// Sections are shared by the consecutive labels, so each one is converted only once.
+			std::unordered_map<Ast::SwitchSection const*, NodeId> sectionIds;
+			std::vector<NodeId> sections;
+			auto const addSection = [this, &sectionIds, &sections](Ast::SwitchSection const* const section)
+			{
+				if (section == nullptr)
+				{
+					return NodeId();
+				}
+				auto const sectionId = sectionIds.find(section);
+				if (sectionId != sectionIds.end())
+				{
+					return sectionId->second;
+				}
+				auto const newSectionId = AddStatements(section->m_Stmts.begin(), section->m_Stmts.end());
+				sectionIds.emplace(section, newSectionId);
+				sections.push_back(newSectionId);
+				return newSectionId;
+			};
+
+			SwitchNode switchNode;
+			switchNode.m_SelectionExpr = AddExpression(switchStmt->m_SelectionExpr);
+			std::vector<SwitchCaseNode> cases;
+			for (auto const& switchCase : switchStmt->m_Sections)
+			{
+				cases.push_back({ switchCase.m_Value, addSection(switchCase.m_Section) });
+			}
+			switchNode.m_DefaultSection = addSection(switchStmt->m_DefaultSection);
+			switchNode.m_Sections = AddList(sections);
+			switchNode.m_FirstCase = static_cast<uint32_t>(m_SwitchCases.size());
+			switchNode.m_CasesCount = static_cast<uint32_t>(cases.size());
+			m_SwitchCases.insert(m_SwitchCases.end(), cases.begin(), cases.end());
+			return AddNode(NodeKind::Switch, m_Switches, switchNode);
+		}
+		if (auto const whileStmt = dynamic_cast<Ast::WhileIterationStatement const*>(stmt))
+		{
+			LoopNode const loopNode = { NodeId(), AddExpression(whileStmt->m_CondExpr), NodeId(), AddStatement(whileStmt->m_LoopStmt) };
+			return AddNode(NodeKind::While, m_Loops, loopNode);
+		}
+		if (auto const doWhileStmt = dynamic_cast<Ast::DoWhileIterationStatement const*>(stmt))
+		{
+			LoopNode const loopNode = { NodeId(), AddExpression(doWhileStmt->m_CondExpr), NodeId(), AddStatement(doWhileStmt->m_LoopStmt) };
+			return AddNode(NodeKind::DoWhile, m_Loops, loopNode);
+		}
+		if (auto const forStmt = dynamic_cast<Ast::ForIterationStatement const*>(stmt))
+		{
+			auto const initStmt = AddStatement(forStmt->m_InitStmt);
+			LoopNode const loopNode = { initStmt, AddExpression(forStmt->m_CondExpr), AddExpression(forStmt->m_StepExpr), AddStatement(forStmt->m_LoopStmt) };
+			return AddNode(NodeKind::For, m_Loops, loopNode);
+		}
+		if (dynamic_cast<Ast::BreakJumpStatement const*>(stmt) != nullptr)
+		{
+			return NodeId(NodeKind::Break, 0);
+		}
+		if (dynamic_cast<Ast::ContinueJumpStatement const*>(stmt) != nullptr)
+		{
+			return NodeId(NodeKind::Continue, 0);
+		}
+		if (dynamic_cast<Ast::DiscardJumpStatement const*>(stmt) != nullptr)
+		{
+			return NodeId(NodeKind::Discard, 0);
+		}
+		if (auto const returnStmt = dynamic_cast<Ast::ReturnJumpStatement const*>(stmt))
+		{
+			return AddNode(NodeKind::Return, m_ExpressionStatements, AddExpression(returnStmt->m_Expr));
+		}
+		if (auto const exprStmt = dynamic_cast<Ast::ExpressionStatement const*>(stmt))
+		{
+			return AddNode(NodeKind::Expression, m_ExpressionStatements, AddExpression(exprStmt->m_Expr));
+		}
+		if (auto const declStmt = dynamic_cast<Ast::DeclarationStatement const*>(stmt))
+		{
+			// Structures are referenced by the types, only variables are converted.
+			std::vector<NodeId> vars;
+			for (auto const var : declStmt->m_Vars)
+			{
+				vars.push_back(NodeId(NodeKind::Variable, AddVariable(var)));
+			}
+			return AddNode(NodeKind::Declaration, m_Declarations, AddList(vars));
+		}
+
+		CrAssert(0);
+		return NodeId();
+	}
+
+	/**
+	 * Converts the expression of the tree into the flat nodes.
+	 * @returns Identifier of the root node or null identifier for the null pointer.
+	 */
+	CR_API FlatAst::NodeId FlatAst::AddExpression(Ast::Expression const* const expr)
+	{
+		if (expr == nullptr)
+		{
+			return NodeId();
+		}
+
+		if (auto const constExpr = dynamic_cast<Ast::ConstantExpression const*>(expr))
+		{
+			return AddNode(NodeKind::Constant, m_Constants, ConstantNode{ constExpr->m_Value, expr->m_Type });
+		}
+		if (auto const identExpr = dynamic_cast<Ast::IdentifierExpression const*>(expr))
+		{
+			auto const var = dynamic_cast<Ast::Variable const*>(identExpr->m_Ident);
+			CrAssert(var != nullptr);
+			return NodeId(NodeKind::Identifier, AddVariable(var));
+		}
+		if (auto const subscriptExpr = dynamic_cast<Ast::SubscriptExpression const*>(expr))
+		{
+			SubscriptNode const subscriptNode = { AddExpression(subscriptExpr->m_Expr), subscriptExpr->m_Subscript, expr->m_Type };
+			return AddNode(NodeKind::Subscript, m_Subscripts, subscriptNode);
+		}
+		if (auto const castExpr = dynamic_cast<Ast::CastExpression const*>(expr))
+		{
+			UnaryNode const unaryNode = { Lexeme::Type::Null, AddExpression(castExpr->m_Expr), castExpr->m_CastTo };
+			return AddNode(NodeKind::Cast, m_Unaries, unaryNode);
+		}
+		if (auto const unaryExpr = dynamic_cast<Ast::UnaryExpression const*>(expr))
+		{
+			UnaryNode const unaryNode = { unaryExpr->m_Op, AddExpression(unaryExpr->m_Expr), expr->m_Type };
+			return AddNode(NodeKind::Unary, m_Unaries, unaryNode);
+		}
+		if (auto const commaExpr = dynamic_cast<Ast::CommaExpression const*>(expr))
+		{
+			auto const lhs = AddExpression(commaExpr->m_Lhs);
+			BinaryNode const binaryNode = { Lexeme::Type::OpComma, lhs, AddExpression(commaExpr->m_Rhs), expr->m_Type };
+			return AddNode(NodeKind::Comma, m_Binaries, binaryNode);
+		}
+		if (auto const binaryExpr = dynamic_cast<Ast::BinaryExpression const*>(expr))
+		{
+			auto const kind = dynamic_cast<Ast::AssignmentBinaryExpression const*>(expr) != nullptr ? NodeKind::Assignment : NodeKind::Binary;
+			auto const lhs = AddExpression(binaryExpr->m_Lhs);
+			BinaryNode const binaryNode = { binaryExpr->m_Op, lhs, AddExpression(binaryExpr->m_Rhs), expr->m_Type };
+			return AddNode(kind, m_Binaries, binaryNode);
+		}
+		if (auto const ternaryExpr = dynamic_cast<Ast::TernaryExpression const*>(expr))
+		{
+			auto const condExpr = AddExpression(ternaryExpr->m_CondExpr);
+			auto const thenExpr = AddExpression(ternaryExpr->m_ThenExpr);
+			TernaryNode const ternaryNode = { condExpr, thenExpr, AddExpression(ternaryExpr->m_ElseExpr), expr->m_Type };
+			return AddNode(NodeKind::Ternary, m_Ternaries, ternaryNode);
+		}
+
+		CrAssert(0);
+		return NodeId();
+	}
+
+	/**
+	 * Adds the constant node with the value, converted to the specified type.
+	 */
+	CR_API FlatAst::NodeId FlatAst::AddConstant(Ast::Value const& value, Ast::Type const& type)
+	{
+		return AddNode(NodeKind::Constant, m_Constants, ConstantNode{ value.Convert(type), type });
+	}
+
+	/**
+	 * Returns the type of the expression node.
+	 */
+	CR_API Ast::Type FlatAst::GetType(NodeId const expr) const
+	{
+		auto const index = expr.GetIndex();
+		switch (expr.GetKind())
+		{
+			case NodeKind::Constant:   return m_Constants[index].m_Type;
+			case NodeKind::Identifier: return m_Variables[index].m_Type;
+			case NodeKind::Subscript:  return m_Subscripts[index].m_Type;
+			case NodeKind::Unary: case NodeKind::Cast: 
+				return m_Unaries[index].m_Type;
+			case NodeKind::Binary: case NodeKind::Assignment: case NodeKind::Comma: 
+				return m_Binaries[index].m_Type;
+			case NodeKind::Ternary:    return m_Ternaries[index].m_Type;
+			default:
+				CrAssert(0);
+				return Ast::Type();
+		}
+	}
+
+	// *************************************************************** //
+	// **                   FlatAst class unit tests.               ** //
+	// *************************************************************** //
+
+	CrUnitTest(FlatAstBuild)
+	{
+		Parser parser(new Preprocessor(std::make_shared<IO::StringInputStream>(R"(
+program 
+{
+		int a = 1 + 2;
+		int b = a * 3;
+		if (b > a) 
+		{
+			b = a;
+			a = b;
+		}
+}
+)")));
+		parser.ParseProgram();
+		auto const& program = parser.GetProgram();
+
+		FlatAst ast;
+		auto const root = ast.AddStatements(program.begin(), program.end());
+		CrAssert(root.GetKind() == FlatAst::NodeKind::Compound && ast.m_Compounds[root.GetIndex()].m_Count == 3);
+		CrAssert(ast.m_Variables.size() == 2 && ast.m_Ifs.size() == 1);
+
+		// Constant initializer of 'a' was folded while parsing.
+		auto const& a = ast.m_Variables[0];
+		CrAssert(a.m_InitExpr.GetKind() == FlatAst::NodeKind::Constant && ast.m_Constants[a.m_InitExpr.GetIndex()].m_Value.To<int32_t>() == 3);
+
+		// Walking the whole tree by the kind tags.
+		size_t assignmentsCount = 0, identifiersCount = 0;
+		std::vector<FlatAst::NodeId> stack(1, root);
+		while (!stack.empty())
+		{
+			auto const node = stack.back();
+			stack.pop_back();
+			assignmentsCount += node.GetKind() == FlatAst::NodeKind::Assignment;
+			identifiersCount += node.GetKind() == FlatAst::NodeKind::Identifier;
+			ast.ForEachChild(node, [&stack](FlatAst::NodeId const child)
+			{
+				stack.push_back(child);
+			});
+		}
+		CrAssert(assignmentsCount == 2 && identifiersCount == 7);
+		CrAssert(ast.GetType(ast.m_Ifs[0].m_CondExpr) == Ast::BaseType::Bool);
+	};
+
+}	// namespace Cr
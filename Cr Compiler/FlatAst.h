@@ -0,0 +1,326 @@
+// $$***************************************************************$$ //
+//                                                                     //
+//                  Goddamn "C for Rendering" project                  //
+//     Copyright (C) Goddamn Industries 2016. All Rights Reserved.     //
+//          ( https://github.com/GoddamnIndustries/GoddamnCr )         //
+//                                                                     //
+//    This software or any its part is distributed under the terms of  //
+//   Goddamn Industries End User License Agreement. By downloading or  //
+//   using this software or any its part you agree with the terms of   //
+//   Goddamn Industries End User License Agreement.                    //
+//                                                                     //
+// $$***************************************************************$$ //
+
+
+#pragma once
+#include "AST.h"
+
+#include <unordered_map>
+#include <vector>
+
+namespace Cr
+{
+	/**
+	 * Data-oriented form of the AST for the optimization and code generation passes.
+	 * Nodes are stored in the arrays by their kind and reference the children with 32-bit identifiers, that 
+	 * pack the kind tag and the index. Passes switch on the kind instead of the virtual calls and casts.
+	 */
+	class FlatAst final
+	{
+	public:
+
+		/**
+		 * Kind of the node. Defines the array, that stores the node.
+		 */
+		enum class NodeKind : uint8_t
+		{
+			Null,
+			// Expressions.
+			Constant,		///< m_Constants.
+			Identifier,		///< Index of the variable in m_Variables.
+			Subscript,		///< m_Subscripts.
+			Unary,			///< m_Unaries.
+			Cast,			///< m_Unaries, operator is null and type is the type of the cast.
+			Binary,			///< m_Binaries, logic, bitwise and arithmetic operators.
+			Assignment,		///< m_Binaries, plain and compound assignments.
+			Comma,			///< m_Binaries.
+			Ternary,		///< m_Ternaries.
+			// Statements.
+			Compound,		///< m_Lists.
+			If,				///< m_Ifs.
+			Switch,			///< m_Switches.
+			While,			///< m_Loops.
+			DoWhile,		///< m_Loops.
+			For,			///< m_Loops.
+			Break,			///< No payload.
+			Continue,		///< No payload.
+			Discard,		///< No payload.
+			Return,			///< m_ExpressionStatements.
+			Expression,		///< m_ExpressionStatements.
+			Declaration,	///< m_Lists of the variables.
+			Variable,		///< m_Variables.
+		};	// enum class NodeKind
+
+		/**
+		 * Reference to the node: kind in the highest 8 bits and index in the lower 24 bits.
+		 */
+		class NodeId final
+		{
+		public:
+			static uint32_t const s_MaxIndex = (1u << 24) - 1;
+
+		private:
+			uint32_t m_Value = 0;
+
+		public:
+			CRINL NodeId() = default;
+			CRINL NodeId(NodeKind const kind, uint32_t const index)
+				: m_Value(static_cast<uint32_t>(kind) << 24 | index)
+			{
+				CrAssert(index <= s_MaxIndex);
+			}
+
+			CRINL NodeKind GetKind() const
+			{
+				return static_cast<NodeKind>(m_Value >> 24);
+			}
+			CRINL uint32_t GetIndex() const
+			{
+				return m_Value & s_MaxIndex;
+			}
+			CRINL bool IsNull() const
+			{
+				return m_Value == 0;
+			}
+
+			CRINL bool operator== (NodeId const other) const
+			{
+				return m_Value == other.m_Value;
+			}
+			CRINL bool operator!= (NodeId const other) const
+			{
+				return m_Value != other.m_Value;
+			}
+		};	// class NodeId
+
+		/**
+		 * Range of the nodes inside m_Lists.
+		 */
+		struct List
+		{
+			uint32_t m_First;
+			uint32_t m_Count;
+		};	// struct List
+
+		struct ConstantNode
+		{
+			Ast::Value m_Value;
+			Ast::Type  m_Type;
+		};	// struct ConstantNode
+
+		struct SubscriptNode
+		{
+			NodeId    m_Expr;
+			Symbol    m_Subscript;
+			Ast::Type m_Type;
+		};	// struct SubscriptNode
+
+		struct UnaryNode
+		{
+			Lexeme::Type m_Op;
+			NodeId       m_Expr;
+			Ast::Type    m_Type;
+		};	// struct UnaryNode
+
+		struct BinaryNode
+		{
+			Lexeme::Type m_Op;
+			NodeId       m_Lhs;
+			NodeId       m_Rhs;
+			Ast::Type    m_Type;
+		};	// struct BinaryNode
+
+		struct TernaryNode
+		{
+			NodeId    m_CondExpr;
+			NodeId    m_ThenExpr;
+			NodeId    m_ElseExpr;
+			Ast::Type m_Type;
+		};	// struct TernaryNode
+
+		struct IfNode
+		{
+			NodeId m_CondExpr;
+			NodeId m_ThenStmt;
+			NodeId m_ElseStmt;
+		};	// struct IfNode
+
+		struct SwitchCaseNode
+		{
+			int64_t m_Value;
+			NodeId  m_Section;	///< Compound node. Labels of the same section share it.
+		};	// struct SwitchCaseNode
+
+		struct SwitchNode
+		{
+			NodeId   m_SelectionExpr;
+			NodeId   m_DefaultSection;
+			List     m_Sections;	///< Compound nodes of all sections, including the default one.
+			uint32_t m_FirstCase;	///< Index in m_SwitchCases.
+			uint32_t m_CasesCount;
+		};	// struct SwitchNode
+
+		struct LoopNode
+		{
+			NodeId m_InitStmt;
+			NodeId m_CondExpr;
+			NodeId m_StepExpr;
+			NodeId m_LoopStmt;
+		};	// struct LoopNode
+
+		struct VariableNode
+		{
+			Symbol    m_Name;
+			Symbol    m_Semantic;
+			Ast::Type m_Type;
+			NodeId    m_InitExpr;
+		};	// struct VariableNode
+
+	public:
+		std::vector<ConstantNode>   m_Constants;
+		std::vector<SubscriptNode>  m_Subscripts;
+		std::vector<UnaryNode>      m_Unaries;
+		std::vector<BinaryNode>     m_Binaries;
+		std::vector<TernaryNode>    m_Ternaries;
+		std::vector<List>           m_Compounds;
+		std::vector<IfNode>         m_Ifs;
+		std::vector<SwitchNode>     m_Switches;
+		std::vector<SwitchCaseNode> m_SwitchCases;
+		std::vector<LoopNode>       m_Loops;
+		std::vector<NodeId>         m_ExpressionStatements;	///< Expressions of the expression and return statements.
+		std::vector<List>           m_Declarations;
+		std::vector<VariableNode>   m_Variables;
+		std::vector<NodeId>         m_Lists;	///< Children of the compound statements, declarations and switches.
+
+	private:
+		std::unordered_map<Ast::Variable const*, uint32_t> m_VariableIndices;
+
+	public:
+
+		/**
+		 * Converts the statements of the tree into the flat nodes.
+		 * @returns Compound node with all the statements.
+		 */
+		CR_API NodeId AddStatements(Ast::Statement* const* begin, Ast::Statement* const* end);
+
+		/**
+		 * Converts the statement or expression of the tree into the flat nodes.
+		 * @returns Identifier of the root node or null identifier for the null pointer.
+		 */
+		/// @{
+		CR_API NodeId AddStatement(Ast::Statement const* stmt);
+		CR_API NodeId AddExpression(Ast::Expression const* expr);
+		/// @}
+
+		/**
+		 * Adds the constant node with the value, converted to the specified type.
+		 */
+		CR_API NodeId AddConstant(Ast::Value const& value, Ast::Type const& type);
+
+		/**
+		 * Returns the nodes of the list.
+		 */
+		CRINL NodeId const* GetList(List const& list) const
+		{
+			return m_Lists.data() + list.m_First;
+		}
+		CRINL NodeId* GetList(List const& list)
+		{
+			return m_Lists.data() + list.m_First;
+		}
+
+		/**
+		 * Returns the type of the expression node.
+		 */
+		CR_API Ast::Type GetType(NodeId expr) const;
+
+		/**
+		 * Calls the function for each non-null direct child of the node.
+		 */
+		template<typename TFunction>
+		CRINL void ForEachChild(NodeId const node, TFunction const& function) const
+		{
+			auto const index = node.GetIndex();
+			auto const call = [&function](NodeId const child)
+			{
+				if (!child.IsNull())
+				{
+					function(child);
+				}
+			};
+			switch (node.GetKind())
+			{
+				case NodeKind::Subscript:
+					call(m_Subscripts[index].m_Expr);
+					break;
+				case NodeKind::Unary: case NodeKind::Cast:
+					call(m_Unaries[index].m_Expr);
+					break;
+				case NodeKind::Binary: case NodeKind::Assignment: case NodeKind::Comma:
+					call(m_Binaries[index].m_Lhs);
+					call(m_Binaries[index].m_Rhs);
+					break;
+				case NodeKind::Ternary:
+					call(m_Ternaries[index].m_CondExpr);
+					call(m_Ternaries[index].m_ThenExpr);
+					call(m_Ternaries[index].m_ElseExpr);
+					break;
+				case NodeKind::Compound: case NodeKind::Declaration:
+					{
+						auto const& list = node.GetKind() == NodeKind::Compound ? m_Compounds[index] : m_Declarations[index];
+						for (uint32_t i = 0; i < list.m_Count; ++i)
+						{
+							call(GetList(list)[i]);
+						}
+					}
+					break;
+				case NodeKind::If:
+					call(m_Ifs[index].m_CondExpr);
+					call(m_Ifs[index].m_ThenStmt);
+					call(m_Ifs[index].m_ElseStmt);
+					break;
+				case NodeKind::Switch:
+					{
+						auto const& switchNode = m_Switches[index];
+						call(switchNode.m_SelectionExpr);
+						for (uint32_t i = 0; i < switchNode.m_Sections.m_Count; ++i)
+						{
+							call(GetList(switchNode.m_Sections)[i]);
+						}
+					}
+					break;
+				case NodeKind::While: case NodeKind::DoWhile: case NodeKind::For:
+					call(m_Loops[index].m_InitStmt);
+					call(m_Loops[index].m_CondExpr);
+					call(m_Loops[index].m_StepExpr);
+					call(m_Loops[index].m_LoopStmt);
+					break;
+				case NodeKind::Return: case NodeKind::Expression:
+					call(m_ExpressionStatements[index]);
+					break;
+				case NodeKind::Variable:
+					call(m_Variables[index].m_InitExpr);
+					break;
+				default:
+					break;
+			}
+		}
+
+	private:
+		CR_INTERNAL uint32_t AddVariable(Ast::Variable const* var);
+		CR_INTERNAL List AddList(std::vector<NodeId> const& nodes);
+		template<typename Tp>
+		CR_INTERNAL NodeId AddNode(NodeKind kind, std::vector<Tp>& nodes, Tp const& node);
+	};	// class FlatAst
+
+}	// namespace Cr
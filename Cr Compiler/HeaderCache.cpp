@@ -0,0 +1,337 @@
+// $$***************************************************************$$ //
+//                                                                     //
+//                  Goddamn "C for Rendering" project                  //
+//     Copyright (C) Goddamn Industries 2016. All Rights Reserved.     //
+//          ( https://github.com/GoddamnIndustries/GoddamnCr )         //
+//                                                                     //
+//    This software or any its part is distributed under the terms of  //
+//   Goddamn Industries End User License Agreement. By downloading or  //
+//   using this software or any its part you agree with the terms of   //
+//   Goddamn Industries End User License Agreement.                    //
+//                                                                     //
+// $$***************************************************************$$ //
+
+#include "HeaderCache.h"
+
+#include <cstdio>
+
+namespace Cr
+{
+	// *************************************************************** //
+	// **             TokenizedFile class implementation.           ** //
+	// *************************************************************** //
+
+	/**
+	 * Scans all remaining lexemes of the scanner and indexes the directive lines,
+	 * so the inactive conditional sections are skipped directive-by-directive.
+	 */
+	CR_API void TokenizedFile::Tokenize(Scanner& scanner)
+	{
+		scanner.Tokenize(m_Lexemes);
+		m_Directives.clear();
+		for (size_t index = 0; index < m_Lexemes.size(); ++index)
+		{
+			if (m_Lexemes[index] == Lexeme::Type::OpPreprocessor && (index == 0 || m_Lexemes[index - 1] == Lexeme::Type::NewLine))
+			{
+				m_Directives.push_back(static_cast<uint32_t>(index));
+			}
+		}
+	}
+
+	// *************************************************************** //
+	// **              HeaderCache class implementation.            ** //
+	// *************************************************************** //
+
+	/**
+	 * Returns the process-wide header cache.
+	 */
+	CR_API HeaderCache& HeaderCache::Global()
+	{
+		static HeaderCache s_Global;
+		return s_Global;
+	}
+
+	/**
+	 * Converts separators to slashes and removes the '.' and '..' components, so each file has a single key.
+	 */
+	CR_API std::string HeaderCache::NormalizePath(std::string const& path)
+	{
+		std::vector<std::string> components;
+		for (size_t begin = 0, end; begin <= path.size(); begin = end + 1)
+		{
+			end = path.find_first_of("/\\", begin);
+			if (end == std::string::npos)
+			{
+				end = path.size();
+			}
+			auto component = path.substr(begin, end - begin);
+			if (component == "..")
+			{
+				if (!components.empty() && components.back() != ".." && !components.back().empty())
+				{
+					components.pop_back();
+					continue;
+				}
+			}
+			else if (component == "." || (component.empty() && !components.empty()))
+			{
+				continue;
+			}
+			components.push_back(std::move(component));
+		}
+
+		std::string normalizedPath;
+		for (auto const& component : components)
+		{
+			if (&component != &components.front())
+			{
+				normalizedPath.push_back('/');
+			}
+			normalizedPath += component;
+		}
+		return normalizedPath;
+	}
+
+	/**
+	 * Tokenizes the file that is registered in the source manager.
+	 */
+	static std::unique_ptr<TokenizedFile> TokenizeFile(std::string const& path, char const* const begin, char const* const end, SourceOffset const offset)
+	{
+		std::unique_ptr<TokenizedFile> file(new TokenizedFile());
+		file->m_Path = path;
+		Scanner scanner(begin, end, offset);
+		file->Tokenize(scanner);
+		file->m_IncludeGuard = HeaderCache::DetectIncludeGuard(file->m_Lexemes);
+		return file;
+	}
+
+	/**
+	 * Returns the tokenized file with the specified path, file is read and tokenized on the first request.
+	 * Files that cannot be opened are remembered too, so the missing candidates of the include search are cheap.
+	 */
+	CR_API TokenizedFile const* HeaderCache::Find(std::string const& path)
+	{
+		auto const normalizedPath = NormalizePath(path);
+		auto const file = m_Files.find(normalizedPath);
+		if (file != m_Files.end())
+		{
+			return file->second.get();
+		}
+
+		IO::PInputStream inputStream;
+		try
+		{
+			inputStream = std::make_shared<IO::MappedFileInputStream>(normalizedPath.c_str());
+		}
+		catch (Exception const&)
+		{
+			m_Files[normalizedPath] = nullptr;
+			return nullptr;
+		}
+
+		char const* begin;
+		char const* end;
+		inputStream->GetBuffer(begin, end);
+		auto const offset = SourceManager::Global().AddBuffer(normalizedPath.c_str(), begin, end, inputStream);
+		return (m_Files[normalizedPath] = TokenizeFile(normalizedPath, begin, end, offset)).get();
+	}
+
+	/**
+	 * Registers the file with the specified contents.
+	 * @warning Should be called before the file with the same path is included.
+	 */
+	CR_API TokenizedFile const* HeaderCache::AddFile(std::string const& path, std::string&& contents)
+	{
+		auto const normalizedPath = NormalizePath(path);
+		auto const length = contents.size();
+		auto const offset = SourceManager::Global().AddBuffer(normalizedPath.c_str(), std::move(contents));
+		auto const begin = SourceManager::Global().GetText(offset);
+		m_Contents[normalizedPath] = { begin, begin + length };
+		return (m_Files[normalizedPath] = TokenizeFile(normalizedPath, begin, begin + length, offset)).get();
+	}
+
+	/**
+	 * Returns the contents of the file, registered with 'AddFile'.
+	 */
+	CR_API bool HeaderCache::FindContents(std::string const& path, char const*& begin, char const*& end) const
+	{
+		auto const contents = m_Contents.find(NormalizePath(path));
+		if (contents == m_Contents.end())
+		{
+			return false;
+		}
+		begin = contents->second.first;
+		end = contents->second.second;
+		return true;
+	}
+
+	/**
+	 * Detects the include guard of the tokenized file.
+	 * Lines are walked by their first lexemes only, nesting of the conditional directives is tracked until the matching '#endif'.
+	 */
+	CR_API Symbol HeaderCache::DetectIncludeGuard(std::vector<Lexeme> const& lexemes)
+	{
+		auto cursor = lexemes.data();
+		auto const skipNewLines = [&cursor]()
+		{
+			while (*cursor == Lexeme::Type::NewLine)
+			{
+				++cursor;
+			}
+		};
+
+		// Parsing '#ifndef <ident>' or '#if !defined <ident>' directive.
+		skipNewLines();
+		if (*cursor != Lexeme::Type::OpPreprocessor)
+		{
+			return NullSymbol;
+		}
+		++cursor;
+		auto guard = NullSymbol;
+		if (*cursor == Lexeme::Type::KwPpIfndef && cursor[1] == Lexeme::Type::IdIdentifier)
+		{
+			guard = cursor[1].GetValueID();
+			cursor += 2;
+		}
+		else if (*cursor == Lexeme::Type::KwPpIf && cursor[1] == Lexeme::Type::OpNot && cursor[2] == Lexeme::Type::KwPpDefined)
+		{
+			cursor += 3;
+			auto const hasParens = *cursor == Lexeme::Type::OpParenOpen;
+			cursor += hasParens;
+			if (*cursor != Lexeme::Type::IdIdentifier)
+			{
+				return NullSymbol;
+			}
+			guard = cursor->GetValueID();
+			++cursor;
+			if (hasParens)
+			{
+				if (*cursor != Lexeme::Type::OpParenClose)
+				{
+					return NullSymbol;
+				}
+				++cursor;
+			}
+		}
+		if (guard == NullSymbol || *cursor != Lexeme::Type::NewLine)
+		{
+			return NullSymbol;
+		}
+		++cursor;
+
+		// Walking the lines until the matching '#endif' directive.
+		for (size_t depth = 1; depth != 0; ++cursor)
+		{
+			if (*cursor == Lexeme::Type::Null)
+			{
+				return NullSymbol;
+			}
+			if (*cursor == Lexeme::Type::OpPreprocessor)
+			{
+				switch (cursor[1].GetType())
+				{
+					case Lexeme::Type::KwPpIf:
+					case Lexeme::Type::KwPpIfdef:
+					case Lexeme::Type::KwPpIfndef:
+						++depth;
+						break;
+					case Lexeme::Type::KwPpElif:
+					case Lexeme::Type::KwPpElse:
+						if (depth == 1)
+						{
+							return NullSymbol;
+						}
+						break;
+					case Lexeme::Type::KwPpEndif:
+						--depth;
+						break;
+					default:
+						break;
+				}
+			}
+			while (*cursor != Lexeme::Type::NewLine)
+			{
+				++cursor;
+			}
+		}
+
+		// Nothing but empty lines should follow the '#endif' directive.
+		skipNewLines();
+		return *cursor == Lexeme::Type::Null ? guard : NullSymbol;
+	}
+
+	// *************************************************************** //
+	// **           Testing::TestFiles class implementation.        ** //
+	// *************************************************************** //
+
+	namespace Testing
+	{
+		CR_API TestFiles::TestFiles(char const* const testName)
+			: m_TestName(testName)
+		{
+		}
+
+		CR_API TestFiles::~TestFiles()
+		{
+			for (auto const& path : m_TemporaryPaths)
+			{
+				remove(path.c_str());
+			}
+		}
+
+		/**
+		 * Registers the source file of the test or replaces its contents.
+		 */
+		CR_API std::string TestFiles::AddSource(char const* const name, std::string&& contents)
+		{
+			auto path = m_TestName + '/' + name;
+			HeaderCache::Global().AddFile(path, std::move(contents));
+			return path;
+		}
+
+		/**
+		 * Returns path of the file in the temporary directory. File, left by the interrupted run, is removed.
+		 */
+		CR_API std::string TestFiles::GetTemporaryPath(char const* const name)
+		{
+			auto path = IO::GetTemporaryDirectory() + '/' + name;
+			remove(path.c_str());
+			m_TemporaryPaths.push_back(path);
+			return path;
+		}
+	}	// namespace Testing
+
+	// *************************************************************** //
+	// **               HeaderCache class unit tests.               ** //
+	// *************************************************************** //
+
+	static Symbol DetectIncludeGuard(char const* const source)
+	{
+		std::vector<Lexeme> lexemes;
+		Scanner(std::make_shared<IO::StringInputStream>(source)).Tokenize(lexemes);
+		return HeaderCache::DetectIncludeGuard(lexemes);
+	}
+
+	CrUnitTest(HeaderCacheIncludeGuards)
+	{
+		auto const guard = SymbolTable::Global().Intern("GUARD");
+		CrAssert(DetectIncludeGuard("\n#ifndef GUARD\n#define GUARD\n#if A\n#else\n#endif\nint a;\n#endif\n\n") == guard);
+		CrAssert(DetectIncludeGuard("#if !defined(GUARD)\n#endif") == guard);
+		CrAssert(DetectIncludeGuard("#if !defined GUARD\n#endif") == guard);
+		CrAssert(DetectIncludeGuard("#ifndef GUARD\n#else\n#endif\n") == NullSymbol);
+		CrAssert(DetectIncludeGuard("#ifndef GUARD\n#endif\nint a;\n") == NullSymbol);
+		CrAssert(DetectIncludeGuard("int a;\n#ifndef GUARD\n#endif\n") == NullSymbol);
+		CrAssert(DetectIncludeGuard("#ifndef GUARD\n") == NullSymbol);
+		CrAssert(DetectIncludeGuard("#if !defined(GUARD) && A\n#endif") == NullSymbol);
+	};
+
+	CrUnitTest(HeaderCacheNormalizedPaths)
+	{
+		HeaderCache headerCache;
+		auto const file = headerCache.AddFile("HeaderCacheNormalizedPaths\\a/./b/../c.fxh", "c");
+		CrAssert(file->m_Path == "HeaderCacheNormalizedPaths/a/c.fxh");
+		CrAssert(headerCache.Find("HeaderCacheNormalizedPaths/a/b/../../a/c.fxh") == file);
+		CrAssert(headerCache.Find("HeaderCacheNormalizedPaths/a/missing.fxh") == nullptr);
+	};
+
+}	// namespace Cr
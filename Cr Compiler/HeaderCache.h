@@ -0,0 +1,127 @@
+// $$***************************************************************$$ //
+//                                                                     //
+//                  Goddamn "C for Rendering" project                  //
+//     Copyright (C) Goddamn Industries 2016. All Rights Reserved.     //
+//          ( https://github.com/GoddamnIndustries/GoddamnCr )         //
+//                                                                     //
+//    This software or any its part is distributed under the terms of  //
+//   Goddamn Industries End User License Agreement. By downloading or  //
+//   using this software or any its part you agree with the terms of   //
+//   Goddamn Industries End User License Agreement.                    //
+//                                                                     //
+// $$***************************************************************$$ //
+
+#pragma once
+#include "Scanner.h"
+#include "CompiledCondition.h"
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Cr
+{
+	/**
+	 * Tokenized source file.
+	 */
+	struct TokenizedFile
+	{
+		std::string         m_Path;
+		std::vector<Lexeme> m_Lexemes;						///< Lines separated with the new line lexemes, terminated with the null lexeme.
+		std::vector<uint32_t> m_Directives;					///< Indices of the '#' lexemes that start the lines.
+		Symbol              m_IncludeGuard = NullSymbol;	///< Macro of the '#ifndef' directive that wraps the whole file.
+		mutable std::unordered_map<uint32_t, CompiledCondition> m_Conditions;	///< Compiled conditions by index of their first lexeme.
+
+		/**
+		 * Scans all remaining lexemes of the scanner and indexes the directive lines.
+		 */
+		CR_API void Tokenize(Scanner& scanner);
+	};	// struct TokenizedFile
+
+	/**
+	 * Keeps the tokenized headers, so each header is read and tokenized once per process.
+	 * Files are assumed to be unchanged while the process runs.
+	 */
+	class HeaderCache final
+	{
+	private:
+		std::unordered_map<std::string, std::unique_ptr<TokenizedFile>> m_Files;
+		std::unordered_map<std::string, std::pair<char const*, char const*>> m_Contents;	///< Contents of the registered files.
+
+	public:
+		HeaderCache(HeaderCache const&) = delete;
+		HeaderCache& operator= (HeaderCache const&) = delete;
+
+		HeaderCache() = default;
+
+		/**
+		 * Returns the process-wide header cache.
+		 * @warning Not thread-safe.
+		 */
+		CR_API static HeaderCache& Global();
+
+		/**
+		 * Returns the tokenized file with the specified path, file is read and tokenized on the first request.
+		 * @returns Tokenized file or null pointer if file cannot be opened.
+		 */
+		CR_API TokenizedFile const* Find(std::string const& path);
+
+		/**
+		 * Registers the file with the specified contents, that are used instead of the file system.
+		 */
+		CR_API TokenizedFile const* AddFile(std::string const& path, std::string&& contents);
+
+		/**
+		 * Returns the contents of the file, registered with 'AddFile'.
+		 * @returns False if the file is not registered.
+		 */
+		CR_API bool FindContents(std::string const& path, char const*& begin, char const*& end) const;
+
+		/**
+		 * Detects the include guard of the tokenized file: the whole file is wrapped with '#ifndef <ident>' or
+		 * '#if !defined(<ident>)' and the matching '#endif', that has no '#elif' or '#else' sections.
+		 * @returns Macro of the include guard or null symbol if there is no guard.
+		 */
+		CR_API static Symbol DetectIncludeGuard(std::vector<Lexeme> const& lexemes);
+
+		/**
+		 * Converts separators to slashes and removes the '.' and '..' components, so each file has a single path.
+		 */
+		CR_API static std::string NormalizePath(std::string const& path);
+	};	// class HeaderCache
+
+	namespace Testing
+	{
+		/**
+		 * Files of the unit test. Sources are registered in the global header cache under the directory, named after the test,
+		 * so no sources are written to the disk. Files, written by the test, are placed into the temporary directory
+		 * and removed with the fixture.
+		 */
+		class TestFiles final
+		{
+		private:
+			std::string              m_TestName;
+			std::vector<std::string> m_TemporaryPaths;
+
+		public:
+			TestFiles(TestFiles const&) = delete;
+			TestFiles& operator= (TestFiles const&) = delete;
+
+			CR_API explicit TestFiles(char const* testName);
+			CR_API ~TestFiles();
+
+			/**
+			 * Registers the source file of the test or replaces its contents.
+			 * @returns Path of the registered file.
+			 */
+			CR_API std::string AddSource(char const* name, std::string&& contents);
+
+			/**
+			 * Returns path of the file in the temporary directory. File, left by the interrupted run, is removed.
+			 */
+			CR_API std::string GetTemporaryPath(char const* name);
+		};	// class TestFiles
+	}	// namespace Testing
+
+}	// namespace Cr
@@ -12,26 +12,289 @@
 // $$***************************************************************$$ //
 
 #include "Lexeme.h"
-#include <iostream>
+#include "NumericLiteral.h"
+#include <cstdio>
 
 namespace Cr
 {
-	std::map<std::string, Lexeme::Type> const Lexeme::s_KeywordsTable = {
-		
-		// Keywords 
-		{ "if", Type::KwIf }, { "else", Type::KwElse }, { "switch", Type::KwSwitch }, { "case", Type::KwCase }, { "default", Type::KwDefault },
-		{ "while", Type::KwWhile }, { "do", Type::KwDo }, { "for", Type::KwFor },
-		{ "break", Type::KwBreak }, { "continue", Type::KwContinue }, { "return", Type::KwReturn }, { "discard", Type::KwDiscard },
-		{ "typedef", Type::KwTypedef },{ "struct", Type::KwStruct },
-		{ "true", Type::KwTrue }, { "false", Type::KwFalse },
-
-		{ "program", Type::KwProgram },
-		{ "int",     Type::KwInt     }, { "float", Type::KwFloat },{ "float4", Type::KwFloat4 },{ "dword3x2", Type::KwDword3x2 },
-
-		// Preprocessor keywords.
-		{ "define", Type::KwPpDefine }, { "undef",  Type::KwPpUndef  }, { "defined", Type::KwPpDefined },
-		{ "ifdef",  Type::KwPpIfdef  }, { "ifndef", Type::KwPpIfndef }, { "elif",    Type::KwPpElif    }, { "endif",    Type::KwPpEndif },
-		{ "pragma", Type::KwPpPragma }, { "line",   Type::KwPpLine   }, { "error",   Type::KwPpError   },
+	// *************************************************************** //
+	// **              Keywords perfect hash generation.            ** //
+	// *************************************************************** //
+
+	struct KeywordSpelling
+	{
+		char const*  m_Spelling;
+		size_t       m_Length;
+		Lexeme::Type m_Type;
+	};	// struct KeywordSpelling
+
+	static constexpr KeywordSpelling s_Keywords[] = {
+#define CrKeywordSpelling(type, spelling) { spelling, sizeof(spelling) - 1, Lexeme::Type::type },
+		CrKeywordsList(CrKeywordSpelling)
+#undef CrKeywordSpelling
+	};
+
+	static constexpr size_t s_KeywordsCount = sizeof(s_Keywords) / sizeof(s_Keywords[0]);
+	static constexpr size_t s_KeywordsSlotsCount = 256;
+	static constexpr size_t s_KeywordsBucketsCount = 64;
+	static_assert(s_KeywordsCount < s_KeywordsSlotsCount, "Keywords do not fit into the hash table.");
+
+	/**
+	 * Hash-and-displace perfect hash table: each key is first hashed into a bucket, then each bucket
+	 * has a displacement pair chosen so that all keys of the language land into distinct slots.
+	 */
+	struct KeywordsHashTable
+	{
+		uint8_t m_Displacements[s_KeywordsBucketsCount][2];
+		uint8_t m_Slots[s_KeywordsSlotsCount];	// Index of the keyword plus one, zero for empty slots.
+		size_t  m_MaxLength;
+		bool    m_IsValid;
+	};	// struct KeywordsHashTable
+
+	CRINL static constexpr size_t GetKeywordBucket(uint32_t const hash)
+	{
+		return hash % s_KeywordsBucketsCount;
+	}
+	CRINL static constexpr size_t GetKeywordSlot(uint32_t const hash, size_t const displacement0, size_t const displacement1)
+	{
+		return ((hash >> 8) + displacement0 * ((hash >> 16) | 1) + displacement1) % s_KeywordsSlotsCount;
+	}
+
+	static constexpr KeywordsHashTable BuildKeywordsHashTable()
+	{
+		KeywordsHashTable table = {};
+		uint32_t hashes[s_KeywordsCount] = {};
+		size_t bucketsSizes[s_KeywordsBucketsCount] = {};
+		for (size_t i = 0; i < s_KeywordsCount; ++i)
+		{
+			hashes[i] = Hash::Fnv1a(s_Keywords[i].m_Spelling, s_Keywords[i].m_Length);
+			bucketsSizes[GetKeywordBucket(hashes[i])] += 1;
+			if (table.m_MaxLength < s_Keywords[i].m_Length)
+			{
+				table.m_MaxLength = s_Keywords[i].m_Length;
+			}
+		}
+
+		// Placing the largest buckets first, while the table is still sparse.
+		bool bucketsPlaced[s_KeywordsBucketsCount] = {};
+		for (size_t placedCount = 0; placedCount < s_KeywordsBucketsCount; ++placedCount)
+		{
+			size_t bucket = s_KeywordsBucketsCount, bucketSize = 0;
+			for (size_t i = 0; i < s_KeywordsBucketsCount; ++i)
+			{
+				if (!bucketsPlaced[i] && (bucket == s_KeywordsBucketsCount || bucketsSizes[i] > bucketSize))
+				{
+					bucket = i;
+					bucketSize = bucketsSizes[i];
+				}
+			}
+			bucketsPlaced[bucket] = true;
+			if (bucketSize == 0)
+			{
+				continue;
+			}
+
+			auto isBucketPlaced = false;
+			for (size_t displacement0 = 0; displacement0 < 256 && !isBucketPlaced; ++displacement0)
+			{
+				for (size_t displacement1 = 0; displacement1 < 256 && !isBucketPlaced; ++displacement1)
+				{
+					// Checking that keys of the bucket land into free and distinct slots.
+					auto doesBucketFit = true;
+					for (size_t i = 0; i < s_KeywordsCount && doesBucketFit; ++i)
+					{
+						if (GetKeywordBucket(hashes[i]) != bucket)
+						{
+							continue;
+						}
+						auto const slot = GetKeywordSlot(hashes[i], displacement0, displacement1);
+						doesBucketFit = table.m_Slots[slot] == 0;
+						for (size_t j = 0; j < i && doesBucketFit; ++j)
+						{
+							doesBucketFit = GetKeywordBucket(hashes[j]) != bucket || GetKeywordSlot(hashes[j], displacement0, displacement1) != slot;
+						}
+					}
+					if (doesBucketFit)
+					{
+						for (size_t i = 0; i < s_KeywordsCount; ++i)
+						{
+							if (GetKeywordBucket(hashes[i]) == bucket)
+							{
+								table.m_Slots[GetKeywordSlot(hashes[i], displacement0, displacement1)] = static_cast<uint8_t>(i + 1);
+							}
+						}
+						table.m_Displacements[bucket][0] = static_cast<uint8_t>(displacement0);
+						table.m_Displacements[bucket][1] = static_cast<uint8_t>(displacement1);
+						isBucketPlaced = true;
+					}
+				}
+			}
+			if (!isBucketPlaced)
+			{
+				return table;
+			}
+		}
+		table.m_IsValid = true;
+		return table;
+	}
+
+	static constexpr KeywordsHashTable s_KeywordsHashTable = BuildKeywordsHashTable();
+	static_assert(s_KeywordsHashTable.m_IsValid, "Failed to build perfect hash for the keywords, try changing the buckets count.");
+
+	// *************************************************************** //
+	// **              SymbolTable class implementation.            ** //
+	// *************************************************************** //
+
+	CR_API SymbolTable::SymbolTable()
+		: m_Slots(1024, NullSymbol)
+	{
+		// Symbol zero is reserved for the null symbol.
+		m_Entries.push_back({ "", 0, 0 });
+	}
+
+	/**
+	 * Returns the process-wide symbol table.
+	 */
+	CR_API SymbolTable& SymbolTable::Global()
+	{
+		static SymbolTable s_Global;
+		return s_Global;
+	}
+
+	/**
+	 * Returns the symbol for the specified spelling, registering it on the first occurrence.
+	 */
+	CR_API Symbol SymbolTable::Intern(char const* const spelling, size_t const length)
+	{
+		auto const hash = Hash::Fnv1a(spelling, length);
+		auto const mask = m_Slots.size() - 1;
+		for (auto slot = hash & mask;; slot = (slot + 1) & mask)
+		{
+			auto const symbol = m_Slots[slot];
+			if (symbol == NullSymbol)
+			{
+				// Spelling is new, copying it into the arena.
+				auto const copy = static_cast<char*>(m_Arena.Allocate(length + 1, 1));
+				memcpy(copy, spelling, length);
+				copy[length] = '\0';
+
+				auto const newSymbol = static_cast<Symbol>(m_Entries.size());
+				m_Entries.push_back({ copy, static_cast<uint32_t>(length), hash });
+				m_Slots[slot] = newSymbol;
+				if (m_Entries.size() * 2 > m_Slots.size())
+				{
+					Rehash();
+				}
+				return newSymbol;
+			}
+			auto const& entry = m_Entries[symbol];
+			if (entry.m_Hash == hash && entry.m_Length == length && memcmp(entry.m_Spelling, spelling, length) == 0)
+			{
+				return symbol;
+			}
+		}
+	}
+
+	/**
+	 * Doubles the slots count and reinserts all symbols.
+	 */
+	CR_INTERNAL void SymbolTable::Rehash()
+	{
+		m_Slots.assign(m_Slots.size() * 2, NullSymbol);
+		auto const mask = m_Slots.size() - 1;
+		for (Symbol symbol = 1; symbol < m_Entries.size(); ++symbol)
+		{
+			auto slot = m_Entries[symbol].m_Hash & mask;
+			while (m_Slots[slot] != NullSymbol)
+			{
+				slot = (slot + 1) & mask;
+			}
+			m_Slots[slot] = symbol;
+		}
+	}
+
+	// *************************************************************** //
+	// **                Lexeme class implementation.               ** //
+	// *************************************************************** //
+
+	/**
+	 * Returns value of the integer constant, decoded from its spelling.
+	 */
+	CR_API int32_t Lexeme::GetValueInt() const
+	{
+		assert(m_Type == Type::CtInt || m_Type == Type::CtUInt);
+		auto const text = GetText();
+		return static_cast<int32_t>(NumericLiteral::DecodeInteger(text, text + m_Length));
+	}
+
+	/**
+	 * Returns value of the floating-point constant, decoded from its spelling.
+	 */
+	CR_API double Lexeme::GetValueReal() const
+	{
+		assert(m_Type == Type::CtFloat || m_Type == Type::CtDouble);
+		auto const text = GetText();
+		return NumericLiteral::DecodeReal(text, text + m_Length);
+	}
+
+	/**
+	 * Looks up the keyword with the specified spelling.
+	 * @returns Type of the keyword or identifier type if spelling is not a keyword.
+	 */
+	CR_API Lexeme::Type Lexeme::FindKeyword(char const* const spelling, size_t const length)
+	{
+		if (length <= s_KeywordsHashTable.m_MaxLength)
+		{
+			auto const hash = Hash::Fnv1a(spelling, length);
+			auto const displacements = s_KeywordsHashTable.m_Displacements[GetKeywordBucket(hash)];
+			auto const index = s_KeywordsHashTable.m_Slots[GetKeywordSlot(hash, displacements[0], displacements[1])];
+			if (index != 0)
+			{
+				auto const& keyword = s_Keywords[index - 1];
+				if (keyword.m_Length == length && memcmp(keyword.m_Spelling, spelling, length) == 0)
+				{
+					return keyword.m_Type;
+				}
+			}
+		}
+		return Type::IdIdentifier;
+	}
+
+	// *************************************************************** //
+	// **                 Lexeme class unit tests.                  ** //
+	// *************************************************************** //
+
+	CrUnitTest(SymbolTableInterning)
+	{
+		SymbolTable symbolTable;
+		auto const symbol = symbolTable.Intern("position");
+		CrAssert(symbol != NullSymbol);
+		CrAssert(symbolTable.Intern("position") == symbol);
+		CrAssert(symbolTable.Intern("pos", 3) != symbol);
+		CrAssert(strcmp(symbolTable.GetSpelling(symbol), "position") == 0);
+
+		// Growing the table past the initial slots count.
+		char spelling[16];
+		for (auto i = 0; i < 5000; ++i)
+		{
+			snprintf(spelling, sizeof(spelling), "id%d", i);
+			symbolTable.Intern(spelling);
+		}
+		CrAssert(symbolTable.Intern("position") == symbol);
+		CrAssert(strcmp(symbolTable.GetSpelling(symbolTable.Intern("id4999")), "id4999") == 0);
+	};
+
+	CrUnitTest(LexemeKeywordsPerfectHash)
+	{
+		for (auto const& keyword : s_Keywords)
+		{
+			CrAssert(Lexeme::FindKeyword(keyword.m_Spelling, keyword.m_Length) == keyword.m_Type);
+		}
+		CrAssert(Lexeme::FindKeyword("float4", 6) == Lexeme::Type::KwFloat4);
+		CrAssert(Lexeme::FindKeyword("float5", 6) == Lexeme::Type::IdIdentifier);
+		CrAssert(Lexeme::FindKeyword("i", 1) == Lexeme::Type::IdIdentifier);
+		CrAssert(Lexeme::FindKeyword("ifa", 3) == Lexeme::Type::IdIdentifier);
+		CrAssert(Lexeme::FindKeyword("textureRECTangle", 16) == Lexeme::Type::IdIdentifier);
 	};
 
 }	// namespace Cr
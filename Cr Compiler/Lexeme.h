@@ -12,10 +12,12 @@
 // $$***************************************************************$$ //
 
 #pragma once
-#include <memory>
-#include <string>
-#include <map>
+#include "Utils.h"
+#include "SourceManager.h"
+
 #include <cassert>
+#include <type_traits>
+#include <vector>
 
 #define CrTypeMaskCreate(m, n) ((m - 1 & 0xFF) << 24) | ((m - 1 & 0xFF) << 16)
 
@@ -47,11 +49,104 @@
 #define CrCaseTypeND(Type) \
 	Type##1D: case Type##2D: case Type##3D: case Type##CUBE \
 
+/**
+ * Substitutes keywords of all combination of scalar, vector and matrix types into the keywords list.
+ */
+#define CrKeywordMxN(CrKeyword, Type, spelling) \
+	CrKeyword(Type, spelling) \
+	CrKeyword(Type##1, spelling "1") CrKeyword(Type##1x1, spelling "1x1") CrKeyword(Type##1x2, spelling "1x2") CrKeyword(Type##1x3, spelling "1x3") CrKeyword(Type##1x4, spelling "1x4") \
+	CrKeyword(Type##2, spelling "2") CrKeyword(Type##2x1, spelling "2x1") CrKeyword(Type##2x2, spelling "2x2") CrKeyword(Type##2x3, spelling "2x3") CrKeyword(Type##2x4, spelling "2x4") \
+	CrKeyword(Type##3, spelling "3") CrKeyword(Type##3x1, spelling "3x1") CrKeyword(Type##3x2, spelling "3x2") CrKeyword(Type##3x3, spelling "3x3") CrKeyword(Type##3x4, spelling "3x4") \
+	CrKeyword(Type##4, spelling "4") CrKeyword(Type##4x1, spelling "4x1") CrKeyword(Type##4x2, spelling "4x2") CrKeyword(Type##4x3, spelling "4x3") CrKeyword(Type##4x4, spelling "4x4")
+
+/**
+ * List of all keywords of the language. Both Lexeme::Type enumeration and keywords hash table are generated from it.
+ * Order of the keywords defines values of the enumeration.
+ */
+#define CrKeywordsList(CrKeyword) \
+	CrKeyword(KwProgram, "program") \
+	CrKeyword(KwIf, "if") CrKeyword(KwElse, "else") CrKeyword(KwSwitch, "switch") CrKeyword(KwCase, "case") CrKeyword(KwDefault, "default") \
+	CrKeyword(KwWhile, "while") CrKeyword(KwDo, "do") CrKeyword(KwFor, "for") \
+	CrKeyword(KwBreak, "break") CrKeyword(KwContinue, "continue") CrKeyword(KwReturn, "return") CrKeyword(KwDiscard, "discard") \
+	CrKeyword(KwTypedef, "typedef") CrKeyword(KwStruct, "struct") \
+	CrKeyword(KwSampler1D, "sampler1D") CrKeyword(KwSampler2D, "sampler2D") CrKeyword(KwSampler3D, "sampler3D") CrKeyword(KwSamplerCUBE, "samplerCUBE") \
+	CrKeyword(KwTexture1D, "texture1D") CrKeyword(KwTexture2D, "texture2D") CrKeyword(KwTexture3D, "texture3D") CrKeyword(KwTextureCUBE, "textureCUBE") CrKeyword(KwTextureRECT, "textureRECT") \
+	CrKeyword(KwVoid, "void") \
+	CrKeywordMxN(CrKeyword, KwBool, "bool") CrKeywordMxN(CrKeyword, KwInt, "int") CrKeywordMxN(CrKeyword, KwUInt, "uint") \
+	CrKeywordMxN(CrKeyword, KwDword, "dword") CrKeywordMxN(CrKeyword, KwFloat, "float") CrKeywordMxN(CrKeyword, KwDouble, "double") \
+	CrKeyword(KwTrue, "true") CrKeyword(KwFalse, "false") \
+	\
+	/* Preprocessor keywords. 'if' and 'else' are shared with the language keywords. */ \
+	CrKeyword(KwPpDefine, "define") CrKeyword(KwPpUndef, "undef") CrKeyword(KwPpDefined, "defined") \
+	CrKeyword(KwPpIfdef, "ifdef") CrKeyword(KwPpIfndef, "ifndef") CrKeyword(KwPpElif, "elif") CrKeyword(KwPpEndif, "endif") \
+	CrKeyword(KwPpInclude, "include") CrKeyword(KwPpPragma, "pragma") CrKeyword(KwPpLine, "line") CrKeyword(KwPpError, "error")
+
 namespace Cr
 {
-	struct Identifier { std::string m_Value; Identifier(std::string const& s): m_Value(s) {} };
-	typedef Identifier* PIdentifier;
-	typedef std::map<std::string, std::unique_ptr<Identifier>> IdentifierTable;
+	/**
+	 * Interned identifier. Equal spellings always have equal symbols.
+	 */
+	typedef uint32_t Symbol;
+	static Symbol const NullSymbol = 0;
+
+	/**
+	 * Interns identifier spellings into the arena and hands out the stable symbols for them.
+	 * Spellings are stored null-terminated and live as long as the table.
+	 */
+	class SymbolTable final
+	{
+	private:
+		struct Entry
+		{
+			char const* m_Spelling;
+			uint32_t    m_Length;
+			uint32_t    m_Hash;
+		};	// struct Entry
+
+		Arena                 m_Arena;
+		std::vector<Entry>    m_Entries;
+		std::vector<Symbol>   m_Slots;
+
+	public:
+		SymbolTable(SymbolTable const&) = delete;
+		SymbolTable& operator= (SymbolTable const&) = delete;
+
+		CR_API SymbolTable();
+
+		/**
+		 * Returns the process-wide symbol table.
+		 * @warning Not thread-safe.
+		 */
+		CR_API static SymbolTable& Global();
+
+		/**
+		 * Returns the symbol for the specified spelling, registering it on the first occurrence.
+		 */
+		/// @{
+		CR_API Symbol Intern(char const* spelling, size_t length);
+		CRINL Symbol Intern(char const* const spelling)
+		{
+			return Intern(spelling, strlen(spelling));
+		}
+		/// @}
+
+		/**
+		 * Returns the null-terminated spelling of the specified symbol.
+		 */
+		CRINL char const* GetSpelling(Symbol const symbol) const
+		{
+			assert(symbol != NullSymbol && symbol < m_Entries.size());
+			return m_Entries[symbol].m_Spelling;
+		}
+		CRINL size_t GetLength(Symbol const symbol) const
+		{
+			assert(symbol != NullSymbol && symbol < m_Entries.size());
+			return m_Entries[symbol].m_Length;
+		}
+
+	private:
+		CR_INTERNAL void Rehash();
+	};	// class SymbolTable
 
 	/**
 	 * Represents a single lexem.
@@ -59,11 +154,11 @@ namespace Cr
 	class Lexeme final
 	{
 	public:
-		enum class Type
+		enum class Type : uint16_t
 		{
 			Null = 0, NewLine,
 			IdIdentifier,
-			CtInt, CtUInt, CtDword = CtUInt, CtFloat, CtDouble,
+			CtInt, CtUInt, CtDword = CtUInt, CtFloat, CtDouble, CtString,
 
 			// Keywords.
 			/*	<-- HLSL keywords that should be added.
@@ -100,24 +195,13 @@ namespace Cr
 			vertexshader*
 			volatile
 			*/
-		/**/	KwProgram,
-			
-			KwIf, KwElse, KwSwitch, KwCase, KwDefault,
-			KwWhile, KwDo, KwFor,
-			KwBreak, KwContinue, KwReturn, KwDiscard,
-			KwTypedef, KwStruct, 
-			KwSampler1D, KwSampler2D, KwSampler3D, KwSamplerCUBE, KwTexture1D, KwTexture2D, KwTexture3D, KwTextureCUBE, KwTextureRECT,
-			KwVoid, CrTypeMxN(KwBool), CrTypeMxN(KwInt), CrTypeMxN(KwUInt), CrTypeMxN(KwDword), CrTypeMxN(KwFloat), CrTypeMxN(KwDouble),
-			KwTrue, KwFalse,
-
-			// Preprocessor keywords.
-			KwPpDefine, KwPpUndef, KwPpDefined,
-			KwPpIf = static_cast<int>(KwIf), KwPpIfdef = static_cast<int>(KwPpDefined) + 1, KwPpIfndef, 
-			KwPpElse = static_cast<int>(KwElse), KwPpElif = static_cast<int>(KwPpIfndef) + 1, KwPpEndif,
-			KwPpPragma, KwPpLine, KwPpError,
+#define CrKeywordEnum(type, spelling) type,
+			CrKeywordsList(CrKeywordEnum)
+#undef CrKeywordEnum
+			KwPpIf = static_cast<int>(KwIf), KwPpElse = static_cast<int>(KwElse),
 
 			// Operators
-			OpAssignment, OpAdd, OpSubtract, OpMultiply, OpDivide, OpModulo, OpInc, OpDec,
+			OpAssignment = static_cast<int>(KwPpError) + 1, OpAdd, OpSubtract, OpMultiply, OpDivide, OpModulo, OpInc, OpDec,
 			OpEquals, OpNotEquals, OpGreater, OpLess, OpGreaterEquals, OpLessEquals,
 			OpNot, OpAnd, OpOr,
 			OpBitwiseNot, OpBitwiseAnd, OpBitwiseOr, OpBitwiseXor, OpBitwiseLeftShift, OpBitwiseRightShift,
@@ -126,17 +210,35 @@ namespace Cr
 			OpSemicolon, OpColon, OpComma, OpDot, OpTernary,
 			OpPreprocessor, OpPreprocessorConcat,
 
+			// Macro replacement lists, never leave the preprocessor.
+			PpArgument, PpArgumentUnexpanded, PpArgumentStringized,
+
 		}; // enum class Type
 
 	public:
-		static std::map<std::string, Type> const s_KeywordsTable;
+
+		/**
+		 * Looks up the keyword with the specified spelling.
+		 * @returns Type of the keyword or identifier type if spelling is not a keyword.
+		 */
+		CR_API static Type FindKeyword(char const* spelling, size_t length);
+
+		/**
+		 * Layout flags of the lexeme.
+		 */
+		enum Flags : uint16_t
+		{
+			FlagsNone         = 0,
+			FlagsStartOfLine  = 1 << 0,	///< Lexeme is the first one on its line.
+			FlagsLeadingSpace = 1 << 1,	///< Lexeme is preceded by whitespace or comment.
+		};	// enum Flags
 
 	private:
-		Type        m_Type = Type::Null;
-		uint32_t     m_ValueInt = 0;
-		std::string m_ValueString;
-		double      m_ValueReal = 0.0;
-		PIdentifier m_ValueID = nullptr;
+		Type         m_Type;
+		uint16_t     m_Flags;
+		uint32_t     m_Value;	///< Symbol of the identifier or index of the macro parameter. Constants are decoded from their spelling.
+		SourceOffset m_Offset;
+		uint32_t     m_Length;
 
 	public:
 
@@ -145,26 +247,22 @@ namespace Cr
 		 * @param type The type of lexem.
 		 */
 		explicit Lexeme(Type const type = Type::Null)
-			: m_Type(type)
+			: m_Type(type), m_Flags(FlagsNone), m_Value(0), m_Offset(NullSourceOffset), m_Length(0)
 		{
 			assert(type <= Type::NewLine || type >= Type::KwProgram);
 		}
 
 		/**
-		 * Initializes a constant lexeme.
-		 * @param value The value of lexem.
+		 * Initializes a lexeme that was scanned from the source.
+		 * @param type The type of lexem.
+		 * @param value Value of the integer constant or symbol of the identifier.
+		 * @param offset Location of the first character of the lexeme.
+		 * @param length Length of the lexeme spelling.
+		 * @param flags Layout flags of the lexeme.
 		 */
-		/// @{
-		explicit Lexeme(Type const type, uint32_t const value)
-			: m_Type(type), m_ValueInt(value)
-		{}
-		explicit Lexeme(Type const type, double const value)
-			: m_Type(type), m_ValueReal(value)
-		{}
-		explicit Lexeme(PIdentifier const& value)
-			: m_Type(Type::IdIdentifier), m_ValueID(value)
+		explicit Lexeme(Type const type, uint32_t const value, SourceOffset const offset, uint32_t const length, uint16_t const flags = FlagsNone)
+			: m_Type(type), m_Flags(flags), m_Value(value), m_Offset(offset), m_Length(length)
 		{}
-		/// @}
 
 		/**
 		 * Returns type of this lexeme.
@@ -184,26 +282,63 @@ namespace Cr
 		}
 
 		/**
-		 * Returns value of this lexeme.
+		 * Returns or changes layout flags of this lexeme.
 		 */
 		/// @{
-		int32_t GetValueInt() const
+		uint16_t GetFlags() const
 		{
-			assert(m_Type == Type::CtInt);
-			return m_ValueInt;
+			return m_Flags;
 		}
-		double GetValueReal() const
+		bool HasFlags(uint16_t const flags) const
 		{
-			assert(m_Type == Type::CtDouble);
-			return m_ValueReal;
+			return (m_Flags & flags) == flags;
 		}
-		std::string const& GetValueID() const
+		void SetFlags(uint16_t const flags)
+		{
+			m_Flags = flags;
+		}
+		/// @}
+
+		/**
+		 * Returns location and spelling of this lexeme in the source.
+		 */
+		/// @{
+		SourceOffset GetOffset() const
+		{
+			return m_Offset;
+		}
+		uint32_t GetLength() const
+		{
+			return m_Length;
+		}
+		char const* GetText() const
+		{
+			assert(m_Offset != NullSourceOffset);
+			return SourceManager::Global().GetText(m_Offset);
+		}
+		/// @}
+
+		/**
+		 * Returns value of this lexeme.
+		 */
+		/// @{
+		CR_API int32_t GetValueInt() const;
+		CR_API double GetValueReal() const;
+		Symbol GetValueID() const
 		{
 			assert(m_Type == Type::IdIdentifier);
-			return m_ValueID->m_Value;
+			return m_Value;
+		}
+		uint32_t GetValueArgument() const
+		{
+			assert(m_Type == Type::PpArgument || m_Type == Type::PpArgumentUnexpanded || m_Type == Type::PpArgumentStringized);
+			return m_Value;
 		}
 		/// @}
 
 	};	// class Lexeme final
 
+	static_assert(sizeof(Lexeme) == 16, "Lexeme should be kept compact.");
+	static_assert(std::is_trivially_copyable<Lexeme>::value, "Lexeme should be trivially copyable.");
+
 }	// namespace Cr
@@ -0,0 +1,213 @@
+// $$***************************************************************$$ //
+//                                                                     //
+//                  Goddamn "C for Rendering" project                  //
+//     Copyright (C) Goddamn Industries 2016. All Rights Reserved.     //
+//          ( https://github.com/GoddamnIndustries/GoddamnCr )         //
+//                                                                     //
+//    This software or any its part is distributed under the terms of  //
+//   Goddamn Industries End User License Agreement. By downloading or  //
+//   using this software or any its part you agree with the terms of   //
+//   Goddamn Industries End User License Agreement.                    //
+//                                                                     //
+// $$***************************************************************$$ //
+
+#include "NumericLiteral.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace Cr
+{
+	namespace NumericLiteral
+	{
+		CRINL static bool IsDigit(char const c)
+		{
+			return c >= '0' && c <= '9';
+		}
+
+		// *************************************************************** //
+		// **                     Integer literals.                     ** //
+		// *************************************************************** //
+
+		/**
+		 * Decodes decimal, octal ('0' prefix) or hexadecimal ('0x' prefix) integer literal.
+		 */
+		CR_API uint64_t DecodeInteger(char const* cursor, char const* const end)
+		{
+			uint64_t value = 0;
+			if (end - cursor > 2 && cursor[0] == '0' && (cursor[1] == 'x' || cursor[1] == 'X'))
+			{
+				for (cursor += 2; cursor != end; ++cursor)
+				{
+					auto const c = *cursor;
+					if (IsDigit(c))
+					{
+						value = value * 0x10 + (c - '0');
+					}
+					else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f')
+					{
+						value = value * 0x10 + ((c | 0x20) - 'a' + 10);
+					}
+					else if (c != '\'')
+					{
+						break;
+					}
+				}
+				return value;
+			}
+
+			auto const base = *cursor == '0' ? 010 : 10;
+			for (; cursor != end; ++cursor)
+			{
+				auto const c = *cursor;
+				if (IsDigit(c))
+				{
+					value = value * base + (c - '0');
+				}
+				else if (c != '\'')
+				{
+					break;
+				}
+			}
+			return value;
+		}
+
+		// *************************************************************** //
+		// **                  Floating-point literals.                 ** //
+		// *************************************************************** //
+
+		/**
+		 * Decodes floating-point literal with the optional exponent part.
+		 *
+		 * Literals with up to 19 significant digits whose mantissa is exactly representable in the double and whose
+		 * decimal exponent is small are decoded with a single exact multiplication or division (Clinger's fast path).
+		 * Other literals are normalized into "<digits>e<exponent>" form, which does not depend on the locale, and passed
+		 * to the correctly rounding 'strtod'.
+		 */
+		CR_API double DecodeReal(char const* cursor, char const* const end)
+		{
+			static double const s_ExactPowersOf10[] = {
+				1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+				1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+			};
+
+			// Collecting significant digits, leading zeros are skipped.
+			auto const begin = cursor;
+			uint64_t mantissa = 0;
+			auto digitsCount = 0, droppedDigitsCount = 0, exponent = 0;
+			auto isFractionPart = false;
+			for (; cursor != end; ++cursor)
+			{
+				auto const c = *cursor;
+				if (c == '.')
+				{
+					isFractionPart = true;
+				}
+				else if (IsDigit(c))
+				{
+					if (digitsCount == 0 && c == '0')
+					{
+						exponent -= isFractionPart;
+					}
+					else if (digitsCount < 19)
+					{
+						mantissa = mantissa * 10 + (c - '0');
+						exponent -= isFractionPart;
+						++digitsCount;
+					}
+					else
+					{
+						exponent += !isFractionPart;
+						droppedDigitsCount += c != '0';
+					}
+				}
+				else if (c != '\'')
+				{
+					break;
+				}
+			}
+
+			// Parsing the exponent part.
+			if (cursor != end && (*cursor == 'e' || *cursor == 'E'))
+			{
+				++cursor;
+				auto const isNegative = cursor != end && *cursor == '-';
+				if (cursor != end && (*cursor == '-' || *cursor == '+'))
+				{
+					++cursor;
+				}
+				auto exponentPart = 0;
+				for (; cursor != end && IsDigit(*cursor); ++cursor)
+				{
+					if (exponentPart < 100000)
+					{
+						exponentPart = exponentPart * 10 + (*cursor - '0');
+					}
+				}
+				exponent += isNegative ? -exponentPart : exponentPart;
+			}
+
+			if (mantissa == 0 && droppedDigitsCount == 0)
+			{
+				return 0.0;
+			}
+			if (droppedDigitsCount == 0 && mantissa <= (1ull << 53) && exponent >= -22 && exponent <= 22)
+			{
+				// Both the mantissa and the power of 10 are exact, the only rounding happens in the operation.
+				auto const value = static_cast<double>(mantissa);
+				return exponent < 0 ? value / s_ExactPowersOf10[-exponent] : value * s_ExactPowersOf10[exponent];
+			}
+
+			// Slow path: normalizing the literal and passing it to the standard library.
+			char buffer[512];
+			size_t length = 0;
+			auto digitsWritten = 0;
+			for (auto c = begin; c != cursor && length < sizeof(buffer) - 16; ++c)
+			{
+				if (*c == 'e' || *c == 'E')
+				{
+					break;
+				}
+				if (IsDigit(*c) && (length != 0 || *c != '0'))
+				{
+					buffer[length++] = *c;
+					++digitsWritten;
+				}
+			}
+			// Exponent was computed relatively to the first 19 digits, adjusting it to the digits written.
+			snprintf(buffer + length, sizeof(buffer) - length, "e%d", exponent - (digitsWritten - digitsCount));
+			return strtod(buffer, nullptr);
+		}
+
+		// *************************************************************** //
+		// **                      Unit tests.                          ** //
+		// *************************************************************** //
+
+		CrUnitTest(NumericLiteralIntegers)
+		{
+			char const* const literals[] = { "1'000", "017", "0x1F", "0XfFu", "42u", "0" };
+			uint64_t const values[] = { 1000, 15, 31, 255, 42, 0 };
+			for (auto i = 0; i < 6; ++i)
+			{
+				CrAssert(DecodeInteger(literals[i], literals[i] + strlen(literals[i])) == values[i]);
+			}
+		};
+
+		CrUnitTest(NumericLiteralReals)
+		{
+			char const* const literals[] = {
+				"1.2003", ".5", "0.1", "2.5f", "1e3", "1.5e-3", "0.000001", "123456789012345678901234.0",
+				"1.7976931348623157e308", "4.9e-324", "0.30000000000000004", "9007199254740993.0", "1'000.5h",
+			};
+			double const values[] = {
+				1.2003, .5, 0.1, 2.5, 1e3, 1.5e-3, 0.000001, 123456789012345678901234.0,
+				1.7976931348623157e308, 4.9e-324, 0.30000000000000004, 9007199254740993.0, 1000.5,
+			};
+			for (auto i = 0; i < 13; ++i)
+			{
+				CrAssert(DecodeReal(literals[i], literals[i] + strlen(literals[i])) == values[i]);
+			}
+		};
+
+	}	// namespace NumericLiteral
+}	// namespace Cr
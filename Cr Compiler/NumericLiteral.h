@@ -0,0 +1,38 @@
+// $$***************************************************************$$ //
+//                                                                     //
+//                  Goddamn "C for Rendering" project                  //
+//     Copyright (C) Goddamn Industries 2016. All Rights Reserved.     //
+//          ( https://github.com/GoddamnIndustries/GoddamnCr )         //
+//                                                                     //
+//    This software or any its part is distributed under the terms of  //
+//   Goddamn Industries End User License Agreement. By downloading or  //
+//   using this software or any its part you agree with the terms of   //
+//   Goddamn Industries End User License Agreement.                    //
+//                                                                     //
+// $$***************************************************************$$ //
+
+#pragma once
+#include "Utils.h"
+
+namespace Cr
+{
+	/**
+	 * Decoding of the numeric literals from their spellings.
+	 * Scanner only classifies the literals, values are decoded when they are requested.
+	 */
+	namespace NumericLiteral
+	{
+		/**
+		 * Decodes decimal, octal ('0' prefix) or hexadecimal ('0x' prefix) integer literal.
+		 * Digit separators and suffixes are ignored, value wraps around on overflow.
+		 */
+		CR_API uint64_t DecodeInteger(char const* begin, char const* end);
+
+		/**
+		 * Decodes floating-point literal with the optional exponent part. Digit separators and suffixes are ignored.
+		 * @returns Correctly rounded value of the literal.
+		 */
+		CR_API double DecodeReal(char const* begin, char const* end);
+
+	}	// namespace NumericLiteral
+}	// namespace Cr
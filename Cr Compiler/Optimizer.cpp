@@ -0,0 +1,678 @@
+// $$***************************************************************$$ //
+//                                                                     //
+//                  Goddamn "C for Rendering" project                  //
+//     Copyright (C) Goddamn Industries 2016. All Rights Reserved.     //
+//          ( https://github.com/GoddamnIndustries/GoddamnCr )         //
+//                                                                     //
+//    This software or any its part is distributed under the terms of  //
+//   Goddamn Industries End User License Agreement. By downloading or  //
+//   using this software or any its part you agree with the terms of   //
+//   Goddamn Industries End User License Agreement.                    //
+//                                                                     //
+// $$***************************************************************$$ //
+
+
+#include "Optimizer.h"
+#include "Parser.h"
+
+namespace Cr
+{
+	// *************************************************************** //
+	// **               Optimizer class implementation.             ** //
+	// *************************************************************** //
+
+	/**
+	 * Optimizes the program.
+	 * @param program Compound node with the statements of the program.
+	 * @returns Optimized program or null identifier if nothing is left.
+	 */
+	CR_API FlatAst::NodeId Optimizer::Run(NodeId program)
+	{
+		m_Variables.assign(m_Ast.m_Variables.size(), VariableInfo());
+		if (program.GetKind() == NodeKind::Compound)
+		{
+			auto const& list = m_Ast.m_Compounds[program.GetIndex()];
+			for (uint32_t i = 0; i < list.m_Count; ++i)
+			{
+				auto const stmt = m_Ast.GetList(list)[i];
+				CollectVariables(stmt, stmt.GetKind() != NodeKind::Declaration);
+			}
+		}
+		else
+		{
+			CollectVariables(program, false);
+		}
+
+		program = OptimizeStatement(program);
+		while (!program.IsNull())
+		{
+			// Removing the variables may leave their initializers without uses, so this is repeated until
+			// nothing is removed.
+			for (auto& variable : m_Variables)
+			{
+				variable.m_ReadsCount = variable.m_WritesCount = variable.m_StatementWritesCount = 0;
+			}
+			CountVariableUses(program);
+			if (!RemoveUnusedVariables(program))
+			{
+				break;
+			}
+			program = OptimizeStatement(program);
+		}
+		return program;
+	}
+
+	// *************************************************************** //
+	CR_INTERNAL void Optimizer::CollectVariables(NodeId const node, bool const isLocal)
+	{
+		auto const index = node.GetIndex();
+		switch (node.GetKind())
+		{
+			case NodeKind::Variable:
+				m_Variables[index].m_IsLocal = isLocal;
+				break;
+			case NodeKind::Assignment:
+				{
+					auto lhs = m_Ast.m_Binaries[index].m_Lhs;
+					while (lhs.GetKind() == NodeKind::Subscript)
+					{
+						lhs = m_Ast.m_Subscripts[lhs.GetIndex()].m_Expr;
+					}
+					if (lhs.GetKind() == NodeKind::Identifier)
+					{
+						m_Variables[lhs.GetIndex()].m_IsAssigned = true;
+					}
+				}
+				break;
+			default:
+				break;
+		}
+
+		// Everything, except the variables of the global declarations, is local.
+		auto const isChildLocal = isLocal || node.GetKind() != NodeKind::Declaration;
+		m_Ast.ForEachChild(node, [this, isChildLocal](NodeId const child)
+		{
+			CollectVariables(child, isChildLocal);
+		});
+	}
+
+	// *************************************************************** //
+	CR_INTERNAL void Optimizer::CountVariableUses(NodeId const node)
+	{
+		auto const index = node.GetIndex();
+		switch (node.GetKind())
+		{
+			case NodeKind::Identifier:
+				++m_Variables[index].m_ReadsCount;
+				return;
+			case NodeKind::Expression:
+				{
+					auto const expr = m_Ast.m_ExpressionStatements[index];
+					if (expr.GetKind() == NodeKind::Assignment)
+					{
+						auto const lhs = m_Ast.m_Binaries[expr.GetIndex()].m_Lhs;
+						if (lhs.GetKind() == NodeKind::Identifier)
+						{
+							++m_Variables[lhs.GetIndex()].m_StatementWritesCount;
+						}
+					}
+				}
+				break;
+			case NodeKind::Assignment:
+				{
+					// Variable, that is only assigned, is never read, even by the compound assignments.
+					auto const& binaryNode = m_Ast.m_Binaries[index];
+					if (binaryNode.m_Lhs.GetKind() == NodeKind::Identifier)
+					{
+						++m_Variables[binaryNode.m_Lhs.GetIndex()].m_WritesCount;
+						CountVariableUses(binaryNode.m_Rhs);
+						return;
+					}
+				}
+				break;
+			default:
+				break;
+		}
+		m_Ast.ForEachChild(node, [this](NodeId const child)
+		{
+			CountVariableUses(child);
+		});
+	}
+
+	// *************************************************************** //
+	CR_INTERNAL bool Optimizer::RemoveUnusedVariables(NodeId const node)
+	{
+		auto const isUnused = [this](uint32_t const variableIndex)
+		{
+			auto const& variable = m_Variables[variableIndex];
+			return variable.m_IsLocal && variable.m_ReadsCount == 0 
+				&& variable.m_WritesCount == variable.m_StatementWritesCount;
+		};
+
+		auto const index = node.GetIndex();
+		switch (node.GetKind())
+		{
+			case NodeKind::Declaration:
+				{
+					auto& list = m_Ast.m_Declarations[index];
+					auto const variables = m_Ast.GetList(list);
+					uint32_t count = 0;
+					for (uint32_t i = 0; i < list.m_Count; ++i)
+					{
+						auto const variableIndex = variables[i].GetIndex();
+						if (!isUnused(variableIndex) || HasSideEffects(m_Ast.m_Variables[variableIndex].m_InitExpr))
+						{
+							variables[count++] = variables[i];
+						}
+					}
+					auto const isChanged = count != list.m_Count;
+					list.m_Count = count;
+					return isChanged;
+				}
+			case NodeKind::Expression:
+				{
+					// Assignment to the unused variable is replaced with its right side. If it has no side effects,
+					// statement is removed on the next optimization.
+					auto& expr = m_Ast.m_ExpressionStatements[index];
+					if (expr.GetKind() == NodeKind::Assignment)
+					{
+						auto const& binaryNode = m_Ast.m_Binaries[expr.GetIndex()];
+						if (binaryNode.m_Lhs.GetKind() == NodeKind::Identifier && isUnused(binaryNode.m_Lhs.GetIndex()))
+						{
+							expr = binaryNode.m_Rhs;
+							return true;
+						}
+					}
+				}
+				return false;
+			case NodeKind::Compound: case NodeKind::If: case NodeKind::Switch:
+			case NodeKind::While: case NodeKind::DoWhile: case NodeKind::For:
+				{
+					auto isChanged = false;
+					m_Ast.ForEachChild(node, [this, &isChanged](NodeId const child)
+					{
+						isChanged |= RemoveUnusedVariables(child);
+					});
+					return isChanged;
+				}
+			default:
+				return false;
+		}
+	}
+
+	/**
+	 * Returns true if the statement may replace its parent statement.
+	 * Declaration may not: it would be moved into the enclosing scope and shadow or redeclare its variables.
+	 */
+	CRINL static bool CanReplaceParent(FlatAst::NodeId const stmt)
+	{
+		return stmt.GetKind() != FlatAst::NodeKind::Declaration;
+	}
+
+	// *************************************************************** //
+	CR_INTERNAL FlatAst::NodeId Optimizer::OptimizeStatement(NodeId const stmt)
+	{
+		auto const index = stmt.GetIndex();
+		switch (stmt.GetKind())
+		{
+			case NodeKind::Compound:
+				{
+					// Statements, that follow the jump statement, are unreachable.
+					auto const list = m_Ast.m_Compounds[index];
+					auto const stmts = m_Ast.GetList(list);
+					uint32_t count = 0;
+					for (uint32_t i = 0; i < list.m_Count; ++i)
+					{
+						auto const innerStmt = OptimizeStatement(stmts[i]);
+						if (!innerStmt.IsNull())
+						{
+							stmts[count++] = innerStmt;
+							if (AlwaysJumps(innerStmt))
+							{
+								break;
+							}
+						}
+					}
+					m_Ast.m_Compounds[index].m_Count = count;
+					switch (count)
+					{
+						case 0:  return NodeId();
+						case 1:  return CanReplaceParent(stmts[0]) ? stmts[0] : stmt;
+						default: return stmt;
+					}
+				}
+
+			case NodeKind::If:
+				{
+					auto& ifNode = m_Ast.m_Ifs[index];
+					ifNode.m_CondExpr = OptimizeExpression(ifNode.m_CondExpr);
+					if (IsConstant(ifNode.m_CondExpr))
+					{
+						auto const isTrue = m_Ast.m_Constants[ifNode.m_CondExpr.GetIndex()].m_Value.To<bool>();
+						auto const branchStmt = OptimizeStatement(isTrue ? ifNode.m_ThenStmt : ifNode.m_ElseStmt);
+						if (CanReplaceParent(branchStmt))
+						{
+							return branchStmt;
+						}
+						// Declaration stays in the scope of its branch, the other branch is dropped.
+						ifNode.m_ThenStmt = isTrue ? branchStmt : NodeId();
+						ifNode.m_ElseStmt = isTrue ? NodeId() : branchStmt;
+						return stmt;
+					}
+					ifNode.m_ThenStmt = OptimizeStatement(ifNode.m_ThenStmt);
+					ifNode.m_ElseStmt = OptimizeStatement(ifNode.m_ElseStmt);
+					if (ifNode.m_ThenStmt.IsNull() && ifNode.m_ElseStmt.IsNull() && !HasSideEffects(ifNode.m_CondExpr))
+					{
+						return NodeId();
+					}
+					return stmt;
+				}
+
+			case NodeKind::Switch:
+				{
+					auto& switchNode = m_Ast.m_Switches[index];
+					switchNode.m_SelectionExpr = OptimizeExpression(switchNode.m_SelectionExpr);
+					for (uint32_t i = 0; i < switchNode.m_Sections.m_Count; ++i)
+					{
+						// Labels reference sections by identifiers, so they are updated too.
+						auto& section = m_Ast.GetList(switchNode.m_Sections)[i];
+						auto const optimizedSection = OptimizeStatement(section);
+						for (uint32_t j = 0; j < switchNode.m_CasesCount; ++j)
+						{
+							auto& caseNode = m_Ast.m_SwitchCases[switchNode.m_FirstCase + j];
+							if (caseNode.m_Section == section)
+							{
+								caseNode.m_Section = optimizedSection;
+							}
+						}
+						if (switchNode.m_DefaultSection == section)
+						{
+							switchNode.m_DefaultSection = optimizedSection;
+						}
+						section = optimizedSection;
+					}
+					if (!IsConstant(switchNode.m_SelectionExpr))
+					{
+						return stmt;
+					}
+
+					auto const value = m_Ast.m_Constants[switchNode.m_SelectionExpr.GetIndex()].m_Value.To<int64_t>();
+					auto section = switchNode.m_DefaultSection;
+					for (uint32_t i = 0; i < switchNode.m_CasesCount; ++i)
+					{
+						auto const& caseNode = m_Ast.m_SwitchCases[switchNode.m_FirstCase + i];
+						if (caseNode.m_Value == value)
+						{
+							section = caseNode.m_Section;
+							break;
+						}
+					}
+					if (section.IsNull() || section.GetKind() == NodeKind::Break)
+					{
+						return NodeId();
+					}
+
+					// Switch is replaced with the selected section, if its only 'break' is the last statement.
+					if (section.GetKind() == NodeKind::Compound)
+					{
+						auto& sectionList = m_Ast.m_Compounds[section.GetIndex()];
+						auto const sectionStmts = m_Ast.GetList(sectionList);
+						if (sectionStmts[sectionList.m_Count - 1].GetKind() == NodeKind::Break)
+						{
+							for (uint32_t i = 0; i < sectionList.m_Count - 1; ++i)
+							{
+								if (ContainsJump(sectionStmts[i], NodeKind::Break))
+								{
+									return stmt;
+								}
+							}
+							--sectionList.m_Count;
+							return OptimizeStatement(section);
+						}
+					}
+					return ContainsJump(section, NodeKind::Break) || !CanReplaceParent(section) ? stmt : section;
+				}
+
+			case NodeKind::While: case NodeKind::DoWhile: case NodeKind::For:
+				{
+					auto& loopNode = m_Ast.m_Loops[index];
+					loopNode.m_InitStmt = OptimizeStatement(loopNode.m_InitStmt);
+					loopNode.m_CondExpr = OptimizeExpression(loopNode.m_CondExpr);
+					loopNode.m_StepExpr = OptimizeExpression(loopNode.m_StepExpr);
+					loopNode.m_LoopStmt = OptimizeStatement(loopNode.m_LoopStmt);
+					if (IsConstant(loopNode.m_CondExpr) && !m_Ast.m_Constants[loopNode.m_CondExpr.GetIndex()].m_Value.To<bool>())
+					{
+						if (stmt.GetKind() != NodeKind::DoWhile)
+						{
+							// Variables of the 'for' loop initializer are visible inside the loop only.
+							return CanReplaceParent(loopNode.m_InitStmt) ? loopNode.m_InitStmt : stmt;
+						}
+						// Body of the 'do-while' loop is executed once, unless it jumps out of the loop.
+						if (!ContainsJump(loopNode.m_LoopStmt, NodeKind::Break) && !ContainsJump(loopNode.m_LoopStmt, NodeKind::Continue)
+							&& CanReplaceParent(loopNode.m_LoopStmt))
+						{
+							return loopNode.m_LoopStmt;
+						}
+					}
+					return stmt;
+				}
+
+			case NodeKind::Return:
+				m_Ast.m_ExpressionStatements[index] = OptimizeExpression(m_Ast.m_ExpressionStatements[index]);
+				return stmt;
+			case NodeKind::Expression:
+				{
+					auto& expr = m_Ast.m_ExpressionStatements[index];
+					expr = OptimizeExpression(expr);
+					return HasSideEffects(expr) ? stmt : NodeId();
+				}
+
+			case NodeKind::Declaration:
+				{
+					auto const& list = m_Ast.m_Declarations[index];
+					if (list.m_Count == 0)
+					{
+						return NodeId();
+					}
+					for (uint32_t i = 0; i < list.m_Count; ++i)
+					{
+						auto const variableIndex = m_Ast.GetList(list)[i].GetIndex();
+						auto& variableNode = m_Ast.m_Variables[variableIndex];
+						variableNode.m_InitExpr = OptimizeExpression(variableNode.m_InitExpr);
+
+						// Local variable, that is never assigned, keeps the value of its constant initializer.
+						auto& variable = m_Variables[variableIndex];
+						if (variable.m_Value.IsNull() && variable.m_IsLocal && !variable.m_IsAssigned 
+							&& IsConstant(variableNode.m_InitExpr) && !variableNode.m_Type.IsStruct())
+						{
+							auto const value = m_Ast.m_Constants[variableNode.m_InitExpr.GetIndex()].m_Value;
+							variable.m_Value = m_Ast.AddConstant(value, variableNode.m_Type);
+						}
+					}
+					return stmt;
+				}
+
+			default:
+				return stmt;
+		}
+	}
+
+	// *************************************************************** //
+	CR_INTERNAL FlatAst::NodeId Optimizer::OptimizeExpression(NodeId const expr)
+	{
+		auto const index = expr.GetIndex();
+		switch (expr.GetKind())
+		{
+			case NodeKind::Identifier:
+				{
+					auto const value = m_Variables[index].m_Value;
+					return value.IsNull() ? expr : value;
+				}
+			case NodeKind::Subscript:
+				m_Ast.m_Subscripts[index].m_Expr = OptimizeExpression(m_Ast.m_Subscripts[index].m_Expr);
+				return expr;
+
+			case NodeKind::Unary: case NodeKind::Cast:
+				m_Ast.m_Unaries[index].m_Expr = OptimizeExpression(m_Ast.m_Unaries[index].m_Expr);
+				return FoldExpression(expr);
+			case NodeKind::Binary: case NodeKind::Comma:
+				{
+					auto& binaryNode = m_Ast.m_Binaries[index];
+					binaryNode.m_Lhs = OptimizeExpression(binaryNode.m_Lhs);
+					binaryNode.m_Rhs = OptimizeExpression(binaryNode.m_Rhs);
+					if (expr.GetKind() == NodeKind::Comma)
+					{
+						return HasSideEffects(binaryNode.m_Lhs) ? expr : binaryNode.m_Rhs;
+					}
+					return FoldExpression(expr);
+				}
+			case NodeKind::Assignment:
+				m_Ast.m_Binaries[index].m_Rhs = OptimizeExpression(m_Ast.m_Binaries[index].m_Rhs);
+				return expr;
+
+			case NodeKind::Ternary:
+				{
+					auto& ternaryNode = m_Ast.m_Ternaries[index];
+					ternaryNode.m_CondExpr = OptimizeExpression(ternaryNode.m_CondExpr);
+					ternaryNode.m_ThenExpr = OptimizeExpression(ternaryNode.m_ThenExpr);
+					ternaryNode.m_ElseExpr = OptimizeExpression(ternaryNode.m_ElseExpr);
+					if (!IsConstant(ternaryNode.m_CondExpr))
+					{
+						return expr;
+					}
+
+					// Both branches are evaluated, so the other one should have no side effects.
+					auto const isTrue = m_Ast.m_Constants[ternaryNode.m_CondExpr.GetIndex()].m_Value.To<bool>();
+					auto const selectedExpr = isTrue ? ternaryNode.m_ThenExpr : ternaryNode.m_ElseExpr;
+					auto const otherExpr = isTrue ? ternaryNode.m_ElseExpr : ternaryNode.m_ThenExpr;
+					if (HasSideEffects(otherExpr))
+					{
+						return expr;
+					}
+					if (IsConstant(selectedExpr))
+					{
+						auto const value = m_Ast.m_Constants[selectedExpr.GetIndex()].m_Value;
+						return m_Ast.AddConstant(value, ternaryNode.m_Type);
+					}
+					return m_Ast.GetType(selectedExpr) == ternaryNode.m_Type ? selectedExpr : expr;
+				}
+
+			default:
+				return expr;
+		}
+	}
+
+	// *************************************************************** //
+	CR_INTERNAL FlatAst::NodeId Optimizer::FoldExpression(NodeId const expr)
+	{
+		auto const index = expr.GetIndex();
+		try
+		{
+			switch (expr.GetKind())
+			{
+				case NodeKind::Unary: case NodeKind::Cast:
+					{
+						auto const& unaryNode = m_Ast.m_Unaries[index];
+						if (!IsConstant(unaryNode.m_Expr) || unaryNode.m_Type.IsStruct())
+						{
+							return expr;
+						}
+						auto const& value = m_Ast.m_Constants[unaryNode.m_Expr.GetIndex()].m_Value;
+						auto const result = expr.GetKind() == NodeKind::Cast ? value : value.Apply(unaryNode.m_Op);
+						return m_Ast.AddConstant(result, unaryNode.m_Type);
+					}
+				case NodeKind::Binary:
+					{
+						auto const& binaryNode = m_Ast.m_Binaries[index];
+						if (!IsConstant(binaryNode.m_Lhs) || !IsConstant(binaryNode.m_Rhs))
+						{
+							return expr;
+						}
+						auto const& lhsValue = m_Ast.m_Constants[binaryNode.m_Lhs.GetIndex()].m_Value;
+						auto const& rhsValue = m_Ast.m_Constants[binaryNode.m_Rhs.GetIndex()].m_Value;
+						auto const result = lhsValue.Apply(binaryNode.m_Op, rhsValue);
+						return m_Ast.AddConstant(result, binaryNode.m_Type);
+					}
+				default:
+					return expr;
+			}
+		}
+		catch (ParserException const&)
+		{
+			// Errors, like the division by zero, are left for the runtime.
+			return expr;
+		}
+	}
+
+	// *************************************************************** //
+	CR_INTERNAL bool Optimizer::IsConstant(NodeId const expr) const
+	{
+		return expr.GetKind() == NodeKind::Constant;
+	}
+
+	// *************************************************************** //
+	CR_INTERNAL bool Optimizer::HasSideEffects(NodeId const expr) const
+	{
+		if (expr.GetKind() == NodeKind::Assignment)
+		{
+			return true;
+		}
+		auto hasSideEffects = false;
+		m_Ast.ForEachChild(expr, [this, &hasSideEffects](NodeId const child)
+		{
+			hasSideEffects = hasSideEffects || HasSideEffects(child);
+		});
+		return hasSideEffects;
+	}
+
+	// *************************************************************** //
+	CR_INTERNAL bool Optimizer::AlwaysJumps(NodeId const stmt) const
+	{
+		auto const index = stmt.GetIndex();
+		switch (stmt.GetKind())
+		{
+			case NodeKind::Break: case NodeKind::Continue: case NodeKind::Discard: case NodeKind::Return:
+				return true;
+			case NodeKind::Compound:
+				{
+					auto const& list = m_Ast.m_Compounds[index];
+					for (uint32_t i = 0; i < list.m_Count; ++i)
+					{
+						if (AlwaysJumps(m_Ast.GetList(list)[i]))
+						{
+							return true;
+						}
+					}
+					return false;
+				}
+			case NodeKind::If:
+				{
+					auto const& ifNode = m_Ast.m_Ifs[index];
+					return !ifNode.m_ThenStmt.IsNull() && !ifNode.m_ElseStmt.IsNull() 
+						&& AlwaysJumps(ifNode.m_ThenStmt) && AlwaysJumps(ifNode.m_ElseStmt);
+				}
+			default:
+				return false;
+		}
+	}
+
+	// *************************************************************** //
+	CR_INTERNAL bool Optimizer::ContainsJump(NodeId const stmt, NodeKind const jumpKind) const
+	{
+		switch (stmt.GetKind())
+		{
+			case NodeKind::Compound: case NodeKind::If: case NodeKind::Switch:
+				{
+					if (stmt.GetKind() == NodeKind::Switch && jumpKind == NodeKind::Break)
+					{
+						// Breaks inside the nested switch statement break it.
+						return false;
+					}
+					auto containsJump = false;
+					m_Ast.ForEachChild(stmt, [this, jumpKind, &containsJump](NodeId const child)
+					{
+						containsJump = containsJump || ContainsJump(child, jumpKind);
+					});
+					return containsJump;
+				}
+			default:
+				// Jumps inside the nested loops jump to them.
+				return stmt.GetKind() == jumpKind;
+		}
+	}
+
+	// *************************************************************** //
+	// **                  Optimizer class unit tests.              ** //
+	// *************************************************************** //
+
+	CrUnitTest(OptimizerPropagateAndEliminate)
+	{
+		Preprocessor preprocessor(std::make_shared<IO::StringInputStream>(R"(
+program 
+{
+		int g = 1;
+		{
+			int a = 2;
+			int b = a * 3;
+			int unused = g;
+			if (b > 5)
+			{
+				g = b;
+			}
+			else
+			{
+				g = 0;
+			}
+			switch (a)
+			{
+				case 1: g = 1; break;
+				case 2: g = g + a; break;
+			}
+			discard;
+			g = 3;
+		}
+}
+)"));
+		Parser parser(&preprocessor);
+		parser.ParseProgram();
+		auto const& program = parser.GetProgram();
+
+		FlatAst ast;
+		auto const root = Optimizer(ast).Run(ast.AddStatements(program.begin(), program.end()));
+
+		// Global declaration and 'g = 6; g = g + 2; discard;' are left.
+		CrAssert(root.GetKind() == FlatAst::NodeKind::Compound && ast.m_Compounds[root.GetIndex()].m_Count == 2);
+		auto const block = ast.GetList(ast.m_Compounds[root.GetIndex()])[1];
+		CrAssert(block.GetKind() == FlatAst::NodeKind::Compound && ast.m_Compounds[block.GetIndex()].m_Count == 3);
+		auto const stmts = ast.GetList(ast.m_Compounds[block.GetIndex()]);
+		CrAssert(stmts[0].GetKind() == FlatAst::NodeKind::Expression && stmts[1].GetKind() == FlatAst::NodeKind::Expression);
+		CrAssert(stmts[2].GetKind() == FlatAst::NodeKind::Discard);
+
+		auto const& thenAssignment = ast.m_Binaries[ast.m_ExpressionStatements[stmts[0].GetIndex()].GetIndex()];
+		CrAssert(thenAssignment.m_Rhs.GetKind() == FlatAst::NodeKind::Constant);
+		CrAssert(ast.m_Constants[thenAssignment.m_Rhs.GetIndex()].m_Value.To<int32_t>() == 6);
+		auto const& caseAssignment = ast.m_Binaries[ast.m_ExpressionStatements[stmts[1].GetIndex()].GetIndex()];
+		CrAssert(caseAssignment.m_Rhs.GetKind() == FlatAst::NodeKind::Binary);
+		auto const& caseRhs = ast.m_Binaries[caseAssignment.m_Rhs.GetIndex()];
+		CrAssert(caseRhs.m_Rhs.GetKind() == FlatAst::NodeKind::Constant && ast.m_Constants[caseRhs.m_Rhs.GetIndex()].m_Value.To<int32_t>() == 2);
+	};
+
+	CrUnitTest(OptimizerKeepsDeclarationsInScope)
+	{
+		Preprocessor preprocessor(std::make_shared<IO::StringInputStream>(R"(
+program 
+{
+		int g = 1;
+		{
+			int a = 2;
+			{
+				int a = g = 3;
+				int b = 5;
+			}
+			for (int j = g = 4; a > 2; )
+			{
+				g = j;
+			}
+			g = g + a;
+		}
+}
+)"));
+		Parser parser(&preprocessor);
+		parser.ParseProgram();
+		auto const& program = parser.GetProgram();
+
+		FlatAst ast;
+		auto const root = Optimizer(ast).Run(ast.AddStatements(program.begin(), program.end()));
+
+		// Inner block is left with a single declaration, and the loop never runs, but neither declaration
+		// is moved into the outer block.
+		auto const block = ast.GetList(ast.m_Compounds[root.GetIndex()])[1];
+		CrAssert(block.GetKind() == FlatAst::NodeKind::Compound && ast.m_Compounds[block.GetIndex()].m_Count == 3);
+		auto const stmts = ast.GetList(ast.m_Compounds[block.GetIndex()]);
+		CrAssert(stmts[0].GetKind() == FlatAst::NodeKind::Compound && ast.m_Compounds[stmts[0].GetIndex()].m_Count == 1);
+		CrAssert(ast.GetList(ast.m_Compounds[stmts[0].GetIndex()])[0].GetKind() == FlatAst::NodeKind::Declaration);
+		CrAssert(stmts[1].GetKind() == FlatAst::NodeKind::For);
+		CrAssert(stmts[2].GetKind() == FlatAst::NodeKind::Expression);
+	};
+
+}	// namespace Cr
@@ -0,0 +1,77 @@
+// $$***************************************************************$$ //
+//                                                                     //
+//                  Goddamn "C for Rendering" project                  //
+//     Copyright (C) Goddamn Industries 2016. All Rights Reserved.     //
+//          ( https://github.com/GoddamnIndustries/GoddamnCr )         //
+//                                                                     //
+//    This software or any its part is distributed under the terms of  //
+//   Goddamn Industries End User License Agreement. By downloading or  //
+//   using this software or any its part you agree with the terms of   //
+//   Goddamn Industries End User License Agreement.                    //
+//                                                                     //
+// $$***************************************************************$$ //
+
+
+#pragma once
+#include "FlatAst.h"
+
+#include <vector>
+
+namespace Cr
+{
+	/**
+	 * Constant propagation and dead code elimination pass over the flat AST.
+	 * Local variables with the constant initializers, that are never assigned, are replaced with their values 
+	 * and the expressions are refolded. Branches and loops with the constant conditions are resolved, statements 
+	 * after the jumps are dropped. Finally, local variables, that are never read, are removed with their 
+	 * assignments. Variables, declared directly inside the program, are globals and are kept as is.
+	 */
+	class Optimizer final
+	{
+	private:
+		typedef FlatAst::NodeId NodeId;
+		typedef FlatAst::NodeKind NodeKind;
+
+		struct VariableInfo
+		{
+			NodeId   m_Value;					///< Constant node with the value of the variable.
+			uint32_t m_ReadsCount = 0;
+			uint32_t m_WritesCount = 0;
+			uint32_t m_StatementWritesCount = 0;	///< Assignments, that are the whole expression statements.
+			bool     m_IsLocal = false;
+			bool     m_IsAssigned = false;
+		};	// struct VariableInfo
+
+	private:
+		FlatAst& m_Ast;
+		std::vector<VariableInfo> m_Variables;
+
+	public:
+		CRINL explicit Optimizer(FlatAst& ast)
+			: m_Ast(ast)
+		{
+		}
+
+		/**
+		 * Optimizes the program.
+		 * @param program Compound node with the statements of the program.
+		 * @returns Optimized program or null identifier if nothing is left.
+		 */
+		CR_API NodeId Run(NodeId program);
+
+	private:
+		CR_INTERNAL void CollectVariables(NodeId node, bool isLocal);
+		CR_INTERNAL void CountVariableUses(NodeId node);
+		CR_INTERNAL bool RemoveUnusedVariables(NodeId node);
+
+		CR_INTERNAL NodeId OptimizeStatement(NodeId stmt);
+		CR_INTERNAL NodeId OptimizeExpression(NodeId expr);
+		CR_INTERNAL NodeId FoldExpression(NodeId expr);
+
+		CR_INTERNAL bool IsConstant(NodeId expr) const;
+		CR_INTERNAL bool HasSideEffects(NodeId expr) const;
+		CR_INTERNAL bool AlwaysJumps(NodeId stmt) const;
+		CR_INTERNAL bool ContainsJump(NodeId stmt, NodeKind jumpKind) const;
+	};	// class Optimizer
+
+}	// namespace Cr
@@ -17,6 +17,7 @@
 
 #include <vector>
 #include <algorithm>
+#include <cmath>
 
 /// @todo Cleanup the whole mess here.
 namespace Cr
@@ -27,10 +28,20 @@ namespace Cr
 
 	/**
 	 * Reads next lexeme from the specified scanner.
+	 * Lexemes are pulled in chunks, the null lexeme at the end of the chunk is never passed.
 	 */
 	CRINL void Parser::ReadNextLexeme()
 	{
-		m_Lexeme = m_Preprocesser->GetNextLexeme();
+		if (m_LexemesChunkCursor == m_LexemesChunkSize)
+		{
+			m_LexemesChunkSize = m_Preprocesser->GetNextLexemes(m_LexemesChunk, sizeof m_LexemesChunk / sizeof m_LexemesChunk[0]);
+			m_LexemesChunkCursor = 0;
+		}
+		m_Lexeme = m_LexemesChunk[m_LexemesChunkCursor];
+		if (m_Lexeme != Lexeme::Type::Null)
+		{
+			++m_LexemesChunkCursor;
+		}
 	}
 
 	/**
@@ -43,7 +54,7 @@ namespace Cr
 		ReadNextLexeme();
 		if (m_Lexeme != type)
 		{
-			throw ParserException("something was expected.");
+			throw ParserException("something was expected.", m_Lexeme.GetOffset());
 		}
 	}
 
@@ -55,7 +66,7 @@ namespace Cr
 	{
 		if (m_Lexeme != type)
 		{
-			throw ParserException("Unexpected lexeme.");
+			throw ParserException("Unexpected lexeme.", m_Lexeme.GetOffset());
 		}
 	}
 	CRINL void Parser::ReadNextLexeme(Lexeme::Type const type)
@@ -193,7 +204,7 @@ namespace Cr
 
 		// Step 1. Parse statement.
 		// ---------------------------------------------------
-		m_ScopedIdents.emplace_back();
+		m_ScopedIdents.PushScope();
 		auto const compoundStmt = m_Profile->CreateCompoundStatement();
 		auto parsingUnreachableCode = false;
 		while (m_Lexeme != Lexeme::Type::OpBraceClose)
@@ -203,13 +214,12 @@ namespace Cr
 			{
 				/// @todo Uncomment warning.
 			//	throw ParserException("Unreachable code detected.");
-				delete innerStmt;
 				continue;
 			}
 
 			if (innerStmt != nullptr)
 			{
-				compoundStmt->m_Stmts.emplace_back(innerStmt);
+				compoundStmt->m_Stmts.PushBack(m_Arena, innerStmt);
 				compoundStmt->m_PerformsJump = innerStmt->m_PerformsJump;
 				if (innerStmt->m_PerformsJump)
 				{
@@ -220,22 +230,19 @@ namespace Cr
 			}
 		}
 		ReadNextLexeme();
-		m_ScopedIdents.pop_back();
+		m_ScopedIdents.PopScope();
 
 		// Step 2. Try to unroll.
 		// ---------------------------------------------------
 		if (compoundStmt->m_Stmts.empty())
 		{
 			// Empty compound statement.
-			delete compoundStmt;
 			return nullptr;
 		}
 		if (compoundStmt->m_Stmts.size() == 1)
 		{
 			// Compound statement with single expression.
-			auto const unrolledStmt = compoundStmt->m_Stmts.front().release();
-			delete compoundStmt;
-			return unrolledStmt;
+			return compoundStmt->m_Stmts.front();
 		}
 		return compoundStmt;
 	}
@@ -253,7 +260,7 @@ namespace Cr
 		auto const ifStmt = m_Profile->CreateIfSelectionStatement();
 
 		ReadNextLexeme(Lexeme::Type::OpParenOpen);
-		ifStmt->m_CondExpr.reset(Parse_Expression());
+		ifStmt->m_CondExpr = Parse_Expression();
 		if (!ifStmt->m_CondExpr->GetType().IsScalar(Ast::BaseType::Bool))
 		{
 			throw ParserException("Condition expression of the 'if' statement must be convertible to scalar boolean "
@@ -261,12 +268,12 @@ namespace Cr
 		}
 		ReadNextLexeme(Lexeme::Type::OpParenClose);
 		
-		ifStmt->m_ThenStmt.reset(Parse_Statement_Scoped());
+		ifStmt->m_ThenStmt = Parse_Statement_Scoped();
 		if (m_Lexeme == Lexeme::Type::KwElse)
 		{
 			// Else statement was specified.
 			ReadNextLexeme();
-			ifStmt->m_ElseStmt.reset(Parse_Statement_Scoped());
+			ifStmt->m_ElseStmt = Parse_Statement_Scoped();
 			ifStmt->m_PerformsJump = ifStmt->m_ThenStmt->m_PerformsJump & ifStmt->m_ElseStmt->m_PerformsJump;
 		}
 		
@@ -276,14 +283,13 @@ namespace Cr
 		{
 			// 'if' statement could be evaluated at compile-time.
 			auto const condExprValue = ifStmt->m_CondExpr->Evaluate().To<bool>();
-			auto const evaluatedStmt = condExprValue ? ifStmt->m_ThenStmt.release() : ifStmt->m_ElseStmt.release();
+			auto const evaluatedStmt = condExprValue ? ifStmt->m_ThenStmt : ifStmt->m_ElseStmt;
 			if (evaluatedStmt == nullptr)
 			{
 				/// @todo Uncomment warning.
 			//	throw ParserException("'if' statement has a constant expression condition, evaluation resulted "
 			//						  "null statement; skipping this 'if' statement.");
 			}
-			delete ifStmt;
 			return evaluatedStmt;
 		}
 		return ifStmt;
@@ -302,7 +308,7 @@ namespace Cr
 		CrAssignAndReset(m_JumpOnBreak, switchStmt);
 
 		ReadNextLexeme(Lexeme::Type::OpParenOpen);
-		switchStmt->m_SelectionExpr.reset(Parse_Expression());
+		switchStmt->m_SelectionExpr = Parse_Expression();
 		if (!switchStmt->m_SelectionExpr->GetType().IsScalar())
 		{
 			throw ParserException("Selection expression of the 'switch' statement must be scalar value.");
@@ -318,12 +324,12 @@ namespace Cr
 		else
 		{
 			// Switch body was specified.
-			m_ScopedIdents.emplace_back();
+			m_ScopedIdents.PushScope();
 			ReadNextLexeme(Lexeme::Type::OpBraceOpen);
 			while (true)
 			{
 				// Parsing the group of case & default sections:
-				std__shared_ptr<Ast::SwitchSection> const switchSection(m_Profile->CreateSwitchSection());
+				auto const switchSection = m_Profile->CreateSwitchSection();
 				while (true)
 				{
 					if (m_Lexeme == Lexeme::Type::KwCase)
@@ -335,11 +341,11 @@ namespace Cr
 						ReadNextLexeme(Lexeme::Type::OpColon);
 
 						auto const switchCaseExprValue = switchCaseExpr->Evaluate().To<int64_t>();
-						if (switchStmt->m_Sections.count(switchCaseExprValue) != 0)
+						if (switchStmt->FindSection(switchCaseExprValue) != nullptr)
 						{
 							throw ParserException("Duplicate 'case' branch of the switch statement.");
 						}
-						switchStmt->m_Sections[switchCaseExprValue] = switchSection;
+						switchStmt->m_Sections.PushBack(m_Arena, { switchCaseExprValue, switchSection });
 						continue;
 					}
 					if (m_Lexeme == Lexeme::Type::KwDefault)
@@ -365,13 +371,11 @@ namespace Cr
 					{
 						/// @todo Uncomment warning.
 					//	throw ParserException("Unreachable code detected.");
-						delete switchSectionStmt;
-						continue;
 					}
-
-					if (switchSectionStmt != nullptr)
+					else if (switchSectionStmt != nullptr)
 					{
 						switchStmt->m_PerformsJump &= switchSectionStmt->m_PerformsJump;
+						switchSection->m_Stmts.PushBack(m_Arena, switchSectionStmt);
 						if (switchSectionStmt->m_PerformsJump)
 						{
 							// This is jump statement. That means that any other following statements  
@@ -383,11 +387,7 @@ namespace Cr
 						m_Lexeme == Lexeme::Type::OpBraceClose)
 					{
 						// We are leaving this section now. Have to validate whether sections have no
-						// fallthrough.
-						switchSection->m_Stmts.emplace_back(switchSectionStmt);
-
-						// According to HLSL specification, each section must end with a jump statement.
-						// (Sections with null statements are treated as non-empty.)
+						// fallthrough. According to HLSL specification, each section must end with a jump statement.
 						if (switchSection->m_Stmts.empty() ||
 							!switchSection->m_Stmts.back()->m_PerformsJump.PerformsBreak() &&
 							!switchSection->m_Stmts.back()->m_PerformsJump.PerformsReturn())
@@ -397,6 +397,7 @@ namespace Cr
 						}
 						if (m_Lexeme == Lexeme::Type::OpBraceClose)
 						{
+							ReadNextLexeme();
 							goto SwitchBodyParsed;
 						}
 						goto SwitchSectionParsed;
@@ -405,7 +406,7 @@ namespace Cr
 			SwitchSectionParsed:;
 			}
 		SwitchBodyParsed:;
-			m_ScopedIdents.pop_back();
+			m_ScopedIdents.PopScope();
 		}
 		if (switchStmt->m_DefaultSection == nullptr && switchStmt->m_Sections.empty())
 		{
@@ -423,27 +424,25 @@ namespace Cr
 		{
 			// 'switch' statement could be evaluated at compile-time.
 			auto const selectionExprVal = switchStmt->m_SelectionExpr->Evaluate().To<int64_t>();
-			auto const evaluatedSection = switchStmt->m_Sections.count(selectionExprVal) != 0 ? switchStmt->m_Sections[selectionExprVal] : switchStmt->m_DefaultSection;
+			auto const caseSection = switchStmt->FindSection(selectionExprVal);
+			auto const evaluatedSection = caseSection != nullptr ? caseSection : switchStmt->m_DefaultSection;
 			if (evaluatedSection == nullptr || evaluatedSection->m_Stmts.empty())
 			{
 				/// @todo Uncomment warning.
 			//	throw ParserException("'switch' statement has a constant expression condition, evaluation resulted "
 			//						  "null statement; skipping this 'switch' statement.");
-				delete switchStmt;
 				return nullptr;
 			}
-			delete switchStmt;
 
 			CrAssert(0);
 			/// @todo We have to remove last break here from the evaluated section, but not something we are doing here.
 			if (evaluatedSection->m_Stmts.size() == 1)
 			{
-				auto const evaluatedStmt = evaluatedSection->m_Stmts[0].release();
+				auto const evaluatedStmt = evaluatedSection->m_Stmts[0];
 				if (dynamic_cast<Ast::BreakJumpStatement*>(evaluatedStmt) != nullptr)
 				{
 					// Evaluated case consists only of 'break' statement that leaves the switch.
 					// The whole unrolled case if empty.
-					delete evaluatedStmt;
 					return nullptr;
 				}
 
@@ -453,12 +452,13 @@ namespace Cr
 			else
 			{
 				// Copying the whole content to the break operator.
-				auto const evaluatedStmt = m_Profile->CreateCompoundStatement(std::move(evaluatedSection->m_Stmts));
-				if (dynamic_cast<Ast::BreakJumpStatement*>(evaluatedStmt->m_Stmts.back().get()) != nullptr)
+				auto const evaluatedStmt = m_Profile->CreateCompoundStatement();
+				evaluatedStmt->m_Stmts = evaluatedSection->m_Stmts;
+				if (dynamic_cast<Ast::BreakJumpStatement*>(evaluatedStmt->m_Stmts.back()) != nullptr)
 				{
 					// Evaluated case ends with 'break' statement that leaves the switch.
 					// Removing it.
-					evaluatedStmt->m_Stmts.pop_back();
+					evaluatedStmt->m_Stmts.PopBack();
 				}
 				return evaluatedStmt;
 			}
@@ -481,7 +481,7 @@ namespace Cr
 		CrAssignAndReset(m_JumpOnContinue, whileStmt);
 
 		ReadNextLexeme(Lexeme::Type::OpParenOpen);
-		whileStmt->m_CondExpr.reset(Parse_Expression());
+		whileStmt->m_CondExpr = Parse_Expression();
 		if (!whileStmt->m_CondExpr->GetType().IsScalar(Ast::BaseType::Bool))
 		{
 			throw ParserException("Condition expression of the 'while' statement must be convertible to scalar boolean "
@@ -489,7 +489,7 @@ namespace Cr
 		}
 		ReadNextLexeme(Lexeme::Type::OpParenClose);
 
-		whileStmt->m_LoopStmt.reset(Parse_Statement_Scoped());
+		whileStmt->m_LoopStmt = Parse_Statement_Scoped();
 
 		// Step 2. Try to evaluate.
 		// ---------------------------------------------------
@@ -502,7 +502,6 @@ namespace Cr
 				/// @todo Uncomment warning.
 			//	throw ParserException("'while' statement has a constant expression condition, evaluation resulted "
 			//						  "null statement, skipping the 'while' statement.");
-				delete whileStmt;
 				return nullptr;
 			}
 
@@ -523,7 +522,7 @@ namespace Cr
 		CrAssignAndReset(m_JumpOnBreak, doWhileStmt);
 		CrAssignAndReset(m_JumpOnContinue, doWhileStmt);
 
-		doWhileStmt->m_LoopStmt.reset(Parse_Statement_Scoped());
+		doWhileStmt->m_LoopStmt = Parse_Statement_Scoped();
 		if (doWhileStmt->m_LoopStmt == nullptr)
 		{
 			/// @todo Uncomment warning.
@@ -533,7 +532,7 @@ namespace Cr
 
 		ReadNextLexeme(Lexeme::Type::KwWhile);
 		ReadNextLexeme(Lexeme::Type::OpParenOpen);
-		doWhileStmt->m_CondExpr.reset(Parse_Expression());
+		doWhileStmt->m_CondExpr = Parse_Expression();
 		if (!doWhileStmt->m_CondExpr->GetType().IsScalar(Ast::BaseType::Bool))
 		{
 			throw ParserException("Condition expression of the 'do-while' statement must be convertible to scalar "
@@ -553,9 +552,7 @@ namespace Cr
 				/// @todo Uncomment warning.
 			//	throw ParserException("'do-while' statement has a constant expression condition, evaluation resulted "
 			//						  "null statement, unrolling the 'do-while' statement.");
-				auto const evaluatedStmt = doWhileStmt->m_LoopStmt.release();
-				delete doWhileStmt;
-				return evaluatedStmt;
+				return doWhileStmt->m_LoopStmt;
 			}
 
 			// Now we know that this loop has true condition.
@@ -580,9 +577,9 @@ namespace Cr
 		if (m_Lexeme != Lexeme::Type::OpSemicolon)
 		{
 			// Initialization section was specified.
-			forStmt->m_InitStmt.reset(Parse_Statement());
-			if (dynamic_cast<Ast::DeclarationStatement*>(forStmt->m_InitStmt.get()) == nullptr &&
-				dynamic_cast<Ast::ExpressionStatement*>(forStmt->m_InitStmt.get()) == nullptr)
+			forStmt->m_InitStmt = Parse_Statement();
+			if (dynamic_cast<Ast::DeclarationStatement*>(forStmt->m_InitStmt) == nullptr &&
+				dynamic_cast<Ast::ExpressionStatement*>(forStmt->m_InitStmt) == nullptr)
 			{
 				throw ParserException("Declaration or expression statement is expected in the non-empty initialization "
 									  "section of the 'for' statement.");
@@ -596,7 +593,7 @@ namespace Cr
 		if (m_Lexeme != Lexeme::Type::OpSemicolon)
 		{
 			// Condition section was specified.
-			forStmt->m_CondExpr.reset(Parse_Expression());
+			forStmt->m_CondExpr = Parse_Expression();
 			if (!forStmt->m_CondExpr->GetType().IsScalar(Ast::BaseType::Bool))
 			{
 				throw ParserException("Condition expression of the condition section of 'for' statement must be "
@@ -612,7 +609,7 @@ namespace Cr
 		if (m_Lexeme != Lexeme::Type::OpParenClose)
 		{
 			// Step section was specified.
-			forStmt->m_StepExpr.reset(Parse_Expression());
+			forStmt->m_StepExpr = Parse_Expression();
 			ReadNextLexeme(Lexeme::Type::OpParenClose);
 		}
 		else
@@ -620,7 +617,7 @@ namespace Cr
 			ReadNextLexeme();
 		}
 
-		forStmt->m_LoopStmt.reset(Parse_Statement_Scoped());
+		forStmt->m_LoopStmt = Parse_Statement_Scoped();
 		
 		// Step 2. Try to unroll.
 		// ---------------------------------------------------
@@ -634,8 +631,7 @@ namespace Cr
 				/// @todo Uncomment warning.
 				//	throw ParserException("'for' statement has a constant expression condition, evaluation resulted "
 				//						  "null statement, skipping the loop section of the 'for' statement.");
-				auto const evaluatedStmt = forStmt->m_LoopStmt.release();
-				delete forStmt;
+				auto const evaluatedStmt = forStmt->m_LoopStmt;
 				if (evaluatedStmt != nullptr)
 				{
 					// 'for' statement should be skipped: we must find the way to unroll the initialization statement.
@@ -708,7 +704,7 @@ namespace Cr
 			{
 				throw ParserException("Function of 'void' return type cannot return a value.");
 			}
-			returnStmt->m_Expr.reset(Parse_Expression());
+			returnStmt->m_Expr = Parse_Expression();
 			if (returnStmt->m_Expr->GetType().IsIncompatibleWith(funcRetType))
 			{
 				throw ParserException("Type of the 'return' statement is inconvertible to the function return type.");
@@ -841,21 +837,18 @@ namespace Cr
 	{
 		if (m_Lexeme == Lexeme::Type::KwStruct)
 		{
-			auto const declStmt = new Ast::DeclarationStatement();
+			auto const declStmt = m_Profile->CreateDeclarationStatement();
 
 			ReadNextLexeme();
 			ExpectLexeme(Lexeme::Type::IdIdentifier);
 			auto const structName = m_Lexeme.GetValueID();
-			if (FindIdentifier(structName) != nullptr)
-			{
-				throw ParserException("Identifier redeclaration.");
-			}
+			ExpectUndeclaredIdentifier(structName);
 			ReadNextLexeme();
 
-			auto const structDecl = new Ast::Structure();
+			auto const structDecl = m_Arena.New<Ast::Structure>();
 			structDecl->m_Name = structName;
 			ReadNextLexeme(Lexeme::Type::OpBraceOpen);
-			m_ScopedIdents.emplace_back();
+			m_ScopedIdents.PushScope();
 			while (m_Lexeme != Lexeme::Type::OpBraceClose)
 			{
 				auto const declStmt = dynamic_cast<Ast::DeclarationStatement*>(Parse_Statement_Declaration_OR_Expression());
@@ -863,19 +856,20 @@ namespace Cr
 				{
 					throw ParserException("Declaration expected.");
 				}
-				structDecl->m_Vars.insert(structDecl->m_Vars.end(), declStmt->m_Vars.begin(), declStmt->m_Vars.end());
-				delete declStmt;
+				for (auto const var : declStmt->m_Vars)
+				{
+					structDecl->m_Vars.PushBack(m_Arena, var);
+				}
 			}
 			ReadNextLexeme();
 			ReadNextLexeme(Lexeme::Type::OpSemicolon);
-			m_ScopedIdents.pop_back();
-			//	m_ScopedIdents.emplace_back(structDecl);
+			m_ScopedIdents.PopScope();
 
-			auto const typedefDecl = new Ast::Typedef();
+			auto const typedefDecl = m_Arena.New<Ast::Typedef>();
 			typedefDecl->m_Type = Ast::Type(structDecl);
-			m_ScopedIdents.back()[structDecl->m_Name] = typedefDecl;
+			m_ScopedIdents.Declare(structDecl->m_Name, typedefDecl);
 
-			declStmt->m_Structs.emplace_back(structDecl);
+			declStmt->m_Structs.PushBack(m_Arena, structDecl);
 			return declStmt;
 		}
 
@@ -883,14 +877,11 @@ namespace Cr
 		auto const type = ParseHelper_Type();
 		if (type != Ast::BaseType::Null)
 		{
-			auto const declStmt = new Ast::DeclarationStatement();
+			auto const declStmt = m_Profile->CreateDeclarationStatement();
 
 			ExpectLexeme(Lexeme::Type::IdIdentifier);
 			auto const varFuncName = m_Lexeme.GetValueID();
-			if (FindIdentifier(varFuncName) != nullptr)
-			{
-				throw ParserException("Identifier redeclaration.");
-			}
+			ExpectUndeclaredIdentifier(varFuncName);
 			ReadNextLexeme();
 
 			if (m_Lexeme == Lexeme::Type::OpParenOpen)
@@ -900,8 +891,8 @@ namespace Cr
 			}
 
 			// This is a variable declaration.
-			auto const varDecl = new Ast::Variable();
-			declStmt->m_Vars.emplace_back(varDecl);
+			auto const varDecl = m_Arena.New<Ast::Variable>();
+			declStmt->m_Vars.PushBack(m_Arena, varDecl);
 			varDecl->m_Type = type;
 			varDecl->m_Name = varFuncName;
 			DeclareVariable(varDecl);
@@ -926,7 +917,7 @@ namespace Cr
 			{
 				// This declaration has initialization expression.
 				ReadNextLexeme();
-				varDecl->m_InitExpr.reset(Parse_Expression());
+				varDecl->m_InitExpr = Parse_Expression();
 				VerifyTypesMatch(type, varDecl->m_InitExpr->GetType());
 			}
 
@@ -963,12 +954,11 @@ namespace Cr
 		{
 			/// @todo Uncomment warning.
 		//	throw ParserException("Compile-time constant expression statement, skipping it.");
-			delete expr;
 			return nullptr;
 		}
 		
 		auto const exprStmt = m_Profile->CreateExpressionStatement();
-		exprStmt->m_Expr.reset();
+		exprStmt->m_Expr = expr;
 		ReadNextLexeme(Lexeme::Type::OpSemicolon);
 		return exprStmt;
 	}
@@ -990,8 +980,8 @@ namespace Cr
 			auto const commaExpr = m_Profile->CreateCommaExpression();
 
 			ReadNextLexeme();
-			commaExpr->m_Lhs.reset(expr);
-			commaExpr->m_Rhs.reset(Parse_Expression_Assignments());
+			commaExpr->m_Lhs = expr;
+			commaExpr->m_Rhs = Parse_Expression_Assignments();
 			commaExpr->m_Type = commaExpr->m_Rhs->GetType();
 			expr = commaExpr;
 		}
@@ -1013,7 +1003,7 @@ namespace Cr
 						ReadNextLexeme();
 
 						auto const assignExpr = m_Profile->CreateAssignmentBinaryExpression(expr, Parse_Expression_Ternary());
-						VerifyLValue(assignExpr->m_Lhs.get());
+						VerifyLValue(assignExpr->m_Lhs);
 
 						auto const lhsExprType = assignExpr->m_Lhs->GetType();
 						auto const rhsExprType = assignExpr->m_Rhs->GetType();
@@ -1033,7 +1023,7 @@ namespace Cr
 						ReadNextLexeme();
 
 						auto const bitwiseAssignExpr = m_Profile->CreateBitwiseAssignmentBinaryExpression(op, expr, Parse_Expression_Ternary());
-						VerifyLValue(bitwiseAssignExpr->m_Lhs.get());
+						VerifyLValue(bitwiseAssignExpr->m_Lhs);
 
 						auto const lhsExprType = bitwiseAssignExpr->m_Lhs->GetType();
 						auto const rhsExprType = bitwiseAssignExpr->m_Rhs->GetType();
@@ -1055,7 +1045,7 @@ namespace Cr
 						ReadNextLexeme();
 
 						auto const arithmAssignExpr = m_Profile->CreateArithmeticAssignmentBinaryExpression(op, expr, Parse_Expression_Ternary());
-						VerifyLValue(arithmAssignExpr->m_Lhs.get());
+						VerifyLValue(arithmAssignExpr->m_Lhs);
 
 						auto const lhsExprType = arithmAssignExpr->m_Lhs->GetType();
 						auto const rhsExprType = arithmAssignExpr->m_Rhs->GetType();
@@ -1090,12 +1080,12 @@ namespace Cr
 	// *************************************************************** //
 	CR_INTERNAL Ast::Expression* Parser::Parse_Expression_Ternary()
 	{
-		auto expr = Parse_Expression_Or();
+		auto expr = Parse_Expression_Binary();
 		while (m_Lexeme == Lexeme::Type::OpTernary)
 		{
 			auto const ternaryExpr = m_Profile->CreateTernaryExpression(nullptr, nullptr, nullptr);
 			
-			ternaryExpr->m_CondExpr.reset(expr);
+			ternaryExpr->m_CondExpr = expr;
 			if (!ternaryExpr->m_CondExpr->GetType().IsScalar(Ast::BaseType::Bool))
 			{
 				throw ParserException("Expression in the condition section of the ternary operator must be convertible "
@@ -1103,9 +1093,9 @@ namespace Cr
 			}
 
 			ReadNextLexeme(Lexeme::Type::OpTernary);
-			ternaryExpr->m_ThenExpr.reset(Parse_Expression());
+			ternaryExpr->m_ThenExpr = Parse_Expression();
 			ReadNextLexeme(Lexeme::Type::OpColon);
-			ternaryExpr->m_ElseExpr.reset(Parse_Expression());
+			ternaryExpr->m_ElseExpr = Parse_Expression();
 			
 			auto const thenExprType = ternaryExpr->m_ThenExpr->GetType();
 			auto const elseExprType = ternaryExpr->m_ElseExpr->GetType();
@@ -1114,10 +1104,11 @@ namespace Cr
 			// Ternary operator may be evaluated at compile time.
 			// Also, ternary operator cannot be l-value due to it is not l-value in HLSL.
 			// Possibly, we can substitute it with 'if-else' operator in this cases.
-			ternaryExpr->m_IsConstexpr = ternaryExpr->m_ThenExpr->IsConstexpr() && ternaryExpr->m_ElseExpr->IsConstexpr();
+			ternaryExpr->m_IsConstexpr = ternaryExpr->m_CondExpr->IsConstexpr() 
+				&& ternaryExpr->m_ThenExpr->IsConstexpr() && ternaryExpr->m_ElseExpr->IsConstexpr();
 			ternaryExpr->m_Type = std::max(thenExprType, elseExprType);
 
-			expr = ternaryExpr;
+			expr = ParseHelper_Expression_Fold(ternaryExpr);
 		}
 		return expr;
 	}
@@ -1126,6 +1117,28 @@ namespace Cr
 	// --                 Binary expression parsing.                -- //
 	// --------------------------------------------------------------- //
 
+	// Replaces the compile-time constant expression with the constant expression node, so the folded sub-tree is
+	// never re-evaluated. Sub-expressions are folded first, so only a single operation is evaluated here.
+	// Value is converted to the base type and dimensions of the expression.
+	// Expressions that fail to evaluate, like the integral division by zero, are left unfolded.
+	// *************************************************************** //
+	CR_HELPER Ast::Expression* Parser::ParseHelper_Expression_Fold(Ast::Expression* const expr) const
+	{
+		if (!expr->IsConstexpr() || dynamic_cast<Ast::ConstantExpression*>(expr) != nullptr)
+		{
+			return expr;
+		}
+		try
+		{
+			return m_Profile->CreateConstExpression(expr->Evaluate(), expr->GetType());
+		}
+		catch (ParserException const&)
+		{
+			// Expression may be in the branch that is never taken.
+			return expr;
+		}
+	}
+
 	// Helpers for semantic analysis of binary expressions.
 	// *************************************************************** //
 	CR_HELPER Ast::Expression* Parser::ParseHelper_Expression_LogicBinary(Lexeme::Type const op
@@ -1141,7 +1154,7 @@ namespace Cr
 		logicBinExpr->m_IsConstexpr = logicBinExpr->m_Lhs->IsConstexpr() && logicBinExpr->m_Rhs->IsConstexpr();
 		logicBinExpr->m_Type = Ast::Type(Ast::BaseType::Bool, lhsExprType);
 
-		return logicBinExpr;
+		return ParseHelper_Expression_Fold(logicBinExpr);
 	}
 	// *************************************************************** //
 	CR_HELPER Ast::Expression* Parser::ParseHelper_Expression_BitwiseBinary(Lexeme::Type const op
@@ -1158,7 +1171,7 @@ namespace Cr
 		bitwiseBinExpr->m_IsConstexpr = bitwiseBinExpr->m_Lhs->IsConstexpr() && bitwiseBinExpr->m_Rhs->IsConstexpr();
 		bitwiseBinExpr->m_Type = std::max(lhsExprType, rhsExprType);
 
-		return bitwiseBinExpr;
+		return ParseHelper_Expression_Fold(bitwiseBinExpr);
 	}
 	// *************************************************************** //
 	CR_HELPER Ast::Expression* Parser::ParseHelper_Expression_ArithmeticBinary(Lexeme::Type const op
@@ -1179,125 +1192,100 @@ namespace Cr
 		arithmBinExpr->m_IsConstexpr = arithmBinExpr->m_Lhs->IsConstexpr() && arithmBinExpr->m_Rhs->IsConstexpr();
 		arithmBinExpr->m_Type = std::max(lhsExprType, rhsExprType);
 
-		return arithmBinExpr;
+		return ParseHelper_Expression_Fold(arithmBinExpr);
 	}
 
-	// { BINARY-EXPR ::= <PREF-UNARY-EXPR> [@ <PREF-UNARY-EXPR>] }
-	// *************************************************************** //
-	CR_INTERNAL Ast::Expression* Parser::Parse_Expression_Or()
-	{
-		auto expr = Parse_Expression_And();
-		while (m_Lexeme == Lexeme::Type::OpOr)
-		{
-			ReadNextLexeme();
-			expr = ParseHelper_Expression_LogicBinary(Lexeme::Type::OpOr, expr, Parse_Expression_And());
-		}
-		return expr;
-	}
-	// *************************************************************** //
-	CR_INTERNAL Ast::Expression* Parser::Parse_Expression_And()
-	{
-		auto expr = Parse_Expression_BitwiseOr();
-		while (m_Lexeme == Lexeme::Type::OpAnd)
-		{
-			ReadNextLexeme();
-			expr = ParseHelper_Expression_LogicBinary(Lexeme::Type::OpAnd, expr, Parse_Expression_BitwiseOr());
-		}
-		return expr;
-	}
-	// *************************************************************** //
-	CR_INTERNAL Ast::Expression* Parser::Parse_Expression_BitwiseOr()
-	{
-		auto expr = Parse_Expression_BitwiseXor();
-		while (m_Lexeme == Lexeme::Type::OpBitwiseOr)
-		{
-			ReadNextLexeme();
-			expr = ParseHelper_Expression_BitwiseBinary(Lexeme::Type::OpBitwiseOr, expr, Parse_Expression_BitwiseXor());
-		}
-		return expr;
-	}
-	// *************************************************************** //
-	CR_INTERNAL Ast::Expression* Parser::Parse_Expression_BitwiseXor()
-	{
-		auto expr = Parse_Expression_BitwiseAnd();
-		while (m_Lexeme == Lexeme::Type::OpBitwiseXor)
-		{
-			ReadNextLexeme();
-			expr = ParseHelper_Expression_BitwiseBinary(Lexeme::Type::OpBitwiseXor, expr, Parse_Expression_BitwiseAnd());
-		}
-		return expr;
-	}
-	// *************************************************************** //
-	CR_INTERNAL Ast::Expression* Parser::Parse_Expression_BitwiseAnd()
-	{
-		auto expr = Parse_Expression_Equals_OR_NotEquals();
-		while (m_Lexeme == Lexeme::Type::OpBitwiseAnd)
-		{
-			ReadNextLexeme();
-			expr = ParseHelper_Expression_BitwiseBinary(Lexeme::Type::OpBitwiseAnd, expr, Parse_Expression_Equals_OR_NotEquals());
-		}
-		return expr;
-	}
-	// *************************************************************** //
-	CR_INTERNAL Ast::Expression* Parser::Parse_Expression_Equals_OR_NotEquals()
-	{
-		auto expr = Parse_Expression_Less_OR_LessEquals_OR_Greater_OR_GreaterEquals();
-		while (m_Lexeme == Lexeme::Type::OpEquals || m_Lexeme == Lexeme::Type::OpNotEquals)
-		{
-			auto const op = m_Lexeme.GetType();
-			ReadNextLexeme();
-			expr = ParseHelper_Expression_LogicBinary(op, expr, Parse_Expression_Less_OR_LessEquals_OR_Greater_OR_GreaterEquals());
-		}
-		return expr;
-	}
-	// *************************************************************** //
-	CR_INTERNAL Ast::Expression* Parser::Parse_Expression_Less_OR_LessEquals_OR_Greater_OR_GreaterEquals()
+	/**
+	 * Kind of the binary operator, selects the semantic helper that validates and builds the binary expression.
+	 */
+	enum class BinaryOperatorKind : uint8_t
 	{
-		auto expr = Parse_Expression_BitwiseLeftShift_OR_BitwiseRightShift();
-		while (m_Lexeme == Lexeme::Type::OpLess || m_Lexeme == Lexeme::Type::OpLessEquals
-			|| m_Lexeme == Lexeme::Type::OpGreater || m_Lexeme == Lexeme::Type::OpGreaterEquals)
-		{
-			auto const op = m_Lexeme.GetType();
-			ReadNextLexeme();
-			expr = ParseHelper_Expression_LogicBinary(op, expr, Parse_Expression_BitwiseLeftShift_OR_BitwiseRightShift());
-		}
-		return expr;
-	}
-	// *************************************************************** //
-	CR_INTERNAL Ast::Expression* Parser::Parse_Expression_BitwiseLeftShift_OR_BitwiseRightShift()
+		Null,
+		Logic,
+		Bitwise,
+		Arithmetic,
+	};	// enum class BinaryOperatorKind
+
+	struct BinaryOperator
 	{
-		auto expr = Parse_Expression_Add_OR_Subtract();
-		while (m_Lexeme == Lexeme::Type::OpBitwiseLeftShift || m_Lexeme == Lexeme::Type::OpBitwiseRightShift)
-		{
-			auto const op = m_Lexeme.GetType();
-			ReadNextLexeme();
-			expr = ParseHelper_Expression_BitwiseBinary(op, expr, Parse_Expression_Add_OR_Subtract());
-		}
-		return expr;
-	}
-	// *************************************************************** //
-	CR_INTERNAL Ast::Expression* Parser::Parse_Expression_Add_OR_Subtract()
+		uint8_t            m_Precedence;	///< Greater precedence binds tighter. Zero for non-binary lexemes.
+		BinaryOperatorKind m_Kind;
+	};	// struct BinaryOperator
+
+	/**
+	 * Binary operators, indexed by the lexeme type starting from the assignment operator.
+	 * Precedence of the operators is the C one.
+	 */
+	static constexpr BinaryOperator s_BinaryOperators[] = {
+		/* OpAssignment        */ { 0, BinaryOperatorKind::Null },
+		/* OpAdd               */ { 9, BinaryOperatorKind::Arithmetic },
+		/* OpSubtract          */ { 9, BinaryOperatorKind::Arithmetic },
+		/* OpMultiply          */ { 10, BinaryOperatorKind::Arithmetic },
+		/* OpDivide            */ { 10, BinaryOperatorKind::Arithmetic },
+		/* OpModulo            */ { 10, BinaryOperatorKind::Arithmetic },
+		/* OpInc               */ { 0, BinaryOperatorKind::Null },
+		/* OpDec               */ { 0, BinaryOperatorKind::Null },
+		/* OpEquals            */ { 6, BinaryOperatorKind::Logic },
+		/* OpNotEquals         */ { 6, BinaryOperatorKind::Logic },
+		/* OpGreater           */ { 7, BinaryOperatorKind::Logic },
+		/* OpLess              */ { 7, BinaryOperatorKind::Logic },
+		/* OpGreaterEquals     */ { 7, BinaryOperatorKind::Logic },
+		/* OpLessEquals        */ { 7, BinaryOperatorKind::Logic },
+		/* OpNot               */ { 0, BinaryOperatorKind::Null },
+		/* OpAnd               */ { 2, BinaryOperatorKind::Logic },
+		/* OpOr                */ { 1, BinaryOperatorKind::Logic },
+		/* OpBitwiseNot        */ { 0, BinaryOperatorKind::Null },
+		/* OpBitwiseAnd        */ { 5, BinaryOperatorKind::Bitwise },
+		/* OpBitwiseOr         */ { 3, BinaryOperatorKind::Bitwise },
+		/* OpBitwiseXor        */ { 4, BinaryOperatorKind::Bitwise },
+		/* OpBitwiseLeftShift  */ { 8, BinaryOperatorKind::Bitwise },
+		/* OpBitwiseRightShift */ { 8, BinaryOperatorKind::Bitwise },
+	};
+	static constexpr size_t s_BinaryOperatorsCount = sizeof(s_BinaryOperators) / sizeof(s_BinaryOperators[0]);
+	static_assert(s_BinaryOperatorsCount == static_cast<size_t>(Lexeme::Type::OpBitwiseRightShift) - static_cast<size_t>(Lexeme::Type::OpAssignment) + 1
+		, "Binary operators table does not match the lexeme types.");
+
+	CRINL static BinaryOperator FindBinaryOperator(Lexeme::Type const type)
 	{
-		auto expr = Parse_Expression_Multiply_OR_Divide_OR_Modulo();
-		while (m_Lexeme == Lexeme::Type::OpAdd || m_Lexeme == Lexeme::Type::OpSubtract)
-		{
-			auto const op = m_Lexeme.GetType();
-			ReadNextLexeme();
-			expr = ParseHelper_Expression_ArithmeticBinary(op, expr, Parse_Expression_Multiply_OR_Divide_OR_Modulo());
-		}
-		return expr;
+		auto const index = static_cast<size_t>(type) - static_cast<size_t>(Lexeme::Type::OpAssignment);
+		return index < s_BinaryOperatorsCount ? s_BinaryOperators[index] : BinaryOperator{ 0, BinaryOperatorKind::Null };
 	}
+
+	// { BINARY-EXPR ::= <PREF-UNARY-EXPR> [@ <PREF-UNARY-EXPR>] }
+	// Binary operators are parsed by precedence climbing: a single call per operand instead of the call per 
+	// precedence level. Operators are left-associative, so the right operand only takes tighter operators.
 	// *************************************************************** //
-	CR_INTERNAL Ast::Expression* Parser::Parse_Expression_Multiply_OR_Divide_OR_Modulo()
+	CR_INTERNAL Ast::Expression* Parser::Parse_Expression_Binary(uint32_t const minPrecedence /*= 1*/)
 	{
 		auto expr = Parse_Expression_PrefixUnary();
-		while (m_Lexeme == Lexeme::Type::OpMultiply || m_Lexeme == Lexeme::Type::OpDivide || m_Lexeme == Lexeme::Type::OpModulo)
+		while (true)
 		{
 			auto const op = m_Lexeme.GetType();
+			auto const binaryOperator = FindBinaryOperator(op);
+			if (binaryOperator.m_Precedence < minPrecedence)
+			{
+				// Not a binary operator (zero precedence) or operator of the outer expression.
+				return expr;
+			}
+
 			ReadNextLexeme();
-			expr = ParseHelper_Expression_ArithmeticBinary(op, expr, Parse_Expression_PrefixUnary());
+			auto const rhs = Parse_Expression_Binary(binaryOperator.m_Precedence + 1u);
+			switch (binaryOperator.m_Kind)
+			{
+				case BinaryOperatorKind::Logic:
+					expr = ParseHelper_Expression_LogicBinary(op, expr, rhs);
+					break;
+				case BinaryOperatorKind::Bitwise:
+					expr = ParseHelper_Expression_BitwiseBinary(op, expr, rhs);
+					break;
+				case BinaryOperatorKind::Arithmetic:
+					expr = ParseHelper_Expression_ArithmeticBinary(op, expr, rhs);
+					break;
+				default:
+					CrAssert(0);
+					break;
+			}
 		}
-		return expr;
 	}
 
 	// --------------------------------------------------------------- //
@@ -1365,7 +1353,7 @@ namespace Cr
 		auto const negExpr = m_Profile->CreateNegateExpression(Parse_Expression_PrefixUnary());
 		negExpr->m_Type = negExpr->m_Expr->GetType();
 		negExpr->m_IsConstexpr = negExpr->m_Expr->IsConstexpr();
-		return negExpr;
+		return ParseHelper_Expression_Fold(negExpr);
 	}
 	// *************************************************************** //
 	CR_INTERNAL Ast::Expression* Parser::Parse_Expression_PrefixUnary_Not()
@@ -1374,7 +1362,7 @@ namespace Cr
 		auto const notExpr = m_Profile->CreateNotExpression(Parse_Expression_PrefixUnary());
 		notExpr->m_Type = Ast::Type(Ast::BaseType::Bool, notExpr->m_Expr->GetType());
 		notExpr->m_IsConstexpr = notExpr->m_Expr->IsConstexpr();
-		return notExpr;
+		return ParseHelper_Expression_Fold(notExpr);
 	}
 	// *************************************************************** //
 	CR_INTERNAL Ast::Expression* Parser::Parse_Expression_PrefixUnary_BitwiseNot()
@@ -1384,10 +1372,10 @@ namespace Cr
 		bitwiseNotExpr->m_Type = bitwiseNotExpr->m_Expr->GetType();
 		bitwiseNotExpr->m_IsConstexpr = bitwiseNotExpr->m_Expr->IsConstexpr();
 		VerifyTypeIntegral(bitwiseNotExpr->m_Expr->GetType());
-		return bitwiseNotExpr;
+		return ParseHelper_Expression_Fold(bitwiseNotExpr);
 	}
 
-	// { <PAREN-OR-CAST-EXPR> ::= (<TYPE>)<expression>
+	// { <PAREN-OR-CAST-EXPR> ::= (<TYPE>)<PREF-UNARY-EXPR>
 	//                          | (<expression>)  }
 	// *************************************************************** //
 	CR_INTERNAL Ast::Expression* Parser::Parse_Expression_PrefixUnary_Cast_OR_Paren()
@@ -1399,7 +1387,10 @@ namespace Cr
 		{
 			/// @todo Validate types.
 			ReadNextLexeme(Lexeme::Type::OpParenClose);
-			return new Ast::CastExpression(castToType, Parse_Expression());
+			auto const castExpr = m_Profile->CreateCastExpression(castToType, Parse_Expression_PrefixUnary());
+			castExpr->m_Type = castToType;
+			castExpr->m_IsConstexpr = castExpr->m_Expr->IsConstexpr() && !castToType.IsStruct();
+			return ParseHelper_Expression_Fold(castExpr);
 		}
 		return Parse_Expression_PrefixUnary_Paren();
 	}
@@ -1431,7 +1422,7 @@ namespace Cr
 					{
 						throw ParserException("Variable expected.");
 					}
-					auto const identExpr = new Ast::IdentifierExpression(var);
+					auto const identExpr = m_Profile->CreateIdentifierExpression(var);
 					identExpr->m_Type = var->m_Type;
 					identExpr->m_IsLValue = true;
 					ReadNextLexeme();
@@ -1467,7 +1458,7 @@ namespace Cr
 			// Or something strange.
 			// *************************************************************** //
 			default:
-				throw ParserException("Unexpected lexeme while parsing expression.");
+				throw ParserException("Unexpected lexeme while parsing expression.", m_Lexeme.GetOffset());
 		}
 	}
 	// *************************************************************** //
@@ -1481,8 +1472,8 @@ namespace Cr
 			auto const operandType = operandExpr->GetType();
 			if (operandType.IsStruct())
 			{
-				auto const subscriptExpr = new Ast::SubscriptExpression();
-				subscriptExpr->m_Expr.reset(operandExpr);
+				auto const subscriptExpr = m_Profile->CreateSubscriptExpression();
+				subscriptExpr->m_Expr = operandExpr;
 				subscriptExpr->m_Subscript = m_Lexeme.GetValueID();
 				ReadNextLexeme();
 
@@ -1562,8 +1553,8 @@ namespace Cr
 	// *************************************************************** //
 	CR_API void Parser::ParseProgram()
 	{
-		m_ScopedIdents.emplace_back();
-		m_Profile = new Profile();
+		m_ScopedIdents.PushScope();
+		m_Profile = m_Arena.New<Profile>(m_Arena);
 		CrLog(0, __FUNCSIG__);
 
 		ReadNextLexeme(Lexeme::Type::KwProgram);
@@ -1580,14 +1571,30 @@ namespace Cr
 				break;
 			}
 
-			auto s = Parse_Statement();
-			s = nullptr;
+			auto const stmt = Parse_Statement();
+			if (stmt != nullptr)
+			{
+				m_Program.PushBack(m_Arena, stmt);
+			}
+		}
+	}
+
+	CR_API Ast::Expression* Parser::ParseExpression()
+	{
+		m_ScopedIdents.PushScope();
+		m_Profile = m_Arena.New<Profile>(m_Arena);
+
+		auto const expr = Parse_Expression();
+		if (m_Lexeme != Lexeme::Type::Null)
+		{
+			throw ParserException("End of the expression expected.");
 		}
+		return expr;
 	}
 
 	CrUnitTest(ParserEmptyStream)
 	{
-		Parser parser(new Preprocessor(std::make_shared<IO::StringInputStream>(R"(
+		Preprocessor preprocessor(std::make_shared<IO::StringInputStream>(R"(
 program 
 {
 		struct A { int a; int b; };
@@ -1595,11 +1602,84 @@ program
 
 		A a;
 		B b;
-		a *= (int)a;
 }
-)")));
+)"));
+		Parser parser(&preprocessor);
 		parser.ParseProgram();
-		int i = 0;
+	};
+
+	CrUnitTest(ParserIncompatibleTypes)
+	{
+		// Structure is neither cast to the scalar, nor multiplied by it.
+		Preprocessor preprocessor(std::make_shared<IO::StringInputStream>(R"(
+program 
+{
+		struct A { int a; int b; };
+
+		A a;
+		a *= (int)a;
+}
+)"));
+		Parser parser(&preprocessor);
+		try
+		{
+			parser.ParseProgram();
+			CrAssert(0);
+		}
+		catch (ParserException const&)
+		{
+		}
+	};
+
+	CrUnitTest(ParserBinaryPrecedence)
+	{
+		auto const evaluate = [](char const* const text)
+		{
+			Preprocessor preprocessor(std::make_shared<IO::StringInputStream>(text));
+			Parser parser(&preprocessor);
+			return parser.ParseExpression()->Evaluate().To<int32_t>();
+		};
+
+		// Tighter operators are applied first, operators of the same precedence are left-associative.
+		CrAssert(evaluate("1 + 2 * 3") == 7 && evaluate("2 * 3 + 1") == 7);
+		CrAssert(evaluate("(1 + 2) << 2") == 12 && evaluate("1 << 2 + 1") == 8);
+		CrAssert(evaluate("1 << 2 << 3") == 32 && evaluate("64 >> 2 >> 1") == 8);
+		CrAssert(evaluate("3 > 2 > 1") == 0);
+		CrAssert(evaluate("1 | 2 ^ 3 & 1") == 3);
+		CrAssert(evaluate("1 + 1 == 2 && 3 < 2 || 4 > 3") == 1);
+		CrAssert(evaluate("1 + 2 * 3 - 8 / 2 % 3") == 6 && evaluate("(7 - 3) << 2") == 16);
+		CrAssert(evaluate("8 - 4 - 2") == 2 && evaluate("16 / 4 / 2") == 2);
+	};
+
+	CrUnitTest(ParserConstantFolding)
+	{
+		auto const fold = [](char const* const text, Ast::BaseType const baseType)
+		{
+			Preprocessor preprocessor(std::make_shared<IO::StringInputStream>(text));
+			Parser parser(&preprocessor);
+			auto const expr = dynamic_cast<Ast::ConstantExpression*>(parser.ParseExpression());
+			CrAssert(expr != nullptr && expr->GetType().GetBaseType() == baseType);
+			auto const value = expr->Evaluate();
+			CrAssert(value.GetBaseType() == baseType && value.IsScalar());
+			return value;
+		};
+
+		// Cast binds tighter than the binary operators.
+		CrAssert(fold("(float)7 / 2", Ast::BaseType::Float).To<float>() == 3.5f);
+		CrAssert(fold("(int)2.5f * 2", Ast::BaseType::Int).To<int32_t>() == 4);
+
+		CrAssert(fold("2147483647 + 1", Ast::BaseType::Int).To<int32_t>() == INT32_MIN);
+		CrAssert(fold("0xFFFFFFFFu >> 28", Ast::BaseType::UInt).To<uint32_t>() == 15);
+		CrAssert(fold("1 < 2 ? 10 : 20", Ast::BaseType::Int).To<int32_t>() == 10);
+		CrAssert(fold("-(3.5f * 2.0f)", Ast::BaseType::Float).To<float>() == -7.0f);
+
+		// Floating point division by zero is folded, the integral one is left unfolded.
+		CrAssert(std::isinf(fold("1.0 / 0.0", Ast::BaseType::Double).To<double>()));
+		CrAssert(fold("1 < 2 ? 10 : 1 / 0", Ast::BaseType::Int).To<int32_t>() == 10);
+		Preprocessor preprocessor(std::make_shared<IO::StringInputStream>("1 / 0"));
+		Parser parser(&preprocessor);
+		auto const expr = parser.ParseExpression();
+		CrAssert(expr->IsConstexpr() && dynamic_cast<Ast::ConstantExpression*>(expr) == nullptr);
 	};
 
 }	// namespace Cr
@@ -15,8 +15,7 @@
 
 #include "Preprocessor.h"
 #include "AST.h"
-
-#include <list>
+#include "ScopedSymbolTable.h"
 
 namespace Cr
 {
@@ -39,27 +38,58 @@ namespace Cr
 		
 		CR_API void ParseProgram();
 
+		/**
+		 * Parses the single expression, that takes the whole stream.
+		 * Nodes of the expression are owned by the parser.
+		 */
+		CR_API Ast::Expression* ParseExpression();
+
+		/**
+		 * Returns the top-level statements of the parsed program.
+		 */
+		CRINL ArenaVector<Ast::Statement*> const& GetProgram() const
+		{
+			return m_Program;
+		}
+
 	private:
+		Arena           m_Arena;	///< Owns all nodes of the parsed tree.
+		ArenaVector<Ast::Statement*> m_Program;
 		Profile*        m_Profile;
 		Preprocessor*   m_Preprocesser;
 		Lexeme          m_Lexeme;
+		Lexeme          m_LexemesChunk[64];	///< Lexemes are pulled from the preprocessor in chunks.
+		size_t          m_LexemesChunkCursor = 0;
+		size_t          m_LexemesChunkSize = 0;
 		Ast::Function*  m_Function;
 		Ast::Statement* m_JumpOnBreak;
 		Ast::Statement* m_JumpOnContinue;
-		std::list<std::map<std::string, std__shared_ptr<Ast::Identifier>>> m_ScopedIdents;
+		ScopedSymbolTable m_ScopedIdents;
 
-		CRINL Ast::Identifier* FindIdentifier(std::string const& name)
+		CRINL Ast::Identifier* FindIdentifier(Symbol const name) const
+		{
+			return m_ScopedIdents.Find(name);
+		}
+		CRINL Ast::Identifier* FindIdentifier() const
 		{
-			return m_ScopedIdents.back()[name];
+			return m_ScopedIdents.Find(m_Lexeme.GetValueID());
 		}
-		CRINL Ast::Identifier* FindIdentifier()
+
+		/**
+		 * Throws if the identifier with the specified name was already declared in the current scope.
+		 * Identifiers of the outer scopes may be shadowed.
+		 */
+		CRINL void ExpectUndeclaredIdentifier(Symbol const name) const
 		{
-			return m_ScopedIdents.back()[m_Lexeme.GetValueID()];
+			if (m_ScopedIdents.FindInCurrentScope(name) != nullptr)
+			{
+				throw ParserException("Identifier redeclaration.");
+			}
 		}
 
 		CRINL void DeclareVariable(Ast::Variable* const var)
 		{
-			m_ScopedIdents.back()[var->m_Name] = var;
+			m_ScopedIdents.Declare(var->m_Name, var);
 		}
 
 		CR_INTERNAL void ReadNextLexeme();
@@ -89,9 +119,9 @@ namespace Cr
 		CR_INTERNAL Ast::Statement* Parse_Statement_Expression();
 		CR_INTERNAL Ast::Statement* Parse_Statement_Scoped()
 		{
-			m_ScopedIdents.emplace_back();
+			m_ScopedIdents.PushScope();
 			auto const stmt = Parse_Statement();
-			m_ScopedIdents.pop_back();
+			m_ScopedIdents.PopScope();
 			return stmt;
 		}
 
@@ -99,19 +129,11 @@ namespace Cr
 		CR_INTERNAL Ast::Expression* Parse_Expression_Comma();
 		CR_INTERNAL Ast::Expression* Parse_Expression_Assignments();
 		CR_INTERNAL Ast::Expression* Parse_Expression_Ternary();
+		CR_HELPER Ast::Expression* ParseHelper_Expression_Fold(Ast::Expression* const expr) const;
 		CR_HELPER Ast::Expression* ParseHelper_Expression_LogicBinary(Lexeme::Type const op, Ast::Expression* const lhs, Ast::Expression* const rhs) const;
 		CR_HELPER Ast::Expression* ParseHelper_Expression_BitwiseBinary(Lexeme::Type const op, Ast::Expression* const lhs, Ast::Expression* const rhs) const;
 		CR_HELPER Ast::Expression* ParseHelper_Expression_ArithmeticBinary(Lexeme::Type const op, Ast::Expression* const lhs, Ast::Expression* const rhs) const;
-		CR_INTERNAL Ast::Expression* Parse_Expression_Or();
-		CR_INTERNAL Ast::Expression* Parse_Expression_And();
-		CR_INTERNAL Ast::Expression* Parse_Expression_BitwiseOr();
-		CR_INTERNAL Ast::Expression* Parse_Expression_BitwiseXor();
-		CR_INTERNAL Ast::Expression* Parse_Expression_BitwiseAnd();
-		CR_INTERNAL Ast::Expression* Parse_Expression_Equals_OR_NotEquals();
-		CR_INTERNAL Ast::Expression* Parse_Expression_Less_OR_LessEquals_OR_Greater_OR_GreaterEquals();
-		CR_INTERNAL Ast::Expression* Parse_Expression_BitwiseLeftShift_OR_BitwiseRightShift();
-		CR_INTERNAL Ast::Expression* Parse_Expression_Add_OR_Subtract();
-		CR_INTERNAL Ast::Expression* Parse_Expression_Multiply_OR_Divide_OR_Modulo();
+		CR_INTERNAL Ast::Expression* Parse_Expression_Binary(uint32_t const minPrecedence = 1);
 		CR_INTERNAL Ast::Expression* Parse_Expression_PrefixUnary();
 		CR_INTERNAL Ast::Expression* Parse_Expression_PrefixUnary_Plus();
 		CR_INTERNAL Ast::Expression* Parse_Expression_PrefixUnary_Negate();
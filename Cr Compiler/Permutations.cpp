@@ -0,0 +1,207 @@
+// $$***************************************************************$$ //
+//                                                                     //
+//                  Goddamn "C for Rendering" project                  //
+//     Copyright (C) Goddamn Industries 2016. All Rights Reserved.     //
+//          ( https://github.com/GoddamnIndustries/GoddamnCr )         //
+//                                                                     //
+//    This software or any its part is distributed under the terms of  //
+//   Goddamn Industries End User License Agreement. By downloading or  //
+//   using this software or any its part you agree with the terms of   //
+//   Goddamn Industries End User License Agreement.                    //
+//                                                                     //
+// $$***************************************************************$$ //
+
+
+#include "Permutations.h"
+
+#include <map>
+
+namespace Cr
+{
+	// *************************************************************** //
+	// **        PermutationPreprocessor class implementation.      ** //
+	// *************************************************************** //
+
+	/**
+	 * Initializes a new preprocessor and tokenizes the specified stream.
+	 */
+	CR_API PermutationPreprocessor::PermutationPreprocessor(IO::PInputStream const& inputStream)
+	{
+		CrAssert(inputStream != nullptr);
+		Scanner scanner(inputStream);
+		m_File.Tokenize(scanner);
+	}
+
+	/**
+	 * Adds the directory to search the included files in.
+	 */
+	CR_API void PermutationPreprocessor::AddIncludeDirectory(char const* const directory)
+	{
+		CrAssert(directory != nullptr);
+		m_IncludeDirectories.emplace_back(directory);
+	}
+
+	/**
+	 * Preprocesses the source under each of the dictionaries.
+	 * Dictionary is preprocessed only if it differs from each earlier preprocessed one in any macro that was
+	 * observed by that run, otherwise output of the run is shared.
+	 */
+	CR_API std::vector<PreprocessedPermutation> PermutationPreprocessor::Preprocess(std::vector<MacroDictionary> const& dictionaries)
+	{
+		// Interning the dictionaries by the macro names, definitions of the undefined macros are null.
+		// Definitions keep the parameter lists, so the function-like and object-like macros differ.
+		std::unordered_set<Symbol> observableMacros;
+		std::vector<std::unordered_map<Symbol, MacroDictionary::value_type const*>> definitions(dictionaries.size());
+		for (size_t index = 0; index < dictionaries.size(); ++index)
+		{
+			for (auto const& macro : dictionaries[index])
+			{
+				auto const name = SymbolTable::Global().Intern(macro.first.substr(0, macro.first.find('(')).c_str());
+				observableMacros.insert(name);
+				definitions[index][name] = &macro;
+			}
+		}
+		auto const isSameDefinition = [&definitions](size_t const first, size_t const second, Symbol const name)
+		{
+			auto const firstDefinition = definitions[first].find(name);
+			auto const secondDefinition = definitions[second].find(name);
+			if (firstDefinition == definitions[first].end() || secondDefinition == definitions[second].end())
+			{
+				return firstDefinition == definitions[first].end() && secondDefinition == definitions[second].end();
+			}
+			return *firstDefinition->second == *secondDefinition->second;
+		};
+
+		struct Run
+		{
+			size_t                     m_Permutation;
+			std::unordered_set<Symbol> m_ObservedMacros;
+		};	// struct Run
+		std::vector<Run> runs;
+		std::unordered_set<Symbol> affectingMacros;
+		std::map<SourceOffset, std::vector<Symbol>> conditionDependencies;
+
+		std::vector<PreprocessedPermutation> permutations(dictionaries.size());
+		for (size_t index = 0; index < dictionaries.size(); ++index)
+		{
+			// Sharing the output of the run, which observed macros are defined the same way.
+			auto const run = std::find_if(runs.begin(), runs.end(), [&](Run const& run)
+			{
+				return std::all_of(run.m_ObservedMacros.begin(), run.m_ObservedMacros.end(), [&](Symbol const name)
+				{
+					return isSameDefinition(run.m_Permutation, index, name);
+				});
+			});
+			if (run != runs.end())
+			{
+				permutations[index].m_SharedWith = run->m_Permutation;
+				continue;
+			}
+
+			Preprocessor preprocessor(m_File);
+			for (auto const& directory : m_IncludeDirectories)
+			{
+				preprocessor.AddIncludeDirectory(directory.c_str());
+			}
+			for (auto const& macro : dictionaries[index])
+			{
+				preprocessor.DefineMacro(macro.first.c_str(), macro.second.c_str());
+			}
+			preprocessor.RecordDependencies(std::unordered_set<Symbol>(observableMacros));
+			auto& lexemes = permutations[index].m_Lexemes;
+			for (auto lexeme = preprocessor.GetNextLexeme(); lexeme != Lexeme::Type::Null; lexeme = preprocessor.GetNextLexeme())
+			{
+				lexemes.push_back(lexeme);
+			}
+
+			for (auto const& dependency : preprocessor.GetConditionDependencies())
+			{
+				auto& macros = conditionDependencies[dependency.m_Location];
+				macros.insert(macros.end(), dependency.m_Macros.begin(), dependency.m_Macros.end());
+			}
+			affectingMacros.insert(preprocessor.GetObservedMacros().begin(), preprocessor.GetObservedMacros().end());
+			runs.push_back({ index, preprocessor.GetObservedMacros() });
+		}
+
+		m_AffectingMacros.assign(affectingMacros.begin(), affectingMacros.end());
+		std::sort(m_AffectingMacros.begin(), m_AffectingMacros.end());
+		m_ConditionDependencies.clear();
+		for (auto& dependency : conditionDependencies)
+		{
+			auto& macros = dependency.second;
+			std::sort(macros.begin(), macros.end());
+			macros.erase(std::unique(macros.begin(), macros.end()), macros.end());
+			m_ConditionDependencies.push_back({ dependency.first, std::move(macros) });
+		}
+		return permutations;
+	}
+
+	// *************************************************************** //
+	// **         PermutationPreprocessor class unit tests.         ** //
+	// *************************************************************** //
+
+	CrUnitTest(PermutationPreprocessor)
+	{
+		PermutationPreprocessor preprocessor(std::make_shared<IO::StringInputStream>(R"(#ifdef USE_FOG
+fog
+#endif
+#if defined(USE_SHADOWS) && defined(USE_FOG)
+shadows
+#endif
+COLOR)"));
+		auto const permutations = preprocessor.Preprocess({
+			{ { "USE_FOG", "1" }, { "COLOR", "red" } },
+			{ { "USE_FOG", "1" }, { "COLOR", "red" }, { "UNUSED", "1" } },
+			{ { "COLOR", "red" } },
+			{ { "USE_FOG", "1" }, { "USE_SHADOWS", "1" }, { "COLOR", "blue" } },
+			{ { "COLOR", "red" }, { "UNUSED", "2" } },
+		});
+		auto const toString = [&permutations](size_t index)
+		{
+			std::string result;
+			for (auto const& lexeme : permutations[index].m_Lexemes)
+			{
+				result.append(lexeme.GetText(), lexeme.GetLength());
+			}
+			return result;
+		};
+		CrAssert(permutations.size() == 5);
+		CrAssert(toString(0) == "fogred" && permutations[0].m_SharedWith == SIZE_MAX);
+		CrAssert(permutations[1].m_SharedWith == 0);
+		CrAssert(toString(2) == "red" && permutations[2].m_SharedWith == SIZE_MAX);
+		CrAssert(toString(3) == "fogshadowsblue" && permutations[3].m_SharedWith == SIZE_MAX);
+		CrAssert(permutations[4].m_SharedWith == 2);
+
+		auto& symbols = SymbolTable::Global();
+		std::vector<Symbol> affectingMacros = { symbols.Intern("USE_FOG"), symbols.Intern("USE_SHADOWS"), symbols.Intern("COLOR") };
+		std::sort(affectingMacros.begin(), affectingMacros.end());
+		CrAssert(preprocessor.GetAffectingMacros() == affectingMacros);
+
+		auto const& dependencies = preprocessor.GetConditionDependencies();
+		CrAssert(dependencies.size() == 2);
+		CrAssert(dependencies[0].m_Macros == std::vector<Symbol>{ symbols.Intern("USE_FOG") });
+		CrAssert(dependencies[1].m_Macros.size() == 2);
+	};
+
+	CrUnitTest(PermutationPreprocessorFunctionLikeMacros)
+	{
+		// Function-like and object-like definitions of the same name are different definitions.
+		PermutationPreprocessor preprocessor(std::make_shared<IO::StringInputStream>("F(2)"));
+		auto const permutations = preprocessor.Preprocess({
+			{ { "F(x)", "1" } },
+			{ { "F", "1" } },
+		});
+		auto const toString = [&permutations](size_t index)
+		{
+			std::string result;
+			for (auto const& lexeme : permutations[index].m_Lexemes)
+			{
+				result.append(lexeme.GetText(), lexeme.GetLength());
+			}
+			return result;
+		};
+		CrAssert(toString(0) == "1" && permutations[0].m_SharedWith == SIZE_MAX);
+		CrAssert(toString(1) == "1(2)" && permutations[1].m_SharedWith == SIZE_MAX);
+	};
+
+}	// namespace Cr
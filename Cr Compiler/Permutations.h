@@ -0,0 +1,91 @@
+// $$***************************************************************$$ //
+//                                                                     //
+//                  Goddamn "C for Rendering" project                  //
+//     Copyright (C) Goddamn Industries 2016. All Rights Reserved.     //
+//          ( https://github.com/GoddamnIndustries/GoddamnCr )         //
+//                                                                     //
+//    This software or any its part is distributed under the terms of  //
+//   Goddamn Industries End User License Agreement. By downloading or  //
+//   using this software or any its part you agree with the terms of   //
+//   Goddamn Industries End User License Agreement.                    //
+//                                                                     //
+// $$***************************************************************$$ //
+
+
+#pragma once
+#include "Preprocessor.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Cr
+{
+	/**
+	 * Names and values of the macros that are defined before the source is preprocessed.
+	 */
+	typedef std::vector<std::pair<std::string, std::string>> MacroDictionary;
+
+	/**
+	 * Preprocessed source under one of the macro dictionaries.
+	 */
+	struct PreprocessedPermutation
+	{
+		std::vector<Lexeme> m_Lexemes;				///< Empty if the output is shared.
+		size_t              m_SharedWith = SIZE_MAX;///< Index of the earlier permutation with the same output.
+	};	// struct PreprocessedPermutation
+
+	/**
+	 * Preprocesses one source under the several macro dictionaries.
+	 * Source is tokenized once. Each run records the dictionary macros it has observed through the conditions
+	 * and the expansions, and dictionaries that agree on all the observed macros of the earlier run share its output.
+	 */
+	class PermutationPreprocessor final
+	{
+	private:
+		TokenizedFile                    m_File;
+		std::vector<std::string>         m_IncludeDirectories;
+		std::vector<Symbol>              m_AffectingMacros;
+		std::vector<ConditionDependency> m_ConditionDependencies;
+
+	public:
+		PermutationPreprocessor(PermutationPreprocessor const&) = delete;
+		PermutationPreprocessor& operator= (PermutationPreprocessor const&) = delete;
+
+		/**
+		 * Initializes a new preprocessor and tokenizes the specified stream.
+		 */
+		CR_API explicit PermutationPreprocessor(IO::PInputStream const& inputStream);
+
+		/**
+		 * Adds the directory to search the included files in.
+		 */
+		CR_API void AddIncludeDirectory(char const* directory);
+
+		/**
+		 * Preprocesses the source under each of the dictionaries.
+		 * @returns Preprocessed permutations in the order of dictionaries.
+		 */
+		CR_API std::vector<PreprocessedPermutation> Preprocess(std::vector<MacroDictionary> const& dictionaries);
+
+		/**
+		 * Returns the sorted names of the dictionary macros that affected the output of the last 'Preprocess' call.
+		 * Permutations that differ in the other macros only are the same.
+		 */
+		CRINL std::vector<Symbol> const& GetAffectingMacros() const
+		{
+			return m_AffectingMacros;
+		}
+
+		/**
+		 * Returns the conditions of the last 'Preprocess' call with the macros they depend on.
+		 * Each condition is reported once, with the macros it observed in any of the runs.
+		 */
+		CRINL std::vector<ConditionDependency> const& GetConditionDependencies() const
+		{
+			return m_ConditionDependencies;
+		}
+
+	};	// class PermutationPreprocessor
+
+}	// namespace Cr
@@ -0,0 +1,179 @@
+// $$***************************************************************$$ //
+//                                                                     //
+//                  Goddamn "C for Rendering" project                  //
+//     Copyright (C) Goddamn Industries 2016. All Rights Reserved.     //
+//          ( https://github.com/GoddamnIndustries/GoddamnCr )         //
+//                                                                     //
+//    This software or any its part is distributed under the terms of  //
+//   Goddamn Industries End User License Agreement. By downloading or  //
+//   using this software or any its part you agree with the terms of   //
+//   Goddamn Industries End User License Agreement.                    //
+//                                                                     //
+// $$***************************************************************$$ //
+
+
+#include "PreprocessedOutput.h"
+
+#include <cctype>
+#include <cstring>
+
+namespace Cr
+{
+	// *************************************************************** //
+	// **           PreprocessedWriter class implementation.        ** //
+	// *************************************************************** //
+
+	/**
+	 * Maximal number of the skipped lines that are written as the empty lines instead of the line marker.
+	 */
+	static uint32_t const s_MaxPaddingLines = 8;
+
+	/**
+	 * Initializes a new preprocessed writer.
+	 * @param writer Writer the preprocessed text is written to.
+	 */
+	CR_API PreprocessedWriter::PreprocessedWriter(IO::BufferedWriter& writer)
+		: m_Writer(writer)
+	{
+	}
+
+	/**
+	 * Preprocesses all remaining lines of the preprocessor and writes them.
+	 */
+	CR_API void PreprocessedWriter::Write(Preprocessor& preprocessor)
+	{
+		preprocessor.SetDoWriteNewLines(true);
+		Lexeme lexemes[256];
+		for (;;)
+		{
+			auto const count = preprocessor.GetNextLexemes(lexemes, sizeof lexemes / sizeof lexemes[0]);
+			for (size_t i = 0; i < count; ++i)
+			{
+				switch (lexemes[i].GetType())
+				{
+					case Lexeme::Type::Null:
+						return;
+					case Lexeme::Type::NewLine:
+						WriteLine(lexemes[i]);
+						break;
+					default:
+						WriteLexeme(lexemes[i]);
+						break;
+				}
+			}
+		}
+	}
+
+	/**
+	 * Appends the lexeme to the current line.
+	 * Space is written before the lexeme if it was preceded with whitespace, or if it would be scanned together with the
+	 * previous lexeme otherwise: identifiers, keywords and constants should not touch each other, and neither should the operators,
+	 * except the brackets and separators.
+	 */
+	CR_INTERNAL void PreprocessedWriter::WriteLexeme(Lexeme const& lexeme)
+	{
+		auto const text = lexeme.GetText();
+		if (!m_Line.empty())
+		{
+			auto const isWordCharacter = [](char const c)
+			{
+				return isalnum(static_cast<unsigned char>(c)) || c == '_';
+			};
+			auto const isOperatorCharacter = [](char const c)
+			{
+				return c != '\0' && strchr("+-*/%<>=!&|^~.:#?", c) != nullptr;
+			};
+			auto const previous = m_Line.back();
+			if (lexeme.HasFlags(Lexeme::FlagsLeadingSpace)
+				|| (isWordCharacter(previous) && (isWordCharacter(*text) || (*text == '.' && lexeme.GetLength() > 1)))
+				|| (previous == '.' && isdigit(static_cast<unsigned char>(*text)))
+				|| (isOperatorCharacter(previous) && isOperatorCharacter(*text)))
+			{
+				m_Line.push_back(' ');
+			}
+		}
+		m_Line.append(text, lexeme.GetLength());
+	}
+
+	/**
+	 * Writes the current line, which has ended at the location of the new line lexeme.
+	 * Lines that follow the previous one closely are aligned with the empty lines, otherwise line marker is written.
+	 */
+	CR_INTERNAL void PreprocessedWriter::WriteLine(Lexeme const& newLine)
+	{
+		auto const location = SourceManager::Global().GetLocation(newLine.GetOffset());
+		if (m_FileName != location.m_Name || location.m_Line < m_LineNumber || location.m_Line > m_LineNumber + s_MaxPaddingLines)
+		{
+			WriteLineMarker(location);
+		}
+		for (; m_LineNumber < location.m_Line; ++m_LineNumber)
+		{
+			m_Writer.Write('\n');
+		}
+
+		m_Writer.Write(m_Line.data(), m_Line.size());
+		m_Writer.Write('\n');
+		m_Line.clear();
+		++m_LineNumber;
+	}
+
+	/**
+	 * Writes the line marker, so that the next line is reported at the specified location.
+	 */
+	CR_INTERNAL void PreprocessedWriter::WriteLineMarker(SourceLocation const& location)
+	{
+		char lineNumber[16];
+		snprintf(lineNumber, sizeof lineNumber, "%u", location.m_Line);
+		m_Writer.Write("#line ");
+		m_Writer.Write(lineNumber);
+		m_Writer.Write(" \"");
+		for (auto name = location.m_Name; *name != '\0'; ++name)
+		{
+			if (*name == '\\' || *name == '"')
+			{
+				m_Writer.Write('\\');
+			}
+			m_Writer.Write(*name);
+		}
+		m_Writer.Write("\"\n");
+
+		m_FileName = location.m_Name;
+		m_LineNumber = location.m_Line;
+	}
+
+	// *************************************************************** //
+	// **              PreprocessedWriter class unit tests.         ** //
+	// *************************************************************** //
+
+	CrUnitTest(PreprocessedWriter)
+	{
+		HeaderCache::Global().AddFile("PreprocessedOutput/included.fxh", "b\nc\n");
+		Preprocessor preprocessor(std::make_shared<IO::StringInputStream>(R"(#define COLOR(x) float4(x, x, x, 1)
+float4 main() : SV_Target
+{
+
+
+	return COLOR(0.5)+-a.b;
+}
+#include "PreprocessedOutput/included.fxh"
+a)"));
+		std::string result;
+		{
+			IO::BufferedWriter writer(result);
+			PreprocessedWriter(writer).Write(preprocessor);
+		}
+		CrAssert(result == "#line 2 \"<memory>\"\n"
+			"float4 main() : SV_Target\n"
+			"{\n"
+			"\n"
+			"\n"
+			"return float4(0.5, 0.5, 0.5, 1)+ -a.b;\n"
+			"}\n"
+			"#line 1 \"PreprocessedOutput/included.fxh\"\n"
+			"b\n"
+			"c\n"
+			"#line 9 \"<memory>\"\n"
+			"a\n");
+	};
+
+}	// namespace Cr
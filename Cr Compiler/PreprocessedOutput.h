@@ -0,0 +1,57 @@
+// $$***************************************************************$$ //
+//                                                                     //
+//                  Goddamn "C for Rendering" project                  //
+//     Copyright (C) Goddamn Industries 2016. All Rights Reserved.     //
+//          ( https://github.com/GoddamnIndustries/GoddamnCr )         //
+//                                                                     //
+//    This software or any its part is distributed under the terms of  //
+//   Goddamn Industries End User License Agreement. By downloading or  //
+//   using this software or any its part you agree with the terms of   //
+//   Goddamn Industries End User License Agreement.                    //
+//                                                                     //
+// $$***************************************************************$$ //
+
+
+#pragma once
+#include "Preprocessor.h"
+
+#include <string>
+
+namespace Cr
+{
+	/**
+	 * Writes the preprocessed source as text.
+	 * Each preprocessed line is written as one line, lexemes are separated with single spaces where the source had
+	 * whitespace or where adjacent lexemes would be scanned as one. Line markers are written when the source file changes
+	 * or the lines skip too far to be padded with the empty lines.
+	 */
+	class PreprocessedWriter final
+	{
+	private:
+		IO::BufferedWriter& m_Writer;
+		std::string         m_Line;
+		std::string         m_FileName;
+		uint32_t            m_LineNumber = 0;
+
+	public:
+		PreprocessedWriter(PreprocessedWriter const&) = delete;
+		PreprocessedWriter& operator= (PreprocessedWriter const&) = delete;
+
+		/**
+		 * Initializes a new preprocessed writer.
+		 * @param writer Writer the preprocessed text is written to.
+		 */
+		CR_API explicit PreprocessedWriter(IO::BufferedWriter& writer);
+
+		/**
+		 * Preprocesses all remaining lines of the preprocessor and writes them.
+		 */
+		CR_API void Write(Preprocessor& preprocessor);
+
+	private:
+		CR_INTERNAL void WriteLexeme(Lexeme const& lexeme);
+		CR_INTERNAL void WriteLine(Lexeme const& newLine);
+		CR_INTERNAL void WriteLineMarker(SourceLocation const& location);
+	};	// class PreprocessedWriter
+
+}	// namespace Cr
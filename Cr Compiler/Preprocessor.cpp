@@ -11,17 +11,185 @@
 //                                                                     //
 // $$***************************************************************$$ //
 
-/// @todo Implement functional macros.
-/// @todo Implement correct nested macro substitution.
-/// @todo Implement "##" and @#" operators for macros expansions.
 #include "Preprocessor.h"
 
+#include <algorithm>
+#include <iterator>
+
 namespace Cr
 {
+	// *************************************************************** //
+	// **             HideSetTable class implementation.            ** //
+	// *************************************************************** //
+
+	/**
+	 * Initializes the table with the empty set.
+	 */
+	CR_API HideSetTable::HideSetTable()
+	{
+		Intern({});
+	}
+
+	/**
+	 * Returns identifier of the set with the specified sorted symbols.
+	 */
+	CR_INTERNAL HideSet HideSetTable::Intern(std::vector<Symbol>&& symbols)
+	{
+		auto const hideSet = m_SetsTable.find(symbols);
+		if (hideSet != m_SetsTable.end())
+		{
+			return hideSet->second;
+		}
+		auto const newHideSet = static_cast<HideSet>(m_Sets.size());
+		m_Sets.push_back(symbols);
+		m_SetsTable.emplace(std::move(symbols), newHideSet);
+		return newHideSet;
+	}
+
+	/**
+	 * Returns the set of the single symbol.
+	 */
+	CR_API HideSet HideSetTable::Make(Symbol const symbol)
+	{
+		return Intern({ symbol });
+	}
+
+	/**
+	 * Returns union of two sets.
+	 */
+	CR_API HideSet HideSetTable::Union(HideSet const first, HideSet const second)
+	{
+		if (first == second || second == EmptyHideSet)
+		{
+			return first;
+		}
+		if (first == EmptyHideSet)
+		{
+			return second;
+		}
+
+		auto const key = static_cast<uint64_t>(std::min(first, second)) << 32 | std::max(first, second);
+		auto const hideSet = m_Unions.find(key);
+		if (hideSet != m_Unions.end())
+		{
+			return hideSet->second;
+		}
+		std::vector<Symbol> symbols;
+		std::set_union(m_Sets[first].begin(), m_Sets[first].end(), m_Sets[second].begin(), m_Sets[second].end(), std::back_inserter(symbols));
+		return m_Unions[key] = Intern(std::move(symbols));
+	}
+
+	/**
+	 * Returns intersection of two sets.
+	 */
+	CR_API HideSet HideSetTable::Intersection(HideSet const first, HideSet const second)
+	{
+		if (first == second || second == EmptyHideSet)
+		{
+			return second;
+		}
+		if (first == EmptyHideSet)
+		{
+			return first;
+		}
+
+		auto const key = static_cast<uint64_t>(std::min(first, second)) << 32 | std::max(first, second);
+		auto const hideSet = m_Intersections.find(key);
+		if (hideSet != m_Intersections.end())
+		{
+			return hideSet->second;
+		}
+		std::vector<Symbol> symbols;
+		std::set_intersection(m_Sets[first].begin(), m_Sets[first].end(), m_Sets[second].begin(), m_Sets[second].end(), std::back_inserter(symbols));
+		return m_Intersections[key] = Intern(std::move(symbols));
+	}
+
 	// *************************************************************** //
 	// **            Preprocessor class implementation.             ** //
 	// *************************************************************** //
 
+	/**
+	 * Initializes a new preprocessor from the specified stream.
+	 */
+	CR_API Preprocessor::Preprocessor(IO::PInputStream const& inputStream)
+		: m_InputStream(inputStream)
+	{
+		CrAssert(inputStream != nullptr);
+		Scanner scanner(m_InputStream);
+		m_MainFile.Tokenize(scanner);
+		m_File = &m_MainFile;
+		ReadNextLexeme();
+	}
+
+	/**
+	 * Initializes a new preprocessor of the tokenized file, file is not tokenized again.
+	 */
+	CR_API Preprocessor::Preprocessor(TokenizedFile const& file)
+		: m_File(&file)
+	{
+		ReadNextLexeme();
+	}
+
+	/**
+	 * Initializes a new preprocessor that passes the already preprocessed lexemes.
+	 * Main file is empty, so no line is ever preprocessed.
+	 */
+	CR_API Preprocessor::Preprocessor(std::vector<Lexeme> const& lexemes)
+		: m_File(&m_MainFile)
+	{
+		m_MainFile.m_Lexemes.push_back(Lexeme(Lexeme::Type::Null));
+		ReadNextLexeme();
+		for (auto const& lexeme : lexemes)
+		{
+			m_LexemesPipe.PushBack(lexeme);
+		}
+	}
+
+	/**
+	 * Adds the directory to search the included files in.
+	 */
+	CR_API void Preprocessor::AddIncludeDirectory(char const* const directory)
+	{
+		CrAssert(directory != nullptr);
+		m_IncludeDirectories.emplace_back(directory);
+	}
+
+	/**
+	 * Defines the macro like the '#define <name> <value>' directive does.
+	 * Definition is tokenized into the scratch buffer and parsed with the directive parser.
+	 */
+	CR_API void Preprocessor::DefineMacro(char const* const name, char const* const value /*= "1"*/)
+	{
+		CrAssert(name != nullptr && value != nullptr);
+		CrAssert(m_IncludeStack.empty());
+		auto const definition = std::string(name) + ' ' + value;
+		auto const offset = SourceManager::Global().AddScratch(definition.data(), definition.size());
+		auto const text = SourceManager::Global().GetText(offset);
+		TokenizedFile definitionFile;
+		Scanner scanner(text, text + definition.size(), offset);
+		definitionFile.Tokenize(scanner);
+
+		auto const file = m_File;
+		auto const lexemeIndex = m_LexemeIndex;
+		auto const lexeme = m_Lexeme;
+		m_File = &definitionFile;
+		m_LexemeIndex = 0;
+		ReadNextLexeme();
+		Parse_Directive_Define();
+		m_File = file;
+		m_LexemeIndex = lexemeIndex;
+		m_Lexeme = lexeme;
+	}
+
+	/**
+	 * Starts recording the macros that are observed by the conditional directives and the macro expansions.
+	 */
+	CR_API void Preprocessor::RecordDependencies(std::unordered_set<Symbol>&& observableMacros)
+	{
+		m_DoRecordDependencies = true;
+		m_ObservableMacros = std::move(observableMacros);
+	}
+
 	/**
 	 * Checks whether current lexeme is of expected type and
 	 * reads next lexeme.
@@ -30,36 +198,29 @@ namespace Cr
 	{
 		if (m_Lexeme != type)
 		{
-			throw PreprocessorException("something was expected.");
+			throw PreprocessorException("something was expected.", m_Lexeme.GetOffset());
 		}
 	}
 
 	/**
-	 * Reads next lexeme from the specified stream.
+	 * Reads next lexeme from the tokenized translation unit.
+	 * Reading continues in the including file at the end of the included one. 
+	 * Null lexeme at the end of the translation unit is never passed.
 	 */
 	CRINL void Preprocessor::ReadNextLexeme()
 	{
-		if (m_LinePipe.empty())
+		m_Lexeme = m_File->m_Lexemes[m_LexemeIndex];
+		if (m_Lexeme != Lexeme::Type::Null)
 		{
-			// Reading line from file.
-			std::string line;
-			auto c = m_InputStream->ReadNextChar();
-			for (; c != '\n' && c != EOF; c = m_InputStream->ReadNextChar())
-			{
-				line.push_back(static_cast<char>(c));
-			}
-			auto const isEof = c == EOF;
-
-			// Lexing it.
-			Scanner scanner(std::make_shared<IO::StringInputStream>(line.c_str()));
-			for (auto lex = scanner.GetNextLexeme(); lex != Lexeme::Type::Null; lex = scanner.GetNextLexeme())
-			{
-				m_LinePipe.push_back(lex);
-			}
-			m_LinePipe.push_back(Lexeme(isEof ? Lexeme::Type::Null : Lexeme::Type::NewLine));
+			++m_LexemeIndex;
+		}
+		else if (!m_IncludeStack.empty())
+		{
+			m_File = m_IncludeStack.back().m_File;
+			m_LexemeIndex = m_IncludeStack.back().m_LexemeIndex;
+			m_IncludeStack.pop_back();
+			ReadNextLexeme();
 		}
-		m_Lexeme = m_LinePipe.front();
-		m_LinePipe.pop_front();
 	}
 	CRINL void Preprocessor::ReadNextLexeme(Lexeme::Type const type)
 	{
@@ -103,15 +264,21 @@ namespace Cr
 			switch (m_Lexeme.GetType())
 			{
 				// Compiler control processing.
-				/// @todo Implement this.
 				// ---------------------------------------------------
 				case Lexeme::Type::KwPpPragma:
 					ReadNextLexeme();
-					CrAssert(0);
+					Parse_Directive_Pragma();
 					break;
 				case Lexeme::Type::KwPpError:
 					ReadNextLexeme();
-					CrAssert(0);
+					Parse_Directive_Error();
+					break;
+
+				// Source file inclusion.
+				// ---------------------------------------------------
+				case Lexeme::Type::KwPpInclude:
+					ReadNextLexeme();
+					Parse_Directive_Include();
 					break;
 
 				// Macro preprocessing.
@@ -169,63 +336,184 @@ namespace Cr
 		} while (!isGlobalScope);
 	}
 
-	/// @todo Implement this correctly
+	// { PP-LINE ::= [<lexeme> .. <lexeme>] <newline> }
 	// *************************************************************** //
 	CR_INTERNAL void Preprocessor::Parse_OrdinaryLine()
 	{
-		//std::deque<Lexeme> substitutedLexemes;
-		//while (true)
-		//{
-		//	auto anyMacroSubstituted = false;
-		//	while (m_Lexeme != Lexeme::Type::NewLine)
-		//	{
-		//		if (m_DoWriteLexemes)
-		//		{
-		//			if (m_Lexeme == Lexeme::Type::IdIdentifier && m_Macros.count(m_Lexeme.GetValueID()) != 0)
-		//			{
-		//				// This is a macro substitution.
-		//				auto& macro = m_Macros[m_Lexeme.GetValueID()];
-		//				substitutedLexemes.insert(m_LexemesPipe.end(), macro.m_Lexemes.begin(), macro.m_Lexemes.end());
-		//				anyMacroSubstituted = true;
-		//			}
-		//			else
-		//			{
-		//				// This is an ordinary lexeme.
-		//				substitutedLexemes.push_back(m_Lexeme);
-		//			}
-		//		}
-		//		ReadNextLexeme();
-		//	}
-
-		//	if (!anyMacroSubstituted)
-		//	{
-		//		break;
-		//	}
-		//	m_LinePipe = std::move(substitutedLexemes);
-		//}
-		//ReadNextLexeme();
+		// Expanding macros of the line. Invocations of the function-like macros may continue on the next lines.
+		auto const& lexemes = m_File->m_Lexemes;
+		MacroInput input = { {}, lexemes.data() + m_LexemeIndex - 1, lexemes.data() + lexemes.size() - 1, false, false };
+		m_LineLexemes.clear();
+		ExpandLexemes(input, m_LineLexemes, true);
+		for (auto const& lexeme : m_LineLexemes)
+		{
+			m_LexemesPipe.PushBack(lexeme.m_Lexeme);
+		}
+		if (m_DoWriteNewLines && !m_LineLexemes.empty())
+		{
+			CrAssert(*input.m_Cursor == Lexeme::Type::NewLine);
+			m_LexemesPipe.PushBack(*input.m_Cursor);
+		}
 
-		while (m_Lexeme != Lexeme::Type::NewLine)
+		m_LexemeIndex = static_cast<size_t>(input.m_Cursor - lexemes.data());
+		ReadNextLexeme();
+		ReadNextLexeme(Lexeme::Type::NewLine);
+	}
+
+	/**
+	 * Skips the inactive block up to the '#elif', '#else' or '#endif' directive of the same nesting level.
+	 * Lines of the block are never parsed: only the indexed directive lines are visited to track the nesting.
+	 */
+	CR_INTERNAL void Preprocessor::SkipBlock()
+	{
+		auto const& lexemes = m_File->m_Lexemes;
+		auto const& directives = m_File->m_Directives;
+		auto directive = std::lower_bound(directives.begin(), directives.end(), static_cast<uint32_t>(m_LexemeIndex - 1));
+		for (size_t depth = 0; directive != directives.end(); ++directive)
 		{
-			if (m_DoWriteLexemes)
+			switch (lexemes[*directive + 1].GetType())
 			{
-				if (m_Lexeme == Lexeme::Type::IdIdentifier && m_Macros.count(m_Lexeme.GetValueID()) != 0)
-				{
-					// This is a macro substitution.
-					auto& macro = m_Macros[m_Lexeme.GetValueID()];
-					m_LexemesPipe.insert(m_LexemesPipe.end(), macro.m_Lexemes.begin(), macro.m_Lexemes.end());
-				}
-				else
+				case Lexeme::Type::KwIf:
+				case Lexeme::Type::KwPpIfdef:
+				case Lexeme::Type::KwPpIfndef:
+					++depth;
+					break;
+				case Lexeme::Type::KwPpEndif:
+					if (depth != 0)
+					{
+						--depth;
+						break;
+					}
+					// Matching '#endif' of the skipped block.
+				case Lexeme::Type::KwPpElif:
+				case Lexeme::Type::KwPpElse:
+					if (depth == 0)
+					{
+						// Reading the directive keyword, like the block parser does.
+						m_LexemeIndex = *directive + 1;
+						ReadNextLexeme();
+						return;
+					}
+					break;
+				default:
+					break;
+			}
+		}
+		throw PreprocessorException("Unexpected end of file while parsing inset preprocessor scope.");
+	}
+
+	// --------------------------------------------------------------- //
+	// --                   Source file inclusion.                  -- //
+	// --------------------------------------------------------------- //
+
+	// { PP-DIR-INCLUDE ::= #include "<path>" <newline>
+	//                    | #include <<path>> <newline> }
+	// *************************************************************** //
+	CR_INTERNAL void Preprocessor::Parse_Directive_Include()
+	{
+		static size_t const s_MaxIncludeDepth = 200;
+
+		// Parsing the path, spelling of the '<path>' form is taken from the source as is.
+		std::string path;
+		auto const directive = m_Lexeme;
+		auto const isAngled = m_Lexeme == Lexeme::Type::OpLess;
+		if (m_Lexeme == Lexeme::Type::CtString)
+		{
+			path.assign(m_Lexeme.GetText() + 1, m_Lexeme.GetLength() - 2);
+			ReadNextLexeme();
+		}
+		else if (isAngled)
+		{
+			auto const pathBegin = m_Lexeme.GetText() + 1;
+			for (ReadNextLexeme(); m_Lexeme != Lexeme::Type::OpGreater; ReadNextLexeme())
+			{
+				if (m_Lexeme == Lexeme::Type::NewLine)
 				{
-					// This is an ordinary lexeme.
-					m_LexemesPipe.push_back(m_Lexeme);
+					throw PreprocessorException("Missing '>' in the '#include' directive.", directive.GetOffset());
 				}
 			}
+			path.assign(pathBegin, m_Lexeme.GetText());
+			ReadNextLexeme();
+		}
+		else
+		{
+			throw PreprocessorException("Expected file name in the '#include' directive.", directive.GetOffset());
+		}
+		ExpectLexeme(Lexeme::Type::NewLine);
+
+		// Searching the file relatively to the including file, then in the include directories.
+		TokenizedFile const* file = nullptr;
+		if (!isAngled)
+		{
+			auto const& includingPath = m_File->m_Path;
+			auto const separator = includingPath.find_last_of("/\\");
+			file = HeaderCache::Global().Find(separator != std::string::npos ? includingPath.substr(0, separator + 1) + path : path);
+		}
+		for (auto directory = m_IncludeDirectories.begin(); file == nullptr && directory != m_IncludeDirectories.end(); ++directory)
+		{
+			file = HeaderCache::Global().Find(*directory + '/' + path);
+		}
+		if (file == nullptr)
+		{
+			throw PreprocessorException(("Cannot open the included file '" + path + "'.").c_str(), directive.GetOffset());
+		}
+
+		// Files that are already included with '#pragma once' or the defined include guard cost a lookup only.
+		auto isSkipped = m_OnceFiles.count(file) != 0;
+		if (!isSkipped && file->m_IncludeGuard != NullSymbol)
+		{
+			isSkipped = IsMacroDefined(file->m_IncludeGuard);
+			RecordCondition(directive.GetOffset());
+		}
+		if (isSkipped)
+		{
+			ReadNextLexeme();
+			return;
+		}
+		if (m_IncludeStack.size() == s_MaxIncludeDepth)
+		{
+			throw PreprocessorException("Included files are nested too deeply.", directive.GetOffset());
+		}
+		m_IncludeStack.push_back({ m_File, m_LexemeIndex });
+		m_File = file;
+		m_LexemeIndex = 0;
+		ReadNextLexeme();
+	}
+
+	// --------------------------------------------------------------- //
+	// --                 Compiler control processing.              -- //
+	// --------------------------------------------------------------- //
+
+	// { PP-DIR-PRAGMA ::= #pragma [<lexeme> .. <lexeme>] <newline> }
+	// *************************************************************** //
+	CR_INTERNAL void Preprocessor::Parse_Directive_Pragma()
+	{
+		// Only '#pragma once' is supported, other pragmas are ignored.
+		if (m_Lexeme == Lexeme::Type::IdIdentifier && m_Lexeme.GetValueID() == SymbolTable::Global().Intern("once"))
+		{
+			m_OnceFiles.insert(m_File);
+		}
+		while (m_Lexeme != Lexeme::Type::NewLine)
+		{
 			ReadNextLexeme();
 		}
 		ReadNextLexeme();
 	}
 
+	// { PP-DIR-ERROR ::= #error [<lexeme> .. <lexeme>] <newline> }
+	// *************************************************************** //
+	CR_INTERNAL void Preprocessor::Parse_Directive_Error()
+	{
+		auto const directive = m_Lexeme;
+		std::string message("#error");
+		for (; m_Lexeme != Lexeme::Type::NewLine; ReadNextLexeme())
+		{
+			message.push_back(' ');
+			message.append(m_Lexeme.GetText(), m_Lexeme.GetLength());
+		}
+		throw PreprocessorException(message.c_str(), directive.GetOffset());
+	}
+
 	// --------------------------------------------------------------- //
 	// --                     Macro preprocessing.                  -- //
 	// --------------------------------------------------------------- //
@@ -242,12 +530,96 @@ namespace Cr
 		//	throw PreprocessorException("Macro redefinition detected.");
 		}
 		auto& macro = m_Macros[m_Lexeme.GetValueID()];
-		
-		// Macros with parameters are still not implemented.
-		/// @todo Implement correct macro evaluation.
-		macro.m_Lexemes = std::move(m_LinePipe);
-		macro.m_Lexemes.pop_back();
+		macro = Macro();
+		++m_MacrosVersion;
 		ReadNextLexeme();
+
+		// Parsing parameters of the function-like macro, parenthesis should immediately follow the name.
+		std::vector<Symbol> params;
+		if (m_Lexeme == Lexeme::Type::OpParenOpen && !m_Lexeme.HasFlags(Lexeme::FlagsLeadingSpace))
+		{
+			macro.m_IsFunctionLike = true;
+			ReadNextLexeme();
+			while (m_Lexeme != Lexeme::Type::OpParenClose)
+			{
+				if (m_Lexeme == Lexeme::Type::OpDot)
+				{
+					// Ellipsis is scanned as three separate dots.
+					ReadNextLexeme(Lexeme::Type::OpDot);
+					ReadNextLexeme(Lexeme::Type::OpDot);
+					ReadNextLexeme(Lexeme::Type::OpDot);
+					params.push_back(SymbolTable::Global().Intern("__VA_ARGS__"));
+					macro.m_IsVariadic = true;
+					break;
+				}
+				ExpectLexeme(Lexeme::Type::IdIdentifier);
+				params.push_back(m_Lexeme.GetValueID());
+				ReadNextLexeme();
+				if (m_Lexeme != Lexeme::Type::OpComma)
+				{
+					break;
+				}
+				ReadNextLexeme();
+			}
+			ReadNextLexeme(Lexeme::Type::OpParenClose);
+			macro.m_ParamsCount = static_cast<uint32_t>(params.size());
+		}
+
+		// Parsing the replacement list. References to the parameters are resolved here once,
+		// arguments that are operands of '##' are marked to be substituted without the expansion.
+		while (m_Lexeme != Lexeme::Type::NewLine)
+		{
+			auto lexeme = m_Lexeme;
+			if (macro.m_IsFunctionLike)
+			{
+				if (lexeme == Lexeme::Type::OpPreprocessor)
+				{
+					ReadNextLexeme();
+					auto const param = m_Lexeme == Lexeme::Type::IdIdentifier ? std::find(params.begin(), params.end(), m_Lexeme.GetValueID()) : params.end();
+					if (param == params.end())
+					{
+						throw PreprocessorException("'#' is not followed by a macro parameter.", lexeme.GetOffset());
+					}
+					lexeme = Lexeme(Lexeme::Type::PpArgumentStringized, static_cast<uint32_t>(param - params.begin())
+						, lexeme.GetOffset(), lexeme.GetLength(), lexeme.GetFlags());
+				}
+				else if (lexeme == Lexeme::Type::IdIdentifier)
+				{
+					auto const param = std::find(params.begin(), params.end(), lexeme.GetValueID());
+					if (param != params.end())
+					{
+						lexeme = Lexeme(Lexeme::Type::PpArgument, static_cast<uint32_t>(param - params.begin())
+							, lexeme.GetOffset(), lexeme.GetLength(), lexeme.GetFlags());
+					}
+				}
+			}
+			if (lexeme == Lexeme::Type::OpPreprocessorConcat)
+			{
+				if (macro.m_Lexemes.empty())
+				{
+					throw PreprocessorException("'##' cannot appear at either end of the macro replacement list.", lexeme.GetOffset());
+				}
+				auto& leftOperand = macro.m_Lexemes.back();
+				if (leftOperand == Lexeme::Type::PpArgument)
+				{
+					leftOperand = Lexeme(Lexeme::Type::PpArgumentUnexpanded, leftOperand.GetValueArgument()
+						, leftOperand.GetOffset(), leftOperand.GetLength(), leftOperand.GetFlags());
+				}
+				macro.m_HasConcat = true;
+			}
+			else if (lexeme == Lexeme::Type::PpArgument && !macro.m_Lexemes.empty() && macro.m_Lexemes.back() == Lexeme::Type::OpPreprocessorConcat)
+			{
+				lexeme = Lexeme(Lexeme::Type::PpArgumentUnexpanded, lexeme.GetValueArgument()
+					, lexeme.GetOffset(), lexeme.GetLength(), lexeme.GetFlags());
+			}
+			macro.m_Lexemes.push_back(lexeme);
+			ReadNextLexeme();
+		}
+		if (!macro.m_Lexemes.empty() && macro.m_Lexemes.back() == Lexeme::Type::OpPreprocessorConcat)
+		{
+			throw PreprocessorException("'##' cannot appear at either end of the macro replacement list.", macro.m_Lexemes.back().GetOffset());
+		}
+		ReadNextLexeme(Lexeme::Type::NewLine);
 	}
 
 	// { PP-DIR-UNDEF ::= #undef <ident> <newline> }
@@ -255,66 +627,459 @@ namespace Cr
 	CR_INTERNAL void Preprocessor::Parse_Directive_Undef()
 	{
 		ExpectLexeme(Lexeme::Type::IdIdentifier);
-		m_Macros.erase(m_Lexeme.GetValueID());
+		if (m_Macros.erase(m_Lexeme.GetValueID()) != 0)
+		{
+			++m_MacrosVersion;
+		}
 		ReadNextLexeme();
 		ReadNextLexeme(Lexeme::Type::NewLine);
 	}
 
 	// --------------------------------------------------------------- //
-	// --                  Conditional preprocessing.               -- //
+	// --                      Macro expansion.                     -- //
 	// --------------------------------------------------------------- //
 
-	// { PP-DIR-IF ::= #if <expression> <newline> <PP-DIR-IF-BODY> }
-	// *************************************************************** //
-	CR_INTERNAL void Preprocessor::Parse_Directive_If()
+	/**
+	 * Reads next lexeme of the macro input.
+	 * @returns False if input is over or the next lexeme is the new line and reading should stop there.
+	 */
+	CR_INTERNAL bool Preprocessor::ReadMacroInput(MacroInput& input, MacroLexeme& lexeme, bool const stopAtNewLine)
 	{
-		auto const condValue = EvaluateExpression() != 0;
-		ReadNextLexeme(Lexeme::Type::NewLine);
-
-		// Parsing sections of the conditional directive.
-		Parse_Directive_ElifElseEndif_Section(condValue);
+		if (!input.m_Pending.empty())
+		{
+			lexeme = input.m_Pending.back();
+			input.m_Pending.pop_back();
+			return true;
+		}
+		if (input.m_Cursor == input.m_End || (stopAtNewLine && *input.m_Cursor == Lexeme::Type::NewLine))
+		{
+			return false;
+		}
+		lexeme = { *input.m_Cursor++, EmptyHideSet };
+		return true;
 	}
 
-	// { PP-DIR-IFDEF ::= #ifdef <ident> <newline> <PP-DIR-IF-BODY> }
-	// *************************************************************** //
-	CR_INTERNAL void Preprocessor::Parse_Directive_Ifdef()
+	/**
+	 * Checks whether the next lexeme of the macro input is the opening parenthesis.
+	 * Arguments of the function-like macros may follow on the next lines and after the ends of the expansions.
+	 */
+	CR_INTERNAL bool Preprocessor::PeekMacroInvocation(MacroInput const& input) const
 	{
-		ExpectLexeme(Lexeme::Type::IdIdentifier);
-		auto const condValue = m_Macros.count(m_Lexeme.GetValueID()) != 0;
-		ReadNextLexeme();
-		ReadNextLexeme(Lexeme::Type::NewLine);
-
-		// Parsing sections of the conditional directive.
-		Parse_Directive_ElifElseEndif_Section(condValue);
+		if (!input.m_Pending.empty())
+		{
+			return input.m_Pending.back().m_Lexeme == Lexeme::Type::OpParenOpen;
+		}
+		for (auto cursor = input.m_Cursor; cursor != input.m_End; ++cursor)
+		{
+			if (*cursor != Lexeme::Type::NewLine)
+			{
+				return *cursor == Lexeme::Type::OpParenOpen;
+			}
+		}
+		return false;
 	}
 
-	// { PP-DIR-IFNDEF ::= #ifndef <ident> <newline> <PP-DIR-IF-SECTION> }
-	// *************************************************************** //
-	CR_INTERNAL void Preprocessor::Parse_Directive_Ifndef()
+	/**
+	 * Expands all macro invocations of the input in a single forward pass, expansions are rescanned together 
+	 * with the rest of the input. Macro is never expanded from the lexeme which hide set contains its name.
+	 */
+	CR_INTERNAL void Preprocessor::ExpandLexemes(MacroInput& input, std::vector<MacroLexeme>& output, bool const stopAtNewLine)
 	{
-		ExpectLexeme(Lexeme::Type::IdIdentifier);
-		auto const condValue = m_Macros.count(m_Lexeme.GetValueID()) == 0;
-		ReadNextLexeme();
-		ReadNextLexeme(Lexeme::Type::NewLine);
+		MacroLexeme lexeme;
+		while (ReadMacroInput(input, lexeme, stopAtNewLine))
+		{
+			if (lexeme.m_Lexeme == Lexeme::Type::IdIdentifier)
+			{
+				auto const name = lexeme.m_Lexeme.GetValueID();
+				if (m_DoRecordDependencies && m_ObservableMacros.count(name) != 0)
+				{
+					m_ObservedMacros.insert(name);
+				}
+				auto const macro = m_Macros.find(name);
+				if (macro != m_Macros.end() && !m_HideSets.Contains(lexeme.m_HideSet, name))
+				{
+					if (CacheMacroExpansion(lexeme, macro->second))
+					{
+						// Cached expansion is copied as is.
+						auto const& expansion = macro->second.m_Expansion;
+						if (!expansion.empty())
+						{
+							output.insert(output.end(), expansion.begin(), expansion.end());
+							auto& first = output[output.size() - expansion.size()].m_Lexeme;
+							auto const layoutFlags = Lexeme::FlagsStartOfLine | Lexeme::FlagsLeadingSpace;
+							first.SetFlags((first.GetFlags() & ~layoutFlags) | (lexeme.m_Lexeme.GetFlags() & layoutFlags));
+						}
+						continue;
+					}
+					if (ExpandMacro(input, lexeme, macro->second))
+					{
+						continue;
+					}
+				}
+			}
+			output.push_back(lexeme);
+		}
+	}
+
+	/**
+	 * Expands the object-like macro completely and caches the expansion, if it is not cached for the current macros.
+	 * Only invocations with the empty hide set are cached. Expansions that end with the name of the function-like macro
+	 * or inside its arguments are not cached, because the arguments may follow the invocation.
+	 * @returns True if the cached expansion may be used.
+	 */
+	CR_INTERNAL bool Preprocessor::CacheMacroExpansion(MacroLexeme const& name, Macro& macro)
+	{
+		if (macro.m_IsFunctionLike || name.m_HideSet != EmptyHideSet)
+		{
+			return false;
+		}
+		if (macro.m_ExpansionVersion != m_MacrosVersion)
+		{
+			macro.m_ExpansionVersion = m_MacrosVersion;
+			macro.m_IsExpansionCached = false;
+
+			std::vector<MacroLexeme> expansion;
+			MacroInput input = { {}, nullptr, nullptr, true, false };
+			ExpandMacro(input, name, macro);
+			ExpandLexemes(input, expansion, false);
+			if (input.m_IsTruncated)
+			{
+				return false;
+			}
+			if (!expansion.empty() && expansion.back().m_Lexeme == Lexeme::Type::IdIdentifier)
+			{
+				auto const& last = expansion.back();
+				auto const lastMacro = m_Macros.find(last.m_Lexeme.GetValueID());
+				if (lastMacro != m_Macros.end() && lastMacro->second.m_IsFunctionLike && !m_HideSets.Contains(last.m_HideSet, lastMacro->first))
+				{
+					return false;
+				}
+			}
+			macro.m_Expansion = std::move(expansion);
+			macro.m_IsExpansionCached = true;
+		}
+		return macro.m_IsExpansionCached;
+	}
+
+	/**
+	 * Expands the macro invocation. Expansion is pushed back to the input to be rescanned.
+	 * Lexemes of the expansion get the hide set of the invocation with the macro name added.
+	 * @returns False if name of the function-like macro is not followed by the arguments.
+	 */
+	CR_INTERNAL bool Preprocessor::ExpandMacro(MacroInput& input, MacroLexeme const& name, Macro& macro)
+	{
+		auto hideSet = name.m_HideSet;
+		std::vector<MacroLexeme> arguments;
+		std::vector<size_t> argumentsBounds;
+		if (macro.m_IsFunctionLike)
+		{
+			// Collecting the arguments, commas inside the nested parentheses do not separate them.
+			if (!PeekMacroInvocation(input))
+			{
+				return false;
+			}
+			MacroLexeme lexeme;
+			while (ReadMacroInput(input, lexeme, false) && lexeme.m_Lexeme != Lexeme::Type::OpParenOpen)
+			{
+			}
+			argumentsBounds.push_back(0);
+			for (size_t depth = 0; ; )
+			{
+				if (!ReadMacroInput(input, lexeme, false))
+				{
+					if (input.m_IsCaching)
+					{
+						// Arguments may continue after the invocation of the cached macro.
+						input.m_IsTruncated = true;
+						return true;
+					}
+					throw PreprocessorException("Unterminated invocation of the function-like macro.", name.m_Lexeme.GetOffset());
+				}
+				auto const type = lexeme.m_Lexeme.GetType();
+				if (type == Lexeme::Type::NewLine)
+				{
+					continue;
+				}
+				if (type == Lexeme::Type::OpParenOpen)
+				{
+					++depth;
+				}
+				else if (type == Lexeme::Type::OpParenClose)
+				{
+					if (depth-- == 0)
+					{
+						break;
+					}
+				}
+				else if (type == Lexeme::Type::OpComma && depth == 0 
+					&& !(macro.m_IsVariadic && argumentsBounds.size() == macro.m_ParamsCount))
+				{
+					argumentsBounds.push_back(arguments.size());
+					continue;
+				}
+				arguments.push_back(lexeme);
+			}
+			argumentsBounds.push_back(arguments.size());
+
+			auto const argumentsCount = argumentsBounds.size() - 1;
+			if (macro.m_IsVariadic && argumentsCount + 1 == macro.m_ParamsCount)
+			{
+				// Variadic arguments are omitted.
+				argumentsBounds.push_back(arguments.size());
+			}
+			else if (argumentsCount != macro.m_ParamsCount && !(macro.m_ParamsCount == 0 && arguments.empty()))
+			{
+				throw PreprocessorException("Wrong number of arguments of the function-like macro invocation.", name.m_Lexeme.GetOffset());
+			}
+
+			// Hide set of the invocation is the intersection of the hide sets of the name and closing parenthesis.
+			hideSet = m_HideSets.Intersection(hideSet, lexeme.m_HideSet);
+		}
+		hideSet = m_HideSets.Union(hideSet, m_HideSets.Make(name.m_Lexeme.GetValueID()));
+
+		// Arguments are fully expanded before the substitution, at most once for each invocation.
+		std::vector<std::vector<MacroLexeme>> expandedArguments(macro.m_ParamsCount);
+		std::vector<bool> isArgumentExpanded(macro.m_ParamsCount);
+		MacroLexeme operand;
+		auto const getOperand = [&](Lexeme const& lexeme, MacroLexeme const*& begin, MacroLexeme const*& end)
+		{
+			switch (lexeme.GetType())
+			{
+				case Lexeme::Type::PpArgument:
+					{
+						auto const index = lexeme.GetValueArgument();
+						auto& expandedArgument = expandedArguments[index];
+						if (!isArgumentExpanded[index])
+						{
+							MacroInput argumentInput = { {}, nullptr, nullptr, false, false };
+							argumentInput.m_Pending.assign(std::reverse_iterator<MacroLexeme const*>(arguments.data() + argumentsBounds[index + 1])
+								, std::reverse_iterator<MacroLexeme const*>(arguments.data() + argumentsBounds[index]));
+							ExpandLexemes(argumentInput, expandedArgument, false);
+							isArgumentExpanded[index] = true;
+						}
+						begin = expandedArgument.data();
+						end = begin + expandedArgument.size();
+						break;
+					}
+				case Lexeme::Type::PpArgumentUnexpanded:
+					begin = arguments.data() + argumentsBounds[lexeme.GetValueArgument()];
+					end = arguments.data() + argumentsBounds[lexeme.GetValueArgument() + 1];
+					break;
+				case Lexeme::Type::PpArgumentStringized:
+					operand = { StringizeLexemes(arguments.data() + argumentsBounds[lexeme.GetValueArgument()]
+						, arguments.data() + argumentsBounds[lexeme.GetValueArgument() + 1]), EmptyHideSet };
+					operand.m_Lexeme.SetFlags(lexeme.GetFlags());
+					begin = &operand;
+					end = begin + 1;
+					break;
+				default:
+					operand = { lexeme, EmptyHideSet };
+					begin = &operand;
+					end = begin + 1;
+					break;
+			}
+		};
+
+		// Substituting the replacement list. Empty operands of '##' act as placemarkers.
+		std::vector<MacroLexeme> expansion;
+		auto isLastOperandEmpty = true;
+		for (auto lexeme = macro.m_Lexemes.data(); lexeme != macro.m_Lexemes.data() + macro.m_Lexemes.size(); ++lexeme)
+		{
+			MacroLexeme const* operandBegin;
+			MacroLexeme const* operandEnd;
+			if (*lexeme == Lexeme::Type::OpPreprocessorConcat)
+			{
+				getOperand(*++lexeme, operandBegin, operandEnd);
+				auto const isOperandEmpty = operandBegin == operandEnd;
+				if (!isOperandEmpty && !isLastOperandEmpty)
+				{
+					auto& left = expansion.back();
+					left.m_Lexeme = PasteLexemes(left.m_Lexeme, operandBegin->m_Lexeme);
+					left.m_HideSet = m_HideSets.Union(m_HideSets.Intersection(left.m_HideSet, operandBegin->m_HideSet), hideSet);
+					++operandBegin;
+				}
+				isLastOperandEmpty = isLastOperandEmpty && isOperandEmpty;
+			}
+			else
+			{
+				getOperand(*lexeme, operandBegin, operandEnd);
+				isLastOperandEmpty = operandBegin == operandEnd;
+				if (!isLastOperandEmpty && (*lexeme == Lexeme::Type::PpArgument || *lexeme == Lexeme::Type::PpArgumentUnexpanded))
+				{
+					// Substituted argument is spaced as its parameter.
+					auto argumentLexeme = operandBegin++->m_Lexeme;
+					argumentLexeme.SetFlags(static_cast<uint16_t>((argumentLexeme.GetFlags() & ~Lexeme::FlagsLeadingSpace)
+						| (lexeme->GetFlags() & Lexeme::FlagsLeadingSpace)));
+					expansion.push_back({ argumentLexeme, m_HideSets.Union(operandBegin[-1].m_HideSet, hideSet) });
+				}
+			}
+			for (; operandBegin != operandEnd; ++operandBegin)
+			{
+				expansion.push_back({ operandBegin->m_Lexeme, m_HideSets.Union(operandBegin->m_HideSet, hideSet) });
+			}
+		}
+
+		// Pushing the expansion back to the input to be rescanned.
+		if (!expansion.empty())
+		{
+			// First lexeme of the expansion takes the layout of the macro name.
+			auto& first = expansion.front().m_Lexeme;
+			auto const layoutFlags = Lexeme::FlagsStartOfLine | Lexeme::FlagsLeadingSpace;
+			first.SetFlags((first.GetFlags() & ~layoutFlags) | (name.m_Lexeme.GetFlags() & layoutFlags));
+			input.m_Pending.insert(input.m_Pending.end(), expansion.rbegin(), expansion.rend());
+		}
+		return true;
+	}
+
+	/**
+	 * Converts the lexemes of the argument into the string constant.
+	 * Spaces between the lexemes are collapsed into the single ones, quotes and slashes of the strings are escaped.
+	 */
+	CR_INTERNAL Lexeme Preprocessor::StringizeLexemes(MacroLexeme const* const begin, MacroLexeme const* const end) const
+	{
+		std::string spelling(1, '"');
+		for (auto macroLexeme = begin; macroLexeme != end; ++macroLexeme)
+		{
+			auto const lexeme = &macroLexeme->m_Lexeme;
+			if (macroLexeme != begin && (lexeme->GetFlags() & (Lexeme::FlagsStartOfLine | Lexeme::FlagsLeadingSpace)) != 0)
+			{
+				spelling.push_back(' ');
+			}
+			auto const text = lexeme->GetText();
+			if (*lexeme == Lexeme::Type::CtString)
+			{
+				for (auto c = text; c != text + lexeme->GetLength(); ++c)
+				{
+					if (*c == '"' || *c == '\\')
+					{
+						spelling.push_back('\\');
+					}
+					spelling.push_back(*c);
+				}
+			}
+			else
+			{
+				spelling.append(text, lexeme->GetLength());
+			}
+		}
+		spelling.push_back('"');
+
+		auto const offset = SourceManager::Global().AddScratch(spelling.data(), spelling.size());
+		return Lexeme(Lexeme::Type::CtString, 0, offset, static_cast<uint32_t>(spelling.size()));
+	}
+
+	/**
+	 * Concatenates spellings of two lexemes and scans the result.
+	 */
+	CR_INTERNAL Lexeme Preprocessor::PasteLexemes(Lexeme const& left, Lexeme const& right) const
+	{
+		std::string spelling(left.GetText(), left.GetLength());
+		spelling.append(right.GetText(), right.GetLength());
+		auto const offset = SourceManager::Global().AddScratch(spelling.data(), spelling.size());
+		auto const text = SourceManager::Global().GetText(offset);
+
+		Scanner scanner(text, text + spelling.size(), offset);
+		auto lexeme = scanner.GetNextLexeme();
+		if (lexeme.GetLength() != spelling.size())
+		{
+			throw PreprocessorException("Pasting does not give a valid lexeme.", left.GetOffset());
+		}
+		lexeme.SetFlags(left.GetFlags() & (Lexeme::FlagsStartOfLine | Lexeme::FlagsLeadingSpace));
+		return lexeme;
+	}
+
+	// --------------------------------------------------------------- //
+	// --                  Conditional preprocessing.               -- //
+	// --------------------------------------------------------------- //
+
+	/**
+	 * Checks whether the macro is defined and records the observation for the dependencies.
+	 */
+	CR_INTERNAL bool Preprocessor::IsMacroDefined(Symbol const name)
+	{
+		if (m_DoRecordDependencies)
+		{
+			m_ConditionMacros.push_back(name);
+			if (m_ObservableMacros.count(name) != 0)
+			{
+				m_ObservedMacros.insert(name);
+			}
+		}
+		return m_Macros.count(name) != 0;
+	}
+
+	/**
+	 * Records the macros that were observed by the just evaluated condition.
+	 */
+	CR_INTERNAL void Preprocessor::RecordCondition(SourceOffset const location)
+	{
+		if (m_DoRecordDependencies)
+		{
+			std::sort(m_ConditionMacros.begin(), m_ConditionMacros.end());
+			m_ConditionMacros.erase(std::unique(m_ConditionMacros.begin(), m_ConditionMacros.end()), m_ConditionMacros.end());
+			m_ConditionDependencies.push_back({ location, std::move(m_ConditionMacros) });
+			m_ConditionMacros.clear();
+		}
+	}
+
+	// { PP-DIR-IF ::= #if <expression> <newline> <PP-DIR-IF-BODY> }
+	// *************************************************************** //
+	CR_INTERNAL void Preprocessor::Parse_Directive_If()
+	{
+		auto const condValue = EvaluateCondition();
+		ReadNextLexeme(Lexeme::Type::NewLine);
+
+		// Parsing sections of the conditional directive.
+		Parse_Directive_ElifElseEndif_Section(condValue, false);
+	}
+
+	// { PP-DIR-IFDEF ::= #ifdef <ident> <newline> <PP-DIR-IF-BODY> }
+	// *************************************************************** //
+	CR_INTERNAL void Preprocessor::Parse_Directive_Ifdef()
+	{
+		ExpectLexeme(Lexeme::Type::IdIdentifier);
+		auto const condValue = IsMacroDefined(m_Lexeme.GetValueID());
+		RecordCondition(m_Lexeme.GetOffset());
+		ReadNextLexeme();
+		ReadNextLexeme(Lexeme::Type::NewLine);
+
+		// Parsing sections of the conditional directive.
+		Parse_Directive_ElifElseEndif_Section(condValue, false);
+	}
+
+	// { PP-DIR-IFNDEF ::= #ifndef <ident> <newline> <PP-DIR-IF-SECTION> }
+	// *************************************************************** //
+	CR_INTERNAL void Preprocessor::Parse_Directive_Ifndef()
+	{
+		ExpectLexeme(Lexeme::Type::IdIdentifier);
+		auto const condValue = !IsMacroDefined(m_Lexeme.GetValueID());
+		RecordCondition(m_Lexeme.GetOffset());
+		ReadNextLexeme();
+		ReadNextLexeme(Lexeme::Type::NewLine);
 
 		// Parsing sections of the conditional directive.
-		Parse_Directive_ElifElseEndif_Section(condValue);
+		Parse_Directive_ElifElseEndif_Section(condValue, false);
 	}
 
 	// { PP-DIR-IF-SECTION ::= <PP-BLOCK> #elif <newline> <PP-DIR-IF-SECTION> 
 	//                       | <PP-BLOCK> #else <newline> <PP-DIR-IF-SECTION> 
 	//                       | <PP-BLOCK> #endif <newline> }
 	// *************************************************************** //
-	CR_INTERNAL void Preprocessor::Parse_Directive_ElifElseEndif_Section(bool const cond
+	CR_INTERNAL void Preprocessor::Parse_Directive_ElifElseEndif_Section(bool const cond, bool const isAnyTaken
 		, bool const allowElifOrElse /*= true*/)
 	{
-		// Parsing section lexemes.
-		auto const oldDoWriteLexemes = m_DoWriteLexemes;
-		m_DoWriteLexemes &= cond;
-		Parse_Block();
-		m_DoWriteLexemes = oldDoWriteLexemes;
+		// Parsing section lexemes, inactive sections are skipped without parsing.
+		if (cond)
+		{
+			Parse_Block();
+		}
+		else
+		{
+			SkipBlock();
+		}
 
 		// Determining what to parse next..
+		auto const isTaken = isAnyTaken || cond;
 		switch (m_Lexeme.GetType())
 		{
 			// .. 'elif'/'else' sections of the conditional directive.
@@ -326,11 +1091,23 @@ namespace Cr
 						throw PreprocessorException("Unexpected '#elif' directive following '#else' directive. ");
 					}
 
+					// Conditions that follow the taken section are never evaluated.
 					ReadNextLexeme();
-					auto const condValue = EvaluateExpression() != 0;
+					auto condValue = false;
+					if (isTaken)
+					{
+						while (m_Lexeme != Lexeme::Type::NewLine)
+						{
+							ReadNextLexeme();
+						}
+					}
+					else
+					{
+						condValue = EvaluateCondition();
+					}
 					ReadNextLexeme(Lexeme::Type::NewLine);
 
-					Parse_Directive_ElifElseEndif_Section(!cond && condValue);
+					Parse_Directive_ElifElseEndif_Section(condValue, isTaken);
 					break;
 				}
 
@@ -346,7 +1123,7 @@ namespace Cr
 					ReadNextLexeme();
 					ReadNextLexeme(Lexeme::Type::NewLine);
 
-					Parse_Directive_ElifElseEndif_Section(!cond, false);
+					Parse_Directive_ElifElseEndif_Section(!isTaken, isTaken, false);
 					break;
 				}
 
@@ -366,285 +1143,189 @@ namespace Cr
 		}
 	}
 
-	// Recursive descent expression parser.
-	// { expression ::= ..see comments in Parser class.. }
-	// *************************************************************** //
-	CR_INTERNAL int64_t Preprocessor::EvaluateExpression()
-	{
-		/// @todo Preprocess condition expression.
-		return EvaluateExpression_Or();
-	}
-	// *************************************************************** //
-	CR_INTERNAL int64_t Preprocessor::EvaluateExpression_Or()
+	/**
+	 * Evaluates the condition of the '#if'/'#elif' directive, the current lexeme is the first one of the condition.
+	 * Condition is compiled once per directive, re-evaluation only reads the macros of its slots.
+	 * Conditions that invoke the function-like macros or are not expressions before the expansion are expanded first.
+	 */
+	CR_INTERNAL bool Preprocessor::EvaluateCondition()
 	{
-		auto value = EvaluateExpression_And();
-		while (m_Lexeme == Lexeme::Type::OpOr)
+		auto const location = m_Lexeme.GetOffset();
+		auto const lexemes = m_File->m_Lexemes.data();
+		auto const begin = static_cast<uint32_t>(m_LexemeIndex - 1);
+		auto condition = m_File->m_Conditions.find(begin);
+		if (condition == m_File->m_Conditions.end())
 		{
-			ReadNextLexeme();
-			value = value || EvaluateExpression_And();
+			auto end = begin;
+			while (lexemes[end] != Lexeme::Type::NewLine)
+			{
+				++end;
+			}
+			condition = m_File->m_Conditions.emplace(begin, CompiledCondition()).first;
+			condition->second.Compile(lexemes + begin, lexemes + end);
 		}
-		return value;
-	}
-	// *************************************************************** //
-	CR_INTERNAL int64_t Preprocessor::EvaluateExpression_And()
-	{
-		auto value = EvaluateExpression_BitwiseOr();
-		while (m_Lexeme == Lexeme::Type::OpAnd)
+
+		int64_t value;
+		auto const end = lexemes + begin + condition->second.GetLength();
+		if (!condition->second.IsCompiled() || !EvaluateCompiledCondition(condition->second, true, value))
 		{
-			ReadNextLexeme();
-			value = value && EvaluateExpression_BitwiseOr();
+			value = EvaluateExpandedCondition(lexemes + begin, end);
 		}
-		return value;
+		RecordCondition(location);
+		m_LexemeIndex = static_cast<size_t>(end - lexemes);
+		ReadNextLexeme();
+		return value != 0;
 	}
-	// *************************************************************** //
-	CR_INTERNAL int64_t Preprocessor::EvaluateExpression_BitwiseOr()
+
+	/**
+	 * Fills the slots of the compiled condition and evaluates it.
+	 * @param doReadMacros Whether the macro slots are read from the macros or are zero, like for the expanded conditions.
+	 * @returns False if value of any macro is not an expression, and the condition should be expanded.
+	 */
+	CR_INTERNAL bool Preprocessor::EvaluateCompiledCondition(CompiledCondition const& condition, bool const doReadMacros, int64_t& value)
 	{
-		auto value = EvaluateExpression_BitwiseXor();
-		while (m_Lexeme == Lexeme::Type::OpBitwiseOr)
+		// Slots of the nested evaluations are placed after the slots of this one.
+		auto const slotsBase = m_SlotValues.size();
+		for (auto const name : condition.GetDefinedSlots())
 		{
-			ReadNextLexeme();
-			value |= EvaluateExpression_BitwiseXor();
+			m_SlotValues.push_back(IsMacroDefined(name));
 		}
-		return value;
-	}
-	// *************************************************************** //
-	CR_INTERNAL int64_t Preprocessor::EvaluateExpression_BitwiseXor()
-	{
-		auto value = EvaluateExpression_BitwiseAnd();
-		while (m_Lexeme == Lexeme::Type::OpBitwiseXor)
+		for (auto const name : condition.GetMacroSlots())
 		{
-			ReadNextLexeme();
-			value ^= EvaluateExpression_BitwiseAnd();
+			int64_t macroValue = 0;
+			if (doReadMacros && !EvaluateMacroValue(name, macroValue))
+			{
+				m_SlotValues.resize(slotsBase);
+				return false;
+			}
+			m_SlotValues.push_back(macroValue);
 		}
-		return value;
-	}
-	// *************************************************************** //
-	CR_INTERNAL int64_t Preprocessor::EvaluateExpression_BitwiseAnd()
-	{
-		auto value = EvaluateExpression_Equals_OR_NotEquals();
-		while (m_Lexeme == Lexeme::Type::OpBitwiseAnd)
+
+		auto const slotValues = m_SlotValues.data() + slotsBase;
+		auto const isEvaluated = condition.Evaluate(slotValues, slotValues + condition.GetDefinedSlots().size(), value);
+		m_SlotValues.resize(slotsBase);
+		if (!isEvaluated)
 		{
-			ReadNextLexeme();
-			value &= EvaluateExpression_Equals_OR_NotEquals();
+			throw PreprocessorException("Division by zero occurred while evaluating preprocessor expression.");
 		}
-		return value;
+		return true;
 	}
-	// *************************************************************** //
-	CR_INTERNAL int64_t Preprocessor::EvaluateExpression_Equals_OR_NotEquals()
+
+	/**
+	 * Returns true if the replacement list is a single primary expression: a constant, an identifier, the 'defined'
+	 * operator or a fully parenthesized expression. Operators of the other lists bind to the operands around the macro
+	 * after the expansion, so their value cannot be substituted as a whole.
+	 */
+	static bool IsSinglePrimary(std::vector<Lexeme> const& lexemes)
 	{
-		auto value = EvaluateExpression_Less_OR_LessEquals_OR_Greater_OR_GreaterEquals();
-		while (true)
+		if (lexemes.size() == 1)
 		{
-			switch (m_Lexeme.GetType())
-			{
-				case Lexeme::Type::OpEquals:
-					ReadNextLexeme();
-					value = value == EvaluateExpression_Less_OR_LessEquals_OR_Greater_OR_GreaterEquals();
-					break;
-				case Lexeme::Type::OpNotEquals:
-					ReadNextLexeme();
-					value = value != EvaluateExpression_Less_OR_LessEquals_OR_Greater_OR_GreaterEquals();
-					break;
-				default:
-					return value;
-			}
+			auto const& lexeme = lexemes.front();
+			return lexeme == Lexeme::Type::CtInt || lexeme == Lexeme::Type::CtUInt || lexeme == Lexeme::Type::KwTrue
+				|| lexeme == Lexeme::Type::KwFalse || lexeme == Lexeme::Type::IdIdentifier;
 		}
-	}
-	// *************************************************************** //
-	CR_INTERNAL int64_t Preprocessor::EvaluateExpression_Less_OR_LessEquals_OR_Greater_OR_GreaterEquals()
-	{
-		auto value = EvaluateExpression_BitwiseLeftShift_OR_BitwiseRightShift();
-		while (true)
+		if (lexemes.empty())
 		{
-			switch (m_Lexeme.GetType())
-			{
-				case Lexeme::Type::OpLess:
-					ReadNextLexeme();
-					value = value < EvaluateExpression_BitwiseLeftShift_OR_BitwiseRightShift();
-					break;
-				case Lexeme::Type::OpLessEquals:
-					ReadNextLexeme();
-					value = value <= EvaluateExpression_BitwiseLeftShift_OR_BitwiseRightShift();
-					break;
-				case Lexeme::Type::OpGreater:
-					ReadNextLexeme();
-					value = value > EvaluateExpression_BitwiseLeftShift_OR_BitwiseRightShift();
-					break;
-				case Lexeme::Type::OpGreaterEquals:
-					ReadNextLexeme();
-					value = value >= EvaluateExpression_BitwiseLeftShift_OR_BitwiseRightShift();
-					break;
-				default:
-					return value;
-			}
+			return false;
 		}
-	}
-	// *************************************************************** //
-	CR_INTERNAL int64_t Preprocessor::EvaluateExpression_BitwiseLeftShift_OR_BitwiseRightShift()
-	{
-		auto value = EvaluateExpression_Add_OR_Subtract();
-		while (true)
+		if (lexemes.front() == Lexeme::Type::KwPpDefined)
 		{
-			switch (m_Lexeme.GetType())
-			{
-				case Lexeme::Type::OpBitwiseLeftShift:
-					ReadNextLexeme();
-					value <<= EvaluateExpression_Add_OR_Subtract();
-					break;
-				case Lexeme::Type::OpBitwiseRightShift:
-					ReadNextLexeme();
-					value >>= EvaluateExpression_Add_OR_Subtract();
-					break;
-				default:
-					return value;
-			}
+			return (lexemes.size() == 2 && lexemes[1] == Lexeme::Type::IdIdentifier) || (lexemes.size() == 4 && lexemes[1] == Lexeme::Type::OpParenOpen
+				&& lexemes[2] == Lexeme::Type::IdIdentifier && lexemes[3] == Lexeme::Type::OpParenClose);
 		}
-	}
-	// *************************************************************** //
-	CR_INTERNAL int64_t Preprocessor::EvaluateExpression_Add_OR_Subtract()
-	{
-		auto value = EvaluateExpression_Multiply_OR_Divide_OR_Modulo();
-		while (true)
+		if (lexemes.front() != Lexeme::Type::OpParenOpen || lexemes.back() != Lexeme::Type::OpParenClose)
 		{
-			switch (m_Lexeme.GetType())
+			return false;
+		}
+		// First parenthesis should be closed by the last one only, like in '(1) + (2)' it is not.
+		auto depth = 0;
+		for (size_t i = 0; i + 1 < lexemes.size(); ++i)
+		{
+			depth += lexemes[i] == Lexeme::Type::OpParenOpen ? 1 : lexemes[i] == Lexeme::Type::OpParenClose ? -1 : 0;
+			if (depth == 0)
 			{
-				case Lexeme::Type::OpAdd:
-					ReadNextLexeme();
-					value += EvaluateExpression_Multiply_OR_Divide_OR_Modulo();
-					break;
-				case Lexeme::Type::OpSubtract:
-					ReadNextLexeme();
-					value -= EvaluateExpression_Multiply_OR_Divide_OR_Modulo();
-					break;
-				default:
-					return value;
+				return false;
 			}
 		}
+		return true;
 	}
-	// *************************************************************** //
-	CR_INTERNAL int64_t Preprocessor::EvaluateExpression_Multiply_OR_Divide_OR_Modulo()
+
+	/**
+	 * Evaluates the identifier of the condition: undefined macros, the function-like macros without arguments and
+	 * the macros that are being evaluated are zero, the object-like macros are values of their replacement lists.
+	 * @returns False if replacement list of the macro is not a single primary expression.
+	 */
+	CR_INTERNAL bool Preprocessor::EvaluateMacroValue(Symbol const name, int64_t& value)
 	{
-		auto value = EvaluateExpression_Unary();
-		while (true)
+		value = 0;
+		if (!IsMacroDefined(name) || std::find(m_EvaluatedMacros.begin(), m_EvaluatedMacros.end(), name) != m_EvaluatedMacros.end())
 		{
-			switch (m_Lexeme.GetType())
+			return true;
+		}
+		auto& macro = m_Macros[name];
+		if (macro.m_IsFunctionLike)
+		{
+			return true;
+		}
+		if (!macro.m_IsValueCompiled)
+		{
+			macro.m_IsValueCompiled = true;
+			if (!macro.m_HasConcat && IsSinglePrimary(macro.m_Lexemes))
 			{
-				case Lexeme::Type::OpMultiply:
-					ReadNextLexeme();
-					value *= EvaluateExpression_Unary();
-					break;
-				case Lexeme::Type::OpDivide:
-					{
-						ReadNextLexeme();
-						auto const rightValue = EvaluateExpression_Unary();
-						if (rightValue == 0)
-						{
-							throw PreprocessorException("Division by zero occurred while evaluating preprocessor "
-									                    "expression.");
-						}
-						value /= rightValue;
-						break;
-					}
-				case Lexeme::Type::OpModulo:
-					{
-						ReadNextLexeme();
-						auto const rightValue = EvaluateExpression_Unary();
-						if (rightValue == 0)
-						{
-							throw PreprocessorException("Division by zero occurred while evaluating preprocessor "
-									                    "expression.");
-						}
-						value %= rightValue;
-						break;
-					}
-				default:
-					return value;
+				macro.m_Value.Compile(macro.m_Lexemes.data(), macro.m_Lexemes.data() + macro.m_Lexemes.size());
 			}
 		}
-	}
-	// *************************************************************** //
-	CR_INTERNAL int64_t Preprocessor::EvaluateExpression_Unary()
-	{
-		switch (m_Lexeme.GetType())
+		if (!macro.m_Value.IsCompiled())
 		{
-			case Lexeme::Type::OpNot:
-				ReadNextLexeme();
-				return !EvaluateExpression_Unary();
-			case Lexeme::Type::OpBitwiseNot:
-				ReadNextLexeme();
-				return ~EvaluateExpression_Unary();
-			case Lexeme::Type::OpAdd:
-				ReadNextLexeme();
-				return +EvaluateExpression_Unary();
-			case Lexeme::Type::OpSubtract:
-				ReadNextLexeme();
-				return -EvaluateExpression_Unary();
-			default:
-				return EvaluateExpression_Primary();
+			return false;
 		}
+
+		m_EvaluatedMacros.push_back(name);
+		auto const isEvaluated = EvaluateCompiledCondition(macro.m_Value, true, value);
+		m_EvaluatedMacros.pop_back();
+		return isEvaluated;
 	}
-	// *************************************************************** //
-	CR_INTERNAL int64_t Preprocessor::EvaluateExpression_Primary()
+
+	/**
+	 * Expands macros of the condition and evaluates it. Operands of the 'defined' operator are not expanded,
+	 * identifiers that are left after the expansion are zero.
+	 */
+	CR_INTERNAL int64_t Preprocessor::EvaluateExpandedCondition(Lexeme const* begin, Lexeme const* const end)
 	{
-		switch (m_Lexeme.GetType())
+		std::vector<MacroLexeme> expandedLexemes;
+		while (begin != end)
 		{
-			// Literals in the macro expression.
-			// ---------------------------------------------------
-			case Lexeme::Type::KwTrue:
-				ReadNextLexeme();
-				return 1;
-			case Lexeme::Type::KwFalse:
-				ReadNextLexeme();
-				return 0;
-			case Lexeme::Type::CtInt:
-				{
-					auto const value = m_Lexeme.GetValueInt();
-					ReadNextLexeme();
-					return value;
-				}
-
-			// 'defined' operator.
-			// ---------------------------------------------------
-			case Lexeme::Type::KwPpDefined:
-				{
-					ReadNextLexeme();
-					if (m_Lexeme == Lexeme::Type::OpParenOpen)
-					{
-						// { defined(<ident>) } syntax.
-						ReadNextLexeme();
-						ExpectLexeme(Lexeme::Type::IdIdentifier);
-						auto const value = m_Macros.count(m_Lexeme.GetValueID()) != 0;
-						ReadNextLexeme();
-						ReadNextLexeme(Lexeme::Type::OpParenClose);
-						return value;
-					}
-					// { defined <ident> } syntax.
-					ExpectLexeme(Lexeme::Type::IdIdentifier);
-					auto const value = m_Macros.count(m_Lexeme.GetValueID()) != 0;
-					ReadNextLexeme();
-					return value;
-				}
-			
-			// Undefined identifier in the expression evaluating.
-			// ---------------------------------------------------
-			case Lexeme::Type::IdIdentifier:
-				ReadNextLexeme();
-				return 0;
-
-			// Parentheses expression.
-			// ---------------------------------------------------
-			case Lexeme::Type::OpParenOpen:
+			if (*begin == Lexeme::Type::KwPpDefined)
+			{
+				auto const operandEnd = std::min(begin + (begin + 1 != end && begin[1] == Lexeme::Type::OpParenOpen ? 4 : 2), end);
+				for (; begin != operandEnd; ++begin)
 				{
-					ReadNextLexeme();
-					auto const parenExpr = EvaluateExpression();
-					ReadNextLexeme(Lexeme::Type::OpParenClose);
-					return parenExpr;
+					expandedLexemes.push_back({ *begin, EmptyHideSet });
 				}
+				continue;
+			}
+			auto const definedOperator = std::find_if(begin, end, [](Lexeme const& lexeme)
+			{
+				return lexeme == Lexeme::Type::KwPpDefined;
+			});
+			MacroInput input = { {}, begin, definedOperator, false, false };
+			ExpandLexemes(input, expandedLexemes, false);
+			begin = definedOperator;
+		}
 
-			// ---------------------------------------------------
-			default:
-				throw PreprocessorException("Unexpected lexeme while parsing preprocessor expression.");
+		std::vector<Lexeme> lexemes;
+		lexemes.reserve(expandedLexemes.size());
+		for (auto const& lexeme : expandedLexemes)
+		{
+			lexemes.push_back(lexeme.m_Lexeme);
+		}
+		CompiledCondition condition;
+		int64_t value;
+		if (!condition.Compile(lexemes.data(), lexemes.data() + lexemes.size()) || !EvaluateCompiledCondition(condition, false, value))
+		{
+			throw PreprocessorException("Unexpected lexeme while parsing preprocessor expression.", end->GetOffset());
 		}
+		return value;
 	}
 
 	// *************************************************************** //
@@ -662,13 +1343,39 @@ namespace Cr
 	// *************************************************************** //
 	CR_API Lexeme Preprocessor::GetNextLexeme()
 	{
-		while (m_LexemesPipe.empty())
+		while (m_LexemesPipe.IsEmpty())
 		{
+			if (m_Lexeme == Lexeme::Type::Null)
+			{
+				return m_Lexeme;
+			}
 			Parse_Block(true);
 		}
-		auto const bufferedLexeme = m_LexemesPipe.front();
-		m_LexemesPipe.pop_front();
-		return bufferedLexeme;
+		return m_LexemesPipe.PopFront();
+	}
+
+	/**
+	 * Reads next lexemes from the specified stream, lines are preprocessed until the array is filled.
+	 */
+	CR_API size_t Preprocessor::GetNextLexemes(Lexeme* const lexemes, size_t const count)
+	{
+		CrAssert(lexemes != nullptr || count == 0);
+		size_t readCount = 0;
+		while (readCount != count)
+		{
+			if (m_LexemesPipe.IsEmpty())
+			{
+				if (m_Lexeme == Lexeme::Type::Null)
+				{
+					lexemes[readCount++] = m_Lexeme;
+					break;
+				}
+				Parse_Block(true);
+				continue;
+			}
+			readCount += m_LexemesPipe.PopFront(lexemes + readCount, count - readCount);
+		}
+		return readCount;
 	}
 
 	// *************************************************************** //
@@ -709,4 +1416,309 @@ KEK
 		int i = 1;
 	};*/
 
+	CrUnitTest(PreprocessorConditionals)
+	{
+		auto inputStream = std::make_shared<IO::StringInputStream>(R"(#define TRUE 1
+#if 0
+1
+#elif defined(TRUE)
+	#undef TRUE
+	#if -((1 << 1) * 35) + 3 + TRUE == -67 && !defined(KEK)
+		2
+	#endif
+	22
+#else 
+3
+#endif
+4)");
+		Preprocessor preprocessor(inputStream);
+		for (auto const value : { 2, 22, 4 })
+		{
+			auto const lexeme = preprocessor.GetNextLexeme();
+			CrAssert(lexeme.GetType() == Lexeme::Type::CtInt && lexeme.GetValueInt() == value);
+		}
+		CrAssert(preprocessor.GetNextLexeme().GetType() == Lexeme::Type::Null);
+	};
+
+	CrUnitTest(PreprocessorShortCircuitConditionals)
+	{
+		auto inputStream = std::make_shared<IO::StringInputStream>(R"(#if 0 && defined(A)
+1
+#endif
+#if 1 || (B + 1)
+2
+#endif
+3)");
+		Preprocessor preprocessor(inputStream);
+		for (auto const value : { 2, 3 })
+		{
+			auto const lexeme = preprocessor.GetNextLexeme();
+			CrAssert(lexeme.GetType() == Lexeme::Type::CtInt && lexeme.GetValueInt() == value);
+		}
+		CrAssert(preprocessor.GetNextLexeme().GetType() == Lexeme::Type::Null);
+	};
+
+	/**
+	 * Preprocesses the source and concatenates spellings of the lexemes without spaces.
+	 */
+	static std::string PreprocessToString(char const* const source)
+	{
+		Preprocessor preprocessor(std::make_shared<IO::StringInputStream>(source));
+		std::string result;
+		for (auto lexeme = preprocessor.GetNextLexeme(); lexeme != Lexeme::Type::Null; lexeme = preprocessor.GetNextLexeme())
+		{
+			result.append(lexeme.GetText(), lexeme.GetLength());
+		}
+		return result;
+	}
+
+	CrUnitTest(PreprocessorFunctionLikeMacros)
+	{
+		CrAssert(PreprocessToString(R"(#define MUL(a, b) ((a) * (b))
+#define NONE() 0
+#define FIRST(a, ...) a
+#define REST(a, ...) __VA_ARGS__
+#define F (1)
+MUL(1 + F, (2, 3)) NONE() F(2)
+FIRST(1) REST(1, 2, 3)
+MUL
+(
+	4, 5
+))") == "((1+(1))*((2,3)))0(1)(2)12,3((4)*(5))");
+	};
+
+	CrUnitTest(PreprocessorStringizeAndConcat)
+	{
+		CrAssert(PreprocessToString(R"(#define STR(x) #x
+#define XSTR(x) STR(x)
+#define CAT(a, b) a ## b
+#define VALUE 42
+STR( a  +
+	"b\n" ) STR() XSTR(VALUE) STR(VALUE)
+CAT(x, VALUE) CAT(, y) CAT(z, ) CAT(1.5, f) CAT(VA, LUE))") == R"("a + \"b\\n\"""""42""VALUE"xVALUEyz1.5f42)");
+	};
+
+	CrUnitTest(PreprocessorRescanning)
+	{
+		// Example of the rescanning from the C standard.
+		CrAssert(PreprocessToString(R"(#define x 3
+#define f(a) f(x * (a))
+#undef x
+#define x 2
+#define g f
+#define z z[0]
+#define h g(~
+#define m(a) a(w)
+#define w 0,1
+#define t(a) a
+f(y+1) + f(f(z)) % t(t(g)(0) + t)(1);
+g(x+(3,4)-w) | h 5) & m
+(f)^m(m);)") == "f(2*(y+1))+f(2*(f(2*(z[0]))))%f(2*(0))+t(1);f(2*(2+(3,4)-0,1))|f(2*(~5))&f(2*(0,1))^m(0,1);");
+	};
+
+	CrUnitTest(PreprocessorCachedExpansions)
+	{
+		CrAssert(PreprocessToString(R"(#define PI 3.14
+#define TWO_PI (2 * PI)
+#define A A B
+#define B A
+#define G F
+#define F(x) x + 1
+TWO_PI TWO_PI A A G(2) G (3)
+#undef PI
+#define PI 3
+#undef F
+#define F(x) x * 2
+TWO_PI G(4))") == "(2*3.14)(2*3.14)AAAA2+13+1(2*3)4*2");
+	};
+
+	CrUnitTest(PreprocessorHideSets)
+	{
+		HideSetTable hideSets;
+		auto const a = hideSets.Make(1), b = hideSets.Make(2);
+		auto const ab = hideSets.Union(a, b);
+		CrAssert(ab == hideSets.Union(b, a) && ab == hideSets.Union(ab, a));
+		CrAssert(hideSets.Contains(ab, 1) && hideSets.Contains(ab, 2) && !hideSets.Contains(ab, 3));
+		CrAssert(hideSets.Intersection(ab, b) == b && hideSets.Intersection(a, b) == EmptyHideSet);
+		CrAssert(hideSets.Union(EmptyHideSet, a) == a && !hideSets.Contains(EmptyHideSet, 1));
+	};
+
+	CrUnitTest(PreprocessorIncludes)
+	{
+		HeaderCache::Global().AddFile("PreprocessorIncludes/guarded.fxh", "#ifndef GUARDED\n#define GUARDED\nguarded\n#endif\n");
+		HeaderCache::Global().AddFile("PreprocessorIncludes/once.fxh", "#pragma once\nonce\n");
+		HeaderCache::Global().AddFile("PreprocessorIncludes/plain.fxh", "plain");
+		HeaderCache::Global().AddFile("PreprocessorIncludes/nested/inner.fxh", "#include \"../plain.fxh\"\ninner\n");
+
+		Preprocessor preprocessor(std::make_shared<IO::StringInputStream>(R"(#include "PreprocessorIncludes/guarded.fxh"
+#include "PreprocessorIncludes/guarded.fxh"
+#include <once.fxh>
+#include "PreprocessorIncludes/once.fxh"
+#include "PreprocessorIncludes/plain.fxh"
+#include "PreprocessorIncludes/plain.fxh"
+#include "PreprocessorIncludes/nested/inner.fxh"
+#if 0
+#include "PreprocessorIncludes/missing.fxh"
+#error Inactive.
+#endif
+end)"));
+		preprocessor.AddIncludeDirectory("PreprocessorIncludes");
+		std::string result;
+		for (auto lexeme = preprocessor.GetNextLexeme(); lexeme != Lexeme::Type::Null; lexeme = preprocessor.GetNextLexeme())
+		{
+			result.append(lexeme.GetText(), lexeme.GetLength());
+		}
+		CrAssert(result == "guardedonceplainplainplaininnerend");
+	};
+
+	CrUnitTest(PreprocessorSkippedBlocks)
+	{
+		// Inactive blocks may contain anything, even broken directives.
+		CrAssert(PreprocessToString(R"(#if 0
+	#define A broken
+	#undef B
+	#unknown
+	#if (
+		never
+	#elif
+	#else
+	#endif
+	#error Inactive.
+#elif 1
+	taken
+#elif (
+	never
+#else
+	never
+#endif
+#ifdef A
+	never
+#else
+	#define B b
+	B
+#endif
+#ifndef B
+#else
+	#if 0
+	#elif 0
+	#else
+		else
+	#endif
+#endif
+A B)") == "takenbelseAb");
+		for (auto const source : { "#if 0\n", "#if 0\n#if 1\n#endif\n", "#if 0\n#else\n#else\n#endif\n" })
+		{
+			try
+			{
+				PreprocessToString(source);
+				CrAssert(0);
+			}
+			catch (PreprocessorException const&)
+			{
+			}
+		}
+	};
+
+	CrUnitTest(PreprocessorConditionExpansion)
+	{
+		CrAssert(PreprocessToString(R"(#define QUALITY 2
+#define HIGH_QUALITY (QUALITY > 1)
+#define VERSION(major, minor) ((major) * 100 + (minor))
+#define OP +
+#define SELF SELF + 1
+#define EMPTY
+#define HAS_QUALITY defined(QUALITY)
+#define LOOP_A LOOP_B
+#define LOOP_B LOOP_A + 3
+#if HIGH_QUALITY && QUALITY == 2
+	a
+#endif
+#if VERSION(1, QUALITY) == 102 && VERSION(0, 1)
+	b
+#endif
+#if 1 OP 1 == 2
+	c
+#endif
+#if SELF == 1 && LOOP_A == 3
+	d
+#endif
+#if EMPTY 1 && defined EMPTY && !defined(NONE)
+	#if HAS_QUALITY
+		e
+	#endif
+#endif
+#if (UNDEFINED ? 1 / 0 : 0 || 1) && !(0 && 1 % 0)
+	f
+#endif
+#define A 1 + 2
+#define B (1) + (2)
+#if A * 2 == 5 && B * 2 == 5
+	g
+#else
+	never
+#endif
+#undef QUALITY
+#define QUALITY 0
+#if HIGH_QUALITY
+	never
+#endif)") == "abcdefg");
+
+		for (auto const source : { "#if\n#endif\n", "#if 1 /\n#endif\n", "#if 1 / 0\n#endif\n", "#define F(x) x\n#if F(1\n#endif\n", "#define E\n#if E\n#endif\n" })
+		{
+			try
+			{
+				PreprocessToString(source);
+				CrAssert(0);
+			}
+			catch (PreprocessorException const&)
+			{
+			}
+		}
+	};
+
+	CrUnitTest(PreprocessorLexemesBatches)
+	{
+		// Long expansions grow the pipe, many lines wrap it around.
+		std::string source = "#define X4 x x x x\n#define X16 X4 X4 X4 X4\n#define X64 X16 X16 X16 X16\n#define X256 X64 X64 X64 X64\nX256 X256 X64\n";
+		for (auto i = 0; i < 100; ++i)
+		{
+			source += "a b c\n";
+		}
+		Preprocessor singlePreprocessor(std::make_shared<IO::StringInputStream>(source.c_str()));
+		Preprocessor batchPreprocessor(std::make_shared<IO::StringInputStream>(source.c_str()));
+		Lexeme lexemes[7];
+		size_t lexemesCount = 0;
+		for (size_t count = 0; (count = batchPreprocessor.GetNextLexemes(lexemes, 7)) != 0;)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				auto const lexeme = singlePreprocessor.GetNextLexeme();
+				CrAssert(lexeme == lexemes[i].GetType() && lexeme.GetLength() == lexemes[i].GetLength()
+					&& strncmp(lexeme.GetText(), lexemes[i].GetText(), lexeme.GetLength()) == 0);
+			}
+			lexemesCount += count;
+			if (lexemes[count - 1] == Lexeme::Type::Null)
+			{
+				CrAssert(count < 7 || batchPreprocessor.GetNextLexemes(lexemes, 7) == 1);
+				break;
+			}
+		}
+		CrAssert(lexemesCount == 576 + 300 + 1);
+	};
+
+	CrUnitTest(PreprocessorBrokenMacros)
+	{
+		for (auto const source : { "#define F(x) #y\n", "#define F(x) ## x\n", "#define F(x) x\nF(1, 2)", "#define F(x) x\nF(1", "#define F(x) x ## +\nF(-)"
+			, "#include \"PreprocessorIncludes/missing.fxh\"\n", "#include\n", "#error Message.\n" })
+		{
+			try
+			{
+				PreprocessToString(source);
+				CrAssert(0);
+			}
+			catch (PreprocessorException const&)
+			{ }
+		}
+	};
+
 }	// namespace Cr
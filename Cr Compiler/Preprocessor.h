@@ -13,15 +13,85 @@
 
 #pragma once
 #include "Scanner.h"
+#include "HeaderCache.h"
 
-#include <deque>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace Cr
 {
 	CrDefineExceptionBase(PreprocessorException, WorkflowException);
 
+	/**
+	 * Identifier of the interned set of macro names. Zero is the empty set.
+	 */
+	typedef uint32_t HideSet;
+	static HideSet const EmptyHideSet = 0;
+
+	/**
+	 * Interns the hide sets of the lexemes, that are produced by the macro expansions.
+	 * Each lexeme carries the names of macros it was produced by, and such macros are never expanded from it.
+	 * Sets are sorted arrays of symbols, unions and intersections are memoized.
+	 */
+	class HideSetTable final
+	{
+	private:
+		struct HideSetHash
+		{
+			CRINL size_t operator() (std::vector<Symbol> const& symbols) const
+			{
+				return Hash::Fnv1a(reinterpret_cast<char const*>(symbols.data()), symbols.size() * sizeof(Symbol));
+			}
+		};	// struct HideSetHash
+
+		std::vector<std::vector<Symbol>>                                m_Sets;
+		std::unordered_map<std::vector<Symbol>, HideSet, HideSetHash>   m_SetsTable;
+		std::unordered_map<uint64_t, HideSet>                           m_Unions;
+		std::unordered_map<uint64_t, HideSet>                           m_Intersections;
+
+	public:
+		CR_API HideSetTable();
+
+		/**
+		 * Returns the set of the single symbol.
+		 */
+		CR_API HideSet Make(Symbol symbol);
+
+		/**
+		 * Returns union or intersection of two sets.
+		 */
+		/// @{
+		CR_API HideSet Union(HideSet first, HideSet second);
+		CR_API HideSet Intersection(HideSet first, HideSet second);
+		/// @}
+
+		/**
+		 * Checks whether the set contains the specified symbol.
+		 */
+		CRINL bool Contains(HideSet const hideSet, Symbol const symbol) const
+		{
+			auto const& symbols = m_Sets[hideSet];
+			return std::binary_search(symbols.begin(), symbols.end(), symbol);
+		}
+
+	private:
+		CR_INTERNAL HideSet Intern(std::vector<Symbol>&& symbols);
+	};	// class HideSetTable
+
+	/**
+	 * Macros that are observed by the conditional directive.
+	 */
+	struct ConditionDependency
+	{
+		SourceOffset        m_Location;	///< Location of the condition.
+		std::vector<Symbol> m_Macros;	///< Sorted names of the macros.
+	};	// struct ConditionDependency
+
 	/**
 	 * Represents a simple preprocessor for Cr language.
+	 * Whole translation unit is tokenized once, lines are separated with the new line lexemes.
 	 */
 	class Preprocessor
 	{
@@ -30,11 +100,60 @@ namespace Cr
 		/**
 		 * Initializes a new scanner from the specified stream.
 		 */
-		CRINL explicit Preprocessor(IO::PInputStream const& inputStream)
-			: m_InputStream(inputStream), m_DoWriteLexemes(true)
+		CR_API explicit Preprocessor(IO::PInputStream const& inputStream);
+
+		/**
+		 * Initializes a new preprocessor of the tokenized file.
+		 * @param file File that should stay alive while the preprocessor is used.
+		 */
+		CR_API explicit Preprocessor(TokenizedFile const& file);
+
+		/**
+		 * Initializes a new preprocessor that passes the already preprocessed lexemes, like the ones from the token cache.
+		 */
+		CR_API explicit Preprocessor(std::vector<Lexeme> const& lexemes);
+
+		/**
+		 * Adds the directory to search the included files in.
+		 * Files included with quotes are searched relatively to the including file first.
+		 */
+		CR_API void AddIncludeDirectory(char const* directory);
+
+		/**
+		 * Defines the macro like the '#define <name> <value>' directive does.
+		 * Function-like macros are defined with the parameters in the name, like "F(x)".
+		 */
+		CR_API void DefineMacro(char const* name, char const* value = "1");
+
+		/**
+		 * Starts recording the macros that are observed by the conditional directives and the macro expansions.
+		 * @param observableMacros Names of the macros, which observation is reported by 'GetObservedMacros'.
+		 */
+		CR_API void RecordDependencies(std::unordered_set<Symbol>&& observableMacros);
+
+		/**
+		 * Returns the observable macros, which definitions were checked or expanded.
+		 */
+		CRINL std::unordered_set<Symbol> const& GetObservedMacros() const
 		{
-			CrAssert(inputStream != nullptr);
-			ReadNextLexeme();
+			return m_ObservedMacros;
+		}
+
+		/**
+		 * Returns the macros, which definitions were checked by the evaluated conditions, in the order of evaluation.
+		 */
+		CRINL std::vector<ConditionDependency> const& GetConditionDependencies() const
+		{
+			return m_ConditionDependencies;
+		}
+
+		/**
+		 * Enables writing the new line lexeme after each preprocessed line, that is not empty.
+		 * New line lexeme is located at the end of the last source line of the preprocessed one.
+		 */
+		CRINL void SetDoWriteNewLines(bool const doWriteNewLines)
+		{
+			m_DoWriteNewLines = doWriteNewLines;
 		}
 
 		/**
@@ -42,45 +161,119 @@ namespace Cr
 		 */
 		CR_API Lexeme GetNextLexeme();
 
+		/**
+		 * Reads next lexemes from the specified stream.
+		 * @param lexemes Array of the specified length the lexemes are written to.
+		 * @returns Amount of the written lexemes. Fewer lexemes are written only when the null lexeme is reached,
+		 *          null lexeme is the last written one then.
+		 */
+		CR_API size_t GetNextLexemes(Lexeme* lexemes, size_t count);
+
 	private:
+
+		/**
+		 * File that includes another one, reading is continued from the lexeme after the '#include' directive.
+		 */
+		struct IncludingFile
+		{
+			TokenizedFile const* m_File;
+			size_t               m_LexemeIndex;
+		};	// struct IncludingFile
+
+		/**
+		 * Lexeme with the hide set.
+		 */
+		struct MacroLexeme
+		{
+			Lexeme  m_Lexeme;
+			HideSet m_HideSet;
+		};	// struct MacroLexeme
+
+		/**
+		 * Macro definition. Replacement list is tokenized once, references to the parameters are replaced
+		 * with the argument lexemes that hold the parameter indices, so expansion is a single splice.
+		 * Complete expansion of the object-like macro is cached until any macro is defined or undefined.
+		 */
 		struct Macro
 		{
-			std::deque<Lexeme> m_Lexemes;
+			std::vector<Lexeme>      m_Lexemes;
+			uint32_t                 m_ParamsCount = 0;
+			bool                     m_IsFunctionLike = false;
+			bool                     m_IsVariadic = false;
+			bool                     m_HasConcat = false;
+			bool                     m_IsExpansionCached = false;	///< Cached expansion is complete and can be spliced as is.
+			uint32_t                 m_ExpansionVersion = 0;		///< Version of the macros the expansion was cached at.
+			std::vector<MacroLexeme> m_Expansion;
+			bool                     m_IsValueCompiled = false;
+			CompiledCondition        m_Value;						///< Replacement list compiled as the condition, if it is a single primary expression.
 		};	// struct Macro
 
-		IO::PInputStream             m_InputStream;
-		Lexeme                       m_Lexeme;
-		bool                         m_DoWriteLexemes;
-		std::deque<Lexeme>           m_LinePipe;
-		std::deque<Lexeme>           m_LexemesPipe;
-		std::map<std::string, Macro> m_Macros;
+		/**
+		 * Lexemes that are rescanned for the macro invocations.
+		 * Expansions are pushed back in front of the remaining lexemes, lexemes of the source have empty hide sets.
+		 */
+		struct MacroInput
+		{
+			std::vector<MacroLexeme> m_Pending;	///< Lexemes of the expansions in the reversed order.
+			Lexeme const*            m_Cursor;
+			Lexeme const*            m_End;
+			bool                     m_IsCaching;	///< Input is expanded to be cached, arguments may continue after its end.
+			bool                     m_IsTruncated;	///< Input of the cached expansion ended inside the arguments.
+		};	// struct MacroInput
+
+		IO::PInputStream                  m_InputStream;
+		TokenizedFile                     m_MainFile;
+		TokenizedFile const*              m_File;
+		size_t                            m_LexemeIndex = 0;
+		std::vector<IncludingFile>        m_IncludeStack;
+		std::vector<std::string>          m_IncludeDirectories;
+		std::unordered_set<TokenizedFile const*> m_OnceFiles;
+		Lexeme                            m_Lexeme;
+		RingBuffer<Lexeme>                m_LexemesPipe;
+		bool                              m_DoWriteNewLines = false;
+		std::vector<MacroLexeme>          m_LineLexemes;
+		std::unordered_map<Symbol, Macro> m_Macros;
+		uint32_t                          m_MacrosVersion = 1;
+		HideSetTable                      m_HideSets;
+		bool                              m_DoRecordDependencies = false;
+		std::unordered_set<Symbol>        m_ObservableMacros;
+		std::unordered_set<Symbol>        m_ObservedMacros;
+		std::vector<Symbol>               m_ConditionMacros;
+		std::vector<ConditionDependency>  m_ConditionDependencies;
+		std::vector<Symbol>               m_EvaluatedMacros;
+		std::vector<int64_t>              m_SlotValues;
 
 		CR_INTERNAL void ReadNextLexeme();
 		CR_INTERNAL void ReadNextLexeme(Lexeme::Type const type);
 		CR_INTERNAL void ExpectLexeme(Lexeme::Type const type) const;
 
 		CR_INTERNAL void Parse_Block(bool const isGlobalScope = false);
+		CR_INTERNAL void SkipBlock();
 		CR_INTERNAL void Parse_OrdinaryLine();
+		CR_INTERNAL void Parse_Directive_Include();
+		CR_INTERNAL void Parse_Directive_Pragma();
+		CR_INTERNAL void Parse_Directive_Error();
 		CR_INTERNAL void Parse_Directive_Define();
 		CR_INTERNAL void Parse_Directive_Undef();
+
+		CR_INTERNAL bool ReadMacroInput(MacroInput& input, MacroLexeme& lexeme, bool const stopAtNewLine);
+		CR_INTERNAL bool PeekMacroInvocation(MacroInput const& input) const;
+		CR_INTERNAL void ExpandLexemes(MacroInput& input, std::vector<MacroLexeme>& output, bool const stopAtNewLine);
+		CR_INTERNAL bool ExpandMacro(MacroInput& input, MacroLexeme const& name, Macro& macro);
+		CR_INTERNAL bool CacheMacroExpansion(MacroLexeme const& name, Macro& macro);
+		CR_INTERNAL Lexeme StringizeLexemes(MacroLexeme const* begin, MacroLexeme const* end) const;
+		CR_INTERNAL Lexeme PasteLexemes(Lexeme const& left, Lexeme const& right) const;
+		CR_INTERNAL bool IsMacroDefined(Symbol const name);
+		CR_INTERNAL void RecordCondition(SourceOffset const location);
 		CR_INTERNAL void Parse_Directive_If();
 		CR_INTERNAL void Parse_Directive_Ifdef();
 		CR_INTERNAL void Parse_Directive_Ifndef();
-		CR_INTERNAL void Parse_Directive_ElifElseEndif_Section(bool const cond, bool const allowElifOrElse = true);
-
-		CR_INTERNAL int64_t EvaluateExpression();
-		CR_INTERNAL int64_t EvaluateExpression_Or();
-		CR_INTERNAL int64_t EvaluateExpression_And();
-		CR_INTERNAL int64_t EvaluateExpression_BitwiseOr();
-		CR_INTERNAL int64_t EvaluateExpression_BitwiseXor();
-		CR_INTERNAL int64_t EvaluateExpression_BitwiseAnd();
-		CR_INTERNAL int64_t EvaluateExpression_Equals_OR_NotEquals();
-		CR_INTERNAL int64_t EvaluateExpression_Less_OR_LessEquals_OR_Greater_OR_GreaterEquals();
-		CR_INTERNAL int64_t EvaluateExpression_BitwiseLeftShift_OR_BitwiseRightShift();
-		CR_INTERNAL int64_t EvaluateExpression_Add_OR_Subtract();
-		CR_INTERNAL int64_t EvaluateExpression_Multiply_OR_Divide_OR_Modulo();
-		CR_INTERNAL int64_t EvaluateExpression_Unary();
-		CR_INTERNAL int64_t EvaluateExpression_Primary();
+		CR_INTERNAL void Parse_Directive_ElifElseEndif_Section(bool const cond, bool const isAnyTaken, bool const allowElifOrElse = true);
+
+		CR_INTERNAL bool EvaluateCondition();
+		CR_INTERNAL bool EvaluateCompiledCondition(CompiledCondition const& condition, bool const doReadMacros, int64_t& value);
+		CR_INTERNAL bool EvaluateMacroValue(Symbol const name, int64_t& value);
+		CR_INTERNAL int64_t EvaluateExpandedCondition(Lexeme const* begin, Lexeme const* end);
 
 	};	// class Preprocessor
 
@@ -23,56 +23,68 @@ namespace Cr
 
 	CR_API Ast::NotExpression* Profile::CreateNotExpression(Ast::Expression* const expr)
 	{
-		return new Ast::NotExpression(expr);
+		return m_Arena.New<Ast::NotExpression>(expr);
 	}
 	CR_API Ast::BitwiseNotExpression* Profile::CreateBitwiseNotExpression(Ast::Expression* const expr)
 	{
-		return new Ast::BitwiseNotExpression(expr);
+		return m_Arena.New<Ast::BitwiseNotExpression>(expr);
 	}
 	CR_API Ast::NegateExpression* Profile::CreateNegateExpression(Ast::Expression* const expr)
 	{
-		return new Ast::NegateExpression(expr);
+		return m_Arena.New<Ast::NegateExpression>(expr);
 	}
 
 	CR_API Ast::CommaExpression* Profile::CreateCommaExpression()
 	{
-		return new Ast::CommaExpression();
+		return m_Arena.New<Ast::CommaExpression>();
 	}
 
 	CR_API Ast::LogicBinaryExpression* Profile::CreateLogicBinaryExpression(Lexeme::Type const op, Ast::Expression* const lhs, Ast::Expression* const rhs)
 	{
-		return new Ast::LogicBinaryExpression(op, lhs, rhs);
+		return m_Arena.New<Ast::LogicBinaryExpression>(op, lhs, rhs);
 	}
 	CR_API Ast::BitwiseBinaryExpression* Profile::CreateBitwiseBinaryExpression(Lexeme::Type const op, Ast::Expression* const lhs, Ast::Expression* const rhs)
 	{
-		return new Ast::BitwiseBinaryExpression(op, lhs, rhs);
+		return m_Arena.New<Ast::BitwiseBinaryExpression>(op, lhs, rhs);
 	}
 	CR_API Ast::ArithmeticBinaryExpression* Profile::CreateArithmeticBinaryExpression(Lexeme::Type const op, Ast::Expression* const lhs, Ast::Expression* const rhs)
 	{
-		return new Ast::ArithmeticBinaryExpression(op, lhs, rhs);
+		return m_Arena.New<Ast::ArithmeticBinaryExpression>(op, lhs, rhs);
 	}
 
 	CR_API Ast::AssignmentBinaryExpression* Profile::CreateAssignmentBinaryExpression(Ast::Expression* const lhs, Ast::Expression* const rhs)
 	{
-		return new Ast::AssignmentBinaryExpression(lhs, rhs);
+		return m_Arena.New<Ast::AssignmentBinaryExpression>(lhs, rhs);
 	}
 	CR_API Ast::BitwiseAssignmentBinaryExpression* Profile::CreateBitwiseAssignmentBinaryExpression(Lexeme::Type const op, Ast::Expression* const lhs, Ast::Expression* const rhs)
 	{
-		return new Ast::BitwiseAssignmentBinaryExpression(op, lhs, rhs);
+		return m_Arena.New<Ast::BitwiseAssignmentBinaryExpression>(op, lhs, rhs);
 	}
 	CR_API Ast::ArithmeticAssignmentBinaryExpression* Profile::CreateArithmeticAssignmentBinaryExpression(Lexeme::Type const op, Ast::Expression* const lhs, Ast::Expression* const rhs)
 	{
-		return new Ast::ArithmeticAssignmentBinaryExpression(op, lhs, rhs);
+		return m_Arena.New<Ast::ArithmeticAssignmentBinaryExpression>(op, lhs, rhs);
 	}
 
 	CR_API Ast::TernaryExpression* Profile::CreateTernaryExpression(Ast::Expression* const condExpr, Ast::Expression* const thenExpr, Ast::Expression* const elseExpr)
 	{
-		return new Ast::TernaryExpression(condExpr, thenExpr, elseExpr);
+		return m_Arena.New<Ast::TernaryExpression>(condExpr, thenExpr, elseExpr);
 	}
 
 	CR_API Ast::ConstantExpression* Profile::CreateConstExpression(Ast::Value const& value, Ast::Type const& type)
 	{
-		return new Ast::ConstantExpression(value, type);
+		return m_Arena.New<Ast::ConstantExpression>(value, type);
+	}
+	CR_API Ast::IdentifierExpression* Profile::CreateIdentifierExpression(Ast::Identifier* const ident)
+	{
+		return m_Arena.New<Ast::IdentifierExpression>(ident);
+	}
+	CR_API Ast::CastExpression* Profile::CreateCastExpression(Ast::Type const& castTo, Ast::Expression* const expr)
+	{
+		return m_Arena.New<Ast::CastExpression>(castTo, expr);
+	}
+	CR_API Ast::SubscriptExpression* Profile::CreateSubscriptExpression()
+	{
+		return m_Arena.New<Ast::SubscriptExpression>();
 	}
 
 	// *************************************************************** //
@@ -81,59 +93,59 @@ namespace Cr
 
 	CR_API Ast::CompoundStatement* Profile::CreateCompoundStatement()
 	{
-		return new Ast::CompoundStatement();
-	}
-	CR_API Ast::CompoundStatement* Profile::CreateCompoundStatement(std::vector<std::unique_ptr<Ast::Statement>>&& stmts)
-	{
-		return new Ast::CompoundStatement(std::forward<std::vector<std::unique_ptr<Ast::Statement>>>(stmts));
+		return m_Arena.New<Ast::CompoundStatement>();
 	}
 
 	CR_API Ast::IfSelectionStatement* Profile::CreateIfSelectionStatement()
 	{
-		return new Ast::IfSelectionStatement();
+		return m_Arena.New<Ast::IfSelectionStatement>();
 	}
 	CR_API Ast::SwitchSelectionStatement* Profile::CreateSwitchSelectionStatement()
 	{
-		return new Ast::SwitchSelectionStatement();
+		return m_Arena.New<Ast::SwitchSelectionStatement>();
 	}
 	CR_API Ast::SwitchSection* Profile::CreateSwitchSection()
 	{
-		return new Ast::SwitchSection();
+		return m_Arena.New<Ast::SwitchSection>();
 	}
 
 	CR_API Ast::DoWhileIterationStatement* Profile::CreateDoIterationStatement()
 	{
-		return new Ast::DoWhileIterationStatement();
+		return m_Arena.New<Ast::DoWhileIterationStatement>();
 	}
 	CR_API Ast::ForIterationStatement* Profile::CreateForIterationStatement()
 	{
-		return new Ast::ForIterationStatement();
+		return m_Arena.New<Ast::ForIterationStatement>();
 	}
 	CR_API Ast::WhileIterationStatement* Profile::CreateWhileIterationStatement()
 	{
-		return new Ast::WhileIterationStatement();
+		return m_Arena.New<Ast::WhileIterationStatement>();
 	}
 
 	CR_API Ast::BreakJumpStatement* Profile::CreateBreakJumpStatement()
 	{
-		return new Ast::BreakJumpStatement();
+		return m_Arena.New<Ast::BreakJumpStatement>();
 	}
 	CR_API Ast::ContinueJumpStatement* Profile::CreateContinueJumpStatement()
 	{
-		return new Ast::ContinueJumpStatement();
+		return m_Arena.New<Ast::ContinueJumpStatement>();
 	}
 	CR_API Ast::ReturnJumpStatement* Profile::CreateReturnJumpStatement()
 	{
-		return new Ast::ReturnJumpStatement();
+		return m_Arena.New<Ast::ReturnJumpStatement>();
 	}
 	CR_API Ast::DiscardJumpStatement* Profile::CreateDiscardJumpStatement()
 	{
-		return new Ast::DiscardJumpStatement();
+		return m_Arena.New<Ast::DiscardJumpStatement>();
 	}
 
 	CR_API Ast::ExpressionStatement* Profile::CreateExpressionStatement()
 	{
-		return new Ast::ExpressionStatement();
+		return m_Arena.New<Ast::ExpressionStatement>();
+	}
+	CR_API Ast::DeclarationStatement* Profile::CreateDeclarationStatement()
+	{
+		return m_Arena.New<Ast::DeclarationStatement>();
 	}
 
 }	// namespace Cr
@@ -22,7 +22,7 @@ namespace Cr
 	namespace Ast
 	{
 		struct Type;
-		union Value;
+		class Value;
 		class BitwiseNotExpression;
 		class NotExpression;
 		class NegateExpression;
@@ -52,11 +52,26 @@ namespace Cr
 		class WhileIterationStatement;
 		class Expression;
 		class Function;
+		class IdentifierExpression;
+		class CastExpression;
+		class SubscriptExpression;
+		class DeclarationStatement;
+		struct Identifier;
 	}	// namespace Ast
 
+	/**
+	 * Factory of the AST nodes.
+	 * Nodes are allocated in the arena, which is owned by the compilation unit and releases the whole tree at once.
+	 */
 	class Profile
 	{
+	protected:
+		Arena& m_Arena;
+
 	public:
+		CR_API explicit Profile(Arena& arena)
+			: m_Arena(arena)
+		{}
 
 		// *************************************************************** //
 		// **                     Expressions parsing.                  ** //
@@ -80,13 +95,15 @@ namespace Cr
 
 		CR_API virtual Ast::Expression* CreateValueExpression(...) {return nullptr;}
 		CR_API virtual Ast::ConstantExpression* CreateConstExpression(Ast::Value const& value, Ast::Type const& type);
+		CR_API virtual Ast::IdentifierExpression* CreateIdentifierExpression(Ast::Identifier* const ident);
+		CR_API virtual Ast::CastExpression* CreateCastExpression(Ast::Type const& castTo, Ast::Expression* const expr);
+		CR_API virtual Ast::SubscriptExpression* CreateSubscriptExpression();
 
 		// *************************************************************** //
 		// **                     Statements parsing.                   ** //
 		// *************************************************************** //
 
 		CR_API virtual Ast::CompoundStatement* CreateCompoundStatement();
-		CR_API virtual Ast::CompoundStatement* CreateCompoundStatement(std::vector<std::unique_ptr<Ast::Statement>>&& stmts);
 
 		CR_API virtual Ast::IfSelectionStatement* CreateIfSelectionStatement() ;
 		CR_API virtual Ast::SwitchSelectionStatement* CreateSwitchSelectionStatement();
@@ -102,6 +119,7 @@ namespace Cr
 		CR_API virtual Ast::DiscardJumpStatement* CreateDiscardJumpStatement();
 
 		CR_API virtual Ast::ExpressionStatement* CreateExpressionStatement();
+		CR_API virtual Ast::DeclarationStatement* CreateDeclarationStatement();
 	};
 
 }	// namespace Cr
@@ -12,540 +12,422 @@
 // $$***************************************************************$$ //
 
 #include "Scanner.h"
+#include "Simd.h"
 
 namespace Cr
 {
+	// *************************************************************** //
+	// **                 Scanner tables generation.                ** //
+	// *************************************************************** //
+
+	enum : uint8_t
+	{
+		CrCharSpace    = 1 << 0,
+		CrCharNewLine  = 1 << 1,
+		CrCharAlpha    = 1 << 2,
+		CrCharDigit    = 1 << 3,
+		CrCharHexDigit = 1 << 4,
+		CrCharOctDigit = 1 << 5,
+	};
+
+	struct OperatorSpelling
+	{
+		char const*  m_Spelling;
+		Lexeme::Type m_Type;
+	};	// struct OperatorSpelling
+
 	/**
-	 * Overload of the global function to support '_' and '$' as alphabetic characters.
+	 * All operators of the language. Operator DFA is generated from this list.
 	 */
-	static int isalpha(int const c)
-	{
-		return c == '_' || c == '$' || ::isalpha(c);
-	}
+	static constexpr OperatorSpelling s_Operators[] = {
+		{ "+",  Lexeme::Type::OpAdd              }, { "+=",  Lexeme::Type::OpAddAssign               }, { "++", Lexeme::Type::OpInc },
+		{ "-",  Lexeme::Type::OpSubtract         }, { "-=",  Lexeme::Type::OpSubtractAssign          }, { "--", Lexeme::Type::OpDec },
+		{ "*",  Lexeme::Type::OpMultiply         }, { "*=",  Lexeme::Type::OpMultiplyAssign          },
+		{ "/",  Lexeme::Type::OpDivide           }, { "/=",  Lexeme::Type::OpDivideAssign            },
+		{ "%",  Lexeme::Type::OpModulo           }, { "%=",  Lexeme::Type::OpModuloAssign            },
+		{ "=",  Lexeme::Type::OpAssignment       }, { "==",  Lexeme::Type::OpEquals                  },
+		{ "!",  Lexeme::Type::OpNot              }, { "!=",  Lexeme::Type::OpNotEquals               },
+		{ ">",  Lexeme::Type::OpGreater          }, { ">=",  Lexeme::Type::OpGreaterEquals           },
+		{ ">>", Lexeme::Type::OpBitwiseRightShift}, { ">>=", Lexeme::Type::OpBitwiseRightShiftAssign },
+		{ "<",  Lexeme::Type::OpLess             }, { "<=",  Lexeme::Type::OpLessEquals              },
+		{ "<<", Lexeme::Type::OpBitwiseLeftShift }, { "<<=", Lexeme::Type::OpBitwiseLeftShiftAssign  },
+		{ "&",  Lexeme::Type::OpBitwiseAnd       }, { "&=",  Lexeme::Type::OpBitwiseAndAssign        }, { "&&", Lexeme::Type::OpAnd },
+		{ "|",  Lexeme::Type::OpBitwiseOr        }, { "|=",  Lexeme::Type::OpBitwiseOrAssign         }, { "||", Lexeme::Type::OpOr  },
+		{ "^",  Lexeme::Type::OpBitwiseXor       }, { "^=",  Lexeme::Type::OpBitwiseXorAssign        },
+		{ "~",  Lexeme::Type::OpBitwiseNot       }, { ";",   Lexeme::Type::OpSemicolon               },
+		{ "?",  Lexeme::Type::OpTernary          }, { ":",   Lexeme::Type::OpColon                   },
+		{ ",",  Lexeme::Type::OpComma            }, { ".",   Lexeme::Type::OpDot                     },
+		{ "{",  Lexeme::Type::OpBraceOpen        }, { "}",   Lexeme::Type::OpBraceClose              },
+		{ "[",  Lexeme::Type::OpBracketOpen      }, { "]",   Lexeme::Type::OpBracketClose            },
+		{ "(",  Lexeme::Type::OpParenOpen        }, { ")",   Lexeme::Type::OpParenClose              },
+		{ "#",  Lexeme::Type::OpPreprocessor     }, { "##",  Lexeme::Type::OpPreprocessorConcat      },
+	};
+
+	static constexpr size_t s_OperatorsCount = sizeof(s_Operators) / sizeof(s_Operators[0]);
+	static constexpr size_t s_OperatorCharsMax = 32;
+	static constexpr size_t s_OperatorStatesMax = s_OperatorsCount + 1;
 
 	/**
-	 * Returns true if specified character is octal digit.
+	 * Character classes and the operators DFA.
+	 * State 0 is the initial state, transition to state 0 means that operator is complete.
 	 */
-	static int isodigit(int const c)
+	struct ScannerTables
+	{
+		uint8_t      m_CharFlags[256];
+		uint8_t      m_OperatorChars[256];
+		uint8_t      m_Transitions[s_OperatorStatesMax][s_OperatorCharsMax];
+		Lexeme::Type m_Accepts[s_OperatorStatesMax];
+	};	// struct ScannerTables
+
+	static constexpr ScannerTables BuildScannerTables()
+	{
+		ScannerTables tables = {};
+		for (auto c = 0; c < 256; ++c)
+		{
+			uint8_t flags = 0;
+			if (c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f')
+				flags |= CrCharSpace;
+			if (c == '\n')
+				flags |= CrCharSpace | CrCharNewLine;
+			if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == '$')
+				flags |= CrCharAlpha;
+			if (c >= '0' && c <= '9')
+				flags |= CrCharDigit | CrCharHexDigit;
+			if ((c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F'))
+				flags |= CrCharHexDigit;
+			if (c >= '0' && c <= '7')
+				flags |= CrCharOctDigit;
+			tables.m_CharFlags[c] = flags;
+		}
+
+		// Building a trie of operator spellings, that is a DFA for the maximal munch.
+		size_t charsCount = 0, statesCount = 1;
+		for (size_t i = 0; i < s_OperatorsCount; ++i)
+		{
+			size_t state = 0;
+			for (auto spelling = s_Operators[i].m_Spelling; *spelling != '\0'; ++spelling)
+			{
+				auto const c = static_cast<uint8_t>(*spelling);
+				if (tables.m_OperatorChars[c] == 0)
+				{
+					tables.m_OperatorChars[c] = static_cast<uint8_t>(++charsCount);
+				}
+				auto const opChar = tables.m_OperatorChars[c];
+				if (tables.m_Transitions[state][opChar] == 0)
+				{
+					tables.m_Transitions[state][opChar] = static_cast<uint8_t>(statesCount++);
+				}
+				state = tables.m_Transitions[state][opChar];
+			}
+			tables.m_Accepts[state] = s_Operators[i].m_Type;
+		}
+		return tables;
+	}
+
+	static constexpr ScannerTables s_Tables = BuildScannerTables();
+
+	CRINL static uint8_t GetCharFlags(char const c)
 	{
-		return c >= '0' && c <= '7';
+		return s_Tables.m_CharFlags[static_cast<uint8_t>(c)];
 	}
 
 	// *************************************************************** //
 	// **               Scanner class implementation.               ** //
 	// *************************************************************** //
 
-	enum class ScannerState
+	/**
+	 * Initializes a new scanner from the specified stream.
+	 */
+	CR_API Scanner::Scanner(IO::PInputStream const& inputStream, SymbolTable& symbolTable /*= SymbolTable::Global()*/)
+		: m_InputStream(inputStream), m_SymbolTable(symbolTable)
 	{
-		Undefined,
-
-		Parsing_Identifier_OR_Keyword,
-
-		Parsing_DECIMAL_ConstantInteger_OR_ConstantFloat_OR_ConstantDouble, Parsing_DECIMAL_ConstantFloat_OR_ConstantDouble_FractionPart,
-		Parsing_OCTAL_OR_HEXADECIMAL_ConstantInteger, Parsing_OCTAL_ConstantInteger, Parsing_HEXADECIMAL_ConstantInteger,
-			
-		Parsing_ConstantString,
-
-		Parsing_OpAdd_OR_OpAddAssign_OR_OpInc,
-		Parsing_OpSubtract_OR_OpSubtractAssign_OR_OpDec,
-		Parsing_OpMultiply_OR_OpMultiplyAssign,
-		Parsing_OpDivide_OR_OpDivideAssign_OR_SignleLineComment_OR_MultiLineComment,
-		Parsing_SingleLineComment,
-		Parsing_MultiLineComment,
-		Parsing_OpModulo_OR_OpModuloAssign,
-		Parsing_OpAssignment_OR_OpEquals,
-		Parsing_OpNot_OR_OpNotEquals,
-		Parsing_OpGreater_OR_OpGreaterEquals_OR_OpBitwiseRightShift_OR_OpBitwiseRightShiftAssign,
-		Parsing_OpBitwiseRightShift_OR_OpBitwiseRightShiftAssign,
-		Parsing_OpLess_OR_OpLessEquals_OR_OpBitwiseLeftShift_OR_OpBitwiseLeftShiftAssign,
-		Parsing_OpBitwiseLeftShift_OR_OpBitwiseLeftShiftAssign,
-		Parsing_OpAnd_OR_OpBitwiseAnd_OR_OpBitwiseAndAssign,
-		Parsing_OpOr_OR_OpBitwiseOr_OR_OpBitwiseOrAssign,
-		Parsing_OpBitwiseXor_OR_OpBitwiseXorAssign,
-		Parsing_OpDot_OR_DECIMAL_ConstantFloat_OR_ConstantDouble_FractionPart,
-		Parsing_OpPreprocessor_OR_OpPreprocessorGlue,
-
-	};	// enum class State
+		assert(inputStream != nullptr);
+		if (m_InputStream->GetBuffer(m_Cursor, m_End))
+		{
+			// Stream is backed by the contiguous memory, it is kept alive by the source manager.
+			m_Offset = SourceManager::Global().AddBuffer(nullptr, m_Cursor, m_End, m_InputStream);
+		}
+		else
+		{
+			// Reading the stream once.
+			std::string buffer;
+			for (auto c = m_InputStream->ReadNextChar(); c != EOF; c = m_InputStream->ReadNextChar())
+			{
+				buffer.push_back(static_cast<char>(c));
+			}
+			auto const length = buffer.size();
+			m_Offset = SourceManager::Global().AddBuffer(nullptr, std::move(buffer));
+			m_Cursor = SourceManager::Global().GetText(m_Offset);
+			m_End = m_Cursor + length;
+		}
+		m_Begin = m_Cursor;
+	}
 
 	/**
-	 * Reads next character from the specified stream.
+	 * Initializes a new scanner that walks the specified memory range directly.
 	 */
-	CRINL void Scanner::ReadNextChar()
+	CR_API Scanner::Scanner(char const* const begin, char const* const end, SourceOffset const offset /*= NullSourceOffset*/
+		, SymbolTable& symbolTable /*= SymbolTable::Global()*/)
+		: m_SymbolTable(symbolTable), m_Begin(begin), m_Cursor(begin), m_End(end), m_Offset(offset)
 	{
-		m_PrevChar = m_Char;
-		m_Char = m_InputStream->ReadNextChar();
+		assert(begin != nullptr && begin <= end);
+		if (m_Offset == NullSourceOffset)
+		{
+			// Scanning the copy, so the text of the lexemes is the scanned one.
+			m_Offset = SourceManager::Global().AddBuffer(nullptr, begin, end);
+			m_Begin = m_Cursor = SourceManager::Global().GetText(m_Offset);
+			m_End = m_Cursor + (end - begin);
+		}
 	}
 
-#if _MSC_VER
-#	pragma warning(push)
-#	pragma warning(disable : 4244) // 'argument' : conversion from 'type1' to 'type2', possible loss of data.
-#endif
-
-#if __clang__
-#	pragma clang diagnostic push
-#	pragma clang diagnostic ignored "-Wconversion"
-#endif
-
 	/**
 	 * Reads next lexem from the specified stream.
 	 * @returns Scanned lexeme or null lexeme on end of stream.
 	 */
-	//! @todo Add lexeme emerging (E.g. '-', '1' -> '-1'; '"a"', '"b"' -> '"ab"').
 	CR_API Lexeme Scanner::GetNextLexeme() throw(ScannerException)
 	{
-		std::string bufferedString;
-		auto bufferedInt = 0ui64;
-		auto bufferedReal = 0.0;
-		auto bufferedRealExponent = 1.0;
-		
-		// Executing the state machine to chop next lexeme.
-		for (auto state = ScannerState::Undefined;;)
+		char const* begin;
+		char const* end;
+		auto const type = ScanNextLexeme(begin, end);
+		auto const offset = GetOffset(begin);
+		auto const length = static_cast<uint32_t>(end - begin);
+		switch (type)
 		{
-			switch (state)
-			{
-				// *************************************************************** //
-				case ScannerState::Undefined:
-					if (m_Char == EOF)
-					{
-						return Lexeme(Lexeme::Type::Null);
-					}
-					if (isspace(m_Char))
-					{
-						// Skipping all unnecessary spaces.
-						ReadNextChar();
-					}
-					else
-					{	
-						// Proceeding alphabetical characters or digits.
-						if (isalpha(m_Char))
-						{
-							state = ScannerState::Parsing_Identifier_OR_Keyword;
-							bufferedString.push_back(m_Char);
-						}
-						else if (isdigit(m_Char))
-						{
-							if (m_Char != '0')
-							{
-								// This numeric constant is octal or hexadecimal.
-								state = ScannerState::Parsing_DECIMAL_ConstantInteger_OR_ConstantFloat_OR_ConstantDouble;
-								bufferedInt = m_Char - '0';
-							}
-							else
-							{
-								// This numeric constant is decimal.
-								state = ScannerState::Parsing_OCTAL_OR_HEXADECIMAL_ConstantInteger;
-							}
-						}
-						else switch (m_Char)
-						{	
-							case '"': state = ScannerState::Parsing_ConstantString; break;
-
-							// Or determining operator: possible composite operator...
-							case '+': state = ScannerState::Parsing_OpAdd_OR_OpAddAssign_OR_OpInc; break;
-							case '-': state = ScannerState::Parsing_OpSubtract_OR_OpSubtractAssign_OR_OpDec; break;
-							case '*': state = ScannerState::Parsing_OpMultiply_OR_OpMultiplyAssign; break;
-							case '/': state = ScannerState::Parsing_OpDivide_OR_OpDivideAssign_OR_SignleLineComment_OR_MultiLineComment; break;
-							case '%': state = ScannerState::Parsing_OpModulo_OR_OpModuloAssign; break;
-							case '=': state = ScannerState::Parsing_OpAssignment_OR_OpEquals; break;
-							case '!': state = ScannerState::Parsing_OpNot_OR_OpNotEquals; break;
-							case '>': state = ScannerState::Parsing_OpGreater_OR_OpGreaterEquals_OR_OpBitwiseRightShift_OR_OpBitwiseRightShiftAssign; break;
-							case '<': state = ScannerState::Parsing_OpLess_OR_OpLessEquals_OR_OpBitwiseLeftShift_OR_OpBitwiseLeftShiftAssign; break;
-							case '&': state = ScannerState::Parsing_OpAnd_OR_OpBitwiseAnd_OR_OpBitwiseAndAssign; break;
-							case '|': state = ScannerState::Parsing_OpOr_OR_OpBitwiseOr_OR_OpBitwiseOrAssign; break;
-							case '^': state = ScannerState::Parsing_OpBitwiseXor_OR_OpBitwiseXorAssign; break;
-							case '.': state = ScannerState::Parsing_OpDot_OR_DECIMAL_ConstantFloat_OR_ConstantDouble_FractionPart; break;
-							case '#': state = ScannerState::Parsing_OpPreprocessor_OR_OpPreprocessorGlue; break;
-
-							// ...or single-character one. 
-							default:
-								ReadNextChar();
-								switch (m_PrevChar)
-								{
-									case '~': return Lexeme(Lexeme::Type::OpBitwiseNot);
-									case ';': return Lexeme(Lexeme::Type::OpSemicolon);
-									case '?': return Lexeme(Lexeme::Type::OpTernary);
-									case ':': return Lexeme(Lexeme::Type::OpColon);
-									case ',': return Lexeme(Lexeme::Type::OpComma);
-									case '{': return Lexeme(Lexeme::Type::OpBraceOpen);
-									case '}': return Lexeme(Lexeme::Type::OpBraceClose);
-									case '[': return Lexeme(Lexeme::Type::OpBracketOpen);
-									case ']': return Lexeme(Lexeme::Type::OpBracketClose);
-									case '(': return Lexeme(Lexeme::Type::OpParenOpen);
-									case ')': return Lexeme(Lexeme::Type::OpParenClose);
-									default:
-										throw ScannerException("Unsupported character in the input stream.");
-								}	// switch (m_PrevChar)
-
-						}	// switch (m_Char)
-						ReadNextChar();
-					}
-					break;
-
-				// *************************************************************** //
-				case ScannerState::Parsing_Identifier_OR_Keyword:
-					if (isalpha(m_Char) || isdigit(m_Char))
-					{
-						bufferedString.push_back(m_Char);
-						ReadNextChar();
-					}
-					else
-					{
-						if (Lexeme::s_KeywordsTable.count(bufferedString) != 0)
-						{
-							return Lexeme(Lexeme::s_KeywordsTable.at(bufferedString));
-						}
-						/// @todo Simplify this trash somehow.
-						PIdentifier identifier = new Identifier { bufferedString };
-						if (m_IdentifierTable != nullptr)
-						{
-						//	identifier = new Identifier();
-							(*m_IdentifierTable)[bufferedString].reset(identifier);
-						}
-						return Lexeme(identifier);
-					}
-					break;
+			case Lexeme::Type::IdIdentifier:
+				return Lexeme(type, m_SymbolTable.Intern(begin, length), offset, length, m_Flags);
+			default:
+				// Numeric constants are decoded from the source on demand.
+				return Lexeme(type, 0, offset, length, m_Flags);
+		}
+	}
 
-				//! @todo Implement postfix parsing.
-				// *************************************************************** //
-				case ScannerState::Parsing_DECIMAL_ConstantInteger_OR_ConstantFloat_OR_ConstantDouble:
-					if (m_Char == '\'')
-					{
-						ReadNextChar();
-					}
-					else if (isdigit(m_Char))
-					{
-						bufferedInt *= 10;
-						bufferedInt += m_Char - '0';
-						ReadNextChar();
-					}
-					else if (m_Char == '.')
-					{
-						bufferedReal = static_cast<double>(bufferedInt);
-						state = ScannerState::Parsing_DECIMAL_ConstantFloat_OR_ConstantDouble_FractionPart;
-						ReadNextChar();
-					}
-					else
-					{
-						if (bufferedInt > INT32_MAX)
-						{
-							/// @todo Uncomment warning.
-						//	throw ScannerException("Decimal integer constant is truncated to 32-bit.");
-						}
-						return Lexeme(Lexeme::Type::CtInt, static_cast<uint32_t>(bufferedInt));
-					}
-					break;
-				case ScannerState::Parsing_DECIMAL_ConstantFloat_OR_ConstantDouble_FractionPart:
-				//	assert(0 && "Not implemented.");
-					//! @todo Implement 'e' notation for exponent part.
-					if (isdigit(m_Char))
-					{
-						bufferedRealExponent /= 10.0f;
-						bufferedReal += (m_Char - '0') * bufferedRealExponent;
-						ReadNextChar();
-					}
-					else
-					{
-						// End of real constant. Parsing suffix.
-						switch (m_Char)
-						{
-							case 'f': case 'F':
-								ReadNextChar();
-								if (bufferedReal > FLT_MAX || bufferedReal < FLT_MIN)
-								{
-									/// @todo Uncomment warning.
-								//	throw ScannerException("Float constant is truncated to 32-bit.");
-								}
-								return Lexeme(Lexeme::Type::CtFloat, bufferedReal);
-							default:
-								return Lexeme(Lexeme::Type::CtDouble, bufferedReal);
-						}
-					}
-					break;
+	/**
+	 * Scans all remaining lexemes of the stream.
+	 * Lines are separated with the new line lexemes, the last line is terminated with the new line lexeme too.
+	 * @param lexemes Array the lexemes are appended to. Null lexeme is appended at the end.
+	 */
+	CR_API void Scanner::Tokenize(std::vector<Lexeme>& lexemes) throw(ScannerException)
+	{
+		// Roughly one lexeme per five characters of the typical shader.
+		lexemes.reserve(lexemes.size() + static_cast<size_t>(m_End - m_Cursor) / 5 + 2);
 
-				// *************************************************************** //
-				case ScannerState::Parsing_OCTAL_OR_HEXADECIMAL_ConstantInteger:
-					if (m_Char == 'x' || m_Char == 'X')
-					{
-						state = ScannerState::Parsing_HEXADECIMAL_ConstantInteger;
-						ReadNextChar();
-						break;
-					}
-					state = ScannerState::Parsing_OCTAL_ConstantInteger;
-					break;
-				case ScannerState::Parsing_OCTAL_ConstantInteger:
-					if (m_Char == '\'')
-					{
-						ReadNextChar();
-					}
-					if (isodigit(m_Char))
-					{
-						bufferedInt *= 010;
-						bufferedInt += m_Char - '0';
-						ReadNextChar();
-					}
-					else
-					{
-						if (bufferedInt > INT32_MAX)
-						{
-							/// @todo Uncomment warning.
-						//	throw ScannerException("Octal integer constant is truncated to 32-bit.");
-						}
-						return Lexeme(Lexeme::Type::CtInt, static_cast<uint32_t>(bufferedInt));
-					}
-					break;
-				case ScannerState::Parsing_HEXADECIMAL_ConstantInteger:
-					if (m_Char == '\'')
-					{
-						ReadNextChar();
-					}
-					if (isxdigit(m_Char))
-					{
-						bufferedInt *= 0x10;
-						if (isdigit(m_Char))
-						{
-							bufferedInt += m_Char - '0';
-						}
-						else
-						{
-							bufferedInt += tolower(m_Char) - 'a';
-						}
-						ReadNextChar();
-					}
-					else
-					{
-						if (bufferedInt > INT32_MAX)
-						{
-							/// @todo Uncomment warning.
-						//	throw ScannerException("Hexadecimal integer constant is truncated to 32-bit.");
-						}
-						return Lexeme(Lexeme::Type::CtInt, static_cast<uint32_t>(bufferedInt));
-					}
-					break;
-				
-				// *************************************************************** //
-				case ScannerState::Parsing_OpAdd_OR_OpAddAssign_OR_OpInc:
-					if (m_Char == '+')
-					{
-						ReadNextChar();
-						return Lexeme(Lexeme::Type::OpInc);
-					}
-					if (m_Char == '=')
-					{
-						ReadNextChar();
-						return Lexeme(Lexeme::Type::OpAddAssign);
-					}
-					return Lexeme(Lexeme::Type::OpAdd);
+		auto isLineEmpty = true;
+		SourceOffset lineEnd = GetOffset(m_Cursor);
+		for (auto lexeme = GetNextLexeme(); lexeme != Lexeme::Type::Null; lexeme = GetNextLexeme())
+		{
+			if (lexeme.HasFlags(Lexeme::FlagsStartOfLine) && !isLineEmpty)
+			{
+				lexemes.push_back(Lexeme(Lexeme::Type::NewLine, 0, lineEnd, 0));
+			}
+			lexemes.push_back(lexeme);
+			lineEnd = lexeme.GetOffset() + lexeme.GetLength();
+			isLineEmpty = false;
+		}
+		if (!isLineEmpty)
+		{
+			lexemes.push_back(Lexeme(Lexeme::Type::NewLine, 0, lineEnd, 0));
+		}
+		lexemes.push_back(Lexeme(Lexeme::Type::Null, 0, GetOffset(m_End), 0));
+	}
 
-				// *************************************************************** //
-				case ScannerState::Parsing_OpSubtract_OR_OpSubtractAssign_OR_OpDec:
-					if (m_Char == '-')
-					{
-						ReadNextChar();
-						return Lexeme(Lexeme::Type::OpDec);
-					}
-					if (m_Char == '=')
-					{
-						ReadNextChar();
-						return Lexeme(Lexeme::Type::OpSubtractAssign);
-					}
-					return Lexeme(Lexeme::Type::OpSubtract);
+	/**
+	 * Chops next lexeme from the specified stream without creating it.
+	 * @returns Type of the scanned lexeme or null type on end of stream.
+	 */
+	CR_API Lexeme::Type Scanner::ScanNextLexeme(char const*& begin, char const*& end) throw(ScannerException)
+	{
+		auto cursor = m_Cursor;
+		auto const bufferEnd = m_End;
+		m_Flags = cursor == m_Begin ? Lexeme::FlagsStartOfLine : Lexeme::FlagsNone;
+		while (true)
+		{
+			// Skipping all unnecessary spaces. Single spaces between lexemes are common, so only runs
+			// of whitespace characters are passed to the vectorized routine.
+			if (cursor != bufferEnd && GetCharFlags(*cursor) & CrCharSpace)
+			{
+				auto const spacesBegin = cursor++;
+				if (cursor != bufferEnd && GetCharFlags(*cursor) & CrCharSpace)
+				{
+					cursor = Simd::SkipSpaces(cursor, bufferEnd);
+				}
+				m_Flags |= Lexeme::FlagsLeadingSpace;
+				if (memchr(spacesBegin, '\n', cursor - spacesBegin) != nullptr)
+				{
+					m_Flags |= Lexeme::FlagsStartOfLine;
+				}
+			}
+			if (cursor == bufferEnd)
+			{
+				m_Cursor = begin = end = cursor;
+				return Lexeme::Type::Null;
+			}
 
-				// *************************************************************** //
-				case ScannerState::Parsing_OpMultiply_OR_OpMultiplyAssign: 
-					if (m_Char == '=')
-					{
-						ReadNextChar();
-						return Lexeme(Lexeme::Type::OpMultiplyAssign);
-					}
-					return Lexeme(Lexeme::Type::OpMultiply);
+			// Skipping line continuations, next line is joined with the current one.
+			if (*cursor == '\\')
+			{
+				auto continuationEnd = cursor + 1;
+				if (continuationEnd != bufferEnd && *continuationEnd == '\r')
+				{
+					++continuationEnd;
+				}
+				if (continuationEnd != bufferEnd && *continuationEnd == '\n')
+				{
+					m_Flags |= Lexeme::FlagsLeadingSpace;
+					cursor = continuationEnd + 1;
+					continue;
+				}
+			}
+
+			// Skipping comments.
+			if (*cursor == '/' && cursor + 1 != bufferEnd)
+			{
+				if (cursor[1] == '/')
+				{
+					m_Flags |= Lexeme::FlagsLeadingSpace;
+					cursor = Simd::FindNewLine(cursor + 2, bufferEnd);
+					continue;
+				}
+				if (cursor[1] == '*')
+				{
+					auto const commentBegin = cursor;
+					m_Flags |= Lexeme::FlagsLeadingSpace;
+					cursor = Simd::FindCommentEnd(cursor + 2, bufferEnd);
+					if (cursor == nullptr)
+					{
+						throw ScannerException("Unexpected end of stream while scanning multi-line comment.", GetOffset(commentBegin));
+					}
+					cursor += 2;
+					continue;
+				}
+			}
+			break;
+		}
 
-				// *************************************************************** //
-				case ScannerState::Parsing_OpDivide_OR_OpDivideAssign_OR_SignleLineComment_OR_MultiLineComment: 
-					if (m_Char == '/')
-					{
-						ReadNextChar();
-						state = ScannerState::Parsing_SingleLineComment;
-						break;
-					}
-					if (m_Char == '*')
-					{
-						ReadNextChar();
-						state = ScannerState::Parsing_MultiLineComment;
-						//! @todo: Surpass this dirty hack somehow.
-						m_PrevChar = 0;
-						break;
-					}
-					if (m_Char == '=')
-					{
-						ReadNextChar();
-						return Lexeme(Lexeme::Type::OpDivideAssign);
-					}
-					return Lexeme(Lexeme::Type::OpDivide);
-				case ScannerState::Parsing_SingleLineComment:
-					if (m_Char == '\n' || m_Char == EOF)
-					{
-						ReadNextChar();
-						state = ScannerState::Undefined;
-						break;
-					}
-					ReadNextChar();
-					break;
-				case ScannerState::Parsing_MultiLineComment: 
-					if (m_PrevChar == '*' && m_Char == '/')
+		begin = cursor;
+		auto type = Lexeme::Type::Null;
+		auto const charFlags = GetCharFlags(*cursor);
+		if (charFlags & CrCharAlpha)
+		{
+			// Identifier or keyword.
+			for (++cursor; cursor != bufferEnd && GetCharFlags(*cursor) & (CrCharAlpha | CrCharDigit); ++cursor)
+			{
+			}
+			type = Lexeme::FindKeyword(begin, cursor - begin);
+		}
+		else if (charFlags & CrCharDigit || (*cursor == '.' && cursor + 1 != bufferEnd && GetCharFlags(cursor[1]) & CrCharDigit))
+		{
+			// Numeric constants are only classified here, values are decoded from the span on demand.
+			type = Lexeme::Type::CtInt;
+			if (*cursor == '0' && cursor + 1 != bufferEnd && (cursor[1] == 'x' || cursor[1] == 'X'))
+			{
+				// Hexadecimal integer constant.
+				for (cursor += 2; cursor != bufferEnd && (GetCharFlags(*cursor) & CrCharHexDigit || *cursor == '\''); ++cursor)
+				{
+				}
+			}
+			else
+			{
+				// Decimal or octal integer constant, or a floating-point constant.
+				for (; cursor != bufferEnd && (GetCharFlags(*cursor) & CrCharDigit || *cursor == '\''); ++cursor)
+				{
+				}
+				if (cursor != bufferEnd && *cursor == '.')
+				{
+					for (++cursor; cursor != bufferEnd && GetCharFlags(*cursor) & CrCharDigit; ++cursor)
 					{
-						ReadNextChar();
-						state = ScannerState::Undefined;
-						break;
 					}
-					if (m_Char == EOF)
+					type = Lexeme::Type::CtDouble;
+				}
+				if (cursor != bufferEnd && (*cursor == 'e' || *cursor == 'E'))
+				{
+					// Exponent part, the sign is optional.
+					auto exponent = cursor + 1;
+					if (exponent != bufferEnd && (*exponent == '+' || *exponent == '-'))
 					{
-						throw ScannerException("Unexpected end of stream while scanning multi-line comment.");
+						++exponent;
 					}
-					ReadNextChar();
-					break;
-
-				// *************************************************************** //
-				case ScannerState::Parsing_OpModulo_OR_OpModuloAssign:
-					if (m_Char == '=')
+					if (exponent == bufferEnd || (GetCharFlags(*exponent) & CrCharDigit) == 0)
 					{
-						ReadNextChar();
-						return Lexeme(Lexeme::Type::OpModuloAssign);
+						throw ScannerException("Exponent part of the floating-point constant has no digits.", GetOffset(cursor));
 					}
-					return Lexeme(Lexeme::Type::OpModulo);
-
-				// *************************************************************** //
-				case ScannerState::Parsing_OpAssignment_OR_OpEquals: 
-					if (m_Char == '=')
+					for (cursor = exponent; cursor != bufferEnd && GetCharFlags(*cursor) & CrCharDigit; ++cursor)
 					{
-						ReadNextChar();
-						return Lexeme(Lexeme::Type::OpEquals);
 					}
-					return Lexeme(Lexeme::Type::OpAssignment);
+					type = Lexeme::Type::CtDouble;
+				}
+			}
 
-				// *************************************************************** //
-				case ScannerState::Parsing_OpNot_OR_OpNotEquals: 
-					if (m_Char == '=')
-					{
-						ReadNextChar();
-						return Lexeme(Lexeme::Type::OpNotEquals);
-					}
-					return Lexeme(Lexeme::Type::OpNot);
-
-				// *************************************************************** //
-				case ScannerState::Parsing_OpGreater_OR_OpGreaterEquals_OR_OpBitwiseRightShift_OR_OpBitwiseRightShiftAssign: 
-					if (m_Char == '>')
-					{
-						ReadNextChar();
-						state = ScannerState::Parsing_OpBitwiseRightShift_OR_OpBitwiseRightShiftAssign;
+			// Suffixes: 'u' and 'l' for integers, 'f', 'h' and 'l' for floating-point constants.
+			if (type == Lexeme::Type::CtInt)
+			{
+				if (cursor != bufferEnd && (*cursor == 'u' || *cursor == 'U'))
+				{
+					type = Lexeme::Type::CtUInt;
+					++cursor;
+				}
+				if (cursor != bufferEnd && (*cursor == 'l' || *cursor == 'L'))
+				{
+					++cursor;
+				}
+			}
+			else if (cursor != bufferEnd)
+			{
+				switch (*cursor)
+				{
+					case 'f': case 'F':
+					case 'h': case 'H':
+						type = Lexeme::Type::CtFloat;
+						++cursor;
 						break;
-					}
-					if (m_Char == '=')
-					{
-						ReadNextChar();
-						return Lexeme(Lexeme::Type::OpGreaterEquals);
-					}
-					return Lexeme(Lexeme::Type::OpGreater);
-				case ScannerState::Parsing_OpBitwiseRightShift_OR_OpBitwiseRightShiftAssign: 
-					if (m_Char == '=')
-					{
-						ReadNextChar();
-						return Lexeme(Lexeme::Type::OpBitwiseRightShiftAssign);
-					}
-					return Lexeme(Lexeme::Type::OpBitwiseRightShift);
-
-				// *************************************************************** //
-				case ScannerState::Parsing_OpLess_OR_OpLessEquals_OR_OpBitwiseLeftShift_OR_OpBitwiseLeftShiftAssign: 
-					if (m_Char == '<')
-					{
-						ReadNextChar();
-						state = ScannerState::Parsing_OpBitwiseLeftShift_OR_OpBitwiseLeftShiftAssign;
+					case 'l': case 'L':
+						++cursor;
 						break;
-					}
-					if (m_Char == '=')
-					{
-						ReadNextChar();
-						return Lexeme(Lexeme::Type::OpLessEquals);
-					}
-					return Lexeme(Lexeme::Type::OpLess);
-				case ScannerState::Parsing_OpBitwiseLeftShift_OR_OpBitwiseLeftShiftAssign: 
-					if (m_Char == '=')
-					{
-						ReadNextChar();
-						return Lexeme(Lexeme::Type::OpBitwiseLeftShiftAssign);
-					}
-					return Lexeme(Lexeme::Type::OpBitwiseLeftShift);
-
-				// *************************************************************** //
-				case ScannerState::Parsing_OpAnd_OR_OpBitwiseAnd_OR_OpBitwiseAndAssign:
-					if (m_Char == '&')
-					{
-						ReadNextChar();
-						return Lexeme(Lexeme::Type::OpAnd);
-					}
-					if (m_Char == '=')
-					{
-						ReadNextChar();
-						return Lexeme(Lexeme::Type::OpBitwiseAndAssign);
-					}
-					return Lexeme(Lexeme::Type::OpBitwiseAnd);
-
-				// *************************************************************** //
-				case ScannerState::Parsing_OpOr_OR_OpBitwiseOr_OR_OpBitwiseOrAssign: 
-					if (m_Char == '|')
-					{
-						ReadNextChar();
-						return Lexeme(Lexeme::Type::OpOr);
-					}
-					if (m_Char == '=')
-					{
-						ReadNextChar();
-						return Lexeme(Lexeme::Type::OpBitwiseOrAssign);
-					}
-					return Lexeme(Lexeme::Type::OpBitwiseOr);
-
-				// *************************************************************** //
-				case ScannerState::Parsing_OpBitwiseXor_OR_OpBitwiseXorAssign: 
-					if (m_Char == '=')
-					{
-						ReadNextChar();
-						return Lexeme(Lexeme::Type::OpBitwiseXorAssign);
-					}
-					return Lexeme(Lexeme::Type::OpBitwiseXor);
-				
-				// *************************************************************** //
-				case ScannerState::Parsing_OpDot_OR_DECIMAL_ConstantFloat_OR_ConstantDouble_FractionPart:
-					if (isdigit(m_Char))
-					{
-						state = ScannerState::Parsing_DECIMAL_ConstantFloat_OR_ConstantDouble_FractionPart;
-						ReadNextChar();
+					default:
 						break;
-					}
-					return Lexeme(Lexeme::Type::OpDot);
-
-				// *************************************************************** //
-				case ScannerState::Parsing_OpPreprocessor_OR_OpPreprocessorGlue:
-					if (m_Char == '#')
-					{
-						ReadNextChar();
-						return Lexeme(Lexeme::Type::OpPreprocessorConcat);
-					}
-					return Lexeme(Lexeme::Type::OpPreprocessor);
-
-				default:
-					CrAssert(0);
-
-			}	// switch (state)
-		}	// for (state;;)
+				}
+			}
+		}
+		else if (*cursor == '"')
+		{
+			// String constant, escape sequences are kept as is.
+			type = Lexeme::Type::CtString;
+			for (++cursor; cursor != bufferEnd && *cursor != '"'; ++cursor)
+			{
+				if (*cursor == '\n' || (*cursor == '\\' && ++cursor == bufferEnd))
+				{
+					throw ScannerException("Unterminated string constant.", GetOffset(begin));
+				}
+			}
+			if (cursor == bufferEnd)
+			{
+				throw ScannerException("Unterminated string constant.", GetOffset(begin));
+			}
+			++cursor;
+		}
+		else
+		{
+			// Walking the operators DFA until there is no transition.
+			size_t state = 0;
+			for (; cursor != bufferEnd; ++cursor)
+			{
+				auto const opChar = s_Tables.m_OperatorChars[static_cast<uint8_t>(*cursor)];
+				auto const nextState = s_Tables.m_Transitions[state][opChar];
+				if (opChar == 0 || nextState == 0)
+				{
+					break;
+				}
+				state = nextState;
+			}
+			type = s_Tables.m_Accepts[state];
+			if (type == Lexeme::Type::Null)
+			{
+				throw ScannerException("Unsupported character in the input stream.", GetOffset(begin));
+			}
+		}
+		m_Cursor = end = cursor;
+		return type;
 	}
 
-#if __clang__
-#	pragma clang diagnostic pop
-#endif
-
-#if _MSC_VER
-#	pragma warning(pop)
-#endif
-
 	// *************************************************************** //
 	// **                 Scanner class unit tests.                 ** //
 	// *************************************************************** //
@@ -578,6 +460,92 @@ namespace Cr
 		CrAssert(lexeme.GetType() == Lexeme::Type::Null);
 	};
 
+	CrUnitTest(ScannerHexAndReals)
+	{
+		auto inputStream = std::make_shared<IO::StringInputStream>("0xFf 017 .5 2.5f");
+		Scanner scanner(inputStream);
+
+		auto lexeme = scanner.GetNextLexeme();
+		CrAssert(lexeme.GetType() == Lexeme::Type::CtInt && lexeme.GetValueInt() == 255);
+
+		lexeme = scanner.GetNextLexeme();
+		CrAssert(lexeme.GetType() == Lexeme::Type::CtInt && lexeme.GetValueInt() == 15);
+
+		lexeme = scanner.GetNextLexeme();
+		CrAssert(lexeme.GetType() == Lexeme::Type::CtDouble && lexeme.GetValueReal() == 0.5);
+
+		lexeme = scanner.GetNextLexeme();
+		CrAssert(lexeme.GetType() == Lexeme::Type::CtFloat && lexeme.GetValueReal() == 2.5);
+	};
+
+	CrUnitTest(ScannerExponentsAndSuffixes)
+	{
+		auto inputStream = std::make_shared<IO::StringInputStream>("1e3 2u 7UL 1.5e-3f 3h 0.1L 2E+2.x");
+		Scanner scanner(inputStream);
+
+		auto lexeme = scanner.GetNextLexeme();
+		CrAssert(lexeme.GetType() == Lexeme::Type::CtDouble && lexeme.GetValueReal() == 1000.0);
+
+		lexeme = scanner.GetNextLexeme();
+		CrAssert(lexeme.GetType() == Lexeme::Type::CtUInt && lexeme.GetValueInt() == 2 && lexeme.GetLength() == 2);
+
+		lexeme = scanner.GetNextLexeme();
+		CrAssert(lexeme.GetType() == Lexeme::Type::CtUInt && lexeme.GetValueInt() == 7 && lexeme.GetLength() == 3);
+
+		lexeme = scanner.GetNextLexeme();
+		CrAssert(lexeme.GetType() == Lexeme::Type::CtFloat && lexeme.GetValueReal() == 1.5e-3);
+
+		lexeme = scanner.GetNextLexeme();
+		CrAssert(lexeme.GetType() == Lexeme::Type::CtInt && lexeme.GetValueInt() == 3);
+
+		lexeme = scanner.GetNextLexeme();
+		CrAssert(lexeme.GetType() == Lexeme::Type::IdIdentifier);
+
+		lexeme = scanner.GetNextLexeme();
+		CrAssert(lexeme.GetType() == Lexeme::Type::CtDouble && lexeme.GetValueReal() == 0.1 && lexeme.GetLength() == 4);
+
+		lexeme = scanner.GetNextLexeme();
+		CrAssert(lexeme.GetType() == Lexeme::Type::CtDouble && lexeme.GetValueReal() == 200.0);
+
+		lexeme = scanner.GetNextLexeme();
+		CrAssert(lexeme.GetType() == Lexeme::Type::OpDot);
+	};
+
+	CrUnitTest(ScannerStrings)
+	{
+		auto inputStream = std::make_shared<IO::StringInputStream>(R"("" "a\"b\\" "c)");
+		Scanner scanner(inputStream);
+
+		auto lexeme = scanner.GetNextLexeme();
+		CrAssert(lexeme.GetType() == Lexeme::Type::CtString && lexeme.GetLength() == 2);
+
+		lexeme = scanner.GetNextLexeme();
+		CrAssert(lexeme.GetType() == Lexeme::Type::CtString && lexeme.GetLength() == 8);
+
+		try
+		{
+			scanner.GetNextLexeme();
+			CrAssert(0);
+		}
+		catch (ScannerException const&)
+		{ }
+	};
+
+	CrUnitTest(ScannerOperators)
+	{
+		auto inputStream = std::make_shared<IO::StringInputStream>("<<=>>&&=## #");
+		Scanner scanner(inputStream);
+
+		Lexeme::Type const expected[] = {
+			Lexeme::Type::OpBitwiseLeftShiftAssign, Lexeme::Type::OpBitwiseRightShift, Lexeme::Type::OpAnd,
+			Lexeme::Type::OpAssignment, Lexeme::Type::OpPreprocessorConcat, Lexeme::Type::OpPreprocessor, Lexeme::Type::Null,
+		};
+		for (auto const type : expected)
+		{
+			CrAssert(scanner.GetNextLexeme().GetType() == type);
+		}
+	};
+
 	CrUnitTest(ScannerKeywordsAndIDs)
 	{
 		auto inputStream = std::make_shared<IO::StringInputStream>("if ifa");
@@ -593,6 +561,61 @@ namespace Cr
 		CrAssert(lexeme.GetType() == Lexeme::Type::Null);
 	};
 
+	CrUnitTest(ScannerContiguousBuffer)
+	{
+		// Range ends in the middle of the identifier, nothing after it should be read.
+		char const source[] = "if ifa";
+		Scanner scanner(source, source + 4);
+
+		auto lexeme = scanner.GetNextLexeme();
+		CrAssert(lexeme.GetType() == Lexeme::Type::KwIf);
+
+		lexeme = scanner.GetNextLexeme();
+		CrAssert(lexeme.GetType() == Lexeme::Type::IdIdentifier && lexeme.GetValueID() == SymbolTable::Global().Intern("i"));
+
+		lexeme = scanner.GetNextLexeme();
+		CrAssert(lexeme.GetType() == Lexeme::Type::Null);
+	};
+
+	CrUnitTest(ScannerLayoutAndLocations)
+	{
+		char const source[] = "a b\n  c/**/d";
+		Scanner scanner(source, source + sizeof(source) - 1);
+
+		auto lexeme = scanner.GetNextLexeme();
+		CrAssert(lexeme.GetFlags() == Lexeme::FlagsStartOfLine);
+
+		lexeme = scanner.GetNextLexeme();
+		CrAssert(lexeme.GetFlags() == Lexeme::FlagsLeadingSpace);
+
+		lexeme = scanner.GetNextLexeme();
+		CrAssert(lexeme.HasFlags(Lexeme::FlagsStartOfLine | Lexeme::FlagsLeadingSpace));
+		auto const location = SourceManager::Global().GetLocation(lexeme.GetOffset());
+		CrAssert(location.m_Line == 2 && location.m_Column == 3);
+
+		lexeme = scanner.GetNextLexeme();
+		CrAssert(lexeme.GetFlags() == Lexeme::FlagsLeadingSpace && *lexeme.GetText() == 'd' && lexeme.GetLength() == 1);
+	};
+
+	CrUnitTest(ScannerTokenize)
+	{
+		auto inputStream = std::make_shared<IO::StringInputStream>("#define A \\\n 1\n\n  A");
+		Scanner scanner(inputStream);
+		std::vector<Lexeme> lexemes;
+		scanner.Tokenize(lexemes);
+
+		Lexeme::Type const expected[] = {
+			Lexeme::Type::OpPreprocessor, Lexeme::Type::KwPpDefine, Lexeme::Type::IdIdentifier, Lexeme::Type::CtInt, Lexeme::Type::NewLine,
+			Lexeme::Type::IdIdentifier, Lexeme::Type::NewLine, Lexeme::Type::Null,
+		};
+		CrAssert(lexemes.size() == sizeof(expected) / sizeof(expected[0]));
+		for (size_t i = 0; i < lexemes.size(); ++i)
+		{
+			CrAssert(lexemes[i].GetType() == expected[i]);
+		}
+		CrAssert(!lexemes[3].HasFlags(Lexeme::FlagsStartOfLine));
+	};
+
 	CrUnitTest(ScannerCorrectComments)
 	{
 		auto inputStream = std::make_shared<IO::StringInputStream>("// \n/*/**/");
@@ -15,22 +15,27 @@
 #include "Utils.h"
 #include "Lexeme.h"
 
+#include <vector>
+
 namespace Cr
 {
 	CrDefineExceptionBase(ScannerException, WorkflowException);
 
 	/** 
 	 * Represents a simple lexical analyzer for Cr language.
+	 * Scanner always walks a contiguous memory range that is registered in the source manager. Streams that
+	 * cannot provide one are read into the source manager once.
 	 */
 	class Scanner final
 	{	
 	private:
 		IO::PInputStream m_InputStream;
-		IdentifierTable* m_IdentifierTable;
-		int m_Char, m_PrevChar;
-
-	private:
-		CRINL void ReadNextChar();
+		SymbolTable& m_SymbolTable;
+		char const* m_Begin = nullptr;
+		char const* m_Cursor = nullptr;
+		char const* m_End = nullptr;
+		SourceOffset m_Offset = NullSourceOffset;
+		uint16_t m_Flags = Lexeme::FlagsStartOfLine;
 
 	public:
 		CRINL Scanner(Scanner const&) = delete;
@@ -39,12 +44,14 @@ namespace Cr
 		/**
 		 * Initializes a new scanner from the specified stream.
 		 */
-		CRINL explicit Scanner(IO::PInputStream const& inputStream, IdentifierTable* const identifierTable = nullptr)
-			: m_InputStream(inputStream), m_IdentifierTable(identifierTable)
-		{
-			assert(inputStream != nullptr);
-			ReadNextChar();
-		}
+		CR_API explicit Scanner(IO::PInputStream const& inputStream, SymbolTable& symbolTable = SymbolTable::Global());
+
+		/**
+		 * Initializes a new scanner that walks the specified memory range directly.
+		 * @param offset Location of the range in the source manager. If null, copy of the range is registered
+		 *               as a new buffer and scanned instead.
+		 */
+		CR_API explicit Scanner(char const* begin, char const* end, SourceOffset offset = NullSourceOffset, SymbolTable& symbolTable = SymbolTable::Global());
 
 	public:
 
@@ -54,6 +61,39 @@ namespace Cr
 		 */
 		CR_API Lexeme GetNextLexeme() throw(ScannerException);
 
+		/**
+		 * Scans all remaining lexemes of the stream.
+		 * Lines are separated with the new line lexemes, the last line is terminated with the new line lexeme too.
+		 * @param lexemes Array the lexemes are appended to. Null lexeme is appended at the end.
+		 */
+		CR_API void Tokenize(std::vector<Lexeme>& lexemes) throw(ScannerException);
+
+		/**
+		 * Chops next lexeme from the specified stream without creating it.
+		 * @param begin Receives first character of the lexeme.
+		 * @param end Receives character after the last one of the lexeme.
+		 * @returns Type of the scanned lexeme or null type on end of stream.
+		 * Layout flags of the scanned lexeme are available through 'GetFlags'.
+		 */
+		CR_API Lexeme::Type ScanNextLexeme(char const*& begin, char const*& end) throw(ScannerException);
+
+		/**
+		 * Returns layout flags of the last scanned lexeme.
+		 */
+		CRINL uint16_t GetFlags() const
+		{
+			return m_Flags;
+		}
+
+		/**
+		 * Returns location of the specified character of the scanned range.
+		 */
+		CRINL SourceOffset GetOffset(char const* const position) const
+		{
+			assert(position >= m_Begin && position <= m_End);
+			return m_Offset + static_cast<SourceOffset>(position - m_Begin);
+		}
+
 	};	// class Scanner
 
 }	// namespace Cr
@@ -0,0 +1,314 @@
+// $$***************************************************************$$ //
+//                                                                     //
+//                  Goddamn "C for Rendering" project                  //
+//     Copyright (C) Goddamn Industries 2016. All Rights Reserved.     //
+//          ( https://github.com/GoddamnIndustries/GoddamnCr )         //
+//                                                                     //
+//    This software or any its part is distributed under the terms of  //
+//   Goddamn Industries End User License Agreement. By downloading or  //
+//   using this software or any its part you agree with the terms of   //
+//   Goddamn Industries End User License Agreement.                    //
+//                                                                     //
+// $$***************************************************************$$ //
+
+/**
+ * Scanner throughput microbenchmark. Built only with CR_BUILD_BENCHMARKS.
+ * Compares the table-driven scanner against the reference character-at-a-time state machine
+ * that reads the input through the virtual stream interface.
+ */
+
+#include "Scanner.h"
+#include <chrono>
+#include <map>
+#include <cstdlib>
+
+namespace Cr
+{
+	namespace Benchmark
+	{
+		// *************************************************************** //
+		// **                  Reference scanner.                       ** //
+		// *************************************************************** //
+
+		/**
+		 * Reference scanner: one virtual call per character, identifiers accumulated into the std::string,
+		 * looked up in the std::map and copied to the heap, numbers decoded while scanning.
+		 */
+		class ReferenceScanner final
+		{
+		private:
+			static std::map<std::string, Lexeme::Type> const s_KeywordsTable;
+
+			IO::PInputStream m_InputStream;
+			int m_Char;
+			uint32_t m_ValueInt = 0;
+			double m_ValueReal = 0.0;
+			std::vector<std::unique_ptr<std::string>> m_Identifiers;
+
+		public:
+			explicit ReferenceScanner(IO::PInputStream const& inputStream)
+				: m_InputStream(inputStream), m_Char(inputStream->ReadNextChar())
+			{}
+
+		private:
+			void ReadNextChar()
+			{
+				m_Char = m_InputStream->ReadNextChar();
+			}
+			bool Accept(int const c)
+			{
+				if (m_Char == c)
+				{
+					ReadNextChar();
+					return true;
+				}
+				return false;
+			}
+			static bool IsAlpha(int const c)
+			{
+				return c == '_' || c == '$' || isalpha(c);
+			}
+
+			Lexeme::Type ScanFraction(double value, double& result)
+			{
+				auto exponent = 1.0;
+				while (isdigit(m_Char))
+				{
+					exponent /= 10.0;
+					value += (m_Char - '0') * exponent;
+					ReadNextChar();
+				}
+				result = value;
+				return Accept('f') || Accept('F') ? Lexeme::Type::CtFloat : Lexeme::Type::CtDouble;
+			}
+
+		public:
+			Lexeme::Type GetNextLexeme()
+			{
+				while (true)
+				{
+					if (m_Char == EOF)
+					{
+						return Lexeme::Type::Null;
+					}
+					if (isspace(m_Char))
+					{
+						ReadNextChar();
+						continue;
+					}
+					if (IsAlpha(m_Char))
+					{
+						std::string buffer;
+						for (; IsAlpha(m_Char) || isdigit(m_Char); ReadNextChar())
+						{
+							buffer.push_back(static_cast<char>(m_Char));
+						}
+						auto const keyword = s_KeywordsTable.find(buffer);
+						if (keyword != s_KeywordsTable.end())
+						{
+							return keyword->second;
+						}
+						m_Identifiers.emplace_back(new std::string(buffer));
+						return Lexeme::Type::IdIdentifier;
+					}
+					if (isdigit(m_Char))
+					{
+						uint64_t value = 0, base = 10;
+						if (Accept('0') && (base = 8, Accept('x') || Accept('X')))
+						{
+							for (; isxdigit(m_Char) || m_Char == '\''; ReadNextChar())
+							{
+								if (m_Char != '\'')
+								{
+									value = value * 0x10 + (isdigit(m_Char) ? m_Char - '0' : tolower(m_Char) - 'a' + 10);
+								}
+							}
+							m_ValueInt = static_cast<uint32_t>(value);
+							return Lexeme::Type::CtInt;
+						}
+						for (; isdigit(m_Char) || m_Char == '\''; ReadNextChar())
+						{
+							if (m_Char != '\'')
+							{
+								value = value * base + (m_Char - '0');
+							}
+						}
+						if (Accept('.'))
+						{
+							return ScanFraction(static_cast<double>(value), m_ValueReal);
+						}
+						m_ValueInt = static_cast<uint32_t>(value);
+						return Lexeme::Type::CtInt;
+					}
+
+					auto const c = m_Char;
+					ReadNextChar();
+					switch (c)
+					{
+						case '+': return Accept('+') ? Lexeme::Type::OpInc : Accept('=') ? Lexeme::Type::OpAddAssign : Lexeme::Type::OpAdd;
+						case '-': return Accept('-') ? Lexeme::Type::OpDec : Accept('=') ? Lexeme::Type::OpSubtractAssign : Lexeme::Type::OpSubtract;
+						case '*': return Accept('=') ? Lexeme::Type::OpMultiplyAssign : Lexeme::Type::OpMultiply;
+						case '%': return Accept('=') ? Lexeme::Type::OpModuloAssign : Lexeme::Type::OpModulo;
+						case '=': return Accept('=') ? Lexeme::Type::OpEquals : Lexeme::Type::OpAssignment;
+						case '!': return Accept('=') ? Lexeme::Type::OpNotEquals : Lexeme::Type::OpNot;
+						case '^': return Accept('=') ? Lexeme::Type::OpBitwiseXorAssign : Lexeme::Type::OpBitwiseXor;
+						case '&': return Accept('&') ? Lexeme::Type::OpAnd : Accept('=') ? Lexeme::Type::OpBitwiseAndAssign : Lexeme::Type::OpBitwiseAnd;
+						case '|': return Accept('|') ? Lexeme::Type::OpOr : Accept('=') ? Lexeme::Type::OpBitwiseOrAssign : Lexeme::Type::OpBitwiseOr;
+						case '#': return Accept('#') ? Lexeme::Type::OpPreprocessorConcat : Lexeme::Type::OpPreprocessor;
+						case '>':
+							if (Accept('>'))
+							{
+								return Accept('=') ? Lexeme::Type::OpBitwiseRightShiftAssign : Lexeme::Type::OpBitwiseRightShift;
+							}
+							return Accept('=') ? Lexeme::Type::OpGreaterEquals : Lexeme::Type::OpGreater;
+						case '<':
+							if (Accept('<'))
+							{
+								return Accept('=') ? Lexeme::Type::OpBitwiseLeftShiftAssign : Lexeme::Type::OpBitwiseLeftShift;
+							}
+							return Accept('=') ? Lexeme::Type::OpLessEquals : Lexeme::Type::OpLess;
+						case '.':
+							if (isdigit(m_Char))
+							{
+								return ScanFraction(0.0, m_ValueReal);
+							}
+							return Lexeme::Type::OpDot;
+						case '/':
+							if (Accept('/'))
+							{
+								while (m_Char != '\n' && m_Char != EOF)
+								{
+									ReadNextChar();
+								}
+								continue;
+							}
+							if (Accept('*'))
+							{
+								for (auto prevChar = 0; prevChar != '*' || m_Char != '/'; ReadNextChar())
+								{
+									if (m_Char == EOF)
+									{
+										throw ScannerException("Unexpected end of stream while scanning multi-line comment.");
+									}
+									prevChar = m_Char;
+								}
+								ReadNextChar();
+								continue;
+							}
+							return Accept('=') ? Lexeme::Type::OpDivideAssign : Lexeme::Type::OpDivide;
+						case '~': return Lexeme::Type::OpBitwiseNot;
+						case ';': return Lexeme::Type::OpSemicolon;
+						case '?': return Lexeme::Type::OpTernary;
+						case ':': return Lexeme::Type::OpColon;
+						case ',': return Lexeme::Type::OpComma;
+						case '{': return Lexeme::Type::OpBraceOpen;
+						case '}': return Lexeme::Type::OpBraceClose;
+						case '[': return Lexeme::Type::OpBracketOpen;
+						case ']': return Lexeme::Type::OpBracketClose;
+						case '(': return Lexeme::Type::OpParenOpen;
+						case ')': return Lexeme::Type::OpParenClose;
+						default:
+							throw ScannerException("Unsupported character in the input stream.");
+					}
+				}
+			}
+		};	// class ReferenceScanner
+
+		std::map<std::string, Lexeme::Type> const ReferenceScanner::s_KeywordsTable = {
+#define CrKeywordMapping(type, spelling) { spelling, Lexeme::Type::type },
+			CrKeywordsList(CrKeywordMapping)
+#undef CrKeywordMapping
+		};
+
+		// *************************************************************** //
+		// **                  Benchmark harness.                       ** //
+		// *************************************************************** //
+
+		static char const s_SourceChunk[] =
+			"// Scanner benchmark source chunk.\n"
+			"float4 main(float4 pos : POSITION, float2 uv : TEXCOORD0) : SV_POSITION\n"
+			"{\n"
+			"\t/* Some multi-line\n"
+			"\t * comment here. */\n"
+			"\tfloat3 color = float3(0.25f, 0.5f, 1.0);\n"
+			"\tint counter = 0x1F + 017 + 1'000;\n"
+			"\tfor (int i = 0; i < 16; ++i)\n"
+			"\t{\n"
+			"\t\tif (pos.x >= 0.5 && pos.y != 0 || counter <<= 2)\n"
+			"\t\t\tcolor *= pos.xyz / 2.0f;\n"
+			"\t\telse\n"
+			"\t\t\tcounter -= i % 3;\n"
+			"\t}\n"
+			"\treturn float4(color, 1.0f);\n"
+			"}\n"
+			"\n";
+
+		template<typename TFunctor>
+		static void Measure(char const* const name, std::string const& source, int const iterations, TFunctor&& functor)
+		{
+			size_t lexemesCount = 0;
+			auto const start = std::chrono::steady_clock::now();
+			for (auto i = 0; i < iterations; ++i)
+			{
+				lexemesCount += functor();
+			}
+			auto const elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			auto const megabytes = static_cast<double>(source.size()) * iterations / (1024.0 * 1024.0);
+			printf("%-24s %10zu lexemes  %8.3f s  %10.2f MB/s\n", name, lexemesCount / iterations, elapsed, megabytes / elapsed);
+		}
+
+	}	// namespace Benchmark
+}	// namespace Cr
+
+/**
+ * Entry point for the scanner benchmark.
+ * Usage: CrScannerBenchmark [size in megabytes] [iterations]
+ */
+int main(int const argc, char const* const* const argv)
+{
+	using namespace Cr;
+	using namespace Cr::Benchmark;
+
+	auto const sizeMegabytes = argc > 1 ? atoi(argv[1]) : 4;
+	auto const iterations = argc > 2 ? atoi(argv[2]) : 5;
+
+	std::string source;
+	while (source.size() < static_cast<size_t>(sizeMegabytes) * 1024 * 1024)
+	{
+		source += s_SourceChunk;
+	}
+
+	Measure("Reference", source, iterations, [&]()
+	{
+		ReferenceScanner scanner(std::make_shared<IO::StringInputStream>(source.c_str()));
+		size_t count = 0;
+		while (scanner.GetNextLexeme() != Lexeme::Type::Null)
+		{
+			++count;
+		}
+		return count;
+	});
+	Measure("Scanner::GetNextLexeme", source, iterations, [&]()
+	{
+		Scanner scanner(source.data(), source.data() + source.size());
+		size_t count = 0;
+		while (scanner.GetNextLexeme().GetType() != Lexeme::Type::Null)
+		{
+			++count;
+		}
+		return count;
+	});
+	Measure("Scanner::ScanNextLexeme", source, iterations, [&]()
+	{
+		Scanner scanner(source.data(), source.data() + source.size());
+		size_t count = 0;
+		char const* begin;
+		char const* end;
+		while (scanner.ScanNextLexeme(begin, end) != Lexeme::Type::Null)
+		{
+			++count;
+		}
+		return count;
+	});
+	return 0;
+}
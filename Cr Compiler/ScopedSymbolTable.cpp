@@ -0,0 +1,131 @@
+// $$***************************************************************$$ //
+//                                                                     //
+//                  Goddamn "C for Rendering" project                  //
+//     Copyright (C) Goddamn Industries 2016. All Rights Reserved.     //
+//          ( https://github.com/GoddamnIndustries/GoddamnCr )         //
+//                                                                     //
+//    This software or any its part is distributed under the terms of  //
+//   Goddamn Industries End User License Agreement. By downloading or  //
+//   using this software or any its part you agree with the terms of   //
+//   Goddamn Industries End User License Agreement.                    //
+//                                                                     //
+// $$***************************************************************$$ //
+
+
+#include "ScopedSymbolTable.h"
+#include "AST.h"
+
+namespace Cr
+{
+	// *************************************************************** //
+	// **           ScopedSymbolTable class implementation.         ** //
+	// *************************************************************** //
+
+	CR_API ScopedSymbolTable::ScopedSymbolTable()
+		: m_Slots(256, Slot{ NullSymbol, s_NullBinding })
+	{
+	}
+
+	/**
+	 * Closes the innermost scope, restoring all identifiers it shadowed.
+	 */
+	CR_API void ScopedSymbolTable::PopScope()
+	{
+		assert(!m_Scopes.empty());
+		auto const scopeBegin = m_Scopes.back();
+		m_Scopes.pop_back();
+
+		// Unlinking the bindings in reverse order, so the chains are restored exactly.
+		while (m_Bindings.size() > scopeBegin)
+		{
+			auto const& binding = m_Bindings.back();
+			m_Slots[FindSlot(binding.m_Name)].m_Binding = binding.m_Shadowed;
+			m_Bindings.pop_back();
+		}
+	}
+
+	/**
+	 * Declares the identifier in the innermost scope, shadowing identifiers with the same name in the outer ones.
+	 */
+	CR_API void ScopedSymbolTable::Declare(Symbol const name, Ast::Identifier* const ident)
+	{
+		assert(!m_Scopes.empty());
+		auto slot = FindSlot(name);
+		if (m_Slots[slot].m_Name == NullSymbol)
+		{
+			// Symbol is declared for the first time. Slots are never released, since the same symbols are 
+			// usually redeclared in the sibling scopes.
+			if ((m_SlotsUsed + 1) * 2 > m_Slots.size())
+			{
+				Rehash();
+				slot = FindSlot(name);
+			}
+			m_Slots[slot].m_Name = name;
+			++m_SlotsUsed;
+		}
+
+		auto const binding = static_cast<uint32_t>(m_Bindings.size());
+		m_Bindings.push_back({ ident, name, m_Slots[slot].m_Binding });
+		m_Slots[slot].m_Binding = binding;
+	}
+
+	// *************************************************************** //
+	CR_INTERNAL void ScopedSymbolTable::Rehash()
+	{
+		std::vector<Slot> slots(m_Slots.size() * 2, Slot{ NullSymbol, s_NullBinding });
+		slots.swap(m_Slots);
+		for (auto const& slot : slots)
+		{
+			if (slot.m_Name != NullSymbol)
+			{
+				m_Slots[FindSlot(slot.m_Name)] = slot;
+			}
+		}
+	}
+
+	// *************************************************************** //
+	// **            ScopedSymbolTable class unit tests.            ** //
+	// *************************************************************** //
+
+	CrUnitTest(ScopedSymbolTable)
+	{
+		SymbolTable symbols;
+		auto const a = symbols.Intern("a"), b = symbols.Intern("b"), c = symbols.Intern("c");
+		Ast::Typedef outerA, innerA, innerB;
+
+		ScopedSymbolTable table;
+		table.PushScope();
+		table.Declare(a, &outerA);
+		CrAssert(table.Find(a) == &outerA && table.Find(b) == nullptr && table.Find(c) == nullptr);
+
+		// Outer identifiers are visible in the nested scopes, until they are shadowed.
+		table.PushScope();
+		CrAssert(table.Find(a) == &outerA && table.FindInCurrentScope(a) == nullptr);
+		table.Declare(a, &innerA);
+		table.Declare(b, &innerB);
+		CrAssert(table.Find(a) == &innerA && table.FindInCurrentScope(a) == &innerA && table.Find(b) == &innerB);
+		table.PushScope();
+		CrAssert(table.Find(a) == &innerA && table.Find(b) == &innerB);
+		table.PopScope();
+		table.PopScope();
+		CrAssert(table.Find(a) == &outerA && table.FindInCurrentScope(a) == &outerA && table.Find(b) == nullptr);
+
+		// Growing the map must preserve the shadow chains.
+		Ast::Typedef idents[1000];
+		table.PushScope();
+		for (auto& ident : idents)
+		{
+			char spelling[16];
+			snprintf(spelling, sizeof spelling, "v%d", static_cast<int>(&ident - idents));
+			table.Declare(symbols.Intern(spelling), &ident);
+		}
+		table.Declare(a, &innerA);
+		CrAssert(table.Find(symbols.Intern("v0")) == &idents[0] && table.Find(symbols.Intern("v999")) == &idents[999]);
+		CrAssert(table.Find(a) == &innerA);
+		table.PopScope();
+		CrAssert(table.Find(a) == &outerA && table.Find(symbols.Intern("v500")) == nullptr);
+		table.PopScope();
+		CrAssert(table.Find(a) == nullptr);
+	};
+
+}	// namespace Cr
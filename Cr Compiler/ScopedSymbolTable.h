@@ -0,0 +1,125 @@
+// $$***************************************************************$$ //
+//                                                                     //
+//                  Goddamn "C for Rendering" project                  //
+//     Copyright (C) Goddamn Industries 2016. All Rights Reserved.     //
+//          ( https://github.com/GoddamnIndustries/GoddamnCr )         //
+//                                                                     //
+//    This software or any its part is distributed under the terms of  //
+//   Goddamn Industries End User License Agreement. By downloading or  //
+//   using this software or any its part you agree with the terms of   //
+//   Goddamn Industries End User License Agreement.                    //
+//                                                                     //
+// $$***************************************************************$$ //
+
+
+#pragma once
+#include "Lexeme.h"
+
+#include <vector>
+
+namespace Cr
+{
+	namespace Ast
+	{
+		struct Identifier;
+	}	// namespace Ast
+
+	/**
+	 * Identifiers, visible in the nested scopes.
+	 * All scopes share a single open-addressing map from the symbol to its innermost binding. Bindings of the 
+	 * outer scopes, that are shadowed by it, are chained behind it. Bindings are pushed into the undo log in 
+	 * declaration order, so popping the scope only unlinks bindings declared in it.
+	 */
+	class ScopedSymbolTable final
+	{
+	private:
+		static uint32_t const s_NullBinding = UINT32_MAX;
+
+		struct Slot
+		{
+			Symbol   m_Name;
+			uint32_t m_Binding;		///< Innermost binding of the symbol or null binding, if symbol is out of scope.
+		};	// struct Slot
+
+		struct Binding
+		{
+			Ast::Identifier* m_Ident;
+			Symbol           m_Name;
+			uint32_t         m_Shadowed;	///< Binding of the same symbol in the outer scopes.
+		};	// struct Binding
+
+		std::vector<Slot>     m_Slots;
+		std::vector<Binding>  m_Bindings;	///< Undo log of the declarations.
+		std::vector<uint32_t> m_Scopes;		///< Size of the undo log at the beginning of each scope.
+		uint32_t              m_SlotsUsed = 0;
+
+	public:
+		ScopedSymbolTable(ScopedSymbolTable const&) = delete;
+		ScopedSymbolTable& operator= (ScopedSymbolTable const&) = delete;
+
+		CR_API ScopedSymbolTable();
+
+		/**
+		 * Opens the nested scope.
+		 */
+		CRINL void PushScope()
+		{
+			m_Scopes.push_back(static_cast<uint32_t>(m_Bindings.size()));
+		}
+
+		/**
+		 * Closes the innermost scope, restoring all identifiers it shadowed.
+		 */
+		CR_API void PopScope();
+
+		/**
+		 * Returns the innermost visible identifier with the specified name or null pointer.
+		 */
+		CRINL Ast::Identifier* Find(Symbol const name) const
+		{
+			auto const binding = m_Slots[FindSlot(name)].m_Binding;
+			return binding != s_NullBinding ? m_Bindings[binding].m_Ident : nullptr;
+		}
+
+		/**
+		 * Returns the identifier with the specified name, declared in the innermost scope, or null pointer.
+		 */
+		CRINL Ast::Identifier* FindInCurrentScope(Symbol const name) const
+		{
+			assert(!m_Scopes.empty());
+			auto const binding = m_Slots[FindSlot(name)].m_Binding;
+			return binding != s_NullBinding && binding >= m_Scopes.back() ? m_Bindings[binding].m_Ident : nullptr;
+		}
+
+		/**
+		 * Declares the identifier in the innermost scope, shadowing identifiers with the same name in the outer ones.
+		 */
+		CR_API void Declare(Symbol name, Ast::Identifier* ident);
+
+	private:
+		CRINL static uint32_t HashSymbol(Symbol const name)
+		{
+			// Symbols are sequential, so Fibonacci hashing spreads them over the whole table.
+			return name * 0x9E3779B9u;
+		}
+
+		/**
+		 * Returns the slot of the symbol or the empty slot, where it should be inserted.
+		 */
+		CRINL size_t FindSlot(Symbol const name) const
+		{
+			assert(name != NullSymbol);
+			auto const mask = m_Slots.size() - 1;
+			for (size_t slot = HashSymbol(name) & mask;; slot = (slot + 1) & mask)
+			{
+				if (m_Slots[slot].m_Name == name || m_Slots[slot].m_Name == NullSymbol)
+				{
+					return slot;
+				}
+			}
+		}
+
+		CR_INTERNAL void Rehash();
+	};	// class ScopedSymbolTable
+
+}	// namespace Cr
@@ -0,0 +1,605 @@
+// $$***************************************************************$$ //
+//                                                                     //
+//                  Goddamn "C for Rendering" project                  //
+//     Copyright (C) Goddamn Industries 2016. All Rights Reserved.     //
+//          ( https://github.com/GoddamnIndustries/GoddamnCr )         //
+//                                                                     //
+//    This software or any its part is distributed under the terms of  //
+//   Goddamn Industries End User License Agreement. By downloading or  //
+//   using this software or any its part you agree with the terms of   //
+//   Goddamn Industries End User License Agreement.                    //
+//                                                                     //
+// $$***************************************************************$$ //
+
+#include "Simd.h"
+
+#if _M_X64 || _M_IX86 || __x86_64__ || __i386__
+#	define CR_SIMD_X86 1
+#	include <immintrin.h>
+#	if _MSC_VER
+#		include <intrin.h>
+#		define CR_SIMD_AVX2
+#		define CrCountTrailingZeros(mask) _tzcnt_u32(mask)
+#	else
+#		define CR_SIMD_AVX2 __attribute__((target("avx2")))
+#		define CrCountTrailingZeros(mask) __builtin_ctz(mask)
+#	endif
+#else
+#	define CR_SIMD_X86 0
+#endif
+
+namespace Cr
+{
+	namespace Simd
+	{
+		CRINL static bool IsSpace(char const c)
+		{
+			return c == ' ' || static_cast<unsigned char>(c - '\t') <= '\r' - '\t';
+		}
+
+		// *************************************************************** //
+		// **                  Scalar implementation.                   ** //
+		// *************************************************************** //
+
+		static char const* SkipSpaces_Scalar(char const* cursor, char const* const end)
+		{
+			while (cursor != end && IsSpace(*cursor))
+			{
+				++cursor;
+			}
+			return cursor;
+		}
+
+		static char const* FindNewLine_Scalar(char const* const cursor, char const* const end)
+		{
+			auto const newLine = static_cast<char const*>(memchr(cursor, '\n', end - cursor));
+			return newLine != nullptr ? newLine : end;
+		}
+
+		static char const* FindCommentEnd_Scalar(char const* cursor, char const* const end)
+		{
+			for (; end - cursor >= 2; ++cursor)
+			{
+				if (cursor[0] == '*' && cursor[1] == '/')
+				{
+					return cursor;
+				}
+			}
+			return nullptr;
+		}
+
+		static void ComputeInt_Scalar(ComponentOp const op, int32_t* const result, int32_t const* const lhs, int32_t const* const rhs, size_t const count)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				// Computing in unsigned integers, so overflows wrap around.
+				auto const a = static_cast<uint32_t>(lhs[i]), b = static_cast<uint32_t>(rhs[i]);
+				switch (op)
+				{
+					case ComponentOp::Add:        result[i] = static_cast<int32_t>(a + b); break;
+					case ComponentOp::Subtract:   result[i] = static_cast<int32_t>(a - b); break;
+					case ComponentOp::Multiply:   result[i] = static_cast<int32_t>(a * b); break;
+					case ComponentOp::BitwiseAnd: result[i] = static_cast<int32_t>(a & b); break;
+					case ComponentOp::BitwiseOr:  result[i] = static_cast<int32_t>(a | b); break;
+					case ComponentOp::BitwiseXor: result[i] = static_cast<int32_t>(a ^ b); break;
+					default:
+						CrAssert(0);
+						return;
+				}
+			}
+		}
+
+		template<typename Tp>
+		static void ComputeReal_Scalar(ComponentOp const op, Tp* const result, Tp const* const lhs, Tp const* const rhs, size_t const count)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				switch (op)
+				{
+					case ComponentOp::Add:      result[i] = lhs[i] + rhs[i]; break;
+					case ComponentOp::Subtract: result[i] = lhs[i] - rhs[i]; break;
+					case ComponentOp::Multiply: result[i] = lhs[i] * rhs[i]; break;
+					case ComponentOp::Divide:   result[i] = lhs[i] / rhs[i]; break;
+					default:
+						CrAssert(0);
+						return;
+				}
+			}
+		}
+
+#if CR_SIMD_X86
+
+		// *************************************************************** //
+		// **                   SSE2 implementation.                    ** //
+		// *************************************************************** //
+
+		/**
+		 * Returns mask of the whitespace characters: ' ' or '\t'...'\r'.
+		 */
+		CRINL static uint32_t SpacesMask_SSE2(__m128i const chars)
+		{
+			auto const controls = _mm_sub_epi8(chars, _mm_set1_epi8('\t'));
+			auto const isControlSpace = _mm_cmpeq_epi8(_mm_min_epu8(controls, _mm_set1_epi8('\r' - '\t')), controls);
+			auto const isSpace = _mm_cmpeq_epi8(chars, _mm_set1_epi8(' '));
+			return static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(isSpace, isControlSpace)));
+		}
+
+		static char const* SkipSpaces_SSE2(char const* cursor, char const* const end)
+		{
+			for (; end - cursor >= 16; cursor += 16)
+			{
+				auto const mask = ~SpacesMask_SSE2(_mm_loadu_si128(reinterpret_cast<__m128i const*>(cursor))) & 0xFFFF;
+				if (mask != 0)
+				{
+					return cursor + CrCountTrailingZeros(mask);
+				}
+			}
+			return SkipSpaces_Scalar(cursor, end);
+		}
+
+		static char const* FindNewLine_SSE2(char const* cursor, char const* const end)
+		{
+			auto const newLines = _mm_set1_epi8('\n');
+			for (; end - cursor >= 16; cursor += 16)
+			{
+				auto const chars = _mm_loadu_si128(reinterpret_cast<__m128i const*>(cursor));
+				auto const mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chars, newLines)));
+				if (mask != 0)
+				{
+					return cursor + CrCountTrailingZeros(mask);
+				}
+			}
+			return FindNewLine_Scalar(cursor, end);
+		}
+
+		static char const* FindCommentEnd_SSE2(char const* cursor, char const* const end)
+		{
+			// Comparing two overlapping loads: '*' at offset i and '/' at offset i + 1.
+			auto const stars = _mm_set1_epi8('*'), slashes = _mm_set1_epi8('/');
+			for (; end - cursor >= 17; cursor += 16)
+			{
+				auto const first = _mm_loadu_si128(reinterpret_cast<__m128i const*>(cursor));
+				auto const second = _mm_loadu_si128(reinterpret_cast<__m128i const*>(cursor + 1));
+				auto const mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, stars), _mm_cmpeq_epi8(second, slashes))));
+				if (mask != 0)
+				{
+					return cursor + CrCountTrailingZeros(mask);
+				}
+			}
+			return FindCommentEnd_Scalar(cursor, end);
+		}
+
+		static void ComputeInt_SSE2(ComponentOp const op, int32_t* const result, int32_t const* const lhs, int32_t const* const rhs, size_t const count)
+		{
+			if (op == ComponentOp::Multiply)
+			{
+				// SSE2 has no 32-bit multiplication.
+				ComputeInt_Scalar(op, result, lhs, rhs, count);
+				return;
+			}
+			for (size_t i = 0; i < count; i += 4)
+			{
+				auto const a = _mm_loadu_si128(reinterpret_cast<__m128i const*>(lhs + i));
+				auto const b = _mm_loadu_si128(reinterpret_cast<__m128i const*>(rhs + i));
+				__m128i c;
+				switch (op)
+				{
+					case ComponentOp::Add:        c = _mm_add_epi32(a, b); break;
+					case ComponentOp::Subtract:   c = _mm_sub_epi32(a, b); break;
+					case ComponentOp::BitwiseAnd: c = _mm_and_si128(a, b); break;
+					case ComponentOp::BitwiseOr:  c = _mm_or_si128(a, b); break;
+					case ComponentOp::BitwiseXor: c = _mm_xor_si128(a, b); break;
+					default:
+						CrAssert(0);
+						return;
+				}
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(result + i), c);
+			}
+		}
+
+		static void ComputeFloat_SSE2(ComponentOp const op, float* const result, float const* const lhs, float const* const rhs, size_t const count)
+		{
+			for (size_t i = 0; i < count; i += 4)
+			{
+				auto const a = _mm_loadu_ps(lhs + i), b = _mm_loadu_ps(rhs + i);
+				__m128 c;
+				switch (op)
+				{
+					case ComponentOp::Add:      c = _mm_add_ps(a, b); break;
+					case ComponentOp::Subtract: c = _mm_sub_ps(a, b); break;
+					case ComponentOp::Multiply: c = _mm_mul_ps(a, b); break;
+					case ComponentOp::Divide:   c = _mm_div_ps(a, b); break;
+					default:
+						CrAssert(0);
+						return;
+				}
+				_mm_storeu_ps(result + i, c);
+			}
+		}
+
+		static void ComputeDouble_SSE2(ComponentOp const op, double* const result, double const* const lhs, double const* const rhs, size_t const count)
+		{
+			for (size_t i = 0; i < count; i += 2)
+			{
+				auto const a = _mm_loadu_pd(lhs + i), b = _mm_loadu_pd(rhs + i);
+				__m128d c;
+				switch (op)
+				{
+					case ComponentOp::Add:      c = _mm_add_pd(a, b); break;
+					case ComponentOp::Subtract: c = _mm_sub_pd(a, b); break;
+					case ComponentOp::Multiply: c = _mm_mul_pd(a, b); break;
+					case ComponentOp::Divide:   c = _mm_div_pd(a, b); break;
+					default:
+						CrAssert(0);
+						return;
+				}
+				_mm_storeu_pd(result + i, c);
+			}
+		}
+
+		// *************************************************************** //
+		// **                   AVX2 implementation.                    ** //
+		// *************************************************************** //
+
+		CR_SIMD_AVX2 static char const* SkipSpaces_AVX2(char const* cursor, char const* const end)
+		{
+			auto const tab = _mm256_set1_epi8('\t'), controlRange = _mm256_set1_epi8('\r' - '\t'), space = _mm256_set1_epi8(' ');
+			for (; end - cursor >= 32; cursor += 32)
+			{
+				auto const chars = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(cursor));
+				auto const controls = _mm256_sub_epi8(chars, tab);
+				auto const isControlSpace = _mm256_cmpeq_epi8(_mm256_min_epu8(controls, controlRange), controls);
+				auto const isSpace = _mm256_cmpeq_epi8(chars, space);
+				auto const mask = ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(isSpace, isControlSpace)));
+				if (mask != 0)
+				{
+					return cursor + CrCountTrailingZeros(mask);
+				}
+			}
+			return SkipSpaces_SSE2(cursor, end);
+		}
+
+		CR_SIMD_AVX2 static char const* FindNewLine_AVX2(char const* cursor, char const* const end)
+		{
+			auto const newLines = _mm256_set1_epi8('\n');
+			for (; end - cursor >= 32; cursor += 32)
+			{
+				auto const chars = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(cursor));
+				auto const mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chars, newLines)));
+				if (mask != 0)
+				{
+					return cursor + CrCountTrailingZeros(mask);
+				}
+			}
+			return FindNewLine_SSE2(cursor, end);
+		}
+
+		CR_SIMD_AVX2 static char const* FindCommentEnd_AVX2(char const* cursor, char const* const end)
+		{
+			auto const stars = _mm256_set1_epi8('*'), slashes = _mm256_set1_epi8('/');
+			for (; end - cursor >= 33; cursor += 32)
+			{
+				auto const first = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(cursor));
+				auto const second = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(cursor + 1));
+				auto const mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(first, stars), _mm256_cmpeq_epi8(second, slashes))));
+				if (mask != 0)
+				{
+					return cursor + CrCountTrailingZeros(mask);
+				}
+			}
+			return FindCommentEnd_SSE2(cursor, end);
+		}
+
+		CR_SIMD_AVX2 static void ComputeInt_AVX2(ComponentOp const op, int32_t* const result, int32_t const* const lhs, int32_t const* const rhs, size_t const count)
+		{
+			for (size_t i = 0; i < count; i += 8)
+			{
+				auto const a = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(lhs + i));
+				auto const b = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(rhs + i));
+				__m256i c;
+				switch (op)
+				{
+					case ComponentOp::Add:        c = _mm256_add_epi32(a, b); break;
+					case ComponentOp::Subtract:   c = _mm256_sub_epi32(a, b); break;
+					case ComponentOp::Multiply:   c = _mm256_mullo_epi32(a, b); break;
+					case ComponentOp::BitwiseAnd: c = _mm256_and_si256(a, b); break;
+					case ComponentOp::BitwiseOr:  c = _mm256_or_si256(a, b); break;
+					case ComponentOp::BitwiseXor: c = _mm256_xor_si256(a, b); break;
+					default:
+						CrAssert(0);
+						return;
+				}
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(result + i), c);
+			}
+		}
+
+		CR_SIMD_AVX2 static void ComputeFloat_AVX2(ComponentOp const op, float* const result, float const* const lhs, float const* const rhs, size_t const count)
+		{
+			for (size_t i = 0; i < count; i += 8)
+			{
+				auto const a = _mm256_loadu_ps(lhs + i), b = _mm256_loadu_ps(rhs + i);
+				__m256 c;
+				switch (op)
+				{
+					case ComponentOp::Add:      c = _mm256_add_ps(a, b); break;
+					case ComponentOp::Subtract: c = _mm256_sub_ps(a, b); break;
+					case ComponentOp::Multiply: c = _mm256_mul_ps(a, b); break;
+					case ComponentOp::Divide:   c = _mm256_div_ps(a, b); break;
+					default:
+						CrAssert(0);
+						return;
+				}
+				_mm256_storeu_ps(result + i, c);
+			}
+		}
+
+		CR_SIMD_AVX2 static void ComputeDouble_AVX2(ComponentOp const op, double* const result, double const* const lhs, double const* const rhs, size_t const count)
+		{
+			for (size_t i = 0; i < count; i += 4)
+			{
+				auto const a = _mm256_loadu_pd(lhs + i), b = _mm256_loadu_pd(rhs + i);
+				__m256d c;
+				switch (op)
+				{
+					case ComponentOp::Add:      c = _mm256_add_pd(a, b); break;
+					case ComponentOp::Subtract: c = _mm256_sub_pd(a, b); break;
+					case ComponentOp::Multiply: c = _mm256_mul_pd(a, b); break;
+					case ComponentOp::Divide:   c = _mm256_div_pd(a, b); break;
+					default:
+						CrAssert(0);
+						return;
+				}
+				_mm256_storeu_pd(result + i, c);
+			}
+		}
+
+		/**
+		 * Returns true if CPU and OS both support AVX2.
+		 */
+		static bool IsAVX2Supported()
+		{
+#if _MSC_VER
+			int info[4];
+			__cpuid(info, 0);
+			if (info[0] < 7)
+			{
+				return false;
+			}
+			__cpuid(info, 1);
+			auto const hasOSXSave = (info[2] & (1 << 27)) != 0, hasAVX = (info[2] & (1 << 28)) != 0;
+			if (!hasOSXSave || !hasAVX || (_xgetbv(0) & 6) != 6)
+			{
+				return false;
+			}
+			__cpuidex(info, 7, 0);
+			return (info[1] & (1 << 5)) != 0;
+#else
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx2") != 0;
+#endif
+		}
+
+#endif	// if CR_SIMD_X86
+
+		// *************************************************************** //
+		// **                    Runtime dispatch.                      ** //
+		// *************************************************************** //
+
+		typedef char const*(*SearchFunction)(char const* cursor, char const* end);
+
+		static char const* SkipSpaces_Resolve(char const* cursor, char const* end);
+		static char const* FindNewLine_Resolve(char const* cursor, char const* end);
+		static char const* FindCommentEnd_Resolve(char const* cursor, char const* end);
+
+		typedef void(*ComputeIntFunction)(ComponentOp op, int32_t* result, int32_t const* lhs, int32_t const* rhs, size_t count);
+		typedef void(*ComputeFloatFunction)(ComponentOp op, float* result, float const* lhs, float const* rhs, size_t count);
+		typedef void(*ComputeDoubleFunction)(ComponentOp op, double* result, double const* lhs, double const* rhs, size_t count);
+
+		static void ComputeInt_Resolve(ComponentOp op, int32_t* result, int32_t const* lhs, int32_t const* rhs, size_t count);
+		static void ComputeFloat_Resolve(ComponentOp op, float* result, float const* lhs, float const* rhs, size_t count);
+		static void ComputeDouble_Resolve(ComponentOp op, double* result, double const* lhs, double const* rhs, size_t count);
+
+		/**
+		 * Dispatch pointers are constant-initialized to resolvers, so they are usable during static
+		 * initialization of other translation units. First call of any routine selects all implementations.
+		 */
+		static SearchFunction s_SkipSpaces = &SkipSpaces_Resolve;
+		static SearchFunction s_FindNewLine = &FindNewLine_Resolve;
+		static SearchFunction s_FindCommentEnd = &FindCommentEnd_Resolve;
+		static ComputeIntFunction s_ComputeInt = &ComputeInt_Resolve;
+		static ComputeFloatFunction s_ComputeFloat = &ComputeFloat_Resolve;
+		static ComputeDoubleFunction s_ComputeDouble = &ComputeDouble_Resolve;
+
+		static void SelectImplementation()
+		{
+#if CR_SIMD_X86
+			if (IsAVX2Supported())
+			{
+				s_SkipSpaces = &SkipSpaces_AVX2;
+				s_FindNewLine = &FindNewLine_AVX2;
+				s_FindCommentEnd = &FindCommentEnd_AVX2;
+				s_ComputeInt = &ComputeInt_AVX2;
+				s_ComputeFloat = &ComputeFloat_AVX2;
+				s_ComputeDouble = &ComputeDouble_AVX2;
+				return;
+			}
+			s_SkipSpaces = &SkipSpaces_SSE2;
+			s_FindNewLine = &FindNewLine_SSE2;
+			s_FindCommentEnd = &FindCommentEnd_SSE2;
+			s_ComputeInt = &ComputeInt_SSE2;
+			s_ComputeFloat = &ComputeFloat_SSE2;
+			s_ComputeDouble = &ComputeDouble_SSE2;
+#else
+			s_SkipSpaces = &SkipSpaces_Scalar;
+			s_FindNewLine = &FindNewLine_Scalar;
+			s_FindCommentEnd = &FindCommentEnd_Scalar;
+			s_ComputeInt = &ComputeInt_Scalar;
+			s_ComputeFloat = &ComputeReal_Scalar<float>;
+			s_ComputeDouble = &ComputeReal_Scalar<double>;
+#endif
+		}
+
+		static char const* SkipSpaces_Resolve(char const* const cursor, char const* const end)
+		{
+			SelectImplementation();
+			return s_SkipSpaces(cursor, end);
+		}
+		static char const* FindNewLine_Resolve(char const* const cursor, char const* const end)
+		{
+			SelectImplementation();
+			return s_FindNewLine(cursor, end);
+		}
+		static char const* FindCommentEnd_Resolve(char const* const cursor, char const* const end)
+		{
+			SelectImplementation();
+			return s_FindCommentEnd(cursor, end);
+		}
+		static void ComputeInt_Resolve(ComponentOp const op, int32_t* const result, int32_t const* const lhs, int32_t const* const rhs, size_t const count)
+		{
+			SelectImplementation();
+			s_ComputeInt(op, result, lhs, rhs, count);
+		}
+		static void ComputeFloat_Resolve(ComponentOp const op, float* const result, float const* const lhs, float const* const rhs, size_t const count)
+		{
+			SelectImplementation();
+			s_ComputeFloat(op, result, lhs, rhs, count);
+		}
+		static void ComputeDouble_Resolve(ComponentOp const op, double* const result, double const* const lhs, double const* const rhs, size_t const count)
+		{
+			SelectImplementation();
+			s_ComputeDouble(op, result, lhs, rhs, count);
+		}
+
+		CR_API char const* SkipSpaces(char const* const cursor, char const* const end)
+		{
+			return s_SkipSpaces(cursor, end);
+		}
+
+		CR_API char const* FindNewLine(char const* const cursor, char const* const end)
+		{
+			return s_FindNewLine(cursor, end);
+		}
+
+		CR_API char const* FindCommentEnd(char const* const cursor, char const* const end)
+		{
+			return s_FindCommentEnd(cursor, end);
+		}
+
+		CR_API void Compute(ComponentOp const op, int32_t* const result, int32_t const* const lhs, int32_t const* const rhs, size_t const count)
+		{
+			s_ComputeInt(op, result, lhs, rhs, count);
+		}
+		CR_API void Compute(ComponentOp const op, float* const result, float const* const lhs, float const* const rhs, size_t const count)
+		{
+			s_ComputeFloat(op, result, lhs, rhs, count);
+		}
+		CR_API void Compute(ComponentOp const op, double* const result, double const* const lhs, double const* const rhs, size_t const count)
+		{
+			s_ComputeDouble(op, result, lhs, rhs, count);
+		}
+
+		// *************************************************************** //
+		// **                      Unit tests.                          ** //
+		// *************************************************************** //
+
+		CrUnitTest(SimdImplementationsMatch)
+		{
+			struct Implementation
+			{
+				SearchFunction SkipSpaces, FindNewLine, FindCommentEnd;
+			};
+			Implementation implementations[3] = { { &SkipSpaces_Scalar, &FindNewLine_Scalar, &FindCommentEnd_Scalar } };
+			auto implementationsCount = 1;
+#if CR_SIMD_X86
+			implementations[implementationsCount++] = { &SkipSpaces_SSE2, &FindNewLine_SSE2, &FindCommentEnd_SSE2 };
+			if (IsAVX2Supported())
+			{
+				implementations[implementationsCount++] = { &SkipSpaces_AVX2, &FindNewLine_AVX2, &FindCommentEnd_AVX2 };
+			}
+#endif	// if CR_SIMD_X86
+
+			// Every length up to the two and a half AVX2 registers, so the vector loops and the scalar tails both
+			// see the match, and every match position, including the last characters and the missing match.
+			static char const spaces[] = " \t\n\v\f\r";
+			char text[80];
+			for (auto length = 0; length <= static_cast<int>(sizeof(text)); ++length)
+			{
+				auto const begin = text, end = text + length;
+				for (auto position = 0; position <= length; ++position)
+				{
+					for (auto index = 0; index < length; ++index)
+					{
+						text[index] = spaces[index % (sizeof(spaces) - 1)];
+					}
+					if (position < length)
+					{
+						text[position] = 'x';
+					}
+					for (auto implementation = 0; implementation < implementationsCount; ++implementation)
+					{
+						CrAssert(implementations[implementation].SkipSpaces(begin, end) == begin + position);
+					}
+					CrAssert(SkipSpaces(begin, end) == begin + position);
+
+					memset(text, 'x', length);
+					if (position < length)
+					{
+						text[position] = '\n';
+					}
+					for (auto implementation = 0; implementation < implementationsCount; ++implementation)
+					{
+						CrAssert(implementations[implementation].FindNewLine(begin, end) == begin + position);
+					}
+					CrAssert(FindNewLine(begin, end) == begin + position);
+
+					// Stars everywhere, so only the slash completes the pair.
+					memset(text, '*', length);
+					if (position < length)
+					{
+						text[position] = '/';
+					}
+					auto const commentEnd = position > 0 && position < length ? begin + position - 1 : nullptr;
+					for (auto implementation = 0; implementation < implementationsCount; ++implementation)
+					{
+						CrAssert(implementations[implementation].FindCommentEnd(begin, end) == commentEnd);
+					}
+					CrAssert(FindCommentEnd(begin, end) == commentEnd);
+				}
+			}
+		};
+
+		CrUnitTest(SimdComputeMatchesScalar)
+		{
+			int32_t lhsInt[16], rhsInt[16], resultInt[16], expectedInt[16];
+			float lhsFloat[16], rhsFloat[16], resultFloat[16], expectedFloat[16];
+			double lhsDouble[16], rhsDouble[16], resultDouble[16], expectedDouble[16];
+			for (auto i = 0; i < 16; ++i)
+			{
+				lhsInt[i] = INT32_MAX - i * 7919;
+				rhsInt[i] = i * 104729 - 5;
+				lhsFloat[i] = 1.5f * i - 3.0f, rhsFloat[i] = 0.25f * i + 1.0f;
+				lhsDouble[i] = 1.5 * i - 3.0, rhsDouble[i] = 0.25 * i + 1.0;
+			}
+
+			ComponentOp const intOps[] = { ComponentOp::Add, ComponentOp::Subtract, ComponentOp::Multiply
+				, ComponentOp::BitwiseAnd, ComponentOp::BitwiseOr, ComponentOp::BitwiseXor };
+			for (auto const op : intOps)
+			{
+				Compute(op, resultInt, lhsInt, rhsInt, 16);
+				ComputeInt_Scalar(op, expectedInt, lhsInt, rhsInt, 16);
+				CrAssert(memcmp(resultInt, expectedInt, sizeof(resultInt)) == 0);
+			}
+			ComponentOp const realOps[] = { ComponentOp::Add, ComponentOp::Subtract, ComponentOp::Multiply, ComponentOp::Divide };
+			for (auto const op : realOps)
+			{
+				Compute(op, resultFloat, lhsFloat, rhsFloat, 16);
+				ComputeReal_Scalar(op, expectedFloat, lhsFloat, rhsFloat, 16);
+				CrAssert(memcmp(resultFloat, expectedFloat, sizeof(resultFloat)) == 0);
+				Compute(op, resultDouble, lhsDouble, rhsDouble, 16);
+				ComputeReal_Scalar(op, expectedDouble, lhsDouble, rhsDouble, 16);
+				CrAssert(memcmp(resultDouble, expectedDouble, sizeof(resultDouble)) == 0);
+			}
+		};
+
+	}	// namespace Simd
+}	// namespace Cr
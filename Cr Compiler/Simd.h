@@ -0,0 +1,73 @@
+// $$***************************************************************$$ //
+//                                                                     //
+//                  Goddamn "C for Rendering" project                  //
+//     Copyright (C) Goddamn Industries 2016. All Rights Reserved.     //
+//          ( https://github.com/GoddamnIndustries/GoddamnCr )         //
+//                                                                     //
+//    This software or any its part is distributed under the terms of  //
+//   Goddamn Industries End User License Agreement. By downloading or  //
+//   using this software or any its part you agree with the terms of   //
+//   Goddamn Industries End User License Agreement.                    //
+//                                                                     //
+// $$***************************************************************$$ //
+
+#pragma once
+#include "Utils.h"
+
+namespace Cr
+{
+	/**
+	 * Vectorized text search routines and per-component kernels of the constant evaluator.
+	 * The widest implementation supported by the CPU (AVX2, SSE2 or scalar) is selected at runtime.
+	 */
+	namespace Simd
+	{
+		/**
+		 * Skips whitespace characters (including new lines).
+		 * @returns Pointer to the first non-space character or end of the range.
+		 */
+		CR_API char const* SkipSpaces(char const* cursor, char const* end);
+
+		/**
+		 * Finds the next new line character.
+		 * @returns Pointer to the new line character or end of the range.
+		 */
+		CR_API char const* FindNewLine(char const* cursor, char const* end);
+
+		/**
+		 * Finds the end of the multi-line comment.
+		 * @returns Pointer to the '*' of the first "*\/" pair or null pointer if there is none.
+		 */
+		CR_API char const* FindCommentEnd(char const* cursor, char const* end);
+
+		/**
+		 * Per-component operations of the constant values.
+		 */
+		enum class ComponentOp : uint8_t
+		{
+			Add,
+			Subtract,
+			Multiply,
+			Divide,		///< Floating-point only.
+			BitwiseAnd,	///< Integral only.
+			BitwiseOr,	///< Integral only.
+			BitwiseXor,	///< Integral only.
+		};	// enum class ComponentOp
+
+		/**
+		 * Components are processed in the whole registers, so arrays must be padded to the multiple of this count.
+		 */
+		static size_t const s_ComponentsPadding = 8;
+
+		/**
+		 * Applies the operation to each pair of components: result[i] = lhs[i] op rhs[i].
+		 * Integer operations wrap around, so they are valid both for signed and unsigned components.
+		 */
+		/// @{
+		CR_API void Compute(ComponentOp op, int32_t* result, int32_t const* lhs, int32_t const* rhs, size_t count);
+		CR_API void Compute(ComponentOp op, float* result, float const* lhs, float const* rhs, size_t count);
+		CR_API void Compute(ComponentOp op, double* result, double const* lhs, double const* rhs, size_t count);
+		/// @}
+
+	}	// namespace Simd
+}	// namespace Cr
@@ -0,0 +1,186 @@
+// $$***************************************************************$$ //
+//                                                                     //
+//                  Goddamn "C for Rendering" project                  //
+//     Copyright (C) Goddamn Industries 2016. All Rights Reserved.     //
+//          ( https://github.com/GoddamnIndustries/GoddamnCr )         //
+//                                                                     //
+//    This software or any its part is distributed under the terms of  //
+//   Goddamn Industries End User License Agreement. By downloading or  //
+//   using this software or any its part you agree with the terms of   //
+//   Goddamn Industries End User License Agreement.                    //
+//                                                                     //
+// $$***************************************************************$$ //
+
+#include "SourceManager.h"
+#include "Simd.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace Cr
+{
+	// *************************************************************** //
+	// **            SourceManager class implementation.            ** //
+	// *************************************************************** //
+
+	/**
+	 * Returns the process-wide source manager.
+	 */
+	CR_API SourceManager& SourceManager::Global()
+	{
+		static SourceManager s_Global;
+		return s_Global;
+	}
+
+	/**
+	 * Registers the buffer in the location space.
+	 * One extra location is reserved after each buffer, so the end of the buffer also has a location.
+	 */
+	CR_API SourceOffset SourceManager::AddBuffer(char const* const name, char const* const begin, char const* const end
+		, std::shared_ptr<void const> const& owner /*= nullptr*/)
+	{
+		assert(begin <= end);
+		if (owner == nullptr)
+		{
+			// Nothing guarantees that the buffer outlives its locations.
+			return AddBuffer(name, std::string(begin, end));
+		}
+
+		auto const size = static_cast<uint64_t>(end - begin);
+		if (m_NextOffset + size + 1 > UINT32_MAX)
+		{
+			throw WorkflowException("Source location space is exhausted.");
+		}
+
+		auto const offset = m_NextOffset;
+		m_Buffers.push_back({ name != nullptr ? name : "<memory>", begin, end, offset, owner, {} });
+		m_NextOffset += static_cast<SourceOffset>(size + 1);
+		return offset;
+	}
+	CR_API SourceOffset SourceManager::AddBuffer(char const* const name, std::string&& contents)
+	{
+		auto const owner = std::make_shared<std::string const>(std::move(contents));
+		return AddBuffer(name, owner->data(), owner->data() + owner->size(), owner);
+	}
+
+	/**
+	 * Copies the text into the scratch space.
+	 * Each text is terminated with the new line character, so texts are reported as separate lines.
+	 */
+	CR_API SourceOffset SourceManager::AddScratch(char const* const text, size_t const length)
+	{
+		static size_t const s_ScratchBufferSize = 64 * 1024;
+		if (static_cast<size_t>(m_ScratchEnd - m_ScratchCursor) < length + 1)
+		{
+			auto const buffer = std::make_shared<std::string>(std::max(s_ScratchBufferSize, length + 1), '\0');
+			m_ScratchCursor = &(*buffer)[0];
+			m_ScratchEnd = m_ScratchCursor + buffer->size();
+			AddBuffer("<scratch>", m_ScratchCursor, m_ScratchEnd, buffer);
+			m_ScratchBuffer = m_Buffers.size() - 1;
+		}
+
+		auto& buffer = m_Buffers[m_ScratchBuffer];
+		auto const offset = buffer.m_Offset + static_cast<SourceOffset>(m_ScratchCursor - buffer.m_Begin);
+		memcpy(m_ScratchCursor, text, length);
+		m_ScratchCursor[length] = '\n';
+		m_ScratchCursor += length + 1;
+
+		// Lines of the scratch buffer are changed.
+		buffer.m_LineOffsets.clear();
+		return offset;
+	}
+
+	/**
+	 * Finds the buffer that contains the specified location.
+	 */
+	CR_API SourceManager::Buffer const& SourceManager::FindBuffer(SourceOffset const offset) const
+	{
+		assert(offset != NullSourceOffset && offset < m_NextOffset);
+		auto const& lastBuffer = m_Buffers.back();
+		if (offset >= lastBuffer.m_Offset)
+		{
+			// Most queries are about the most recent buffer.
+			return lastBuffer;
+		}
+		auto const buffer = std::upper_bound(m_Buffers.begin(), m_Buffers.end(), offset
+			, [](SourceOffset const offset, Buffer const& buffer) { return offset < buffer.m_Offset; });
+		return *(buffer - 1);
+	}
+
+	/**
+	 * Returns name, line and column of the specified location.
+	 * Offsets of the lines are computed for each buffer on the first query.
+	 */
+	CR_API SourceLocation SourceManager::GetLocation(SourceOffset const offset) const
+	{
+		auto const& buffer = FindBuffer(offset);
+		if (buffer.m_LineOffsets.empty())
+		{
+			buffer.m_LineOffsets.push_back(0);
+			for (auto cursor = buffer.m_Begin; (cursor = Simd::FindNewLine(cursor, buffer.m_End)) != buffer.m_End; )
+			{
+				++cursor;
+				buffer.m_LineOffsets.push_back(static_cast<uint32_t>(cursor - buffer.m_Begin));
+			}
+		}
+
+		auto const position = offset - buffer.m_Offset;
+		auto const line = std::upper_bound(buffer.m_LineOffsets.begin(), buffer.m_LineOffsets.end(), position) - 1;
+		return { buffer.m_Name.c_str(), static_cast<uint32_t>(line - buffer.m_LineOffsets.begin() + 1), position - *line + 1 };
+	}
+
+	// *************************************************************** //
+	// **          Exceptions with the source locations.            ** //
+	// *************************************************************** //
+
+	/**
+	 * Prefixes the message with "name(line,column): ".
+	 */
+	CR_API Exception::Exception(char const* const message, SourceOffset const location)
+		: m_Message(message)
+	{
+		if (location != NullSourceOffset)
+		{
+			auto const sourceLocation = SourceManager::Global().GetLocation(location);
+			char prefix[64];
+			snprintf(prefix, sizeof(prefix), "(%u,%u): ", sourceLocation.m_Line, sourceLocation.m_Column);
+			m_Message = sourceLocation.m_Name + (prefix + m_Message);
+		}
+	}
+
+	// *************************************************************** //
+	// **              SourceManager class unit tests.              ** //
+	// *************************************************************** //
+
+	CrUnitTest(SourceManagerLocations)
+	{
+		SourceManager sourceManager;
+		char const first[] = "a\nbc\n";
+		auto const firstOffset = sourceManager.AddBuffer("first.fx", first, first + sizeof(first) - 1);
+		auto const secondOffset = sourceManager.AddBuffer("second.fx", std::string("\n\nxyz"));
+		CrAssert(secondOffset > firstOffset + sizeof(first) - 1);
+
+		auto location = sourceManager.GetLocation(firstOffset + 3);
+		CrAssert(strcmp(location.m_Name, "first.fx") == 0 && location.m_Line == 2 && location.m_Column == 2);
+		CrAssert(*sourceManager.GetText(firstOffset + 3) == 'c');
+
+		location = sourceManager.GetLocation(secondOffset + 3);
+		CrAssert(strcmp(location.m_Name, "second.fx") == 0 && location.m_Line == 3 && location.m_Column == 2);
+		CrAssert(*sourceManager.GetText(secondOffset + 3) == 'y');
+
+		auto const firstScratch = sourceManager.AddScratch("ab", 2);
+		auto const secondScratch = sourceManager.AddScratch("cd", 2);
+		CrAssert(strncmp(sourceManager.GetText(firstScratch), "ab", 2) == 0 && strncmp(sourceManager.GetText(secondScratch), "cd", 2) == 0);
+		CrAssert(sourceManager.GetLocation(secondScratch + 1).m_Line == 2);
+	};
+
+	CrUnitTest(SourceManagerCopiesUnownedBuffers)
+	{
+		SourceManager sourceManager;
+		char text[] = "abc";
+		auto const offset = sourceManager.AddBuffer("text.fx", text, text + sizeof(text) - 1);
+		text[1] = 'x';
+		CrAssert(sourceManager.GetText(offset) != text && *sourceManager.GetText(offset + 1) == 'b');
+	};
+
+}	// namespace Cr
@@ -0,0 +1,110 @@
+// $$***************************************************************$$ //
+//                                                                     //
+//                  Goddamn "C for Rendering" project                  //
+//     Copyright (C) Goddamn Industries 2016. All Rights Reserved.     //
+//          ( https://github.com/GoddamnIndustries/GoddamnCr )         //
+//                                                                     //
+//    This software or any its part is distributed under the terms of  //
+//   Goddamn Industries End User License Agreement. By downloading or  //
+//   using this software or any its part you agree with the terms of   //
+//   Goddamn Industries End User License Agreement.                    //
+//                                                                     //
+// $$***************************************************************$$ //
+
+#pragma once
+#include "Utils.h"
+
+#include <string>
+#include <vector>
+
+namespace Cr
+{
+	/**
+	 * Offset in the global source location space. Zero is an invalid location.
+	 */
+	typedef uint32_t SourceOffset;
+	static SourceOffset const NullSourceOffset = 0;
+
+	/**
+	 * Human-readable position inside the source buffer.
+	 */
+	struct SourceLocation
+	{
+		char const* m_Name;
+		uint32_t    m_Line;
+		uint32_t    m_Column;
+	};	// struct SourceLocation
+
+	/**
+	 * Keeps all source buffers of the compilation and maps them into the single location space,
+	 * so any position inside any buffer is described by the 32-bit offset.
+	 * Buffers are kept alive until the source manager is destroyed and their locations are never reused.
+	 */
+	class SourceManager final
+	{
+	private:
+		struct Buffer
+		{
+			std::string                   m_Name;
+			char const*                   m_Begin;
+			char const*                   m_End;
+			SourceOffset                  m_Offset;
+			std::shared_ptr<void const>   m_Owner;
+			mutable std::vector<uint32_t> m_LineOffsets;
+		};	// struct Buffer
+
+		std::vector<Buffer> m_Buffers;
+		SourceOffset        m_NextOffset = 1;
+		size_t              m_ScratchBuffer = SIZE_MAX;
+		char*               m_ScratchCursor = nullptr;
+		char*               m_ScratchEnd = nullptr;
+
+	public:
+		SourceManager(SourceManager const&) = delete;
+		SourceManager& operator= (SourceManager const&) = delete;
+
+		SourceManager() = default;
+
+		/**
+		 * Returns the process-wide source manager.
+		 * @warning Not thread-safe.
+		 */
+		CR_API static SourceManager& Global();
+
+		/**
+		 * Registers the buffer in the location space.
+		 * @param owner Object that keeps the buffer alive. If null, the buffer is copied.
+		 * @returns Location of the first character of the buffer.
+		 * @throws WorkflowException If the location space is exhausted.
+		 */
+		/// @{
+		CR_API SourceOffset AddBuffer(char const* name, char const* begin, char const* end, std::shared_ptr<void const> const& owner = nullptr);
+		CR_API SourceOffset AddBuffer(char const* name, std::string&& contents);
+		/// @}
+
+		/**
+		 * Copies the text into the scratch space, used for the lexemes that are produced by the preprocessor.
+		 * Small texts share the scratch buffers, so no buffer is registered for each of them.
+		 * @returns Location of the first character of the copied text.
+		 */
+		CR_API SourceOffset AddScratch(char const* text, size_t length);
+
+		/**
+		 * Returns pointer to the character at the specified location.
+		 */
+		CRINL char const* GetText(SourceOffset const offset) const
+		{
+			auto const& buffer = FindBuffer(offset);
+			return buffer.m_Begin + (offset - buffer.m_Offset);
+		}
+
+		/**
+		 * Returns name, line and column of the specified location.
+		 */
+		CR_API SourceLocation GetLocation(SourceOffset offset) const;
+
+	private:
+		CR_API Buffer const& FindBuffer(SourceOffset offset) const;
+	};	// class SourceManager
+
+}	// namespace Cr
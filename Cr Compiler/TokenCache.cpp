@@ -0,0 +1,412 @@
+// $$***************************************************************$$ //
+//                                                                     //
+//                  Goddamn "C for Rendering" project                  //
+//     Copyright (C) Goddamn Industries 2016. All Rights Reserved.     //
+//          ( https://github.com/GoddamnIndustries/GoddamnCr )         //
+//                                                                     //
+//    This software or any its part is distributed under the terms of  //
+//   Goddamn Industries End User License Agreement. By downloading or  //
+//   using this software or any its part you agree with the terms of   //
+//   Goddamn Industries End User License Agreement.                    //
+//                                                                     //
+// $$***************************************************************$$ //
+
+
+#include "TokenCache.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+
+namespace Cr
+{
+	// *************************************************************** //
+	// **               TokenCache class implementation.            ** //
+	// *************************************************************** //
+
+	/**
+	 * Header of the cache entry, followed by the lexemes, the identifiers and the text sections.
+	 * Sections are naturally aligned, so the mapped entry is read in place.
+	 */
+	struct TokenCacheHeader
+	{
+		char     m_Magic[8];
+		uint64_t m_Key;
+		uint32_t m_LexemesCount;
+		uint32_t m_IdentifiersCount;
+		uint32_t m_TextSize;
+		uint32_t m_Reserved;
+	};	// struct TokenCacheHeader
+
+	/**
+	 * Lexeme of the cache entry.
+	 * Offset is relative to the text section, value of the identifier is the index of its spelling in the identifiers section.
+	 */
+	struct TokenCacheLexeme
+	{
+		uint16_t m_Type;
+		uint16_t m_Flags;
+		uint32_t m_Value;
+		uint32_t m_Offset;
+		uint32_t m_Length;
+	};	// struct TokenCacheLexeme
+
+	/**
+	 * Spelling of the identifier in the text section.
+	 */
+	struct TokenCacheIdentifier
+	{
+		uint32_t m_Offset;
+		uint32_t m_Length;
+	};	// struct TokenCacheIdentifier
+
+	static char const s_TokenCacheMagic[8] = "CrTok01";
+	static char const s_TokenCacheIndexName[] = "/CrTokenCache.index";
+
+	/**
+	 * Initializes a new cache in the existing directory.
+	 */
+	CR_API TokenCache::TokenCache(char const* const directory)
+		: m_Directory(directory), m_Index((m_Directory + s_TokenCacheIndexName).c_str())
+	{
+	}
+
+	/**
+	 * Adds the directory to search the included files in.
+	 */
+	CR_API void TokenCache::AddIncludeDirectory(char const* const directory)
+	{
+		CrAssert(directory != nullptr);
+		m_IncludeDirectories.emplace_back(directory);
+		m_Index.AddIncludeDirectory(directory);
+	}
+
+	/**
+	 * Preprocesses the file, or loads the cached lexemes if the file and its includes have not changed.
+	 * Preprocessed lexemes are stored into the cache on the miss.
+	 */
+	CR_API std::vector<Lexeme> TokenCache::Preprocess(char const* const path, MacroDictionary const& macros, bool* const isCached /*= nullptr*/)
+	{
+		auto const key = ComputeKey(path, macros);
+		std::vector<Lexeme> lexemes;
+		auto const isLoaded = Load(key, lexemes);
+		if (isCached != nullptr)
+		{
+			*isCached = isLoaded;
+		}
+		if (isLoaded)
+		{
+			return lexemes;
+		}
+
+		auto const file = HeaderCache::Global().Find(path);
+		if (file == nullptr)
+		{
+			throw TokenCacheException(("Cannot open the preprocessed file '" + std::string(path) + "'.").c_str());
+		}
+		Preprocessor preprocessor(*file);
+		for (auto const& directory : m_IncludeDirectories)
+		{
+			preprocessor.AddIncludeDirectory(directory.c_str());
+		}
+		for (auto const& macro : macros)
+		{
+			preprocessor.DefineMacro(macro.first.c_str(), macro.second.c_str());
+		}
+		Lexeme chunk[256];
+		for (size_t count; (count = preprocessor.GetNextLexemes(chunk, sizeof chunk / sizeof chunk[0])) != 0;)
+		{
+			if (chunk[count - 1] == Lexeme::Type::Null)
+			{
+				lexemes.insert(lexemes.end(), chunk, chunk + count - 1);
+				break;
+			}
+			lexemes.insert(lexemes.end(), chunk, chunk + count);
+		}
+
+		Store(key, lexemes);
+		m_Index.Save();
+		return lexemes;
+	}
+
+	/**
+	 * Computes the key of the file preprocessed with the specified macros.
+	 * Key covers the paths and contents of the file and its includes, the include directories, the macros
+	 * sorted by their names and the version of the lexemes.
+	 */
+	CR_API uint64_t TokenCache::ComputeKey(char const* const path, MacroDictionary const& macros)
+	{
+		CrAssert(path != nullptr);
+		uint64_t key;
+		m_Index.Scan(path, &key);
+		auto const typesCount = static_cast<uint16_t>(Lexeme::Type::PpArgumentStringized);
+		key = Hash::Fnv1a64(s_TokenCacheMagic, sizeof s_TokenCacheMagic, key);
+		key = Hash::Fnv1a64(reinterpret_cast<char const*>(&typesCount), sizeof typesCount, key);
+
+		auto const directoriesCount = static_cast<uint64_t>(m_IncludeDirectories.size());
+		key = Hash::Fnv1a64(reinterpret_cast<char const*>(&directoriesCount), sizeof directoriesCount, key);
+		for (auto const& directory : m_IncludeDirectories)
+		{
+			key = Hash::Fnv1a64(directory.c_str(), directory.size() + 1, key);
+		}
+
+		// Later definitions of the same macro override the earlier ones, so the order of the equal names is kept.
+		std::vector<MacroDictionary::value_type const*> sortedMacros;
+		for (auto const& macro : macros)
+		{
+			sortedMacros.push_back(&macro);
+		}
+		std::stable_sort(sortedMacros.begin(), sortedMacros.end(), [](MacroDictionary::value_type const* const first, MacroDictionary::value_type const* const second)
+		{
+			return first->first < second->first;
+		});
+		for (auto const macro : sortedMacros)
+		{
+			key = Hash::Fnv1a64(macro->first.c_str(), macro->first.size() + 1, key);
+			key = Hash::Fnv1a64(macro->second.c_str(), macro->second.size() + 1, key);
+		}
+		return key;
+	}
+
+	/**
+	 * Loads the entry with the specified key.
+	 * Entry is mapped and its text section is added to the source manager, identifiers are interned once for each spelling.
+	 */
+	CR_API bool TokenCache::Load(uint64_t const key, std::vector<Lexeme>& lexemes) const
+	{
+		auto const path = GetEntryPath(key);
+		IO::PInputStream inputStream;
+		try
+		{
+			inputStream = std::make_shared<IO::MappedFileInputStream>(path.c_str());
+		}
+		catch (Exception const&)
+		{
+			return false;
+		}
+
+		char const* begin;
+		char const* end;
+		inputStream->GetBuffer(begin, end);
+		auto const size = static_cast<uint64_t>(end - begin);
+		auto const header = reinterpret_cast<TokenCacheHeader const*>(begin);
+		if (size < sizeof *header || memcmp(header->m_Magic, s_TokenCacheMagic, sizeof s_TokenCacheMagic) != 0 || header->m_Key != key
+			|| size != sizeof *header + header->m_LexemesCount * uint64_t(sizeof(TokenCacheLexeme))
+				+ header->m_IdentifiersCount * uint64_t(sizeof(TokenCacheIdentifier)) + header->m_TextSize)
+		{
+			return false;
+		}
+		auto const cachedLexemes = reinterpret_cast<TokenCacheLexeme const*>(header + 1);
+		auto const cachedIdentifiers = reinterpret_cast<TokenCacheIdentifier const*>(cachedLexemes + header->m_LexemesCount);
+		auto const text = reinterpret_cast<char const*>(cachedIdentifiers + header->m_IdentifiersCount);
+
+		// Whole entry is validated first, so nothing is registered or interned for the damaged one.
+		for (uint32_t i = 0; i < header->m_IdentifiersCount; ++i)
+		{
+			auto const& identifier = cachedIdentifiers[i];
+			if (identifier.m_Length == 0 || identifier.m_Offset > header->m_TextSize || identifier.m_Length > header->m_TextSize - identifier.m_Offset)
+			{
+				return false;
+			}
+		}
+		for (uint32_t i = 0; i < header->m_LexemesCount; ++i)
+		{
+			auto const& lexeme = cachedLexemes[i];
+			if (lexeme.m_Type == static_cast<uint16_t>(Lexeme::Type::Null) || lexeme.m_Type >= static_cast<uint16_t>(Lexeme::Type::PpArgument)
+				|| lexeme.m_Offset > header->m_TextSize || lexeme.m_Length > header->m_TextSize - lexeme.m_Offset
+				|| (static_cast<Lexeme::Type>(lexeme.m_Type) == Lexeme::Type::IdIdentifier && lexeme.m_Value >= header->m_IdentifiersCount))
+			{
+				return false;
+			}
+		}
+
+		auto const textOffset = SourceManager::Global().AddBuffer(path.c_str(), text, text + header->m_TextSize, inputStream);
+		std::vector<Symbol> symbols(header->m_IdentifiersCount);
+		for (uint32_t i = 0; i < header->m_IdentifiersCount; ++i)
+		{
+			symbols[i] = SymbolTable::Global().Intern(text + cachedIdentifiers[i].m_Offset, cachedIdentifiers[i].m_Length);
+		}
+		std::vector<Lexeme> loadedLexemes;
+		loadedLexemes.reserve(header->m_LexemesCount);
+		for (uint32_t i = 0; i < header->m_LexemesCount; ++i)
+		{
+			auto const& lexeme = cachedLexemes[i];
+			auto const type = static_cast<Lexeme::Type>(lexeme.m_Type);
+			loadedLexemes.push_back(Lexeme(type, type == Lexeme::Type::IdIdentifier ? symbols[lexeme.m_Value] : lexeme.m_Value
+				, textOffset + lexeme.m_Offset, lexeme.m_Length, lexeme.m_Flags));
+		}
+		lexemes = std::move(loadedLexemes);
+		return true;
+	}
+
+	/**
+	 * Stores the entry with the specified key.
+	 * Spellings are written line by line as the lexemes were in the source, so locations inside the entry stay readable.
+	 * Entry is written into the temporary file first, so the damaged entry is never left.
+	 */
+	CR_API void TokenCache::Store(uint64_t const key, std::vector<Lexeme> const& lexemes) const
+	{
+		std::string text;
+		std::vector<TokenCacheLexeme> cachedLexemes;
+		std::vector<TokenCacheIdentifier> cachedIdentifiers;
+		std::unordered_map<Symbol, uint32_t> identifierIndices;
+		cachedLexemes.reserve(lexemes.size());
+		for (auto const& lexeme : lexemes)
+		{
+			if (!text.empty())
+			{
+				text.push_back(lexeme.HasFlags(Lexeme::FlagsStartOfLine) ? '\n' : ' ');
+			}
+			TokenCacheLexeme cachedLexeme = { static_cast<uint16_t>(lexeme.GetType()), lexeme.GetFlags(), 0
+				, static_cast<uint32_t>(text.size()), lexeme.GetLength() };
+			if (lexeme == Lexeme::Type::IdIdentifier)
+			{
+				auto const identifier = identifierIndices.emplace(lexeme.GetValueID(), static_cast<uint32_t>(cachedIdentifiers.size()));
+				if (identifier.second)
+				{
+					cachedIdentifiers.push_back({ cachedLexeme.m_Offset, cachedLexeme.m_Length });
+				}
+				cachedLexeme.m_Value = identifier.first->second;
+			}
+			cachedLexemes.push_back(cachedLexeme);
+			text.append(lexeme.GetText(), lexeme.GetLength());
+		}
+		if (text.size() > UINT32_MAX || lexemes.size() > UINT32_MAX)
+		{
+			throw TokenCacheException("Preprocessed source is too large to be cached.");
+		}
+
+		TokenCacheHeader header = {};
+		memcpy(header.m_Magic, s_TokenCacheMagic, sizeof s_TokenCacheMagic);
+		header.m_Key = key;
+		header.m_LexemesCount = static_cast<uint32_t>(cachedLexemes.size());
+		header.m_IdentifiersCount = static_cast<uint32_t>(cachedIdentifiers.size());
+		header.m_TextSize = static_cast<uint32_t>(text.size());
+
+		auto const path = GetEntryPath(key);
+		auto const temporaryPath = path + ".tmp";
+		auto const entryFile = fopen(temporaryPath.c_str(), "wb");
+		if (entryFile == nullptr)
+		{
+			throw TokenCacheException("Failed to write the token cache entry.");
+		}
+		auto isWritten = true;
+		try
+		{
+			IO::BufferedWriter writer(entryFile);
+			writer.Write(reinterpret_cast<char const*>(&header), sizeof header);
+			writer.Write(reinterpret_cast<char const*>(cachedLexemes.data()), cachedLexemes.size() * sizeof(TokenCacheLexeme));
+			writer.Write(reinterpret_cast<char const*>(cachedIdentifiers.data()), cachedIdentifiers.size() * sizeof(TokenCacheIdentifier));
+			writer.Write(text.data(), text.size());
+			writer.Flush();
+		}
+		catch (Exception const&)
+		{
+			isWritten = false;
+		}
+		isWritten = fclose(entryFile) == 0 && isWritten;
+		remove(path.c_str());
+		if (!isWritten || rename(temporaryPath.c_str(), path.c_str()) != 0)
+		{
+			remove(temporaryPath.c_str());
+			throw TokenCacheException("Failed to write the token cache entry.");
+		}
+	}
+
+	/**
+	 * Returns path of the entry with the specified key.
+	 */
+	CR_INTERNAL std::string TokenCache::GetEntryPath(uint64_t const key) const
+	{
+		char name[32];
+		snprintf(name, sizeof name, "/%016llx.crtokens", static_cast<unsigned long long>(key));
+		return m_Directory + name;
+	}
+
+	// *************************************************************** //
+	// **                 TokenCache class unit tests.              ** //
+	// *************************************************************** //
+
+	CrUnitTest(TokenCache)
+	{
+		Testing::TestFiles files("TokenCacheTest");
+		auto const shaderPath = files.AddSource("Shader.fx", R"(#include "Shader.fxh"
+#if QUALITY > 1
+float4 color = COLOR(0.5);
+#endif
+"text" 1.5f)");
+		files.AddSource("Shader.fxh", "#define COLOR(x) float4(x, x, x, 1)\n");
+		auto const directory = IO::GetTemporaryDirectory();
+		MacroDictionary const macros = { { "QUALITY", "2" } };
+		auto const toString = [](std::vector<Lexeme> const& lexemes)
+		{
+			std::string result;
+			for (auto const& lexeme : lexemes)
+			{
+				result.append(lexeme.GetText(), lexeme.GetLength()).push_back(' ');
+			}
+			return result;
+		};
+
+		TokenCache cache(directory.c_str());
+		auto const key = cache.ComputeKey(shaderPath.c_str(), macros);
+		char entryName[32];
+		snprintf(entryName, sizeof entryName, "%016llx.crtokens", static_cast<unsigned long long>(key));
+		files.GetTemporaryPath(entryName);
+		files.GetTemporaryPath(s_TokenCacheIndexName + 1);
+
+		bool isCached;
+		auto const lexemes = cache.Preprocess(shaderPath.c_str(), macros, &isCached);
+		CrAssert(!isCached && toString(lexemes) == "float4 color = float4 ( 0.5 , 0.5 , 0.5 , 1 ) ; \"text\" 1.5f ");
+		{
+			// Cached lexemes are equal to the preprocessed ones and may be parsed.
+			TokenCache loadedCache(directory.c_str());
+			auto const cachedLexemes = loadedCache.Preprocess(shaderPath.c_str(), macros, &isCached);
+			CrAssert(isCached && cachedLexemes.size() == lexemes.size() && toString(cachedLexemes) == toString(lexemes));
+			for (size_t i = 0; i < lexemes.size(); ++i)
+			{
+				CrAssert(cachedLexemes[i].GetType() == lexemes[i].GetType() && cachedLexemes[i].GetFlags() == lexemes[i].GetFlags());
+				CrAssert(cachedLexemes[i] != Lexeme::Type::IdIdentifier || cachedLexemes[i].GetValueID() == lexemes[i].GetValueID());
+			}
+			CrAssert(cachedLexemes[5].GetValueReal() == 0.5);
+
+			// Preprocessor replays the cached lexemes as they are.
+			Preprocessor preprocessor(cachedLexemes);
+			std::vector<Lexeme> replayedLexemes;
+			for (auto lexeme = preprocessor.GetNextLexeme(); lexeme != Lexeme::Type::Null; lexeme = preprocessor.GetNextLexeme())
+			{
+				replayedLexemes.push_back(lexeme);
+			}
+			CrAssert(replayedLexemes.size() == lexemes.size() && toString(replayedLexemes) == toString(lexemes));
+			for (size_t i = 0; i < lexemes.size(); ++i)
+			{
+				CrAssert(replayedLexemes[i].GetType() == lexemes[i].GetType() && replayedLexemes[i].GetOffset() == cachedLexemes[i].GetOffset());
+			}
+		}
+
+		// Macros and included files change the key.
+		CrAssert(cache.ComputeKey(shaderPath.c_str(), { { "QUALITY", "3" } }) != key);
+		CrAssert(cache.ComputeKey(shaderPath.c_str(), { { "QUALITY", "2" }, { "UNUSED", "1" } }) != key);
+		files.AddSource("Shader.fxh", "#define COLOR(x) float4(x, x, x, 0)\n");
+		auto const changedKey = cache.ComputeKey(shaderPath.c_str(), macros);
+		std::vector<Lexeme> changedLexemes;
+		CrAssert(changedKey != key && !cache.Load(changedKey, changedLexemes));
+
+		// Damaged entry is rejected before its text is registered in the source manager.
+		snprintf(entryName, sizeof entryName, "%016llx.crtokens", static_cast<unsigned long long>(changedKey));
+		auto const damagedEntryPath = files.GetTemporaryPath(entryName);
+		cache.Store(changedKey, lexemes);
+		auto const file = fopen(damagedEntryPath.c_str(), "r+b");
+		CrAssert(file != nullptr);
+		auto const nullType = static_cast<uint16_t>(Lexeme::Type::Null);
+		fseek(file, sizeof(TokenCacheHeader) + offsetof(TokenCacheLexeme, m_Type), SEEK_SET);
+		fwrite(&nullType, sizeof nullType, 1, file);
+		fclose(file);
+		auto const offset = SourceManager::Global().AddBuffer(nullptr, std::string("a"));
+		CrAssert(!cache.Load(changedKey, changedLexemes));
+		CrAssert(SourceManager::Global().AddBuffer(nullptr, std::string("a")) == offset + 2);
+	};
+
+}	// namespace Cr
@@ -0,0 +1,84 @@
+// $$***************************************************************$$ //
+//                                                                     //
+//                  Goddamn "C for Rendering" project                  //
+//     Copyright (C) Goddamn Industries 2016. All Rights Reserved.     //
+//          ( https://github.com/GoddamnIndustries/GoddamnCr )         //
+//                                                                     //
+//    This software or any its part is distributed under the terms of  //
+//   Goddamn Industries End User License Agreement. By downloading or  //
+//   using this software or any its part you agree with the terms of   //
+//   Goddamn Industries End User License Agreement.                    //
+//                                                                     //
+// $$***************************************************************$$ //
+
+
+#pragma once
+#include "DependencyIndex.h"
+#include "Permutations.h"
+
+#include <string>
+#include <vector>
+
+namespace Cr
+{
+	CrDefineExceptionBase(TokenCacheException, WorkflowException);
+
+	/**
+	 * On-disk cache of the preprocessed lexemes.
+	 * Entries are keyed by the hash of the source, all its includes and the macro set, and are stored in the binary format that is
+	 * mapped into the memory as is: lexemes refer the text section of the entry, which becomes a buffer of the source manager, so a hit
+	 * skips both the scanner and the preprocessor.
+	 *
+	 * Includes are followed regardless of the conditions, like the dependency index does, so the key may change
+	 * when an inactive include changes, but never stays the same when the output could differ.
+	 */
+	class TokenCache final
+	{
+	private:
+		std::string              m_Directory;
+		DependencyIndex          m_Index;
+		std::vector<std::string> m_IncludeDirectories;
+
+	public:
+		TokenCache(TokenCache const&) = delete;
+		TokenCache& operator= (TokenCache const&) = delete;
+
+		/**
+		 * Initializes a new cache in the existing directory.
+		 * Dependency index of the cache is stored in the same directory.
+		 */
+		CR_API explicit TokenCache(char const* directory);
+
+		/**
+		 * Adds the directory to search the included files in.
+		 */
+		CR_API void AddIncludeDirectory(char const* directory);
+
+		/**
+		 * Preprocesses the file, or loads the cached lexemes if the file and its includes have not changed.
+		 * @param isCached Receives true on the cache hit, if not null.
+		 * @returns Preprocessed lexemes without the trailing null one.
+		 */
+		CR_API std::vector<Lexeme> Preprocess(char const* path, MacroDictionary const& macros, bool* isCached = nullptr);
+
+		/**
+		 * Computes the key of the file preprocessed with the specified macros.
+		 */
+		CR_API uint64_t ComputeKey(char const* path, MacroDictionary const& macros);
+
+		/**
+		 * Loads the entry with the specified key.
+		 * @returns False if the entry does not exist or is damaged.
+		 */
+		CR_API bool Load(uint64_t key, std::vector<Lexeme>& lexemes) const;
+
+		/**
+		 * Stores the entry with the specified key, existing entry is replaced.
+		 */
+		CR_API void Store(uint64_t key, std::vector<Lexeme> const& lexemes) const;
+
+	private:
+		CR_INTERNAL std::string GetEntryPath(uint64_t key) const;
+	};	// class TokenCache
+
+}	// namespace Cr
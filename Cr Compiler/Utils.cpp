@@ -0,0 +1,244 @@
+// $$***************************************************************$$ //
+//                                                                     //
+//                  Goddamn "C for Rendering" project                  //
+//     Copyright (C) Goddamn Industries 2016. All Rights Reserved.     //
+//          ( https://github.com/GoddamnIndustries/GoddamnCr )         //
+//                                                                     //
+//    This software or any its part is distributed under the terms of  //
+//   Goddamn Industries End User License Agreement. By downloading or  //
+//   using this software or any its part you agree with the terms of   //
+//   Goddamn Industries End User License Agreement.                    //
+//                                                                     //
+// $$***************************************************************$$ //
+
+#include "Utils.h"
+
+#include <cstdlib>
+#include <type_traits>
+
+#if _WIN32
+#	define WIN32_LEAN_AND_MEAN
+#	define NOMINMAX
+#	include <Windows.h>
+#else
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <fcntl.h>
+#	include <unistd.h>
+#endif
+
+namespace Cr
+{
+	// *************************************************************** //
+	// **                  Arena class implementation.              ** //
+	// *************************************************************** //
+
+	/**
+	 * Allocates a new block and places the requested memory at its beginning.
+	 * Requests larger than the block size get the dedicated block.
+	 */
+	CR_API void* Arena::AllocateBlock(size_t const size, size_t const alignment)
+	{
+		auto const blockSize = size + alignment > m_BlockSize ? size + alignment : m_BlockSize;
+		m_Blocks.emplace_back(new char[blockSize]);
+
+		auto const block = m_Blocks.back().get();
+		auto const address = reinterpret_cast<uintptr_t>(block);
+		auto const aligned = reinterpret_cast<char*>((address + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1));
+		if (blockSize == m_BlockSize)
+		{
+			m_Cursor = aligned + size;
+			m_End = block + blockSize;
+		}
+		return aligned;
+	}
+
+	// *************************************************************** //
+	// **                   Arena class unit tests.                 ** //
+	// *************************************************************** //
+
+	CrUnitTest(ArenaVector)
+	{
+		Arena arena(256);
+		ArenaVector<uint64_t> vector;
+		for (uint64_t i = 0; i < 100; ++i)
+		{
+			vector.PushBack(arena, i);
+			CrAssert(reinterpret_cast<uintptr_t>(&vector.back()) % alignof(uint64_t) == 0);
+		}
+		CrAssert(vector.size() == 100 && vector.front() == 0 && vector[50] == 50 && vector.back() == 99);
+
+		// Copies share the storage, so they are as cheap as the nodes that hold them.
+		auto const copy = vector;
+		vector.PopBack();
+		CrAssert(copy.size() == 100 && vector.size() == 99 && copy.begin() == vector.begin());
+		static_assert(std::is_trivially_destructible<ArenaVector<uint64_t>>::value, "Arena vector must be trivially destructible.");
+	};
+
+	namespace IO
+	{
+		/**
+		 * Returns the directory for the temporary files, without the trailing separator.
+		 * Current directory is returned if the temporary one is unknown.
+		 */
+		CR_API std::string GetTemporaryDirectory()
+		{
+#if _WIN32
+			char path[MAX_PATH + 1];
+			auto const length = GetTempPathA(sizeof path, path);
+			std::string directory = length != 0 && length <= MAX_PATH ? std::string(path, length) : ".";
+#else	// if _WIN32
+			auto const environmentDirectory = getenv("TMPDIR");
+			std::string directory = environmentDirectory != nullptr && *environmentDirectory != '\0' ? environmentDirectory : "/tmp";
+#endif	// if _WIN32
+			while (directory.size() > 1 && (directory.back() == '/' || directory.back() == '\\'))
+			{
+				directory.pop_back();
+			}
+			return directory;
+		}
+
+		// *************************************************************** //
+		// **          MappedFileInputStream class implementation.       ** //
+		// *************************************************************** //
+
+#if _WIN32
+
+		/**
+		 * Maps the specified file into the address space.
+		 */
+		MappedFileInputStream::MappedFileInputStream(char const* const path)
+		{
+			assert(path != nullptr);
+			auto const file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING
+				, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+			if (file == INVALID_HANDLE_VALUE)
+			{
+				throw Exception("Failed to open file for mapping.");
+			}
+
+			LARGE_INTEGER fileSize = {};
+			if (!GetFileSizeEx(file, &fileSize))
+			{
+				CloseHandle(file);
+				throw Exception("Failed to query size of the mapped file.");
+			}
+			if (fileSize.QuadPart == 0)
+			{
+				// Empty files cannot be mapped.
+				CloseHandle(file);
+				m_Begin = m_Cursor = m_End = "";
+				return;
+			}
+
+			auto const mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			CloseHandle(file);
+			if (mapping == nullptr)
+			{
+				throw Exception("Failed to create file mapping.");
+			}
+			auto const view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			if (view == nullptr)
+			{
+				CloseHandle(mapping);
+				throw Exception("Failed to map view of the file.");
+			}
+
+			m_Mapping = mapping;
+			m_Begin = m_Cursor = static_cast<char const*>(view);
+			m_End = m_Begin + static_cast<size_t>(fileSize.QuadPart);
+		}
+
+		/**
+		 * Unmaps the file.
+		 */
+		MappedFileInputStream::~MappedFileInputStream()
+		{
+			if (m_Mapping != nullptr)
+			{
+				UnmapViewOfFile(m_Begin);
+				CloseHandle(m_Mapping);
+			}
+		}
+
+#else	// if _WIN32
+
+		/**
+		 * Maps the specified file into the address space.
+		 */
+		MappedFileInputStream::MappedFileInputStream(char const* const path)
+		{
+			assert(path != nullptr);
+			auto const file = open(path, O_RDONLY);
+			if (file == -1)
+			{
+				throw Exception("Failed to open file for mapping.");
+			}
+
+			struct stat fileStat = {};
+			if (fstat(file, &fileStat) == -1)
+			{
+				close(file);
+				throw Exception("Failed to query size of the mapped file.");
+			}
+			if (fileStat.st_size == 0)
+			{
+				// Empty files cannot be mapped.
+				close(file);
+				m_Begin = m_Cursor = m_End = "";
+				return;
+			}
+
+			auto const fileSize = static_cast<size_t>(fileStat.st_size);
+			auto const view = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, file, 0);
+			close(file);
+			if (view == MAP_FAILED)
+			{
+				throw Exception("Failed to map the file.");
+			}
+			madvise(view, fileSize, MADV_SEQUENTIAL);
+
+			m_Mapping = view;
+			m_Begin = m_Cursor = static_cast<char const*>(view);
+			m_End = m_Begin + fileSize;
+		}
+
+		/**
+		 * Unmaps the file.
+		 */
+		MappedFileInputStream::~MappedFileInputStream()
+		{
+			if (m_Mapping != nullptr)
+			{
+				munmap(m_Mapping, static_cast<size_t>(m_End - m_Begin));
+			}
+		}
+
+#endif	// if _WIN32
+
+		// *************************************************************** //
+		// **              BufferedWriter class implementation.         ** //
+		// *************************************************************** //
+
+		/**
+		 * Passes the text to the file or string.
+		 */
+		CR_API void BufferedWriter::WriteDirectly(char const* const text, size_t const length)
+		{
+			if (length == 0)
+			{
+				return;
+			}
+			if (m_String != nullptr)
+			{
+				m_String->append(text, length);
+			}
+			else if (fwrite(text, 1, length, m_File) != length)
+			{
+				throw Exception("Failed to write the output file.");
+			}
+		}
+
+	}	// namespace IO
+
+}	// namespace Cr
@@ -12,8 +12,17 @@
 // $$***************************************************************$$ //
 
 #pragma once
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
 #include <memory>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
 #include <list>
 
 #define CR_API
@@ -79,8 +88,21 @@ namespace Cr
 	// Tiny exception hierarchy.
 	struct Exception : public std::exception
 	{
-		explicit Exception(char const* const /*message*/)
-			: std::exception(/*message*/) {}
+		std::string m_Message;
+
+		explicit Exception(char const* const message)
+			: m_Message(message) {}
+
+		/**
+		 * Initializes an exception with the message prefixed by the source location.
+		 * Implemented in SourceManager.cpp.
+		 */
+		CR_API explicit Exception(char const* message, uint32_t location);
+
+		virtual char const* what() const throw() override
+		{
+			return m_Message.c_str();
+		}
 	};	// class Exception
 
 #define CrDefineExceptionBase(ClassName, ClassBaseName) \
@@ -88,11 +110,254 @@ namespace Cr
 	{ \
 		explicit ClassName(char const* const message) \
 			: ClassBaseName(message) {} \
+		explicit ClassName(char const* const message, uint32_t const location) \
+			: ClassBaseName(message, location) {} \
 	}
 #define CrDefineException(ClassName) CrDefineExceptionBase(ClassName, Exception)
 
 	CrDefineException(WorkflowException);
 
+	/**
+	 * Bump allocator: memory is handed out from large blocks and released only with the arena itself.
+	 * Destructors of the allocated objects are never called.
+	 */
+	class Arena final
+	{
+	private:
+		std::vector<std::unique_ptr<char[]>> m_Blocks;
+		char*  m_Cursor = nullptr;
+		char*  m_End = nullptr;
+		size_t m_BlockSize;
+
+	public:
+		Arena(Arena const&) = delete;
+		Arena& operator= (Arena const&) = delete;
+
+		explicit Arena(size_t const blockSize = 64 * 1024)
+			: m_BlockSize(blockSize)
+		{}
+
+		/**
+		 * Allocates uninitialized memory of the specified size and alignment.
+		 */
+		CRINL void* Allocate(size_t const size, size_t const alignment = alignof(std::max_align_t))
+		{
+			assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+			auto const address = reinterpret_cast<uintptr_t>(m_Cursor);
+			auto const aligned = reinterpret_cast<char*>((address + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1));
+			if (m_Cursor == nullptr || aligned > m_End || static_cast<size_t>(m_End - aligned) < size)
+			{
+				return AllocateBlock(size, alignment);
+			}
+			m_Cursor = aligned + size;
+			return aligned;
+		}
+
+		/**
+		 * Constructs a new object inside the arena.
+		 */
+		template<typename Tp, typename... TArgs>
+		CRINL Tp* New(TArgs&&... args)
+		{
+			return new (Allocate(sizeof(Tp), alignof(Tp))) Tp(std::forward<TArgs>(args)...);
+		}
+
+	private:
+		CR_API void* AllocateBlock(size_t size, size_t alignment);
+	};	// class Arena
+
+	/**
+	 * Growable array, which elements are allocated inside the arena.
+	 * Array is trivially destructible: storage is reallocated from the arena when it is full, the old one is abandoned.
+	 * Copies of the array share the storage.
+	 */
+	template<typename Tp>
+	class ArenaVector final
+	{
+	private:
+		Tp*      m_Elements = nullptr;
+		uint32_t m_Size = 0;
+		uint32_t m_Capacity = 0;
+
+	public:
+		CRINL Tp* begin() const
+		{
+			return m_Elements;
+		}
+		CRINL Tp* end() const
+		{
+			return m_Elements + m_Size;
+		}
+		CRINL size_t size() const
+		{
+			return m_Size;
+		}
+		CRINL bool empty() const
+		{
+			return m_Size == 0;
+		}
+		CRINL Tp& operator[] (size_t const index) const
+		{
+			assert(index < m_Size);
+			return m_Elements[index];
+		}
+		CRINL Tp& front() const
+		{
+			assert(m_Size != 0);
+			return m_Elements[0];
+		}
+		CRINL Tp& back() const
+		{
+			assert(m_Size != 0);
+			return m_Elements[m_Size - 1];
+		}
+
+		/**
+		 * Appends the element, storage is allocated from the specified arena.
+		 */
+		CRINL void PushBack(Arena& arena, Tp const& element)
+		{
+			if (m_Size == m_Capacity)
+			{
+				Grow(arena);
+			}
+			new (m_Elements + m_Size++) Tp(element);
+		}
+		CRINL void PopBack()
+		{
+			assert(m_Size != 0);
+			--m_Size;
+		}
+
+	private:
+		CRINL void Grow(Arena& arena)
+		{
+			auto const capacity = m_Capacity == 0 ? 4 : m_Capacity * 2;
+			auto const elements = static_cast<Tp*>(arena.Allocate(sizeof(Tp) * capacity, alignof(Tp)));
+			for (uint32_t i = 0; i < m_Size; ++i)
+			{
+				new (elements + i) Tp(m_Elements[i]);
+			}
+			m_Elements = elements;
+			m_Capacity = capacity;
+		}
+	};	// class ArenaVector
+
+	/**
+	 * FIFO queue over the single power-of-two array, that grows when it is full.
+	 * Elements are read and written in batches with at most two copies.
+	 */
+	template<typename Tp>
+	class RingBuffer final
+	{
+	private:
+		std::unique_ptr<Tp[]> m_Elements;
+		size_t m_Capacity;
+		size_t m_Head = 0;
+		size_t m_Size = 0;
+
+	public:
+		RingBuffer(RingBuffer const&) = delete;
+		RingBuffer& operator= (RingBuffer const&) = delete;
+
+		explicit RingBuffer(size_t const capacity = 256)
+			: m_Elements(new Tp[capacity]), m_Capacity(capacity)
+		{
+			assert(capacity != 0 && (capacity & (capacity - 1)) == 0);
+		}
+
+		CRINL bool IsEmpty() const
+		{
+			return m_Size == 0;
+		}
+		CRINL size_t GetSize() const
+		{
+			return m_Size;
+		}
+
+		/**
+		 * Appends the element to the back of the queue.
+		 */
+		CRINL void PushBack(Tp const& element)
+		{
+			if (m_Size == m_Capacity)
+			{
+				Grow(m_Size + 1);
+			}
+			m_Elements[(m_Head + m_Size++) & (m_Capacity - 1)] = element;
+		}
+
+		/**
+		 * Removes the front element of the queue.
+		 */
+		CRINL Tp PopFront()
+		{
+			assert(m_Size != 0);
+			auto const& element = m_Elements[m_Head];
+			m_Head = (m_Head + 1) & (m_Capacity - 1);
+			--m_Size;
+			return element;
+		}
+
+		/**
+		 * Removes up to the specified amount of the front elements of the queue.
+		 * @returns Amount of the removed elements.
+		 */
+		CRINL size_t PopFront(Tp* const elements, size_t count)
+		{
+			count = std::min(count, m_Size);
+			auto const firstCount = std::min(count, m_Capacity - m_Head);
+			std::copy(m_Elements.get() + m_Head, m_Elements.get() + m_Head + firstCount, elements);
+			std::copy(m_Elements.get(), m_Elements.get() + (count - firstCount), elements + firstCount);
+			m_Head = (m_Head + count) & (m_Capacity - 1);
+			m_Size -= count;
+			return count;
+		}
+
+	private:
+		CRINL void Grow(size_t const size)
+		{
+			auto capacity = m_Capacity * 2;
+			while (capacity < size)
+			{
+				capacity *= 2;
+			}
+			std::unique_ptr<Tp[]> elements(new Tp[capacity]);
+			m_Size = PopFront(elements.get(), m_Size);
+			m_Elements = std::move(elements);
+			m_Capacity = capacity;
+			m_Head = 0;
+		}
+	};	// class RingBuffer
+
+	// Tiny hashing utilities.
+	namespace Hash
+	{
+		/**
+		 * Computes the 32-bit FNV-1a hash of the specified bytes. Usable at compile time.
+		 */
+		CRINL constexpr uint32_t Fnv1a(char const* const data, size_t const length, uint32_t hash = 2166136261u)
+		{
+			for (size_t i = 0; i < length; ++i)
+			{
+				hash = (hash ^ static_cast<uint8_t>(data[i])) * 16777619u;
+			}
+			return hash;
+		}
+
+		/**
+		 * Computes the 64-bit FNV-1a hash of the specified bytes, used where collisions should be unlikely.
+		 */
+		CRINL constexpr uint64_t Fnv1a64(char const* const data, size_t const length, uint64_t hash = 14695981039346656037ull)
+		{
+			for (size_t i = 0; i < length; ++i)
+			{
+				hash = (hash ^ static_cast<uint8_t>(data[i])) * 1099511628211ull;
+			}
+			return hash;
+		}
+	}	// namespace Hash
+
 	// Tiny unit-testing framework.
 	namespace Testing
 	{
@@ -121,12 +386,20 @@ namespace Cr
 	{
 		class Exception : public Cr::Exception
 		{
+		public:
+			explicit Exception(char const* const message)
+				: Cr::Exception(message) {}
 		};	// class Exception
 
 		class EndOfStreamException : Exception
 		{
 		};	// class EndOfStreamException
 
+		/**
+		 * Returns the directory for the temporary files, without the trailing separator.
+		 */
+		CR_API std::string GetTemporaryDirectory();
+
 		class InputStream
 		{
 		public:
@@ -136,6 +409,18 @@ namespace Cr
 
 		public:
 			virtual int ReadNextChar() = 0;
+
+			/**
+			 * Provides the remaining contents of the stream as a contiguous memory range.
+			 * Consumers may walk this range directly instead of calling 'ReadNextChar' per character.
+			 * @returns False if this stream is not backed by contiguous memory.
+			 */
+			virtual bool GetBuffer(char const*& begin, char const*& end) const
+			{
+				static_cast<void>(begin);
+				static_cast<void>(end);
+				return false;
+			}
 		};	// class InputStream
 
 		typedef std::shared_ptr<InputStream> PInputStream;
@@ -155,8 +440,142 @@ namespace Cr
 				++m_String;
 				return result;
 			}
+			virtual bool GetBuffer(char const*& begin, char const*& end) const override final
+			{
+				begin = m_String;
+				end = m_String + strlen(m_String);
+				return true;
+			}
 		};	// class StringInputStream
 
+		/**
+		 * Stream over a memory range that is owned by someone else.
+		 */
+		class BufferInputStream final : public InputStream
+		{
+		private:
+			char const* m_Cursor;
+			char const* m_End;
+
+		public:
+			explicit BufferInputStream(char const* begin, char const* end) 
+				: m_Cursor(begin), m_End(end) { assert(begin != nullptr && begin <= end); }
+			virtual int ReadNextChar() override final
+			{
+				if (m_Cursor == m_End)
+					return EOF;
+				return *m_Cursor++;
+			}
+			virtual bool GetBuffer(char const*& begin, char const*& end) const override final
+			{
+				begin = m_Cursor;
+				end = m_End;
+				return true;
+			}
+		};	// class BufferInputStream
+
+		/**
+		 * Read-only stream over a file that is mapped into the address space.
+		 * The mapping stays alive while the stream exists.
+		 */
+		class MappedFileInputStream final : public InputStream
+		{
+		private:
+			char const* m_Begin = nullptr;
+			char const* m_Cursor = nullptr;
+			char const* m_End = nullptr;
+			void* m_Mapping = nullptr;
+
+		public:
+			explicit MappedFileInputStream(char const* const path);
+			virtual ~MappedFileInputStream();
+
+			virtual int ReadNextChar() override final
+			{
+				if (m_Cursor == m_End)
+					return EOF;
+				return *m_Cursor++;
+			}
+			virtual bool GetBuffer(char const*& begin, char const*& end) const override final
+			{
+				begin = m_Cursor;
+				end = m_End;
+				return true;
+			}
+		};	// class MappedFileInputStream
+
+		/**
+		 * Writer that collects the output in the fixed buffer and passes it to the file or string in large blocks.
+		 * Buffer is flushed when it is full and when the writer is destroyed.
+		 */
+		class BufferedWriter final
+		{
+		private:
+			FILE*        m_File = nullptr;
+			std::string* m_String = nullptr;
+			size_t       m_Size = 0;
+			char         m_Buffer[64 * 1024];
+
+		public:
+			BufferedWriter(BufferedWriter const&) = delete;
+			BufferedWriter& operator= (BufferedWriter const&) = delete;
+
+			explicit BufferedWriter(FILE* const file)
+				: m_File(file) { assert(file != nullptr); }
+			explicit BufferedWriter(std::string& string)
+				: m_String(&string) {}
+			~BufferedWriter()
+			{
+				// Errors are reported by the explicit flush only.
+				try
+				{
+					Flush();
+				}
+				catch (Exception const&)
+				{
+				}
+			}
+
+			CRINL void Write(char const* const text, size_t const length)
+			{
+				if (length > sizeof m_Buffer - m_Size)
+				{
+					Flush();
+					if (length > sizeof m_Buffer)
+					{
+						WriteDirectly(text, length);
+						return;
+					}
+				}
+				memcpy(m_Buffer + m_Size, text, length);
+				m_Size += length;
+			}
+			CRINL void Write(char const c)
+			{
+				if (m_Size == sizeof m_Buffer)
+				{
+					Flush();
+				}
+				m_Buffer[m_Size++] = c;
+			}
+			CRINL void Write(char const* const text)
+			{
+				Write(text, strlen(text));
+			}
+
+			/**
+			 * Passes the buffered output to the file or string.
+			 */
+			CRINL void Flush()
+			{
+				WriteDirectly(m_Buffer, m_Size);
+				m_Size = 0;
+			}
+
+		private:
+			CR_API void WriteDirectly(char const* text, size_t length);
+		};	// class BufferedWriter
+
 	}	// namespace IO
 
 }	// namespace Cr